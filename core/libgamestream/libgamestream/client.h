@@ -51,6 +51,13 @@ typedef struct _SERVER_DATA {
 
 typedef struct GS_CLIENT_T *GS_CLIENT;
 
+typedef enum GS_STATUS_MODE {
+    /** Request serverinfo over HTTPS, and fall back to HTTP if refused */
+    GS_STATUS_SERIAL,
+    /** Request serverinfo over HTTPS and HTTP concurrently, HTTPS response is used if available */
+    GS_STATUS_RACE,
+} GS_STATUS_MODE;
+
 GS_CLIENT gs_new(const char *keydir);
 
 int gs_conf_init(const char *keydir);
@@ -59,6 +66,8 @@ void gs_destroy(GS_CLIENT hnd);
 
 void gs_set_timeout(GS_CLIENT hnd, int timeout_secs);
 
+void gs_set_status_mode(GS_CLIENT hnd, GS_STATUS_MODE mode);
+
 int gs_get_status(GS_CLIENT hnd, PSERVER_DATA server, const char *address, uint16_t port, bool unsupported);
 
 int gs_start_app(GS_CLIENT hnd, PSERVER_DATA server, PSTREAM_CONFIGURATION config, int appId, bool is_gfe, bool sops,
@@ -72,4 +81,8 @@ int gs_pair(GS_CLIENT hnd, PSERVER_DATA server, const char *pin);
 
 int gs_quit_app(GS_CLIENT hnd, PSERVER_DATA server);
 
+/**
+ * Download cover of the app to `path`. An existing file is replaced atomically, or kept if the host says it's not
+ * modified.
+ */
 int gs_download_cover(GS_CLIENT hnd, const SERVER_DATA *server, int appId, const char *path);
\ No newline at end of file
@@ -19,7 +19,9 @@
 
 #pragma once
 
+#include <stdarg.h>
 #include <stddef.h>
+#include <stdbool.h>
 
 #define CERTIFICATE_FILE_NAME "client.pem"
 #define KEY_FILE_NAME "key.pem"
@@ -29,16 +31,99 @@ typedef struct HTTP_T HTTP;
 typedef struct _HTTP_DATA {
     char *memory;
     size_t size;
+    /** Allocated size of memory, always larger than size */
+    size_t capacity;
 } HTTP_DATA;
 
+typedef struct _HTTP_REQUEST {
+    char *url;
+    HTTP_DATA *data;
+    /** Whether the request has finished, requests that lost the race are aborted */
+    bool done;
+    /** Result of finished request, same as http_request */
+    int result;
+} HTTP_REQUEST;
+
+/**
+ * Called after every request finishes, on the thread that made it.
+ * @param result Same as the return value of the request function
+ * @param bytes Size of response body received
+ */
+typedef void (*http_request_observer)(int result, long http_code, size_t bytes, double elapsed_ms);
+
+/**
+ * Set an observer for all clients, e.g. to collect metrics. Set it before making any request.
+ */
+void http_set_request_observer(http_request_observer observer);
+
+/**
+ * Receives log messages of requests, with the same arguments as commons_log_vprintf.
+ */
+typedef void (*http_logger)(int level, const char *tag, const char *fmt, va_list args);
+
+/**
+ * @return Whether messages of this level would be written, so they can be skipped before formatting
+ */
+typedef bool (*http_log_filter)(int level);
+
+/**
+ * Set a logger for all clients, e.g. to keep formatting and writing logs off request threads. Messages go to
+ * commons_log_vprintf if not set. Set it before making any request.
+ * @param filter Optional, messages it rejects are not formatted at all
+ */
+void http_set_logger(http_logger logger, http_log_filter filter);
+
 HTTP *http_create(const char *keydir);
 
 int http_request(HTTP *http, char *url, HTTP_DATA * data);
 
+/**
+ * Perform requests concurrently.
+ *
+ * Returns as soon as the request at index `preferred` succeeds, or when all requests finished.
+ * @return GS_OK if requests were performed, check `done` and `result` of each request for the outcome
+ */
+int http_request_race(HTTP *http, HTTP_REQUEST *requests, size_t count, size_t preferred);
+
+/**
+ * Download response body to file at `path`.
+ *
+ * Body is written to a temporary file next to `path` as it arrives, and replaces `path` only when the transfer
+ * succeeded. If `path` exists, it's revalidated with If-Modified-Since and If-None-Match and kept if not modified.
+ * @param modified Set to false if existing file was kept, can be NULL
+ */
+int http_download(HTTP *http, char *url, const char *path, bool *modified);
+
 void http_destroy(HTTP *http);
 
 void http_set_timeout(HTTP *http, int timeout);
 
 HTTP_DATA * http_data_alloc();
 
+/**
+ * Append to the buffer, growing its capacity geometrically. Memory is always NUL terminated.
+ */
+void http_data_append(HTTP_DATA *data, const void *contents, size_t len);
+
+/**
+ * cURL write callback appending the response to the HTTP_DATA passed as userp.
+ */
+size_t http_data_write_fn(void *contents, size_t size, size_t nmemb, void *userp);
+
+/**
+ * Empty the buffer, but keep its capacity.
+ */
+void http_data_reset(HTTP_DATA *data);
+
 void http_data_free(HTTP_DATA * data);
+
+/**
+ * Take a buffer from the pool of this client, or allocate one if the pool is empty.
+ * Return it with http_data_release.
+ */
+HTTP_DATA *http_data_acquire(HTTP *http);
+
+/**
+ * Return the buffer to the pool so its capacity is reused by later requests.
+ */
+void http_data_release(HTTP *http, HTTP_DATA *data);
@@ -30,6 +30,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <stdarg.h>
+#include <pthread.h>
 #include <mbedtls/md.h>
 #include <mbedtls/aes.h>
 #include <mbedtls/ctr_drbg.h>
@@ -54,8 +55,35 @@
 #include "set_error.h"
 #include "conf.h"
 
+#define HTTPS_PORT_CACHE_SIZE 16
+
+/**
+ * HTTPS port of hosts using custom ports. Clients are created for each task, so this is shared by all of them.
+ */
+static struct {
+    struct https_port_cache_entry {
+        char address[256];
+        uint16_t port;
+        uint16_t https_port;
+    } entries[HTTPS_PORT_CACHE_SIZE];
+    size_t next;
+    pthread_mutex_t lock;
+} https_port_cache = {.lock = PTHREAD_MUTEX_INITIALIZER};
+
 static int load_server_status(GS_CLIENT hnd, PSERVER_DATA server);
 
+static int load_server_status_serial(GS_CLIENT hnd, PSERVER_DATA server);
+
+static int load_server_status_race(GS_CLIENT hnd, PSERVER_DATA server);
+
+static int parse_server_status(PSERVER_DATA server, HTTP_DATA *data);
+
+static void server_status_free(PSERVER_DATA server);
+
+static uint16_t https_port_cache_get(const char *address, uint16_t port);
+
+static void https_port_cache_put(const char *address, uint16_t port, uint16_t https_port);
+
 static int resolve_ports(GS_CLIENT hnd, const char *address, uint16_t port, uint16_t *https_port);
 
 static bool construct_url(GS_CLIENT, char *url, size_t ulen, bool secure, const char *address, uint16_t port,
@@ -97,7 +125,7 @@ static void hex_to_bytes(const char *in, unsigned char *out, size_t maxlen, size
 int gs_unpair(GS_CLIENT hnd, PSERVER_DATA server) {
     int ret = GS_OK;
     char url[4096];
-    HTTP_DATA *data = http_data_alloc();
+    HTTP_DATA *data = http_data_acquire(hnd->http);
     if (data == NULL) {
         return GS_OUT_OF_MEMORY;
     }
@@ -117,7 +145,7 @@ int gs_unpair(GS_CLIENT hnd, PSERVER_DATA server) {
     server->paired = false;
 
     cleanup:
-    http_data_free(data);
+    http_data_release(hnd->http, data);
 
     return ret;
 }
@@ -197,7 +225,7 @@ int gs_pair(GS_CLIENT hnd, PSERVER_DATA server, const char *pin) {
     // because the user must enter the PIN before the server responds
     construct_url(hnd, url, sizeof(url), false, server->serverInfo.address, server_port(server, false), "pair",
                   "devicename=roth&updateState=1&phrase=getservercert&salt=%s&clientcert=%s", salt_hex, hnd->cert_hex);
-    data = http_data_alloc();
+    data = http_data_acquire(hnd->http);
 
     if ((ret = http_request(hnd->http, url, data)) != GS_OK) {
         gs_set_error(ret, "Failed to request pairing. Check connection.");
@@ -447,7 +475,7 @@ int gs_pair(GS_CLIENT hnd, PSERVER_DATA server, const char *pin) {
     }
 
     if (data != NULL) {
-        http_data_free(data);
+        http_data_release(hnd->http, data);
     }
 
     mbedtls_aes_free(&aes_enc);
@@ -462,7 +490,7 @@ int gs_pair(GS_CLIENT hnd, PSERVER_DATA server, const char *pin) {
 int gs_applist(GS_CLIENT hnd, const SERVER_DATA *server, PAPP_LIST *list) {
     int ret = GS_OK;
     char url[4096];
-    HTTP_DATA *data = http_data_alloc();
+    HTTP_DATA *data = http_data_acquire(hnd->http);
     if (data == NULL) {
         return gs_set_error(GS_OUT_OF_MEMORY, "Out of memory");
     }
@@ -476,7 +504,7 @@ int gs_applist(GS_CLIENT hnd, const SERVER_DATA *server, PAPP_LIST *list) {
         ret = GS_INVALID;
     }
 
-    http_data_free(data);
+    http_data_release(hnd->http, data);
     return ret;
 }
 
@@ -527,7 +555,7 @@ int gs_start_app(GS_CLIENT hnd, PSERVER_DATA server, STREAM_CONFIGURATION *confi
     char rikey_hex[33];
     bytes_to_hex((unsigned char *) config->remoteInputAesKey, rikey_hex, 16);
 
-    data = http_data_alloc();
+    data = http_data_acquire(hnd->http);
     bool resume = server->currentGame == 0;
 
     if (resume) {
@@ -602,7 +630,7 @@ int gs_start_app(GS_CLIENT hnd, PSERVER_DATA server, STREAM_CONFIGURATION *confi
     }
 
     if (data != NULL) {
-        http_data_free(data);
+        http_data_release(hnd->http, data);
     }
 
     mbedtls_ctr_drbg_free(&ctr_drbg);
@@ -613,7 +641,7 @@ int gs_quit_app(GS_CLIENT hnd, PSERVER_DATA server) {
     int ret = GS_OK;
     char url[4096];
     char *result = NULL;
-    HTTP_DATA *data = http_data_alloc();
+    HTTP_DATA *data = http_data_acquire(hnd->http);
     if (data == NULL) {
         return gs_set_error(GS_OUT_OF_MEMORY, "Out of memory");
     }
@@ -644,38 +672,15 @@ int gs_quit_app(GS_CLIENT hnd, PSERVER_DATA server) {
         free(result);
     }
 
-    http_data_free(data);
+    http_data_release(hnd->http, data);
     return ret;
 }
 
 int gs_download_cover(GS_CLIENT hnd, const SERVER_DATA *server, int appid, const char *path) {
-    int ret = GS_OK;
     char url[4096];
-    HTTP_DATA *data = http_data_alloc();
-    if (data == NULL) {
-        return GS_OUT_OF_MEMORY;
-    }
-
     construct_url(hnd, url, sizeof(url), true, server->serverInfo.address, server_port(server, true), "appasset",
                   "appid=%d&AssetType=2&AssetIdx=0", appid);
-    ret = http_request(hnd->http, url, data);
-    if (ret != GS_OK) {
-        goto cleanup;
-    }
-
-    FILE *f = fopen(path, "wb");
-    if (f == NULL) {
-        ret = gs_set_error(GS_IO_ERROR, "Failed to download cover");
-        goto cleanup;
-    }
-
-    fwrite(data->memory, data->size, 1, f);
-    fflush(f);
-    fclose(f);
-
-    cleanup:
-    http_data_free(data);
-    return ret;
+    return http_download(hnd->http, url, path, NULL);
 }
 
 GS_CLIENT gs_new(const char *keydir) {
@@ -707,6 +712,10 @@ void gs_set_timeout(GS_CLIENT hnd, int timeout_secs) {
     http_set_timeout(hnd->http, timeout_secs);
 }
 
+void gs_set_status_mode(GS_CLIENT hnd, GS_STATUS_MODE mode) {
+    hnd->status_mode = mode;
+}
+
 int gs_get_status(GS_CLIENT hnd, PSERVER_DATA server, const char *address, uint16_t port, bool unsupported) {
     LiInitializeServerInformation(&server->serverInfo);
     server->serverInfo.address = address;
@@ -716,6 +725,36 @@ int gs_get_status(GS_CLIENT hnd, PSERVER_DATA server, const char *address, uint1
 }
 
 static int load_server_status(GS_CLIENT hnd, PSERVER_DATA server) {
+    const char *address = server->serverInfo.address;
+    uint16_t port = server->extPort;
+    if (port != 0 && server->httpsPort == 0) {
+        server->httpsPort = https_port_cache_get(address, port);
+    }
+    int ret;
+    if (hnd->status_mode == GS_STATUS_RACE) {
+        ret = load_server_status_race(hnd, server);
+    } else {
+        ret = load_server_status_serial(hnd, server);
+    }
+
+    if (ret == GS_OK && port != 0) {
+        https_port_cache_put(address, port, server->httpsPort);
+    }
+
+    if (ret == GS_OK && !server->unsupported) {
+        if (server->serverMajorVersion > MAX_SUPPORTED_GFE_VERSION) {
+            ret = gs_set_error(GS_UNSUPPORTED_VERSION, "Ensure you're running the latest version of Moonlight "
+                                                       "or downgrade GeForce Experience and try again");
+        } else if (server->serverMajorVersion < MIN_SUPPORTED_GFE_VERSION) {
+            ret = gs_set_error(GS_UNSUPPORTED_VERSION, "Moonlight requires a newer version of GeForce Experience. "
+                                                       "Please upgrade GFE on your PC and try again.");
+        }
+    }
+
+    return ret;
+}
+
+static int load_server_status_serial(GS_CLIENT hnd, PSERVER_DATA server) {
     int ret = GS_OK;
     if (server->extPort != 0 && server->httpsPort == 0) {
         ret = resolve_ports(hnd, server->serverInfo.address, server->extPort, &server->httpsPort);
@@ -727,15 +766,6 @@ static int load_server_status(GS_CLIENT hnd, PSERVER_DATA server) {
     char url[4096];
     int i = 0;
     do {
-        char *pairedText = NULL;
-        char *currentGameText = NULL;
-        char *stateText = NULL;
-        char *serverCodecModeSupportText = NULL;
-        char *httpsPortText = NULL;
-        char *externalPortText = NULL;
-
-        ret = GS_INVALID;
-
         // Modern GFE versions don't allow serverinfo to be fetched over HTTPS if the client
         // is not already paired. Since we can't pair without knowing the server version, we
         // make another request over HTTP if the HTTPS request fails. We can't just use HTTP
@@ -744,10 +774,9 @@ static int load_server_status(GS_CLIENT hnd, PSERVER_DATA server) {
         construct_url(hnd, url, sizeof(url), secure, server->serverInfo.address, server_port(server, secure),
                       "serverinfo", NULL);
 
-        HTTP_DATA *data = http_data_alloc();
+        HTTP_DATA *data = http_data_acquire(hnd->http);
         if (data == NULL) {
-            ret = GS_OUT_OF_MEMORY;
-            goto cleanup;
+            return GS_OUT_OF_MEMORY;
         }
         if ((ret = http_request(hnd->http, url, data)) != GS_OK) {
             if (i == 0 && ret == GS_FAILED) {
@@ -755,140 +784,303 @@ static int load_server_status(GS_CLIENT hnd, PSERVER_DATA server) {
             } else {
                 ret = GS_IO_ERROR;
             }
-            goto cleanup;
+        } else {
+            ret = parse_server_status(server, data);
         }
+        http_data_release(hnd->http, data);
 
-        if (xml_status(data->memory, data->size) == GS_ERROR) {
-            ret = GS_ERROR;
-            goto cleanup;
-        }
+        i++;
+    } while (ret == GS_ERROR && i < 2);
+    return ret;
+}
 
-        if (xml_search(data->memory, data->size, "uniqueid", (char **) &server->uuid) != GS_OK) {
-            goto cleanup;
-        }
-        if (xml_search(data->memory, data->size, "mac", (char **) &server->mac) != GS_OK) {
+/**
+ * Same as load_server_status_serial, but HTTP request doesn't wait for HTTPS one to fail.
+ * When HTTPS port is not known yet, HTTP response tells us which port to use.
+ */
+static int load_server_status_race(GS_CLIENT hnd, PSERVER_DATA server) {
+    const char *address = server->serverInfo.address;
+    uint16_t port = server->extPort, https_port = server->httpsPort;
+    char https_url[4096], http_url[4096];
+    HTTP_REQUEST requests[2] = {
+            {.url = https_url, .data = http_data_acquire(hnd->http), .result = GS_FAILED},
+            {.url = http_url, .data = http_data_acquire(hnd->http), .result = GS_FAILED},
+    };
+    HTTP_REQUEST *https = &requests[0], *http = &requests[1];
+    if (https->data == NULL || http->data == NULL) {
+        http_data_release(hnd->http, https->data);
+        http_data_release(hnd->http, http->data);
+        return GS_OUT_OF_MEMORY;
+    }
+    int ret;
+    construct_url(hnd, http_url, sizeof(http_url), false, address, port, "serverinfo", NULL);
+    if (port == 0 || https_port != 0) {
+        construct_url(hnd, https_url, sizeof(https_url), true, address, https_port, "serverinfo", NULL);
+        if ((ret = http_request_race(hnd->http, requests, 2, 0)) != GS_OK) {
             goto cleanup;
         }
-        if (xml_search(data->memory, data->size, "hostname", (char **) &server->hostname) != GS_OK) {
-            server->hostname = strdup(server->serverInfo.address);
-        }
+    }
 
-        if (xml_search(data->memory, data->size, "currentgame", &currentGameText) != GS_OK) {
+    // Only HTTPS response tells us if we're paired
+    if (https->done && https->result == GS_OK) {
+        if ((ret = parse_server_status(server, https->data)) != GS_ERROR) {
             goto cleanup;
         }
+        https->result = GS_FAILED;
+    }
 
-        if (xml_search(data->memory, data->size, "PairStatus", &pairedText) != GS_OK) {
-            goto cleanup;
-        }
+    if (!http->done) {
+        http->result = http_request(hnd->http, http_url, http->data);
+        http->done = true;
+    }
+    if (http->result != GS_OK) {
+        ret = GS_IO_ERROR;
+        goto cleanup;
+    }
+    if ((ret = parse_server_status(server, http->data)) != GS_OK) {
+        goto cleanup;
+    }
 
-        if (xml_search(data->memory, data->size, "appversion", (char **) &server->serverInfo.serverInfoAppVersion) !=
-            GS_OK) {
-            goto cleanup;
+    if (port != 0 && server->httpsPort != 0 && server->httpsPort != https_port) {
+        // HTTPS port was unknown or has changed, so ask again with the one we just learned
+        construct_url(hnd, https_url, sizeof(https_url), true, address, server->httpsPort, "serverinfo", NULL);
+        https->done = true;
+        if ((https->result = http_request(hnd->http, https_url, https->data)) == GS_OK) {
+            if (parse_server_status(server, https->data) == GS_ERROR) {
+                https->result = GS_FAILED;
+            }
         }
+    }
+    if (https->done && https->result == GS_IO_ERROR) {
+        // Not refused for being unpaired, the host isn't reachable over HTTPS
+        ret = GS_IO_ERROR;
+    }
 
-        if (xml_search(data->memory, data->size, "state", &stateText) != GS_OK) {
-            goto cleanup;
-        }
+    cleanup:
+    http_data_release(hnd->http, https->data);
+    http_data_release(hnd->http, http->data);
+    return ret;
+}
 
-        if (xml_search(data->memory, data->size, "ServerCodecModeSupport", &serverCodecModeSupportText) != GS_OK) {
-            goto cleanup;
-        }
+/**
+ * @return GS_OK if parsed successfully, GS_ERROR if server responded with error status
+ */
+static int parse_server_status(PSERVER_DATA server, HTTP_DATA *data) {
+    char *pairedText = NULL;
+    char *currentGameText = NULL;
+    char *stateText = NULL;
+    char *serverCodecModeSupportText = NULL;
+    char *httpsPortText = NULL;
+    char *externalPortText = NULL;
 
-        if (xml_search(data->memory, data->size, "gputype", (char **) &server->gpuType) != GS_OK) {
-            goto cleanup;
-        }
+    int ret = GS_INVALID;
 
-        if (xml_search(data->memory, data->size, "GsVersion", (char **) &server->gsVersion) != GS_OK) {
-            goto cleanup;
-        }
+    // Parsed into a copy, so values from an earlier response are only replaced when this one is complete
+    SERVER_DATA parsed = *server;
+    parsed.uuid = NULL;
+    parsed.mac = NULL;
+    parsed.hostname = NULL;
+    parsed.gpuType = NULL;
+    parsed.gsVersion = NULL;
+    parsed.modes = NULL;
+    parsed.serverInfo.serverInfoAppVersion = NULL;
+    parsed.serverInfo.serverInfoGfeVersion = NULL;
 
-        if (xml_search(data->memory, data->size, "GfeVersion", (char **) &server->serverInfo.serverInfoGfeVersion) !=
-            GS_OK) {
-            goto cleanup;
-        }
+    if (xml_status(data->memory, data->size) == GS_ERROR) {
+        ret = GS_ERROR;
+        goto cleanup;
+    }
 
-        if (xml_search(data->memory, data->size, "HttpsPort", &httpsPortText) != GS_OK) {
-            goto cleanup;
-        }
+    if (xml_search(data->memory, data->size, "uniqueid", (char **) &parsed.uuid) != GS_OK) {
+        goto cleanup;
+    }
+    if (xml_search(data->memory, data->size, "mac", (char **) &parsed.mac) != GS_OK) {
+        goto cleanup;
+    }
+    if (xml_search(data->memory, data->size, "hostname", (char **) &parsed.hostname) != GS_OK) {
+        parsed.hostname = strdup(parsed.serverInfo.address);
+    }
 
-        if (xml_search(data->memory, data->size, "ExternalPort", &externalPortText) != GS_OK) {
-            goto cleanup;
-        }
+    if (xml_search(data->memory, data->size, "currentgame", &currentGameText) != GS_OK) {
+        goto cleanup;
+    }
 
-        if (xml_modelist(data->memory, data->size, &server->modes) != GS_OK) {
-            goto cleanup;
-        }
+    if (xml_search(data->memory, data->size, "PairStatus", &pairedText) != GS_OK) {
+        goto cleanup;
+    }
 
-        // These fields are present on all version of GFE that this client supports
-        if (!strlen(currentGameText) || !strlen(pairedText) || !strlen(server->serverInfo.serverInfoAppVersion) ||
-            !strlen(stateText)) {
-            goto cleanup;
-        }
+    if (xml_search(data->memory, data->size, "appversion", (char **) &parsed.serverInfo.serverInfoAppVersion) !=
+        GS_OK) {
+        goto cleanup;
+    }
 
-        int serverCodecModeSupport = serverCodecModeSupportText == NULL ? 0 :
-                                     (int) strtol(serverCodecModeSupportText, NULL, 0);
-
-        server->paired = pairedText != NULL && strcmp(pairedText, "1") == 0;
-        server->currentGame = currentGameText == NULL ? 0 : (int) strtol(currentGameText, NULL, 0);
-        server->supports4K = serverCodecModeSupport != 0;
-        server->supportsHdr = serverCodecModeSupport & 0x200;
-        server->serverMajorVersion = (int) strtol(server->serverInfo.serverInfoAppVersion, NULL, 0);
-        // Real Nvidia host software (GeForce Experience and RTX Experience) both use the 'Mjolnir'
-        // codename in the state field and no version of Sunshine does. We can use this to bypass
-        // some assumptions about Nvidia hardware that don't apply to Sunshine hosts.
-        server->isGfe = strstr(stateText, "MJOLNIR") != NULL;
-        server->httpsPort = httpsPortText == NULL ? 0 : (int) strtol(httpsPortText, NULL, 0);
-        server->extPort = externalPortText == NULL ? 0 : (int) strtol(externalPortText, NULL, 0);
-
-        if (strstr(stateText, "_SERVER_BUSY") == NULL) {
-            // After GFE 2.8, current game remains set even after streaming
-            // has ended. We emulate the old behavior by forcing it to zero
-            // if streaming is not active.
-            server->currentGame = 0;
-        }
-        ret = GS_OK;
+    if (xml_search(data->memory, data->size, "state", &stateText) != GS_OK) {
+        goto cleanup;
+    }
 
-        cleanup:
-        if (data != NULL) {
-            http_data_free(data);
-        }
+    if (xml_search(data->memory, data->size, "ServerCodecModeSupport", &serverCodecModeSupportText) != GS_OK) {
+        goto cleanup;
+    }
 
-        if (pairedText != NULL) {
-            free(pairedText);
-        }
+    if (xml_search(data->memory, data->size, "gputype", (char **) &parsed.gpuType) != GS_OK) {
+        goto cleanup;
+    }
 
-        if (currentGameText != NULL) {
-            free(currentGameText);
-        }
+    if (xml_search(data->memory, data->size, "GsVersion", (char **) &parsed.gsVersion) != GS_OK) {
+        goto cleanup;
+    }
 
-        if (stateText != NULL) {
-            free(stateText);
-        }
+    if (xml_search(data->memory, data->size, "GfeVersion", (char **) &parsed.serverInfo.serverInfoGfeVersion) !=
+        GS_OK) {
+        goto cleanup;
+    }
 
-        if (serverCodecModeSupportText != NULL) {
-            free(serverCodecModeSupportText);
-        }
+    if (xml_search(data->memory, data->size, "HttpsPort", &httpsPortText) != GS_OK) {
+        goto cleanup;
+    }
 
-        i++;
-    } while (ret == GS_ERROR && i < 2);
+    if (xml_search(data->memory, data->size, "ExternalPort", &externalPortText) != GS_OK) {
+        goto cleanup;
+    }
 
-    if (ret == GS_OK && !server->unsupported) {
-        if (server->serverMajorVersion > MAX_SUPPORTED_GFE_VERSION) {
-            ret = gs_set_error(GS_UNSUPPORTED_VERSION, "Ensure you're running the latest version of Moonlight "
-                                                       "or downgrade GeForce Experience and try again");
-        } else if (server->serverMajorVersion < MIN_SUPPORTED_GFE_VERSION) {
-            ret = gs_set_error(GS_UNSUPPORTED_VERSION, "Moonlight requires a newer version of GeForce Experience. "
-                                                       "Please upgrade GFE on your PC and try again.");
-        }
+    if (xml_modelist(data->memory, data->size, &parsed.modes) != GS_OK) {
+        goto cleanup;
+    }
+
+    // These fields are present on all version of GFE that this client supports
+    if (!strlen(currentGameText) || !strlen(pairedText) || !strlen(parsed.serverInfo.serverInfoAppVersion) ||
+        !strlen(stateText)) {
+        goto cleanup;
+    }
+
+    int serverCodecModeSupport = serverCodecModeSupportText == NULL ? 0 :
+                                 (int) strtol(serverCodecModeSupportText, NULL, 0);
+
+    parsed.paired = pairedText != NULL && strcmp(pairedText, "1") == 0;
+    parsed.currentGame = currentGameText == NULL ? 0 : (int) strtol(currentGameText, NULL, 0);
+    parsed.serverInfo.serverCodecModeSupport = serverCodecModeSupport;
+    parsed.supports4K = serverCodecModeSupport != 0;
+    parsed.supportsHdr = serverCodecModeSupport & 0x200;
+    parsed.serverMajorVersion = (int) strtol(parsed.serverInfo.serverInfoAppVersion, NULL, 0);
+    // Real Nvidia host software (GeForce Experience and RTX Experience) both use the 'Mjolnir'
+    // codename in the state field and no version of Sunshine does. We can use this to bypass
+    // some assumptions about Nvidia hardware that don't apply to Sunshine hosts.
+    parsed.isGfe = strstr(stateText, "MJOLNIR") != NULL;
+    parsed.httpsPort = httpsPortText == NULL ? 0 : (int) strtol(httpsPortText, NULL, 0);
+    parsed.extPort = externalPortText == NULL ? 0 : (int) strtol(externalPortText, NULL, 0);
+
+    if (strstr(stateText, "_SERVER_BUSY") == NULL) {
+        // After GFE 2.8, current game remains set even after streaming
+        // has ended. We emulate the old behavior by forcing it to zero
+        // if streaming is not active.
+        parsed.currentGame = 0;
+    }
+    ret = GS_OK;
+
+    cleanup:
+    if (ret == GS_OK) {
+        server_status_free(server);
+        *server = parsed;
+    } else {
+        server_status_free(&parsed);
+    }
+
+    if (pairedText != NULL) {
+        free(pairedText);
+    }
+
+    if (currentGameText != NULL) {
+        free(currentGameText);
+    }
+
+    if (stateText != NULL) {
+        free(stateText);
+    }
+
+    if (serverCodecModeSupportText != NULL) {
+        free(serverCodecModeSupportText);
+    }
+
+    if (httpsPortText != NULL) {
+        free(httpsPortText);
+    }
+
+    if (externalPortText != NULL) {
+        free(externalPortText);
     }
 
     return ret;
 }
 
+/**
+ * Frees values allocated by parse_server_status, the struct itself is owned by the caller.
+ */
+static void server_status_free(PSERVER_DATA server) {
+    PDISPLAY_MODE mode = server->modes;
+    while (mode != NULL) {
+        PDISPLAY_MODE next = mode->next;
+        free(mode);
+        mode = next;
+    }
+    free((void *) server->uuid);
+    free((void *) server->mac);
+    free((void *) server->hostname);
+    free((void *) server->gpuType);
+    free((void *) server->gsVersion);
+    free((void *) server->serverInfo.serverInfoAppVersion);
+    free((void *) server->serverInfo.serverInfoGfeVersion);
+    server->uuid = NULL;
+    server->mac = NULL;
+    server->hostname = NULL;
+    server->gpuType = NULL;
+    server->gsVersion = NULL;
+    server->modes = NULL;
+    server->serverInfo.serverInfoAppVersion = NULL;
+    server->serverInfo.serverInfoGfeVersion = NULL;
+}
+
+static uint16_t https_port_cache_get(const char *address, uint16_t port) {
+    uint16_t https_port = 0;
+    pthread_mutex_lock(&https_port_cache.lock);
+    for (size_t i = 0; i < HTTPS_PORT_CACHE_SIZE; i++) {
+        const struct https_port_cache_entry *entry = &https_port_cache.entries[i];
+        if (entry->port == port && strcmp(entry->address, address) == 0) {
+            https_port = entry->https_port;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&https_port_cache.lock);
+    return https_port;
+}
+
+static void https_port_cache_put(const char *address, uint16_t port, uint16_t https_port) {
+    if (https_port == 0 || strlen(address) >= sizeof(https_port_cache.entries[0].address)) {
+        return;
+    }
+    pthread_mutex_lock(&https_port_cache.lock);
+    struct https_port_cache_entry *entry = NULL;
+    for (size_t i = 0; i < HTTPS_PORT_CACHE_SIZE; i++) {
+        if (https_port_cache.entries[i].port == port && strcmp(https_port_cache.entries[i].address, address) == 0) {
+            entry = &https_port_cache.entries[i];
+            break;
+        }
+    }
+    if (entry == NULL) {
+        // Replace oldest entry
+        entry = &https_port_cache.entries[https_port_cache.next];
+        https_port_cache.next = (https_port_cache.next + 1) % HTTPS_PORT_CACHE_SIZE;
+        strncpy(entry->address, address, sizeof(entry->address) - 1);
+        entry->address[sizeof(entry->address) - 1] = '\0';
+        entry->port = port;
+    }
+    entry->https_port = https_port;
+    pthread_mutex_unlock(&https_port_cache.lock);
+}
+
 static int resolve_ports(GS_CLIENT hnd, const char *address, uint16_t port, uint16_t *https_port) {
     int ret = GS_OK;
     char url[4096];
-    HTTP_DATA *data = http_data_alloc();
+    HTTP_DATA *data = http_data_acquire(hnd->http);
     if (data == NULL) {
         return GS_OUT_OF_MEMORY;
     }
@@ -912,7 +1104,7 @@ static int resolve_ports(GS_CLIENT hnd, const char *address, uint16_t port, uint
     *https_port = (uint16_t) strtol(httpsPortText, NULL, 0);
 
     cleanup:
-    http_data_free(data);
+    http_data_release(hnd->http, data);
     return ret;
 }
 
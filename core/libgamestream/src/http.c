@@ -23,34 +23,107 @@
 #include "logging.h"
 
 #include <string.h>
+#include <strings.h>
 #include <curl/curl.h>
 #include <pthread.h>
 #include <stdlib.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdatomic.h>
+#include <ctype.h>
 #include <assert.h>
+#include <sys/stat.h>
 
 #ifdef __WIN32
+#include <io.h>
+#include <windows.h>
+
 #define PATH_SEPARATOR '\\'
+#define fsync(fd) _commit(fd)
 #else
+
+#include <unistd.h>
+
 #define PATH_SEPARATOR '/'
 #endif
 
+#define HTTP_ETAG_MAX 256
+/* Responses can be hundreds of KiB, only the beginning is dumped so the log queue isn't flooded */
+#define HTTP_LOG_HEXDUMP_MAX 1024
+#define HTTP_LOG_HEXDUMP_LINE 16
+
+#define HTTP_DATA_POOL_SIZE 4
+/* Larger buffers are freed on release, so a single huge response doesn't pin memory */
+#define HTTP_DATA_POOL_MAX_CAPACITY (1024 * 1024)
+
 struct HTTP_T {
     CURL *curl;
     pthread_mutex_t mutex;
+    /* Response buffers kept with their capacity for next requests */
+    HTTP_DATA *pool[HTTP_DATA_POOL_SIZE];
+    size_t pool_size;
+    pthread_mutex_t pool_lock;
 };
 
-static size_t write_fn(void *contents, size_t size, size_t nmemb, void *userp) {
-    size_t realsize = size * nmemb;
-    HTTP_DATA *mem = (HTTP_DATA *) userp;
+typedef struct download_state_t {
+    FILE *fp;
+    char etag[HTTP_ETAG_MAX];
+} download_state_t;
+
+/* Makes temporary file names unique across concurrent downloads of the same file */
+static atomic_uint download_seq;
+
+static http_request_observer request_observer = NULL;
+static http_logger request_logger = NULL;
+static http_log_filter request_log_filter = NULL;
+
+static bool read_etag(const char *path, char *etag, size_t len);
 
-    void *allocated = realloc(mem->memory, mem->size + realsize + 1);
-    assert(allocated != NULL);
-    mem->memory = allocated;
-    memcpy(&(mem->memory[mem->size]), contents, realsize);
-    mem->size += realsize;
-    mem->memory[mem->size] = 0;
+static void write_etag(const char *path, const char *etag);
 
-    return realsize;
+static bool replace_file(const char *src, const char *dst);
+
+static void request_notify(CURL *curl, int result);
+
+static void http_log(int level, const char *fmt, ...) __attribute__ ((format (printf, 2, 3)));
+
+static void http_log_hexdump(const HTTP_DATA *data);
+
+static size_t write_file_fn(void *contents, size_t size, size_t nmemb, void *userp) {
+    download_state_t *state = userp;
+    // Returning less than requested makes cURL abort with CURLE_WRITE_ERROR
+    return fwrite(contents, 1, size * nmemb, state->fp);
+}
+
+static size_t header_fn(char *buffer, size_t size, size_t nitems, void *userp) {
+    download_state_t *state = userp;
+    size_t len = size * nitems;
+    static const char name[] = "etag:";
+    if (len > sizeof(name) - 1 && strncasecmp(buffer, name, sizeof(name) - 1) == 0) {
+        const char *value = buffer + sizeof(name) - 1;
+        const char *end = buffer + len;
+        while (value < end && isspace((unsigned char) *value)) {
+            value++;
+        }
+        while (end > value && isspace((unsigned char) end[-1])) {
+            end--;
+        }
+        size_t value_len = end - value;
+        if (value_len > 0 && value_len < sizeof(state->etag)) {
+            memcpy(state->etag, value, value_len);
+            state->etag[value_len] = '\0';
+        }
+    }
+    return len;
+}
+
+void http_set_request_observer(http_request_observer observer) {
+    request_observer = observer;
+}
+
+void http_set_logger(http_logger logger, http_log_filter filter) {
+    request_logger = logger;
+    request_log_filter = filter;
 }
 
 HTTP *http_create(const char *keydir) {
@@ -73,59 +146,236 @@ HTTP *http_create(const char *keydir) {
     curl_easy_setopt(curl, CURLOPT_SSLKEYTYPE, "PEM");
     curl_easy_setopt(curl, CURLOPT_SSLKEY, keyFilePath);
     curl_easy_setopt(curl, CURLOPT_SSL_VERIFYPEER, 0L);
-    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, write_fn);
+    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, http_data_write_fn);
     curl_easy_setopt(curl, CURLOPT_FAILONERROR, 1L);
     curl_easy_setopt(curl, CURLOPT_SSL_SESSIONID_CACHE, 0L);
     // Fix for https://github.com/mariotaku/moonlight-tv/issues/452
     curl_easy_setopt(curl, CURLOPT_FORBID_REUSE, 1L);
 
-    struct HTTP_T *http = malloc(sizeof(struct HTTP_T));
+    struct HTTP_T *http = calloc(1, sizeof(struct HTTP_T));
     assert(http != NULL);
     http->curl = curl;
     pthread_mutex_init(&http->mutex, NULL);
+    pthread_mutex_init(&http->pool_lock, NULL);
     return http;
 }
 
+static int request_result(CURL *curl, CURLcode res, const void *data) {
+    int ret = GS_OK;
+    if (res == CURLE_HTTP_RETURNED_ERROR) {
+        int http_status = 0;
+        curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &http_status);
+        http_log(COMMONS_LOG_LEVEL_WARN, "Request %p error HTTP %d", data, http_status);
+        ret = GS_FAILED;
+    } else if (res != CURLE_OK) {
+        const char *errmsg = curl_easy_strerror(res);
+        ret = gs_set_error(GS_IO_ERROR, "cURL error: %s", errmsg);
+        http_log(COMMONS_LOG_LEVEL_DEBUG, "Request %p error %d: %s", data, ret, errmsg);
+    } else {
+        int http_code = 0;
+        curl_easy_getinfo(curl, CURLINFO_HTTP_CODE, &http_code);
+        http_log(COMMONS_LOG_LEVEL_DEBUG, "Request %p response %d", data, http_code);
+    }
+    request_notify(curl, ret);
+    return ret;
+}
+
+static void request_notify(CURL *curl, int result) {
+    if (request_observer == NULL) {
+        return;
+    }
+    long http_code = 0;
+    double total_time = 0;
+    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &http_code);
+    curl_easy_getinfo(curl, CURLINFO_TOTAL_TIME, &total_time);
+#if LIBCURL_VERSION_NUM >= 0x073700
+    curl_off_t size = 0;
+    curl_easy_getinfo(curl, CURLINFO_SIZE_DOWNLOAD_T, &size);
+#else
+    double size = 0;
+    curl_easy_getinfo(curl, CURLINFO_SIZE_DOWNLOAD, &size);
+#endif
+    request_observer(result, http_code, (size_t) size, total_time * 1000.0);
+}
+
 int http_request(HTTP *http, char *url, HTTP_DATA *data) {
     assert(http != NULL);
     assert(data != NULL);
-    if (data->size > 0) {
-        void *allocated = realloc(data->memory, 1);
-        assert(allocated != NULL);
-        data->memory = allocated;
-        data->memory[0] = 0;
-        data->size = 0;
-    }
+    http_data_reset(data);
     pthread_mutex_lock(&http->mutex);
     CURL *curl = http->curl;
     curl_easy_setopt(curl, CURLOPT_WRITEDATA, data);
     curl_easy_setopt(curl, CURLOPT_URL, url);
 
-    commons_log_debug("GameStream", "Request %p %s", data, url);
+    http_log(COMMONS_LOG_LEVEL_DEBUG, "Request %p %s", data, url);
 
-    int ret = GS_FAILED;
     CURLcode res = curl_easy_perform(curl);
+    int ret = request_result(curl, res, data);
+    if (ret == GS_OK) {
+        assert (data->memory != NULL);
+        http_log_hexdump(data);
+    }
 
-    if (res == CURLE_HTTP_RETURNED_ERROR) {
-        int http_status = 0;
-        curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &http_status);
-        commons_log_warn("GameStream", "Request %p error HTTP %d", data, http_status);
-        goto finish;
-    } else if (res != CURLE_OK) {
-        const char *errmsg = curl_easy_strerror(res);
-        ret = gs_set_error(GS_IO_ERROR, "cURL error: %s", errmsg);
-        commons_log_debug("GameStream", "Request %p error %d: %s", data, ret, errmsg);
-        goto finish;
+    pthread_mutex_unlock(&http->mutex);
+    return ret;
+}
+
+int http_request_race(HTTP *http, HTTP_REQUEST *requests, size_t count, size_t preferred) {
+    assert(http != NULL);
+    assert(requests != NULL);
+    assert(preferred < count);
+    CURLM *multi = curl_multi_init();
+    if (multi == NULL) {
+        return gs_set_error(GS_ERROR, "Failed to create cURL multi instance");
+    }
+    CURL **handles = calloc(count, sizeof(CURL *));
+    assert(handles != NULL);
+
+    int ret = GS_OK;
+    // Duplicated handles inherit certificate, key and timeout options
+    pthread_mutex_lock(&http->mutex);
+    for (size_t i = 0; i < count; i++) {
+        HTTP_REQUEST *request = &requests[i];
+        assert(request->data != NULL);
+        http_data_reset(request->data);
+        request->done = false;
+        request->result = GS_IO_ERROR;
+        if ((handles[i] = curl_easy_duphandle(http->curl)) == NULL) {
+            ret = gs_set_error(GS_ERROR, "Failed to create cURL instance");
+            break;
+        }
+        curl_easy_setopt(handles[i], CURLOPT_WRITEDATA, request->data);
+        curl_easy_setopt(handles[i], CURLOPT_URL, request->url);
+        curl_multi_add_handle(multi, handles[i]);
+        http_log(COMMONS_LOG_LEVEL_DEBUG, "Request %p %s", request->data, request->url);
     }
-    assert (data->memory != NULL);
-    int http_code = 0;
-    curl_easy_getinfo(curl, CURLINFO_HTTP_CODE, &http_code);
-    commons_log_debug("GameStream", "Request %p response %d", data, http_code);
-    commons_log_hexdump(COMMONS_LOG_LEVEL_VERBOSE, "GameStream", data->memory, data->size);
+    pthread_mutex_unlock(&http->mutex);
+
+    int running = 0;
+    while (ret == GS_OK) {
+        if (curl_multi_perform(multi, &running) != CURLM_OK) {
+            ret = gs_set_error(GS_IO_ERROR, "cURL multi perform failed");
+            break;
+        }
+        CURLMsg *msg;
+        int queued = 0;
+        bool settled = false;
+        while ((msg = curl_multi_info_read(multi, &queued)) != NULL) {
+            if (msg->msg != CURLMSG_DONE) {
+                continue;
+            }
+            for (size_t i = 0; i < count; i++) {
+                if (handles[i] != msg->easy_handle) {
+                    continue;
+                }
+                requests[i].done = true;
+                HTTP_DATA *data = requests[i].data;
+                if ((requests[i].result = request_result(handles[i], msg->data.result, data)) == GS_OK) {
+                    http_log_hexdump(data);
+                }
+                settled |= i == preferred && requests[i].result == GS_OK;
+                break;
+            }
+        }
+        if (settled || running == 0) {
+            break;
+        }
+        if (curl_multi_wait(multi, NULL, 0, 100, NULL) != CURLM_OK) {
+            ret = gs_set_error(GS_IO_ERROR, "cURL multi wait failed");
+            break;
+        }
+    }
+
+    // Requests still running lost the race, they're aborted here
+    for (size_t i = 0; i < count; i++) {
+        if (handles[i] == NULL) {
+            continue;
+        }
+        if (!requests[i].done) {
+            http_log(COMMONS_LOG_LEVEL_DEBUG, "Request %p aborted", requests[i].data);
+        }
+        curl_multi_remove_handle(multi, handles[i]);
+        curl_easy_cleanup(handles[i]);
+    }
+    free(handles);
+    curl_multi_cleanup(multi);
+    return ret;
+}
 
-    ret = GS_OK;
-    finish:
+int http_download(HTTP *http, char *url, const char *path, bool *modified) {
+    assert(http != NULL);
+    assert(path != NULL);
+    char tmp_path[4096], etag_path[4096];
+    snprintf(tmp_path, sizeof(tmp_path), "%s.%u.tmp", path, atomic_fetch_add(&download_seq, 1));
+    snprintf(etag_path, sizeof(etag_path), "%s.etag", path);
+
+    // Use a separate handle, so downloads don't hold the lock during transfer
+    pthread_mutex_lock(&http->mutex);
+    CURL *curl = curl_easy_duphandle(http->curl);
     pthread_mutex_unlock(&http->mutex);
+    if (curl == NULL) {
+        return gs_set_error(GS_ERROR, "Failed to create cURL instance");
+    }
+    download_state_t state = {.fp = fopen(tmp_path, "wb")};
+    if (state.fp == NULL) {
+        curl_easy_cleanup(curl);
+        return gs_set_error(GS_IO_ERROR, "Failed to create %s", tmp_path);
+    }
+
+    struct curl_slist *headers = NULL;
+    struct stat st;
+    if (stat(path, &st) == 0) {
+        // Existing file will be kept if server says it's not modified
+        curl_easy_setopt(curl, CURLOPT_TIMECONDITION, (long) CURL_TIMECOND_IFMODSINCE);
+        curl_easy_setopt(curl, CURLOPT_TIMEVALUE, (long) st.st_mtime);
+        char etag[HTTP_ETAG_MAX], header[HTTP_ETAG_MAX + 16];
+        if (read_etag(etag_path, etag, sizeof(etag))) {
+            snprintf(header, sizeof(header), "If-None-Match: %s", etag);
+            headers = curl_slist_append(headers, header);
+            curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
+        }
+    }
+    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, write_file_fn);
+    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &state);
+    curl_easy_setopt(curl, CURLOPT_HEADERFUNCTION, header_fn);
+    curl_easy_setopt(curl, CURLOPT_HEADERDATA, &state);
+    curl_easy_setopt(curl, CURLOPT_URL, url);
+
+    http_log(COMMONS_LOG_LEVEL_DEBUG, "Download %p %s", &state, url);
+
+    CURLcode res = curl_easy_perform(curl);
+    int ret = request_result(curl, res, &state);
+
+    long http_code = 0, unmet = 0;
+    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &http_code);
+    curl_easy_getinfo(curl, CURLINFO_CONDITION_UNMET, &unmet);
+    bool not_modified = ret == GS_OK && (http_code == 304 || unmet);
+
+    if (ret == GS_OK && !not_modified && (fflush(state.fp) != 0 || fsync(fileno(state.fp)) != 0)) {
+        ret = gs_set_error(GS_IO_ERROR, "Failed to write %s", tmp_path);
+    }
+    if (fclose(state.fp) != 0 && ret == GS_OK) {
+        ret = gs_set_error(GS_IO_ERROR, "Failed to write %s", tmp_path);
+    }
+    if (ret == GS_OK && !not_modified) {
+        if (!replace_file(tmp_path, path)) {
+            ret = gs_set_error(GS_IO_ERROR, "Failed to replace %s", path);
+        } else {
+            write_etag(etag_path, state.etag);
+        }
+    }
+    if (ret != GS_OK || not_modified) {
+        remove(tmp_path);
+    }
+    if (not_modified) {
+        http_log(COMMONS_LOG_LEVEL_DEBUG, "Download %p not modified", &state);
+    }
+    if (modified != NULL) {
+        *modified = ret == GS_OK && !not_modified;
+    }
+
+    curl_slist_free_all(headers);
+    curl_easy_cleanup(curl);
     return ret;
 }
 
@@ -135,6 +385,10 @@ void http_destroy(HTTP *http) {
     curl_easy_cleanup(http->curl);
     pthread_mutex_unlock(&http->mutex);
     pthread_mutex_destroy(&http->mutex);
+    for (size_t i = 0; i < http->pool_size; i++) {
+        http_data_free(http->pool[i]);
+    }
+    pthread_mutex_destroy(&http->pool_lock);
     free((void *) http);
 }
 
@@ -145,24 +399,108 @@ void http_set_timeout(HTTP *http, int timeout) {
     pthread_mutex_unlock(&http->mutex);
 }
 
-HTTP_DATA *http_data_alloc() {
-    HTTP_DATA *data = malloc(sizeof(HTTP_DATA));
-    assert(data != NULL);
-
-    data->memory = malloc(1);
-    assert(data->memory != NULL);
-    data->size = 0;
-
+HTTP_DATA *http_data_acquire(HTTP *http) {
+    assert(http != NULL);
+    HTTP_DATA *data = NULL;
+    pthread_mutex_lock(&http->pool_lock);
+    if (http->pool_size > 0) {
+        data = http->pool[--http->pool_size];
+    }
+    pthread_mutex_unlock(&http->pool_lock);
+    if (data == NULL) {
+        return http_data_alloc();
+    }
+    http_data_reset(data);
     return data;
 }
 
-void http_data_free(HTTP_DATA *data) {
+void http_data_release(HTTP *http, HTTP_DATA *data) {
+    assert(http != NULL);
     if (data == NULL) {
         return;
     }
-    if (data->memory != NULL) {
-        free(data->memory);
+    if (data->capacity <= HTTP_DATA_POOL_MAX_CAPACITY) {
+        pthread_mutex_lock(&http->pool_lock);
+        if (http->pool_size < HTTP_DATA_POOL_SIZE) {
+            http->pool[http->pool_size++] = data;
+            data = NULL;
+        }
+        pthread_mutex_unlock(&http->pool_lock);
+    }
+    http_data_free(data);
+}
+
+static bool read_etag(const char *path, char *etag, size_t len) {
+    FILE *f = fopen(path, "r");
+    if (f == NULL) {
+        return false;
     }
+    bool ok = fgets(etag, (int) len, f) != NULL && etag[0] != '\0';
+    fclose(f);
+    return ok;
+}
 
-    free(data);
+static void write_etag(const char *path, const char *etag) {
+    if (etag[0] == '\0') {
+        remove(path);
+        return;
+    }
+    FILE *f = fopen(path, "w");
+    if (f == NULL) {
+        return;
+    }
+    fputs(etag, f);
+    fclose(f);
+}
+
+/**
+ * Move src over dst. On Windows, rename fails if dst exists, and removing dst first would lose it if the move fails.
+ */
+static bool replace_file(const char *src, const char *dst) {
+#ifdef __WIN32
+    return MoveFileExA(src, dst, MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+    return rename(src, dst) == 0;
+#endif
+}
+
+static void http_log(int level, const char *fmt, ...) {
+    if (request_log_filter != NULL && !request_log_filter(level)) {
+        return;
+    }
+    va_list args;
+    va_start(args, fmt);
+    if (request_logger != NULL) {
+        request_logger(level, "GameStream", fmt, args);
+    } else {
+        commons_log_vprintf(level, "GameStream", fmt, args);
+    }
+    va_end(args);
+}
+
+/**
+ * Dumps the response one line per message, as each line goes through the logger separately.
+ */
+static void http_log_hexdump(const HTTP_DATA *data) {
+    // Formatting up to a hundred lines for every response is wasted when verbose logs are off
+    if (request_log_filter != NULL && !request_log_filter(COMMONS_LOG_LEVEL_VERBOSE)) {
+        return;
+    }
+    if (request_logger == NULL) {
+        commons_log_hexdump(COMMONS_LOG_LEVEL_VERBOSE, "GameStream", data->memory, data->size);
+        return;
+    }
+    size_t size = data->size < HTTP_LOG_HEXDUMP_MAX ? data->size : HTTP_LOG_HEXDUMP_MAX;
+    for (size_t offset = 0; offset < size; offset += HTTP_LOG_HEXDUMP_LINE) {
+        char hex[HTTP_LOG_HEXDUMP_LINE * 3 + 1] = {0}, text[HTTP_LOG_HEXDUMP_LINE + 1] = {0};
+        for (size_t i = 0; i < HTTP_LOG_HEXDUMP_LINE && offset + i < size; i++) {
+            unsigned char c = (unsigned char) data->memory[offset + i];
+            snprintf(&hex[i * 3], 4, "%02x ", c);
+            text[i] = isprint(c) ? (char) c : '.';
+        }
+        http_log(COMMONS_LOG_LEVEL_VERBOSE, "%p %04zx: %-48s %s", data, offset, hex, text);
+    }
+    if (data->size > size) {
+        http_log(COMMONS_LOG_LEVEL_VERBOSE, "%p %zu more bytes", data, data->size - size);
+    }
 }
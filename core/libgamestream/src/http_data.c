@@ -0,0 +1,80 @@
+/*
+ * This file is part of Moonlight Embedded.
+ *
+ * Copyright (C) 2015 Iwan Timmer
+ *
+ * Moonlight is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Moonlight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Moonlight; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "http.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#define HTTP_DATA_INITIAL_CAPACITY 4096
+
+HTTP_DATA *http_data_alloc() {
+    HTTP_DATA *data = malloc(sizeof(HTTP_DATA));
+    assert(data != NULL);
+
+    data->memory = malloc(HTTP_DATA_INITIAL_CAPACITY);
+    assert(data->memory != NULL);
+    data->memory[0] = 0;
+    data->size = 0;
+    data->capacity = HTTP_DATA_INITIAL_CAPACITY;
+
+    return data;
+}
+
+void http_data_append(HTTP_DATA *data, const void *contents, size_t len) {
+    size_t required = data->size + len + 1;
+    if (required > data->capacity) {
+        // Double the capacity, so a response of N bytes takes O(log N) reallocations
+        size_t capacity = data->capacity > 0 ? data->capacity : HTTP_DATA_INITIAL_CAPACITY;
+        while (capacity < required) {
+            capacity *= 2;
+        }
+        void *allocated = realloc(data->memory, capacity);
+        assert(allocated != NULL);
+        data->memory = allocated;
+        data->capacity = capacity;
+    }
+    memcpy(&(data->memory[data->size]), contents, len);
+    data->size += len;
+    data->memory[data->size] = 0;
+}
+
+size_t http_data_write_fn(void *contents, size_t size, size_t nmemb, void *userp) {
+    size_t realsize = size * nmemb;
+    http_data_append((HTTP_DATA *) userp, contents, realsize);
+    return realsize;
+}
+
+void http_data_reset(HTTP_DATA *data) {
+    assert(data->memory != NULL);
+    data->memory[0] = 0;
+    data->size = 0;
+}
+
+void http_data_free(HTTP_DATA *data) {
+    if (data == NULL) {
+        return;
+    }
+    if (data->memory != NULL) {
+        free(data->memory);
+    }
+
+    free(data);
+}
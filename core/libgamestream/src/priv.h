@@ -1,6 +1,7 @@
 #pragma once
 
 #include "http.h"
+#include "client.h"
 #include <mbedtls/pk.h>
 #include <mbedtls/x509_crt.h>
 
@@ -16,4 +17,5 @@ struct GS_CLIENT_T {
     mbedtls_x509_crt cert;
     char cert_hex[8192];
     HTTP *http;
+    GS_STATUS_MODE status_mode;
 };
@@ -0,0 +1,204 @@
+#include "unity.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "http.h"
+
+#define APP_COUNT 2000
+#define REQUESTS 20
+/* Same as CURL_MAX_WRITE_SIZE, the largest chunk cURL passes to write callback */
+#define CHUNK_SIZE 16384
+/* Same as HTTP_DATA_POOL_MAX_CAPACITY */
+#define POOL_MAX_CAPACITY (1024 * 1024)
+
+static HTTP *http = NULL;
+
+static char *applist_response(size_t *len);
+
+static void append_chunked(HTTP_DATA *data, const char *contents, size_t len);
+
+static size_t write_chunked(HTTP_DATA *data, const char *contents, size_t len);
+
+static size_t legacy_write_fn(void *contents, size_t size, size_t nmemb, void *userp);
+
+static void legacy_reset(HTTP_DATA *data);
+
+/* Reallocations made by the legacy buffer handling */
+static size_t legacy_reallocs = 0;
+
+void setUp(void) {
+    http = http_create("/tmp");
+    TEST_ASSERT_NOT_NULL(http);
+}
+
+void tearDown(void) {
+    http_destroy(http);
+}
+
+void test_reuse_keeps_capacity(void) {
+    size_t len = 0;
+    char *response = applist_response(&len);
+
+    HTTP_DATA *data = http_data_acquire(http);
+    TEST_ASSERT_NOT_NULL(data);
+    append_chunked(data, response, len);
+    TEST_ASSERT_EQUAL_size_t(len, data->size);
+    TEST_ASSERT_EQUAL_MEMORY(response, data->memory, len);
+    char *memory = data->memory;
+    size_t capacity = data->capacity;
+    TEST_ASSERT_GREATER_THAN_size_t(len, capacity);
+    http_data_release(http, data);
+
+    HTTP_DATA *reused = http_data_acquire(http);
+    TEST_ASSERT_EQUAL_PTR(data, reused);
+    TEST_ASSERT_EQUAL_PTR(memory, reused->memory);
+    TEST_ASSERT_EQUAL_size_t(capacity, reused->capacity);
+    TEST_ASSERT_EQUAL_size_t(0, reused->size);
+    TEST_ASSERT_EQUAL_INT('\0', reused->memory[0]);
+
+    // Same response fits without growing the buffer again
+    append_chunked(reused, response, len);
+    TEST_ASSERT_EQUAL_PTR(memory, reused->memory);
+    TEST_ASSERT_EQUAL_MEMORY(response, reused->memory, len);
+    http_data_release(http, reused);
+    free(response);
+}
+
+void test_large_buffer_freed(void) {
+    HTTP_DATA *data = http_data_acquire(http);
+    TEST_ASSERT_NOT_NULL(data);
+    char *chunk = calloc(1, CHUNK_SIZE);
+    while (data->capacity <= POOL_MAX_CAPACITY) {
+        http_data_append(data, chunk, CHUNK_SIZE);
+    }
+    free(chunk);
+    http_data_release(http, data);
+
+    // Pool is empty, so this is a fresh buffer rather than the large one
+    HTTP_DATA *fresh = http_data_acquire(http);
+    TEST_ASSERT_NOT_NULL(fresh);
+    TEST_ASSERT_LESS_OR_EQUAL_size_t(POOL_MAX_CAPACITY, fresh->capacity);
+    TEST_ASSERT_EQUAL_size_t(0, fresh->size);
+    http_data_release(http, fresh);
+}
+
+void test_applist_reallocs(void) {
+    size_t len = 0;
+    char *response = applist_response(&len);
+
+    HTTP_DATA legacy = {.memory = malloc(1), .size = 0, .capacity = 1};
+    TEST_ASSERT_NOT_NULL(legacy.memory);
+    legacy.memory[0] = 0;
+    legacy_reallocs = 0;
+    for (int i = 0; i < REQUESTS; i++) {
+        legacy_reset(&legacy);
+        for (size_t offset = 0; offset < len; offset += CHUNK_SIZE) {
+            size_t chunk = len - offset < CHUNK_SIZE ? len - offset : CHUNK_SIZE;
+            TEST_ASSERT_EQUAL_size_t(chunk, legacy_write_fn(response + offset, 1, chunk, &legacy));
+        }
+        TEST_ASSERT_EQUAL_size_t(len, legacy.size);
+    }
+    free(legacy.memory);
+
+    size_t pooled_reallocs = 0, first_reallocs = 0;
+    for (int i = 0; i < REQUESTS; i++) {
+        HTTP_DATA *data = http_data_acquire(http);
+        TEST_ASSERT_NOT_NULL(data);
+        size_t reallocs = write_chunked(data, response, len);
+        TEST_ASSERT_EQUAL_size_t(len, data->size);
+        TEST_ASSERT_EQUAL_INT('\0', data->memory[len]);
+        TEST_ASSERT_EQUAL_MEMORY(response, data->memory, len);
+        http_data_release(http, data);
+        if (i == 0) {
+            first_reallocs = reallocs;
+        }
+        pooled_reallocs += reallocs;
+    }
+
+    printf("applist response: %zu bytes, %d requests\n", len, REQUESTS);
+    printf("legacy: %zu reallocations\n", legacy_reallocs);
+    printf("pooled: %zu reallocations\n", pooled_reallocs);
+
+    // Capacity doubles from 4 KiB, so the first request takes a logarithmic number of reallocations
+    size_t max_first = 0;
+    for (size_t capacity = 4096; capacity < len + 1; capacity *= 2) {
+        max_first++;
+    }
+    TEST_ASSERT_LESS_OR_EQUAL_size_t(max_first, first_reallocs);
+    // Buffer from the pool is already large enough
+    TEST_ASSERT_EQUAL_size_t(first_reallocs, pooled_reallocs);
+    TEST_ASSERT_LESS_THAN_size_t(legacy_reallocs, pooled_reallocs);
+    free(response);
+}
+
+/* Response of /applist from a host with 2000 apps, in the same shape GameStream hosts send */
+static char *applist_response(size_t *len) {
+    size_t cap = APP_COUNT * 160 + 128;
+    char *xml = malloc(cap);
+    TEST_ASSERT_NOT_NULL(xml);
+    size_t w = snprintf(xml, cap, "<?xml version=\"1.0\" encoding=\"utf-8\"?>\n<root status_code=\"200\">\n");
+    for (int i = 0; i < APP_COUNT; i++) {
+        w += snprintf(xml + w, cap - w, "<App>\n<IsHdrSupported>%d</IsHdrSupported>\n<AppTitle>Game Title %04d"
+                                        "</AppTitle>\n<ID>%d</ID>\n</App>\n", i % 2, i, 100000 + i);
+    }
+    w += snprintf(xml + w, cap - w, "</root>\n");
+    TEST_ASSERT_LESS_THAN_size_t(cap, w);
+    *len = w;
+    return xml;
+}
+
+static void append_chunked(HTTP_DATA *data, const char *contents, size_t len) {
+    for (size_t offset = 0; offset < len; offset += CHUNK_SIZE) {
+        http_data_append(data, contents + offset, len - offset < CHUNK_SIZE ? len - offset : CHUNK_SIZE);
+    }
+}
+
+/* Feed the response the way cURL does, and count how many times the buffer was reallocated */
+static size_t write_chunked(HTTP_DATA *data, const char *contents, size_t len) {
+    size_t reallocs = 0;
+    for (size_t offset = 0; offset < len; offset += CHUNK_SIZE) {
+        size_t chunk = len - offset < CHUNK_SIZE ? len - offset : CHUNK_SIZE;
+        size_t capacity = data->capacity;
+        TEST_ASSERT_EQUAL_size_t(chunk, http_data_write_fn((void *) (contents + offset), 1, chunk, data));
+        // Buffer only grows by reallocating
+        if (data->capacity != capacity) {
+            reallocs++;
+        }
+    }
+    return reallocs;
+}
+
+/* Buffer handling before pooling: grow by exact size on every chunk, shrink to 1 byte before reuse */
+static size_t legacy_write_fn(void *contents, size_t size, size_t nmemb, void *userp) {
+    size_t realsize = size * nmemb;
+    HTTP_DATA *data = userp;
+    void *allocated = realloc(data->memory, data->size + realsize + 1);
+    TEST_ASSERT_NOT_NULL(allocated);
+    legacy_reallocs++;
+    data->memory = allocated;
+    memcpy(&(data->memory[data->size]), contents, realsize);
+    data->size += realsize;
+    data->memory[data->size] = 0;
+    return realsize;
+}
+
+static void legacy_reset(HTTP_DATA *data) {
+    if (data->size > 0) {
+        void *allocated = realloc(data->memory, 1);
+        TEST_ASSERT_NOT_NULL(allocated);
+        legacy_reallocs++;
+        data->memory = allocated;
+        data->memory[0] = 0;
+        data->size = 0;
+    }
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_reuse_keeps_capacity);
+    RUN_TEST(test_large_buffer_freed);
+    RUN_TEST(test_applist_reallocs);
+    return UNITY_END();
+}
@@ -12,6 +12,7 @@
 #include "logging_ext_sdl.h"
 #include "logging_ext_ss4s.h"
 #include "backend/backend_root.h"
+#include "backend/client_conf.h"
 #include "stream/session.h"
 #include "ui/root.h"
 #include "util/bus.h"
@@ -25,75 +26,143 @@
 #include "app_error.h"
 #include "app_session.h"
 #include "stream/embed_wrapper.h"
+#include "input/input_gamepad_mapping.h"
+#include "util/font.h"
+#include "util/init_graph.h"
+#include "util/startup_trace.h"
+#include "util/async_log.h"
+#include "util/metrics.h"
+
+#define APP_SUSPENDED_WAIT_MS 100U
+#define APP_ASYNC_LOG_CAPACITY 256
 
 PCONFIGURATION app_configuration = NULL;
 
 static void quit_confirm_cb(lv_event_t *e);
 
-static void libs_init(app_t *app, int argc, char *argv[]);
-
 app_t *global = NULL;
 
 
+typedef enum app_init_phase_t {
+    APP_INIT_SETTINGS,
+    APP_INIT_CLIENT_CONF,
+    APP_INIT_OS_INFO,
+    APP_INIT_SS4S_MODULES,
+    APP_INIT_SS4S,
+    APP_INIT_LOCALE,
+    APP_INIT_KNOWN_HOSTS,
+    APP_INIT_FONTCONFIG,
+    APP_INIT_GAMEPAD_MAPPING,
+    APP_INIT_VIDEO,
+    APP_INIT_INPUT,
+    APP_INIT_UI,
+    APP_INIT_POST,
+    APP_INIT_PHASE_COUNT,
+} app_init_phase_t;
+
+typedef struct app_init_context_t {
+    app_t *app;
+    app_settings_loader *settings_loader;
+    int argc;
+    char **argv;
+} app_init_context_t;
+
+static int init_settings(app_init_context_t *ctx);
+
+static int init_client_conf(app_init_context_t *ctx);
+
+static int init_os_info(app_init_context_t *ctx);
+
+static int init_ss4s_modules(app_init_context_t *ctx);
+
+static int init_ss4s(app_init_context_t *ctx);
+
+static int init_locale(app_init_context_t *ctx);
+
+static int init_known_hosts(app_init_context_t *ctx);
+
+static int init_fontconfig(app_init_context_t *ctx);
+
+static int init_gamepad_mapping(app_init_context_t *ctx);
+
+static int init_video(app_init_context_t *ctx);
+
+static int init_input(app_init_context_t *ctx);
+
+static int init_ui(app_init_context_t *ctx);
+
+static int init_post(app_init_context_t *ctx);
+
+#define DEP(phase) INIT_PHASE_DEP(APP_INIT_##phase)
+
+/* Phases only touching their own state run in background, anything involving SDL video, SS4S or LVGL stays on the
+ * main thread. */
+static const init_phase_t app_init_phases[APP_INIT_PHASE_COUNT] = {
+        [APP_INIT_SETTINGS] = {"settings", (init_phase_fn) init_settings, 0, true},
+        /* Only starts key generation, the first GameStream client waits for it */
+        [APP_INIT_CLIENT_CONF] = {"client_conf", (init_phase_fn) init_client_conf, DEP(SETTINGS), false},
+        [APP_INIT_OS_INFO] = {"os_info", (init_phase_fn) init_os_info, 0, true},
+        [APP_INIT_SS4S_MODULES] = {"ss4s_modules", (init_phase_fn) init_ss4s_modules, DEP(SETTINGS) | DEP(OS_INFO),
+                                   true},
+        [APP_INIT_SS4S] = {"ss4s", (init_phase_fn) init_ss4s, DEP(SS4S_MODULES), false},
+        /* setlocale affects number parsing, wait for every background phase parsing files to finish */
+        [APP_INIT_LOCALE] = {"locale", (init_phase_fn) init_locale, DEP(SETTINGS) | DEP(SS4S_MODULES) |
+                                                                   DEP(KNOWN_HOSTS) | DEP(FONTCONFIG) |
+                                                                   DEP(GAMEPAD_MAPPING), false},
+        [APP_INIT_KNOWN_HOSTS] = {"known_hosts", (init_phase_fn) init_known_hosts, DEP(SETTINGS), true},
+        [APP_INIT_FONTCONFIG] = {"fontconfig", (init_phase_fn) init_fontconfig, 0, true},
+        [APP_INIT_GAMEPAD_MAPPING] = {"gamepad_mapping", (init_phase_fn) init_gamepad_mapping, DEP(SETTINGS), true},
+        /* DO not init video subsystem before NDL/LGNC initialization */
+        [APP_INIT_VIDEO] = {"video", (init_phase_fn) init_video, DEP(SETTINGS) | DEP(SS4S), false},
+        [APP_INIT_INPUT] = {"input", (init_phase_fn) init_input, DEP(VIDEO) | DEP(GAMEPAD_MAPPING), false},
+        [APP_INIT_UI] = {"ui", (init_phase_fn) init_ui, DEP(VIDEO) | DEP(LOCALE) | DEP(FONTCONFIG), false},
+        [APP_INIT_POST] = {"post_init", (init_phase_fn) init_post, DEP(UI) | DEP(INPUT) | DEP(KNOWN_HOSTS), false},
+};
+
+#undef DEP
+
 int app_init(app_t *app, app_settings_loader *settings_loader, int argc, char *argv[]) {
     assert(settings_loader != NULL);
     memset(app, 0, sizeof(*app));
+    startup_trace_reset();
     commons_logging_init("moonlight");
     SDL_LogSetOutputFunction(commons_sdl_log, NULL);
     SDL_SetAssertionHandler(app_assertion_handler_abort, NULL);
     SDL_Init(0);
     commons_log_info("APP", "Start Moonlight. Version %s", APP_VERSION);
-    settings_loader(&app->settings);
     app->main_thread_id = SDL_ThreadID();
+    app->log = async_log_create(APP_ASYNC_LOG_CAPACITY, NULL, NULL);
+    if (app->log != NULL) {
+        // Verbose messages, like HTTP response dumps, would crowd out the rest of the queue
+#ifdef DEBUG
+        async_log_set_level(app->log, COMMONS_LOG_LEVEL_VERBOSE);
+#else
+        async_log_set_level(app->log, COMMONS_LOG_LEVEL_DEBUG);
+#endif
+    }
+    if (app->log != NULL && async_log_start(app->log)) {
+        async_log_set_default(app->log);
+    }
+    const char *metrics_socket = SDL_getenv("MOONLIGHT_METRICS_SOCKET");
+    if (metrics_socket != NULL && metrics_socket[0] != '\0') {
+        metrics_server_start(metrics_socket);
+    }
     app->running = true;
     app->focused = false;
 #if FEATURE_EMBEDDED_SHELL
     app->embed_version.major = -1;
 #endif
     app_configuration = &app->settings;
-    if (os_info_get(&app->os_info) == 0) {
-        char *info_str = os_info_str(&app->os_info);
-        commons_log_info("APP", "System: %s", info_str);
-        free(info_str);
-    }
-    libs_init(app, argc, argv);
-
-    app_init_locale();
+    SS4S_SetLoggingFunction(commons_ss4s_logf);
     backend_init(&app->backend, app);
 
-#if TARGET_WEBOS
-    SDL_SetHint(SDL_HINT_WEBOS_ACCESS_POLICY_KEYS_BACK, "true");
-    SDL_SetHint(SDL_HINT_WEBOS_ACCESS_POLICY_KEYS_EXIT, "true");
-    SDL_SetHint(SDL_HINT_WEBOS_CURSOR_SLEEP_TIME, "5000");
-    SDL_SetHint(SDL_HINT_WEBOS_CURSOR_FREQUENCY, "60");
-    SDL_SetHint(SDL_HINT_WEBOS_CURSOR_CALIBRATION_DISABLE, "true");
-    SDL_SetHint(SDL_HINT_WEBOS_HIDAPI_IGNORE_BLUETOOTH_DEVICES, "0x057e/0x0000");
-    if (app->settings.syskey_capture) {
-        SDL_SetHint(SDL_HINT_WEBOS_ACCESS_POLICY_KEYS_HOME, "true");
-        SDL_SetHint(SDL_HINT_WEBOS_ACCESS_POLICY_RIBBON, "false");
-    }
-#else
-    if (app->settings.syskey_capture) {
-        SDL_SetHint(SDL_HINT_GRAB_KEYBOARD, "1");
-    }
-#endif
-    // DO not init video subsystem before NDL/LGNC initialization
-    if (SDL_InitSubSystem(SDL_INIT_VIDEO) < 0) {
-        commons_log_fatal("APP", "Failed to initialize SDL video subsystem: %s", SDL_GetError());
-        return -1;
-    }
-    // This will occupy SDL_USEREVENT
-    SDL_RegisterEvents(1);
-    commons_log_info("APP", "UI locale: %s (%s)", i18n_locale(), locstr("[Localized Language]"));
-
-    app_input_init(&app->input, app);
-
-    app_ui_init(&app->ui, app);
-
-    global = app;
-
-    SS4S_PostInit(argc, argv);
-    return 0;
+    app_init_context_t context = {
+            .app = app,
+            .settings_loader = settings_loader,
+            .argc = argc,
+            .argv = argv,
+    };
+    return init_graph_run(app_init_phases, APP_INIT_PHASE_COUNT, app->backend.executor, &context);
 }
 
 void app_deinit(app_t *app) {
@@ -122,13 +191,26 @@ void app_deinit(app_t *app) {
 
     _lv_draw_mask_cleanup();
 
+    metrics_server_stop();
+    metrics_report();
+
+    if (app->log != NULL) {
+        async_log_destroy(app->log);
+        app->log = NULL;
+    }
+
     SDL_Quit();
 }
 
 void app_run_loop(app_t *app) {
     app_process_events(app);
-    lv_task_handler();
-    SDL_Delay(1);
+    uint32_t next_timer = lv_task_handler();
+    if (app_ui_is_suspended(&app->ui)) {
+        // Nothing to draw, sleep until an event comes or a remaining timer fires
+        SDL_WaitEventTimeout(NULL, (int) SDL_min(next_timer, APP_SUSPENDED_WAIT_MS));
+    } else {
+        SDL_Delay(1);
+    }
 }
 
 static int app_event_filter(void *userdata, SDL_Event *event) {
@@ -139,12 +221,19 @@ static int app_event_filter(void *userdata, SDL_Event *event) {
             if (app_ui_is_opened(&app->ui) && app->session != NULL) {
                 session_interrupt(app->session, false, STREAMING_INTERRUPT_BACKGROUND);
             }
+            // App may be killed while in background
+            pcmanager_sync_known_hosts(pcmanager);
             break;
         }
         case SDL_APP_DIDENTERFOREGROUND: {
             lv_obj_invalidate(lv_scr_act());
             break;
         }
+        case SDL_APP_LOWMEMORY: {
+            commons_log_warn("APP", "Low memory warning received");
+            bus_pushevent(USER_LOW_MEMORY, NULL, NULL);
+            break;
+        }
         case SDL_WINDOWEVENT: {
             switch (event->window.event) {
                 case SDL_WINDOWEVENT_FOCUS_GAINED:
@@ -217,6 +306,10 @@ static int app_event_filter(void *userdata, SDL_Event *event) {
         case SDL_CONTROLLERDEVICEADDED:
         case SDL_CONTROLLERDEVICEREMOVED:
         case SDL_CONTROLLERDEVICEREMAPPED: {
+            if (app->session != NULL) {
+                // Input sender may still be using the gamepad state
+                session_flush_input_events(app->session);
+            }
             app_input_handle_event(&app->input, event);
             if (app->session != NULL) {
                 session_handle_input_event(app->session, event);
@@ -244,7 +337,7 @@ static int app_event_filter(void *userdata, SDL_Event *event) {
                     session_screen_keyboard_closed(app->session);
                 }
             }
-            if (!app_ui_is_opened(&app->ui) && app->session != NULL) {
+            if ((!app_ui_is_opened(&app->ui) || app_ui_is_suspended(&app->ui)) && app->session != NULL) {
                 session_handle_input_event(app->session, event);
                 return 0;
             }
@@ -261,7 +354,8 @@ static int app_event_filter(void *userdata, SDL_Event *event) {
         }
         default:
             if (event->type == USER_REMOTEBUTTONEVENT) {
-                return 1;
+                // Remote buttons are only used by overlay, input devices aren't polled when UI is suspended
+                return !app_ui_is_suspended(&app->ui);
             }
             return 0;
     }
@@ -302,8 +396,22 @@ bool app_decoder_or_embedded_present(app_t *app) {
 }
 #endif
 
-static void libs_init(app_t *app, int argc, char *argv[]) {
-    SS4S_SetLoggingFunction(commons_ss4s_logf);
+static int init_settings(app_init_context_t *ctx) {
+    return ctx->settings_loader(&ctx->app->settings);
+}
+
+static int init_os_info(app_init_context_t *ctx) {
+    app_t *app = ctx->app;
+    if (os_info_get(&app->os_info) == 0) {
+        char *info_str = os_info_str(&app->os_info);
+        commons_log_info("APP", "System: %s", info_str);
+        free(info_str);
+    }
+    return 0;
+}
+
+static int init_ss4s_modules(app_init_context_t *ctx) {
+    app_t *app = ctx->app;
     int errno;
     if ((errno = SS4S_ModulesList(&app->ss4s.modules, &app->os_info)) != 0) {
         commons_log_error("SS4S", "Can't load modules list: %s", strerror(errno));
@@ -328,12 +436,16 @@ static void libs_init(app_t *app, int argc, char *argv[]) {
         }
     }
 #endif
+    return 0;
+}
 
+static int init_ss4s(app_init_context_t *ctx) {
+    app_t *app = ctx->app;
     SS4S_Config ss4s_config = {
             .audioDriver = SS4S_ModuleInfoGetId(app->ss4s.selection.audio_module),
             .videoDriver = SS4S_ModuleInfoGetId(app->ss4s.selection.video_module),
     };
-    SS4S_Init(argc, argv, &ss4s_config);
+    SS4S_Init(ctx->argc, ctx->argv, &ss4s_config);
 
     SS4S_GetAudioCapabilitiesByCodecs(&app->ss4s.audio_cap, SS4S_AUDIO_PCM_S16LE | SS4S_AUDIO_OPUS);
     SS4S_GetVideoCapabilities(&app->ss4s.video_cap);
@@ -342,6 +454,86 @@ static void libs_init(app_t *app, int argc, char *argv[]) {
 #if FEATURE_INPUT_LIBCEC
     cec_sdl_init(&app->cec, "Moonlight");
 #endif
+    return 0;
+}
+
+static int init_locale(app_init_context_t *ctx) {
+    (void) ctx;
+    app_init_locale();
+    return 0;
+}
+
+static int init_client_conf(app_init_context_t *ctx) {
+    app_backend_t *backend = &ctx->app->backend;
+    client_conf_start(backend->client_conf, app_configuration->key_dir, NULL);
+    return 0;
+}
+
+static int init_known_hosts(app_init_context_t *ctx) {
+    (void) ctx;
+    pcmanager_load_known_hosts(pcmanager);
+    return 0;
+}
+
+static int init_fontconfig(app_init_context_t *ctx) {
+    (void) ctx;
+    if (app_font_config_init() != 0) {
+        // Not fatal, app_font_init will try again
+        commons_log_warn("APP", "Failed to initialize fontconfig");
+    }
+    return 0;
+}
+
+static int init_gamepad_mapping(app_init_context_t *ctx) {
+    if (ctx->app->settings.condb_path != NULL) {
+        app_input_copy_initial_gamepad_mapping(&ctx->app->settings);
+        app_input_update_gamepad_mapping_index(&ctx->app->settings);
+    }
+    return 0;
+}
+
+static int init_video(app_init_context_t *ctx) {
+    app_t *app = ctx->app;
+#if TARGET_WEBOS
+    SDL_SetHint(SDL_HINT_WEBOS_ACCESS_POLICY_KEYS_BACK, "true");
+    SDL_SetHint(SDL_HINT_WEBOS_ACCESS_POLICY_KEYS_EXIT, "true");
+    SDL_SetHint(SDL_HINT_WEBOS_CURSOR_SLEEP_TIME, "5000");
+    SDL_SetHint(SDL_HINT_WEBOS_CURSOR_FREQUENCY, "60");
+    SDL_SetHint(SDL_HINT_WEBOS_CURSOR_CALIBRATION_DISABLE, "true");
+    SDL_SetHint(SDL_HINT_WEBOS_HIDAPI_IGNORE_BLUETOOTH_DEVICES, "0x057e/0x0000");
+    if (app->settings.syskey_capture) {
+        SDL_SetHint(SDL_HINT_WEBOS_ACCESS_POLICY_KEYS_HOME, "true");
+        SDL_SetHint(SDL_HINT_WEBOS_ACCESS_POLICY_RIBBON, "false");
+    }
+#else
+    if (app->settings.syskey_capture) {
+        SDL_SetHint(SDL_HINT_GRAB_KEYBOARD, "1");
+    }
+#endif
+    if (SDL_InitSubSystem(SDL_INIT_VIDEO) < 0) {
+        commons_log_fatal("APP", "Failed to initialize SDL video subsystem: %s", SDL_GetError());
+        return -1;
+    }
+    // This will occupy SDL_USEREVENT
+    SDL_RegisterEvents(1);
+    return 0;
+}
+
+static int init_input(app_init_context_t *ctx) {
+    app_input_init(&ctx->app->input, ctx->app);
+    return 0;
+}
+
+static int init_ui(app_init_context_t *ctx) {
+    commons_log_info("APP", "UI locale: %s (%s)", i18n_locale(), locstr("[Localized Language]"));
+    app_ui_init(&ctx->app->ui, ctx->app);
+    return 0;
+}
+
+static int init_post(app_init_context_t *ctx) {
+    global = ctx->app;
+    SS4S_PostInit(ctx->argc, ctx->argv);
+    return 0;
 }
 
 static void quit_confirm_cb(lv_event_t *e) {
@@ -30,12 +30,15 @@ extern pcmanager_t *pcmanager;
 
 typedef struct session_t session_t;
 typedef struct app_wakelock_t app_wakelock_t;
+typedef struct async_log_t async_log_t;
 
 typedef int (app_settings_loader)(app_settings_t *settings);
 
 typedef struct app_t {
     bool running, focused;
     SDL_threadID main_thread_id;
+    /* Used by streaming threads, so slow log output won't stall them */
+    async_log_t *log;
     os_info_t os_info;
     app_settings_t settings;
     app_backend_t backend;
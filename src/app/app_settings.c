@@ -5,9 +5,8 @@
 #include <string.h>
 #include <errno.h>
 
-#include <ini.h>
-
 #include "util/ini_ext.h"
+#include "util/ini_index.h"
 #include "util/nullable.h"
 #include "util/path.h"
 #include "util/i18n.h"
@@ -49,6 +48,8 @@ void settings_initialize(app_settings_t *config, char *conf_dir) {
     config->stream.audioConfiguration = AUDIO_CONFIGURATION_STEREO;
 
     config->debug_level = 0;
+    config->cover_cache_limit = 32;
+    config->glyph_atlas = true;
     set_string(&config->language, "auto");
     set_string(&config->audio_backend, "auto");
     set_string(&config->decoder, "auto");
@@ -79,7 +80,7 @@ void settings_initialize(app_settings_t *config, char *conf_dir) {
 }
 
 bool settings_read(app_settings_t *config) {
-    return ini_parse(config->ini_path, (ini_handler) settings_parse, config) == 0;
+    return ini_index_parse(config->ini_path, (ini_index_handler) settings_parse, config) == 0;
 }
 
 bool settings_save(app_settings_t *config) {
@@ -93,6 +94,8 @@ bool settings_save(app_settings_t *config) {
     ini_write_string(fp, "language", config->language);
     ini_write_bool(fp, "fullscreen", config->fullscreen);
     ini_write_int(fp, "debug_level", config->debug_level);
+    ini_write_int(fp, "cover_cache_limit", config->cover_cache_limit);
+    ini_write_bool(fp, "glyph_atlas", config->glyph_atlas);
 
     ini_write_section(fp, "streaming");
     ini_write_int(fp, "width", config->stream.width);
@@ -285,6 +288,13 @@ static int settings_parse(app_settings_t *config, const char *section, const cha
 #endif
     } else if (INI_NAME_MATCH("debug_level")) {
         set_int(&config->debug_level, value);
+    } else if (INI_NAME_MATCH("cover_cache_limit")) {
+        set_int(&config->cover_cache_limit, value);
+        if (config->cover_cache_limit < 0) {
+            config->cover_cache_limit = 0;
+        }
+    } else if (INI_NAME_MATCH("glyph_atlas")) {
+        config->glyph_atlas = INI_IS_TRUE(value);
     } else if (INI_FULL_MATCH("window", "x")) {
         set_int(&config->window_state.x, value);
     } else if (INI_FULL_MATCH("window", "y")) {
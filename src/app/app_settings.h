@@ -30,6 +30,8 @@ typedef struct window_state_t {
 typedef struct app_settings_t {
     STREAM_CONFIGURATION stream;
     int debug_level;
+    int cover_cache_limit;
+    bool glyph_atlas;
     char *decoder;
     char *audio_backend;
     char *audio_device;
@@ -70,6 +72,9 @@ extern const size_t audio_config_len;
 
 #define CONF_NAME_MOONLIGHT "moonlight.ini"
 #define CONF_NAME_HOSTS "hosts.ini"
+#define CONF_NAME_HOST_CAPS "host_caps.ini"
+#define CONF_NAME_HOSTS_JOURNAL "hosts.journal"
+#define CONF_NAME_LAUNCH_TIMELINE "launch_timeline.tsv"
 
 #define RES_MERGE(w, h) (((w) & 0xFFFF) << 16 | ((h) & 0xFFFF))
 
@@ -3,6 +3,7 @@
 #include "app.h"
 #include "errors.h"
 #include "util/bus.h"
+#include "util/metrics_executor.h"
 #include "lazy.h"
 #include "refcounter.h"
 
@@ -82,9 +83,17 @@ void apploader_load(apploader_t *loader) {
         loader->callback.start(loader->userdata);
     }
     apploader_task_ctx_t *ctx = task_create(loader);
-    const executor_task_t *task = executor_submit(loader->executor, (executor_action_cb) task_run,
-                                                  (executor_cleanup_cb) task_finalize, ctx);
+    const executor_task_t *task = metrics_executor_submit(loader->executor, (executor_action_cb) task_run,
+                                                          (executor_cleanup_cb) task_finalize, ctx);
     commons_log_debug("AppLoader", "[loader %p] task start, task=%p", loader, task);
+    if (task == NULL) {
+        // Context is already freed by task_finalize
+        loader->state = APPLOADER_STATE_ERROR;
+        if (loader->callback.error != NULL) {
+            loader->callback.error(GS_ERROR, "Failed to start loading apps", loader->userdata);
+        }
+        return;
+    }
     ctx->task = task;
     loader->task = task;
 }
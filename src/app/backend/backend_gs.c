@@ -4,28 +4,24 @@
 #include "client.h"
 #include "errors.h"
 #include "app_error.h"
+#include "client_conf.h"
 
 GS_CLIENT app_gs_client_new(app_t *app) {
     if (SDL_ThreadID() == app->main_thread_id) {
         commons_log_fatal("APP", "%s MUST BE called from worker thread!", __FUNCTION__);
         abort();
     }
+    const char *conf_message = NULL;
+    if (client_conf_wait(app->backend.client_conf, &conf_message) != GS_OK) {
+        app_fatal_error("Failed to generate client info",
+                        "Please turn off and unplug to completely restart the TV.\n\n"
+                        "Details: %s", conf_message);
+        app_halt(app);
+    }
     SDL_assert_release(app->backend.gs_client_mutex != NULL);
     SDL_LockMutex(app->backend.gs_client_mutex);
     SDL_assert_release(app_configuration != NULL);
     GS_CLIENT client = gs_new(app_configuration->key_dir);
-    if (client == NULL && gs_get_error(NULL) == GS_BAD_CONF) {
-        if (gs_conf_init(app_configuration->key_dir) != GS_OK) {
-            const char *message = NULL;
-            gs_get_error(&message);
-            app_fatal_error("Failed to generate client info",
-                            "Please turn off and unplug to completely restart the TV.\n\n"
-                            "Details: %s", message);
-            app_halt(app);
-        } else {
-            client = gs_new(app_configuration->key_dir);
-        }
-    }
     if (client == NULL) {
         const char *message = NULL;
         gs_get_error(&message);
@@ -35,5 +31,6 @@ GS_CLIENT app_gs_client_new(app_t *app) {
         app_halt(app);
     }
     SDL_UnlockMutex(app->backend.gs_client_mutex);
+    gs_set_status_mode(client, GS_STATUS_RACE);
     return client;
 }
@@ -7,14 +7,29 @@
 
 #include "app.h"
 #include "executor.h"
+#include "client_conf.h"
+#include "libgamestream/http.h"
+#include "libgamestream/errors.h"
+#include "util/metrics.h"
+#include "util/async_log.h"
 
 pcmanager_t *pcmanager;
 
+METRICS_COUNTER(http_requests, "http.requests");
+METRICS_COUNTER(http_failures, "http.failures");
+METRICS_COUNTER(http_bytes, "http.bytes");
+METRICS_HISTOGRAM(http_latency, "http.latency_ms");
+
+static void http_observe(int result, long http_code, size_t bytes, double elapsed_ms);
 
 void backend_init(app_backend_t *backend, app_t *app) {
     backend->app = app;
+    http_set_request_observer(http_observe);
+    // Request logs and response dumps would otherwise be written on I/O threads
+    http_set_logger(async_log_default_vprintf, async_log_default_is_loggable);
     backend->executor = executor_create("moonlight-io", 2 * SDL_min(3, SDL_GetCPUCount()));
     backend->gs_client_mutex = SDL_CreateMutex();
+    backend->client_conf = client_conf_new(backend->executor);
     pcmanager = pcmanager_new(app, backend->executor);
 }
 
@@ -22,6 +37,7 @@ void backend_destroy(app_backend_t *backend) {
     pcmanager_destroy(pcmanager);
     SDL_DestroyMutex(backend->gs_client_mutex);
     executor_destroy(backend->executor);
+    client_conf_destroy(backend->client_conf);
 }
 
 bool backend_dispatch_userevent(app_backend_t *backend, int which, void *data1, void *data2) {
@@ -30,4 +46,14 @@ bool backend_dispatch_userevent(app_backend_t *backend, int which, void *data1,
     (void) data1;
     (void) data2;
     return false;
-}
\ No newline at end of file
+}
+
+static void http_observe(int result, long http_code, size_t bytes, double elapsed_ms) {
+    (void) http_code;
+    metrics_count(&http_requests, 1);
+    if (result != GS_OK) {
+        metrics_count(&http_failures, 1);
+    }
+    metrics_count(&http_bytes, bytes);
+    metrics_observe(&http_latency, (uint64_t) elapsed_ms);
+}
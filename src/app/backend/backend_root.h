@@ -5,11 +5,14 @@
 
 typedef struct app_t app_t;
 typedef struct executor_t executor_t;
+typedef struct client_conf_t client_conf_t;
 
 typedef struct app_backend_t {
     app_t *app;
     executor_t *executor;
     SDL_mutex *gs_client_mutex;
+    /* GameStream clients can be created once this is ready */
+    client_conf_t *client_conf;
 } app_backend_t;
 
 void backend_init(app_backend_t *backend, app_t *app);
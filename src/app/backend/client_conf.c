@@ -0,0 +1,121 @@
+#include "client_conf.h"
+
+#include "util/metrics_executor.h"
+#include "logging.h"
+#include "client.h"
+#include "errors.h"
+
+#include <errno.h>
+
+#include <SDL2/SDL_mutex.h>
+#include <SDL2/SDL_stdinc.h>
+#include <SDL2/SDL_timer.h>
+
+struct client_conf_t {
+    executor_t *executor;
+    char *keydir;
+    client_conf_init_fn init;
+    SDL_mutex *mutex;
+    SDL_cond *cond;
+    bool started;
+    bool ready;
+    int result;
+    char *message;
+};
+
+static int conf_init_default(const char *keydir);
+
+static int conf_task_run(client_conf_t *conf);
+
+static void conf_task_finalize(client_conf_t *conf, int result);
+
+client_conf_t *client_conf_new(executor_t *executor) {
+    client_conf_t *conf = SDL_calloc(1, sizeof(client_conf_t));
+    conf->executor = executor;
+    conf->mutex = SDL_CreateMutex();
+    conf->cond = SDL_CreateCond();
+    return conf;
+}
+
+void client_conf_start(client_conf_t *conf, const char *keydir, client_conf_init_fn init) {
+    SDL_LockMutex(conf->mutex);
+    SDL_assert_release(!conf->started);
+    conf->keydir = SDL_strdup(keydir);
+    conf->init = init != NULL ? init : conf_init_default;
+    conf->started = true;
+    SDL_UnlockMutex(conf->mutex);
+    metrics_executor_submit(conf->executor, (executor_action_cb) conf_task_run,
+                            (executor_cleanup_cb) conf_task_finalize, conf);
+}
+
+int client_conf_wait(client_conf_t *conf, const char **message) {
+    SDL_LockMutex(conf->mutex);
+    if (!conf->ready) {
+        Uint32 start = SDL_GetTicks();
+        commons_log_info("GameStream", "Waiting for client configuration");
+        while (!conf->ready) {
+            SDL_CondWait(conf->cond, conf->mutex);
+        }
+        commons_log_info("GameStream", "Client configuration ready after waiting %u ms", SDL_GetTicks() - start);
+    }
+    int result = conf->result;
+    if (message != NULL) {
+        *message = conf->message;
+    }
+    SDL_UnlockMutex(conf->mutex);
+    return result;
+}
+
+bool client_conf_is_ready(client_conf_t *conf) {
+    SDL_LockMutex(conf->mutex);
+    bool ready = conf->ready;
+    SDL_UnlockMutex(conf->mutex);
+    return ready;
+}
+
+void client_conf_destroy(client_conf_t *conf) {
+    SDL_DestroyCond(conf->cond);
+    SDL_DestroyMutex(conf->mutex);
+    SDL_free(conf->keydir);
+    SDL_free(conf->message);
+    SDL_free(conf);
+}
+
+static int conf_init_default(const char *keydir) {
+    GS_CLIENT client = gs_new(keydir);
+    if (client != NULL) {
+        gs_destroy(client);
+        return GS_OK;
+    }
+    int error = gs_get_error(NULL);
+    if (error != GS_BAD_CONF) {
+        return error;
+    }
+    return gs_conf_init(keydir);
+}
+
+static int conf_task_run(client_conf_t *conf) {
+    Uint32 start = SDL_GetTicks();
+    int result = conf->init(conf->keydir);
+    const char *message = NULL;
+    if (result != GS_OK) {
+        gs_get_error(&message);
+    }
+    commons_log_info("GameStream", "Client configuration prepared in %u ms, result %d", SDL_GetTicks() - start,
+                     result);
+    SDL_LockMutex(conf->mutex);
+    conf->result = result;
+    conf->message = message != NULL ? SDL_strdup(message) : NULL;
+    SDL_UnlockMutex(conf->mutex);
+    return result;
+}
+
+static void conf_task_finalize(client_conf_t *conf, int result) {
+    SDL_LockMutex(conf->mutex);
+    if (result == ECANCELED) {
+        conf->result = GS_FAILED;
+    }
+    conf->ready = true;
+    SDL_CondBroadcast(conf->cond);
+    SDL_UnlockMutex(conf->mutex);
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <stdbool.h>
+
+typedef struct executor_t executor_t;
+
+/**
+ * Client configuration (unique ID, certificate and key) prepared in background, so the slow key generation on first
+ * run doesn't block workers that don't need a GameStream client yet.
+ */
+typedef struct client_conf_t client_conf_t;
+
+/**
+ * Makes sure configuration exists in the key directory, generating it if needed.
+ * @return GS_OK, or error code with message set by gs_set_error
+ */
+typedef int (*client_conf_init_fn)(const char *keydir);
+
+client_conf_t *client_conf_new(executor_t *executor);
+
+/**
+ * Start preparing configuration on the executor.
+ * @param init Initialization function, or NULL for the default one that generates missing configuration
+ */
+void client_conf_start(client_conf_t *conf, const char *keydir, client_conf_init_fn init);
+
+/**
+ * Block until configuration is ready.
+ * @param message Error message if failed, valid until client_conf_destroy
+ * @return GS_OK, or error code of the initialization
+ */
+int client_conf_wait(client_conf_t *conf, const char **message);
+
+bool client_conf_is_ready(client_conf_t *conf);
+
+/**
+ * Must be called after the executor is destroyed, or after configuration is ready.
+ */
+void client_conf_destroy(client_conf_t *conf);
@@ -18,9 +18,15 @@ typedef void (*pcmanager_callback_t)(int result, const char *error, const uuidst
 
 typedef void(*pcmanager_listener_fn)(const uuidstr_t *uuid, void *userdata);
 
+/**
+ * @param changes Bitmask of pcmanager_change_t, accumulated since last notification. Never 0.
+ */
+typedef void(*pcmanager_update_listener_fn)(const uuidstr_t *uuid, pcmanager_change_t changes, void *userdata);
+
 typedef struct pcmanager_listener_t {
     pcmanager_listener_fn added;
-    pcmanager_listener_fn updated;
+    /** Coalesced, called at most once per host per main loop iteration, and only if something changed */
+    pcmanager_update_listener_fn updated;
     pcmanager_listener_fn removed;
 } pcmanager_listener_t;
 
@@ -30,6 +36,16 @@ typedef struct pcmanager_listener_t {
  */
 pcmanager_t *pcmanager_new(app_t *app, executor_t *executor);
 
+/**
+ * @brief Load saved hosts. Called once after pcmanager_new, can be called from any thread.
+ */
+void pcmanager_load_known_hosts(pcmanager_t *manager);
+
+/**
+ * @brief Make sure changes to known hosts are on disk, as the app may be killed without exiting normally.
+ */
+void pcmanager_sync_known_hosts(pcmanager_t *manager);
+
 /**
  * @brief Free all allocated memories, such as computer_list.
  * 
@@ -40,6 +56,24 @@ void pcmanager_auto_discovery_start(pcmanager_t *manager);
 
 void pcmanager_auto_discovery_stop(pcmanager_t *manager);
 
+/**
+ * Start refreshing hosts in background. Each host is polled at its own interval, faster while it's booting or running
+ * a game, and slower while it's offline. Must be called on main thread.
+ */
+void pcmanager_polling_start(pcmanager_t *manager);
+
+void pcmanager_polling_stop(pcmanager_t *manager);
+
+/**
+ * Pause polling while streaming, so it won't compete with the stream for bandwidth and CPU.
+ */
+void pcmanager_polling_suspend(pcmanager_t *manager, bool suspend);
+
+/**
+ * Poll the host more frequently for a while, as it's expected to come online soon.
+ */
+void pcmanager_polling_host_waking(pcmanager_t *manager, const uuidstr_t *uuid);
+
 const pclist_t *pcmanager_servers(pcmanager_t *manager);
 
 const pclist_t *pcmanager_node(pcmanager_t *manager, const uuidstr_t *uuid);
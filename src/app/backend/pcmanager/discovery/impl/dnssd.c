@@ -1,6 +1,7 @@
 #include "backend/pcmanager.h"
 #include "backend/pcmanager/priv.h"
 #include "backend/pcmanager/worker/worker.h"
+#include "util/metrics_executor.h"
 
 #include <dns_sd.h>
 #include <SDL_thread.h>
@@ -71,7 +72,7 @@ void pcmanager_auto_discovery_stop(pcmanager_t *manager) {
         return;
     }
     manager->discovery_task = NULL;
-    executor_submit(manager->executor, executor_noop, discovery_finalize, task);
+    metrics_executor_submit(manager->executor, executor_noop, discovery_finalize, task);
     pcmanager_unlock(manager);
 }
 
@@ -31,6 +31,8 @@ void pcmanager_lan_host_discovered(const sockaddr_t *addr, pcmanager_t *manager)
     SERVER_DATA *server = serverdata_new();
     char ip[64];
     sockaddr_get_ip_str(addr, ip, sizeof(ip));
+    // Host announced itself, waiting Wake-on-LAN requests can check it now
+    pcmanager_probe_trigger(manager, ip);
     int ret = gs_get_status(client, server, strndup(ip, sizeof(ip)), sockaddr_get_port(addr),
                             app_configuration->unsupported);
     if (ret == GS_OK) {
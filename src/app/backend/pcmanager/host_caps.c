@@ -0,0 +1,232 @@
+#include "priv.h"
+#include "pclist.h"
+#include "app.h"
+
+#include "ini_writer.h"
+#include "util/ini_ext.h"
+#include "util/ini_index.h"
+#include "util/path.h"
+#include "util/nullable.h"
+#include "app_settings.h"
+#include "util/metrics_executor.h"
+#include "logging.h"
+
+#ifdef __WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+/*
+ * Capabilities of known hosts from their last status, so a host can be launched before it responds to serverinfo
+ * after a cold start. Stored in a separate file to keep hosts.ini user editable.
+ */
+
+static void host_caps_apply(SERVER_DATA *server, const char *name, const char *value);
+
+static void host_caps_append_mode(SERVER_DATA *server, const char *value);
+
+static int host_caps_flush_task(pcmanager_t *manager);
+
+static void host_caps_flush(pcmanager_t *manager);
+
+static void host_caps_flush_done(pcmanager_t *manager, int result);
+
+static FILE *host_caps_write_tmp(pcmanager_t *manager, const char *tmp_file);
+
+static bool host_caps_commit(FILE *fp, const char *tmp_file, const char *conf_file);
+
+void pcmanager_load_host_caps(pcmanager_t *manager) {
+    char *conf_file = path_join(manager->app->settings.conf_dir, CONF_NAME_HOST_CAPS);
+    ini_index_t *index = ini_index_open(conf_file);
+    if (index == NULL) {
+        commons_log_debug("PCManager", "No host capabilities loaded from %s", conf_file);
+        free(conf_file);
+        return;
+    }
+    for (int section = 0; section < ini_index_sections_count(index); section++) {
+        uuidstr_t uuid;
+        uuidstr_fromstr(&uuid, ini_index_section_name(index, section));
+        pclist_t *node = pclist_find_by_uuid(manager, &uuid);
+        // Only fill in hosts loaded from hosts.ini, status from the host itself always wins
+        if (node == NULL || node->server == NULL || node->state.code != SERVER_STATE_NONE) { continue; }
+        for (const ini_index_entry_t *entry = ini_index_section_first(index, section); entry != NULL;
+             entry = ini_index_entry_next(index, entry)) {
+            host_caps_apply(node->server, entry->name, entry->value);
+        }
+    }
+    ini_index_close(index);
+    free(conf_file);
+}
+
+void pcmanager_host_caps_changed(pcmanager_t *manager) {
+    manager->host_caps_dirty = true;
+    if (manager->host_caps_saving) {
+        // The scheduled write will pick this up as well
+        return;
+    }
+    manager->host_caps_saving = true;
+    metrics_executor_submit(manager->executor, (executor_action_cb) host_caps_flush_task,
+                            (executor_cleanup_cb) host_caps_flush_done, manager);
+}
+
+void pcmanager_save_host_caps(pcmanager_t *manager) {
+    pcmanager_lock(manager);
+    while (manager->host_caps_saving) {
+        SDL_CondWait(manager->host_caps_cond, manager->lock);
+    }
+    if (manager->host_caps_dirty) {
+        host_caps_flush(manager);
+    }
+    pcmanager_unlock(manager);
+}
+
+static int host_caps_flush_task(pcmanager_t *manager) {
+    pcmanager_lock(manager);
+    host_caps_flush(manager);
+    pcmanager_unlock(manager);
+    return 0;
+}
+
+/**
+ * Write until no change is left. Must be called with lock held, it's released while syncing to disk.
+ */
+static void host_caps_flush(pcmanager_t *manager) {
+    char *conf_file = path_join(manager->app->settings.conf_dir, CONF_NAME_HOST_CAPS);
+    size_t tmp_file_len = strlen(conf_file) + 5;
+    char *tmp_file = malloc(tmp_file_len);
+    snprintf(tmp_file, tmp_file_len, "%s.tmp", conf_file);
+    while (manager->host_caps_dirty) {
+        manager->host_caps_dirty = false;
+        FILE *fp = host_caps_write_tmp(manager, tmp_file);
+        if (fp == NULL) {
+            commons_log_warn("PCManager", "Failed to write %s", conf_file);
+            manager->host_caps_dirty = true;
+            break;
+        }
+        pcmanager_unlock(manager);
+        bool ok = host_caps_commit(fp, tmp_file, conf_file);
+        pcmanager_lock(manager);
+        if (!ok) {
+            commons_log_warn("PCManager", "Failed to write %s", conf_file);
+            manager->host_caps_dirty = true;
+            break;
+        }
+    }
+    free(tmp_file);
+    free(conf_file);
+}
+
+static void host_caps_flush_done(pcmanager_t *manager, int result) {
+    (void) result;
+    pcmanager_lock(manager);
+    // If the write didn't happen, changes are still marked and will be saved on exit
+    manager->host_caps_saving = false;
+    SDL_CondBroadcast(manager->host_caps_cond);
+    pcmanager_unlock(manager);
+}
+
+static FILE *host_caps_write_tmp(pcmanager_t *manager, const char *tmp_file) {
+    FILE *fp = fopen(tmp_file, "wb");
+    if (!fp) {
+        return NULL;
+    }
+    for (pclist_t *cur = manager->servers; cur != NULL; cur = cur->next) {
+        const SERVER_DATA *server = cur->server;
+        // Hosts never responded don't have anything to save
+        if (!server || !cur->known || !server->serverInfo.serverInfoAppVersion) {
+            continue;
+        }
+        ini_write_section(fp, server->uuid);
+
+        ini_write_string(fp, "app_version", server->serverInfo.serverInfoAppVersion);
+        if (server->serverInfo.serverInfoGfeVersion) {
+            ini_write_string(fp, "gfe_version", server->serverInfo.serverInfoGfeVersion);
+        }
+        if (server->gsVersion) {
+            ini_write_string(fp, "gs_version", server->gsVersion);
+        }
+        if (server->gpuType) {
+            ini_write_string(fp, "gpu_type", server->gpuType);
+        }
+        ini_write_int(fp, "https_port", server->httpsPort);
+        ini_write_bool(fp, "gfe", server->isGfe);
+        ini_write_bool(fp, "supports_4k", server->supports4K);
+        ini_write_bool(fp, "supports_hdr", server->supportsHdr);
+        ini_write_int(fp, "codec_mode_support", server->serverInfo.serverCodecModeSupport);
+        for (const DISPLAY_MODE *mode = server->modes; mode != NULL; mode = mode->next) {
+            char mode_buf[32];
+            SDL_snprintf(mode_buf, sizeof(mode_buf), "%ux%ux%u", mode->width, mode->height, mode->refresh);
+            ini_write_string(fp, "mode", mode_buf);
+        }
+    }
+    if (fflush(fp) != 0) {
+        fclose(fp);
+        remove(tmp_file);
+        return NULL;
+    }
+    return fp;
+}
+
+static bool host_caps_commit(FILE *fp, const char *tmp_file, const char *conf_file) {
+    // Saved while the app is running, so it's replaced only when completely on disk
+    bool ok;
+#ifdef __WIN32
+    ok = _commit(_fileno(fp)) == 0;
+#else
+    ok = fsync(fileno(fp)) == 0;
+#endif
+    ok = fclose(fp) == 0 && ok;
+    if (ok) {
+        ok = path_replace(tmp_file, conf_file) == 0;
+    }
+    if (!ok) {
+        remove(tmp_file);
+    }
+    return ok;
+}
+
+static void host_caps_apply(SERVER_DATA *server, const char *name, const char *value) {
+    if (INI_NAME_MATCH("app_version")) {
+        free_nullable((void *) server->serverInfo.serverInfoAppVersion);
+        server->serverInfo.serverInfoAppVersion = SDL_strdup(value);
+        server->serverMajorVersion = SDL_atoi(value);
+    } else if (INI_NAME_MATCH("gfe_version")) {
+        free_nullable((void *) server->serverInfo.serverInfoGfeVersion);
+        server->serverInfo.serverInfoGfeVersion = SDL_strdup(value);
+    } else if (INI_NAME_MATCH("gs_version")) {
+        free_nullable((void *) server->gsVersion);
+        server->gsVersion = SDL_strdup(value);
+    } else if (INI_NAME_MATCH("gpu_type")) {
+        free_nullable((void *) server->gpuType);
+        server->gpuType = SDL_strdup(value);
+    } else if (INI_NAME_MATCH("https_port")) {
+        server->httpsPort = (unsigned short) SDL_atoi(value);
+    } else if (INI_NAME_MATCH("gfe")) {
+        server->isGfe = INI_IS_TRUE(value);
+    } else if (INI_NAME_MATCH("supports_4k")) {
+        server->supports4K = INI_IS_TRUE(value);
+    } else if (INI_NAME_MATCH("supports_hdr")) {
+        server->supportsHdr = INI_IS_TRUE(value);
+    } else if (INI_NAME_MATCH("codec_mode_support")) {
+        server->serverInfo.serverCodecModeSupport = SDL_atoi(value);
+    } else if (INI_NAME_MATCH("mode")) {
+        host_caps_append_mode(server, value);
+    }
+}
+
+static void host_caps_append_mode(SERVER_DATA *server, const char *value) {
+    unsigned int width = 0, height = 0, refresh = 0;
+    if (SDL_sscanf(value, "%ux%ux%u", &width, &height, &refresh) != 3) {
+        return;
+    }
+    DISPLAY_MODE *mode = SDL_calloc(1, sizeof(DISPLAY_MODE));
+    mode->width = width;
+    mode->height = height;
+    mode->refresh = refresh;
+    DISPLAY_MODE **tail = &server->modes;
+    while (*tail != NULL) {
+        tail = &(*tail)->next;
+    }
+    *tail = mode;
+}
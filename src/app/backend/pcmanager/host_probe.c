@@ -0,0 +1,182 @@
+#include "host_probe.h"
+
+#include <SDL_mutex.h>
+#include <SDL_timer.h>
+
+#include <assert.h>
+#include <errno.h>
+#include <string.h>
+
+#ifdef __WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+
+/* Winsock is initialized by cURL global init */
+typedef SOCKET probe_socket_t;
+typedef WSAPOLLFD probe_pollfd_t;
+#define PROBE_INVALID_SOCKET INVALID_SOCKET
+#define probe_close(fd) closesocket(fd)
+#define probe_poll(fds, nfds, timeout) WSAPoll(fds, nfds, timeout)
+#define probe_connect_pending() (WSAGetLastError() == WSAEWOULDBLOCK)
+#else
+#include <fcntl.h>
+#include <netdb.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+typedef int probe_socket_t;
+typedef struct pollfd probe_pollfd_t;
+#define PROBE_INVALID_SOCKET (-1)
+#define probe_close(fd) close(fd)
+#define probe_poll(fds, nfds, timeout) poll(fds, nfds, timeout)
+#define probe_connect_pending() (errno == EINPROGRESS)
+#endif
+
+#include "logging.h"
+
+struct host_probe_t {
+    char *address;
+    uint16_t ports[HOST_PROBE_MAX_PORTS];
+    size_t num_ports;
+    SDL_sem *trigger;
+};
+
+static int probe_attempt(host_probe_t *probe, Uint32 wait_ms);
+
+static probe_socket_t connect_nonblock(const char *address, uint16_t port);
+
+host_probe_t *host_probe_new(const char *address, const uint16_t *ports, size_t num_ports) {
+    assert(num_ports > 0 && num_ports <= HOST_PROBE_MAX_PORTS);
+    host_probe_t *probe = SDL_calloc(1, sizeof(host_probe_t));
+    probe->address = SDL_strdup(address);
+    SDL_memcpy(probe->ports, ports, num_ports * sizeof(uint16_t));
+    probe->num_ports = num_ports;
+    probe->trigger = SDL_CreateSemaphore(0);
+    return probe;
+}
+
+void host_probe_destroy(host_probe_t *probe) {
+    SDL_DestroySemaphore(probe->trigger);
+    SDL_free(probe->address);
+    SDL_free(probe);
+}
+
+const char *host_probe_address(const host_probe_t *probe) {
+    return probe->address;
+}
+
+int host_probe_wait(host_probe_t *probe, const host_probe_options_t *options) {
+    Uint32 deadline = SDL_GetTicks() + options->timeout_ms;
+    Uint32 interval = options->initial_interval_ms;
+    int attempts = 0;
+    while (!SDL_TICKS_PASSED(SDL_GetTicks(), deadline)) {
+        Uint32 attempt_start = SDL_GetTicks();
+        Uint32 remaining = deadline - attempt_start;
+        attempts++;
+        // Connection attempt itself waits for at most one interval
+        int index = probe_attempt(probe, SDL_min(interval, remaining));
+        if (index >= 0) {
+            commons_log_debug("HostProbe", "%s:%u answered after %d attempts", probe->address, probe->ports[index],
+                              attempts);
+            return index;
+        }
+        Uint32 now = SDL_GetTicks();
+        if (SDL_TICKS_PASSED(now, deadline)) {
+            break;
+        }
+        Uint32 elapsed = now - attempt_start;
+        if (elapsed < interval) {
+            Uint32 wait = SDL_min(interval - elapsed, deadline - now);
+            if (SDL_SemWaitTimeout(probe->trigger, wait) == 0) {
+                commons_log_debug("HostProbe", "%s triggered", probe->address);
+                interval = options->initial_interval_ms;
+                continue;
+            }
+        }
+        interval = SDL_min(interval * 2, options->max_interval_ms);
+    }
+    commons_log_debug("HostProbe", "%s didn't answer after %d attempts", probe->address, attempts);
+    return -1;
+}
+
+void host_probe_trigger(host_probe_t *probe) {
+    if (SDL_SemValue(probe->trigger) == 0) {
+        SDL_SemPost(probe->trigger);
+    }
+}
+
+/**
+ * @return Index of connected port, or -1 if none of them connected in time
+ */
+static int probe_attempt(host_probe_t *probe, Uint32 wait_ms) {
+    probe_pollfd_t fds[HOST_PROBE_MAX_PORTS];
+    size_t pending = 0;
+    for (size_t i = 0; i < probe->num_ports; i++) {
+        fds[i].fd = connect_nonblock(probe->address, probe->ports[i]);
+        fds[i].events = POLLOUT;
+        fds[i].revents = 0;
+        if (fds[i].fd != PROBE_INVALID_SOCKET) {
+            pending++;
+        }
+    }
+    int result = -1;
+    Uint32 deadline = SDL_GetTicks() + wait_ms;
+    while (pending > 0 && result < 0) {
+        Uint32 now = SDL_GetTicks();
+        if (SDL_TICKS_PASSED(now, deadline)) {
+            break;
+        }
+        int ret = probe_poll(fds, probe->num_ports, (int) (deadline - now));
+        if (ret < 0 && errno == EINTR) {
+            continue;
+        } else if (ret <= 0) {
+            break;
+        }
+        for (size_t i = 0; i < probe->num_ports; i++) {
+            if (fds[i].fd == PROBE_INVALID_SOCKET || fds[i].revents == 0) {
+                continue;
+            }
+            int error = 0;
+            socklen_t len = sizeof(error);
+            if (getsockopt(fds[i].fd, SOL_SOCKET, SO_ERROR, (char *) &error, &len) == 0 && error == 0) {
+                result = (int) i;
+                break;
+            }
+            // Refused or unreachable, machine may still be booting
+            probe_close(fds[i].fd);
+            fds[i].fd = PROBE_INVALID_SOCKET;
+            pending--;
+        }
+    }
+    for (size_t i = 0; i < probe->num_ports; i++) {
+        if (fds[i].fd != PROBE_INVALID_SOCKET) {
+            probe_close(fds[i].fd);
+        }
+    }
+    return result;
+}
+
+static probe_socket_t connect_nonblock(const char *address, uint16_t port) {
+    struct addrinfo hints = {.ai_family = AF_UNSPEC, .ai_socktype = SOCK_STREAM}, *addrs = NULL;
+    char port_str[8];
+    SDL_snprintf(port_str, sizeof(port_str), "%u", port);
+    if (getaddrinfo(address, port_str, &hints, &addrs) != 0 || addrs == NULL) {
+        return PROBE_INVALID_SOCKET;
+    }
+    probe_socket_t fd = socket(addrs->ai_family, addrs->ai_socktype, addrs->ai_protocol);
+    if (fd != PROBE_INVALID_SOCKET) {
+#ifdef __WIN32
+        u_long nonblock = 1;
+        ioctlsocket(fd, FIONBIO, &nonblock);
+#else
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+#endif
+        if (connect(fd, addrs->ai_addr, (int) addrs->ai_addrlen) != 0 && !probe_connect_pending()) {
+            probe_close(fd);
+            fd = PROBE_INVALID_SOCKET;
+        }
+    }
+    freeaddrinfo(addrs);
+    return fd;
+}
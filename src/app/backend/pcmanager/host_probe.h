@@ -0,0 +1,39 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <SDL_stdinc.h>
+
+/**
+ * Cheap reachability check for a host that may be waking up. Only opens TCP connections, so it can be retried
+ * frequently without the cost of a full serverinfo request.
+ */
+typedef struct host_probe_t host_probe_t;
+
+typedef struct host_probe_options_t {
+    /* Give up after this time */
+    Uint32 timeout_ms;
+    /* Interval between attempts, doubled after each attempt until max_interval_ms */
+    Uint32 initial_interval_ms;
+    Uint32 max_interval_ms;
+} host_probe_options_t;
+
+#define HOST_PROBE_MAX_PORTS 4
+
+host_probe_t *host_probe_new(const char *address, const uint16_t *ports, size_t num_ports);
+
+void host_probe_destroy(host_probe_t *probe);
+
+const char *host_probe_address(const host_probe_t *probe);
+
+/**
+ * Block until one of the ports accepts a connection, or timed out.
+ *
+ * @return Index of the port answered first, or -1 if timed out
+ */
+int host_probe_wait(host_probe_t *probe, const host_probe_options_t *options);
+
+/**
+ * Make the waiting probe try again right away, e.g. when the host announced itself. Can be called from any thread.
+ */
+void host_probe_trigger(host_probe_t *probe);
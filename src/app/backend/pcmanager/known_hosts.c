@@ -1,12 +1,12 @@
 #include "known_hosts.h"
+#include "known_hosts_journal.h"
 #include "priv.h"
 #include "pclist.h"
 #include "app.h"
 
-#include <ini.h>
-
 #include "ini_writer.h"
 #include "util/ini_ext.h"
+#include "util/ini_index.h"
 #include "util/path.h"
 #include "app_settings.h"
 
@@ -23,15 +23,30 @@
 #undef LINKEDLIST_TYPE
 #undef LINKEDLIST_PREFIX
 
-static int known_hosts_handle(known_host_t **list, const char *section, const char *name, const char *value);
+#ifdef __WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+/* Fold the journal into hosts.ini once it has this many records */
+#define KNOWN_HOSTS_COMPACT_RECORDS 64
+
+static void known_hosts_apply(known_host_t *host, const char *name, const char *value);
 
-static int known_hosts_find_uuid(known_host_t *node, void *v);
+static bool known_hosts_address_string(const SERVER_DATA *server, char *buf, size_t len);
+
+static void known_hosts_journal_written(pcmanager_t *manager, bool written);
 
 void pcmanager_load_known_hosts(pcmanager_t *manager) {
     commons_log_info("PCManager", "Load unknown hosts");
     char *conf_file = path_join(manager->app->settings.conf_dir, CONF_NAME_HOSTS);
     known_host_t *hosts = known_hosts_parse(conf_file);
+    char *journal_file = path_join(manager->app->settings.conf_dir, CONF_NAME_HOSTS_JOURNAL);
 
+    pcmanager_lock(manager);
+    // Changes made after hosts.ini was last written, the process might not have exited normally
+    manager->journal = known_hosts_journal_open(journal_file, &hosts);
     bool selected_set = false;
     for (known_host_t *cur = hosts; cur; cur = cur->next) {
         const char *mac = cur->mac, *hostname = cur->hostname;
@@ -64,15 +79,27 @@ void pcmanager_load_known_hosts(pcmanager_t *manager) {
             selected_set = true;
         }
     }
+    pcmanager_load_host_caps(manager);
+    if (known_hosts_journal_records(manager->journal) > 0) {
+        pcmanager_save_known_hosts(manager);
+    }
+    pcmanager_unlock(manager);
     known_hosts_free(hosts, known_hosts_node_free);
+    free(journal_file);
     free(conf_file);
 }
 
 void pcmanager_save_known_hosts(pcmanager_t *manager) {
     char *conf_file = path_join(manager->app->settings.conf_dir, CONF_NAME_HOSTS);
-    FILE *fp = fopen(conf_file, "wb");
-    free(conf_file);
-    if (!fp) { return; }
+    size_t tmp_file_len = strlen(conf_file) + 5;
+    char *tmp_file = malloc(tmp_file_len);
+    snprintf(tmp_file, tmp_file_len, "%s.tmp", conf_file);
+    FILE *fp = fopen(tmp_file, "wb");
+    if (!fp) {
+        free(tmp_file);
+        free(conf_file);
+        return;
+    }
 
     bool selected_set = false;
     for (pclist_t *cur = manager->servers; cur != NULL; cur = cur->next) {
@@ -80,19 +107,15 @@ void pcmanager_save_known_hosts(pcmanager_t *manager) {
             continue;
         }
         const SERVER_DATA *server = cur->server;
-        hostport_t *address = hostport_new(server->serverInfo.address, server->extPort);
-        if (address == NULL) {
+        char address_buf[260] = {0};
+        if (!known_hosts_address_string(server, address_buf, sizeof(address_buf))) {
             continue;
         }
         ini_write_section(fp, server->uuid);
 
         ini_write_string(fp, "mac", server->mac);
         ini_write_string(fp, "hostname", server->hostname);
-
-        char address_buf[260] = {0};
-        hostport_to_string(address, address_buf, sizeof(address_buf));
         ini_write_string(fp, "address", address_buf);
-        hostport_free(address);
 
         if (!selected_set && cur->selected) {
             ini_write_bool(fp, "selected", true);
@@ -111,17 +134,63 @@ void pcmanager_save_known_hosts(pcmanager_t *manager) {
             }
         }
     }
-    fclose(fp);
+    // Journal can only be discarded once hosts.ini is completely on disk
+    bool ok = fflush(fp) == 0;
+#ifdef __WIN32
+    ok = ok && _commit(_fileno(fp)) == 0;
+#else
+    ok = ok && fsync(fileno(fp)) == 0;
+#endif
+    ok = fclose(fp) == 0 && ok;
+    if (ok) {
+        ok = path_replace(tmp_file, conf_file) == 0;
+    }
+    if (ok) {
+        known_hosts_journal_reset(manager->journal);
+    } else {
+        commons_log_warn("PCManager", "Failed to write %s", conf_file);
+        remove(tmp_file);
+    }
+    free(tmp_file);
+    free(conf_file);
 }
 
-static int known_hosts_handle(known_host_t **list, const char *section, const char *name, const char *value) {
-    if (!section) { return 1; }
-    known_host_t *host = known_hosts_find_by(*list, section, (known_hosts_find_fn) known_hosts_find_uuid);
-    if (!host) {
-        host = known_hosts_new();
-        uuidstr_fromstr(&host->uuid, section);
-        *list = known_hosts_append(*list, host);
+void pcmanager_sync_known_hosts(pcmanager_t *manager) {
+    pcmanager_lock(manager);
+    known_hosts_journal_sync(manager->journal);
+    pcmanager_unlock(manager);
+}
+
+void pcmanager_journal_host(pcmanager_t *manager, const pclist_t *node) {
+    const SERVER_DATA *server = node->server;
+    char address_buf[260] = {0};
+    if (manager->journal == NULL || server == NULL || !known_hosts_address_string(server, address_buf,
+                                                                                  sizeof(address_buf))) {
+        return;
     }
+    known_hosts_journal_written(manager, known_hosts_journal_host(manager->journal, server->uuid, server->mac,
+                                                                  server->hostname, address_buf));
+}
+
+void pcmanager_journal_forget(pcmanager_t *manager, const uuidstr_t *uuid) {
+    known_hosts_journal_written(manager, known_hosts_journal_forget(manager->journal, (const char *) uuid));
+}
+
+void pcmanager_journal_select(pcmanager_t *manager, const uuidstr_t *uuid) {
+    known_hosts_journal_written(manager, known_hosts_journal_select(manager->journal, (const char *) uuid));
+}
+
+void pcmanager_journal_favorite(pcmanager_t *manager, const uuidstr_t *uuid, int appid, bool favorite) {
+    known_hosts_journal_written(manager, known_hosts_journal_favorite(manager->journal, (const char *) uuid, appid,
+                                                                      favorite));
+}
+
+void pcmanager_journal_hidden(pcmanager_t *manager, const uuidstr_t *uuid, int appid, bool hidden) {
+    known_hosts_journal_written(manager, known_hosts_journal_hidden(manager->journal, (const char *) uuid, appid,
+                                                                    hidden));
+}
+
+static void known_hosts_apply(known_host_t *host, const char *name, const char *value) {
     if (INI_NAME_MATCH("mac")) {
         host->mac = SDL_strdup(value);
     } else if (INI_NAME_MATCH("hostname")) {
@@ -139,11 +208,26 @@ static int known_hosts_handle(known_host_t **list, const char *section, const ch
         id_item->id = SDL_atoi(value);
         host->hidden = appid_list_append(host->hidden, id_item);
     }
-    return 1;
 }
 
-static int known_hosts_find_uuid(known_host_t *node, void *v) {
-    return !uuidstr_t_equals_s(&node->uuid, v);
+static bool known_hosts_address_string(const SERVER_DATA *server, char *buf, size_t len) {
+    hostport_t *address = hostport_new(server->serverInfo.address, server->extPort);
+    if (address == NULL) {
+        return false;
+    }
+    hostport_to_string(address, buf, len);
+    hostport_free(address);
+    return true;
+}
+
+static void known_hosts_journal_written(pcmanager_t *manager, bool written) {
+    if (!written) {
+        // Without the journal, the change will be saved on exit
+        return;
+    }
+    if (known_hosts_journal_records(manager->journal) >= KNOWN_HOSTS_COMPACT_RECORDS) {
+        pcmanager_save_known_hosts(manager);
+    }
 }
 
 void known_hosts_node_free(known_host_t *node) {
@@ -160,9 +244,36 @@ void known_hosts_node_free(known_host_t *node) {
 }
 
 known_host_t *known_hosts_parse(const char *conf_file) {
-    known_host_t *hosts = NULL;
-    if (ini_parse(conf_file, (ini_handler) known_hosts_handle, &hosts) != 0) {
+    ini_index_t *index = ini_index_open(conf_file);
+    if (index == NULL) {
         return NULL;
     }
+    if (ini_index_error(index) != 0) {
+        commons_log_warn("PCManager", "Failed to parse %s at line %d", conf_file, ini_index_error(index));
+        ini_index_close(index);
+        return NULL;
+    }
+    // Sections with the same UUID are merged by the index, so each host is created once
+    known_host_t *hosts = NULL, *tail = NULL;
+    for (int section = 0; section < ini_index_sections_count(index); section++) {
+        const char *uuid = ini_index_section_name(index, section);
+        if (uuid[0] == '\0') {
+            continue;
+        }
+        known_host_t *host = known_hosts_new();
+        uuidstr_fromstr(&host->uuid, uuid);
+        for (const ini_index_entry_t *entry = ini_index_section_first(index, section); entry != NULL;
+             entry = ini_index_entry_next(index, entry)) {
+            known_hosts_apply(host, entry->name, entry->value);
+        }
+        // Not using known_hosts_append, it walks the whole list every time
+        if (tail == NULL) {
+            hosts = host;
+        } else {
+            tail->next = host;
+        }
+        tail = host;
+    }
+    ini_index_close(index);
     return hosts;
 }
\ No newline at end of file
@@ -0,0 +1,380 @@
+#include "known_hosts_journal.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <SDL.h>
+
+#ifdef __WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+#define LINKEDLIST_IMPL
+#define LINKEDLIST_MODIFIER static
+#define LINKEDLIST_TYPE appid_list_t
+#define LINKEDLIST_PREFIX appid_list_jl
+#define LINKEDLIST_DOUBLE 1
+
+#include "linked_list.h"
+
+#undef LINKEDLIST_DOUBLE
+#undef LINKEDLIST_TYPE
+#undef LINKEDLIST_PREFIX
+
+#include "logging.h"
+#include "util/path.h"
+
+/* Records are synced to disk once this many are pending, or the last sync was this long ago */
+#define JOURNAL_SYNC_BATCH 8
+#define JOURNAL_SYNC_INTERVAL_MS 2000
+
+#define JOURNAL_MAX_RECORD 1024
+#define JOURNAL_MAX_FIELDS 5
+
+struct known_hosts_journal_t {
+    char *path;
+    FILE *fp;
+    size_t records;
+    size_t unsynced;
+    Uint32 last_sync;
+};
+
+static char *journal_read(const char *path, size_t *size);
+
+static size_t journal_apply_all(const char *data, size_t size, known_host_t **hosts, size_t *valid_size);
+
+static void journal_apply(char *record, known_host_t **hosts);
+
+static bool journal_append(known_hosts_journal_t *journal, const char *op, const char *const *fields,
+                           int num_fields);
+
+static bool journal_rewrite(const char *path, const char *data, size_t size);
+
+static void journal_fsync(FILE *fp);
+
+static known_host_t *journal_find_host(known_host_t *hosts, const char *uuid);
+
+static void journal_set_id(appid_list_t **list, int appid, bool present);
+
+static int journal_find_id(appid_list_t *other, const void *v);
+
+static void journal_replace_str(char **dst, const char *value);
+
+known_hosts_journal_t *known_hosts_journal_open(const char *path, known_host_t **hosts) {
+    size_t size = 0, valid_size = 0, records = 0;
+    char *data = journal_read(path, &size);
+    if (data != NULL) {
+        records = journal_apply_all(data, size, hosts, &valid_size);
+        if (valid_size < size) {
+            commons_log_warn("PCManager", "Dropping %zu bytes of incomplete records from %s", size - valid_size, path);
+            // Records appended after a torn one would never be replayed
+            if (!journal_rewrite(path, data, valid_size)) {
+                free(data);
+                return NULL;
+            }
+        }
+        free(data);
+    }
+    FILE *fp = fopen(path, "ab");
+    if (fp == NULL) {
+        commons_log_warn("PCManager", "Failed to open %s, changes to hosts will be saved on exit only", path);
+        return NULL;
+    }
+    known_hosts_journal_t *journal = calloc(1, sizeof(known_hosts_journal_t));
+    journal->path = strdup(path);
+    journal->fp = fp;
+    journal->records = records;
+    journal->last_sync = SDL_GetTicks();
+    if (records > 0) {
+        commons_log_info("PCManager", "Recovered %zu changes to hosts from %s", records, path);
+    }
+    return journal;
+}
+
+void known_hosts_journal_close(known_hosts_journal_t *journal) {
+    if (journal == NULL) {
+        return;
+    }
+    if (journal->fp != NULL) {
+        known_hosts_journal_sync(journal);
+        fclose(journal->fp);
+    }
+    free(journal->path);
+    free(journal);
+}
+
+size_t known_hosts_journal_replay(const char *path, known_host_t **hosts) {
+    size_t size = 0, valid_size = 0;
+    char *data = journal_read(path, &size);
+    if (data == NULL) {
+        return 0;
+    }
+    size_t records = journal_apply_all(data, size, hosts, &valid_size);
+    free(data);
+    return records;
+}
+
+bool known_hosts_journal_host(known_hosts_journal_t *journal, const char *uuid, const char *mac,
+                              const char *hostname, const char *address) {
+    const char *fields[] = {uuid, mac, hostname, address};
+    return journal_append(journal, "host", fields, 4);
+}
+
+bool known_hosts_journal_forget(known_hosts_journal_t *journal, const char *uuid) {
+    const char *fields[] = {uuid};
+    return journal_append(journal, "forget", fields, 1);
+}
+
+bool known_hosts_journal_select(known_hosts_journal_t *journal, const char *uuid) {
+    const char *fields[] = {uuid};
+    return journal_append(journal, "select", fields, 1);
+}
+
+bool known_hosts_journal_favorite(known_hosts_journal_t *journal, const char *uuid, int appid, bool favorite) {
+    char appid_buf[16];
+    SDL_snprintf(appid_buf, sizeof(appid_buf), "%d", appid);
+    const char *fields[] = {uuid, appid_buf, favorite ? "1" : "0"};
+    return journal_append(journal, "favorite", fields, 3);
+}
+
+bool known_hosts_journal_hidden(known_hosts_journal_t *journal, const char *uuid, int appid, bool hidden) {
+    char appid_buf[16];
+    SDL_snprintf(appid_buf, sizeof(appid_buf), "%d", appid);
+    const char *fields[] = {uuid, appid_buf, hidden ? "1" : "0"};
+    return journal_append(journal, "hidden", fields, 3);
+}
+
+void known_hosts_journal_sync(known_hosts_journal_t *journal) {
+    if (journal == NULL || journal->fp == NULL || journal->unsynced == 0) {
+        return;
+    }
+    journal_fsync(journal->fp);
+    journal->unsynced = 0;
+    journal->last_sync = SDL_GetTicks();
+}
+
+void known_hosts_journal_reset(known_hosts_journal_t *journal) {
+    if (journal == NULL) {
+        return;
+    }
+    if (journal->fp != NULL) {
+        journal->fp = freopen(journal->path, "wb", journal->fp);
+    } else {
+        journal->fp = fopen(journal->path, "wb");
+    }
+    journal->records = 0;
+    journal->unsynced = 0;
+}
+
+size_t known_hosts_journal_records(const known_hosts_journal_t *journal) {
+    return journal != NULL ? journal->records : 0;
+}
+
+static char *journal_read(const char *path, size_t *size) {
+    FILE *fp = fopen(path, "rb");
+    if (fp == NULL) {
+        return NULL;
+    }
+    char *data = NULL;
+    long length;
+    if (fseek(fp, 0, SEEK_END) != 0 || (length = ftell(fp)) < 0 || fseek(fp, 0, SEEK_SET) != 0) {
+        fclose(fp);
+        return NULL;
+    }
+    data = malloc(length + 1);
+    if (data != NULL && fread(data, 1, length, fp) != (size_t) length) {
+        free(data);
+        data = NULL;
+    }
+    fclose(fp);
+    if (data != NULL) {
+        data[length] = '\0';
+        *size = length;
+    }
+    return data;
+}
+
+/**
+ * Record format: op, fields and checksum of everything before it, separated by tabs. Stops at the first record that
+ * is incomplete or doesn't match its checksum.
+ *
+ * @param valid_size Length of intact records at the beginning
+ * @return Number of intact records
+ */
+static size_t journal_apply_all(const char *data, size_t size, known_host_t **hosts, size_t *valid_size) {
+    size_t records = 0, offset = 0;
+    char record[JOURNAL_MAX_RECORD];
+    while (offset < size) {
+        const char *line = data + offset;
+        const char *end = memchr(line, '\n', size - offset);
+        if (end == NULL) {
+            break;
+        }
+        size_t line_len = end - line;
+        const char *checksum = line_len > 9 ? line + line_len - 9 : NULL;
+        if (checksum == NULL || line_len >= sizeof(record) || checksum[0] != '\t') {
+            break;
+        }
+        char *checksum_end = NULL;
+        Uint32 expected = (Uint32) SDL_strtoul(checksum + 1, &checksum_end, 16);
+        if (checksum_end != end || expected != SDL_crc32(0, line, checksum - line)) {
+            break;
+        }
+        memcpy(record, line, checksum - line);
+        record[checksum - line] = '\0';
+        journal_apply(record, hosts);
+        records++;
+        offset += line_len + 1;
+    }
+    *valid_size = offset;
+    return records;
+}
+
+static void journal_apply(char *record, known_host_t **hosts) {
+    char *fields[JOURNAL_MAX_FIELDS + 1];
+    int num_fields = 0;
+    for (char *field = record; field != NULL && num_fields < JOURNAL_MAX_FIELDS + 1; num_fields++) {
+        fields[num_fields] = field;
+        char *sep = strchr(field, '\t');
+        if (sep != NULL) {
+            *sep = '\0';
+            sep++;
+        }
+        field = sep;
+    }
+    const char *op = fields[0];
+    if (num_fields < 2) {
+        return;
+    }
+    known_host_t *host = journal_find_host(*hosts, fields[1]);
+    if (SDL_strcmp(op, "host") == 0 && num_fields == 5) {
+        if (host == NULL) {
+            host = known_hosts_new();
+            uuidstr_fromstr(&host->uuid, fields[1]);
+            *hosts = known_hosts_append(*hosts, host);
+        }
+        journal_replace_str(&host->mac, fields[2]);
+        journal_replace_str(&host->hostname, fields[3]);
+        if (host->address != NULL) {
+            free(host->address);
+        }
+        host->address = fields[4][0] != '\0' ? hostport_parse(fields[4]) : NULL;
+    } else if (SDL_strcmp(op, "forget") == 0) {
+        for (known_host_t **cur = hosts; *cur != NULL; cur = &(*cur)->next) {
+            if (*cur == host) {
+                *cur = host->next;
+                journal_replace_str(&host->mac, NULL);
+                journal_replace_str(&host->hostname, NULL);
+                known_hosts_node_free(host);
+                break;
+            }
+        }
+    } else if (SDL_strcmp(op, "select") == 0) {
+        for (known_host_t *cur = *hosts; cur != NULL; cur = cur->next) {
+            cur->selected = cur == host;
+        }
+    } else if (host != NULL && num_fields == 4 && SDL_strcmp(op, "favorite") == 0) {
+        journal_set_id(&host->favs, SDL_atoi(fields[2]), SDL_strcmp(fields[3], "1") == 0);
+    } else if (host != NULL && num_fields == 4 && SDL_strcmp(op, "hidden") == 0) {
+        journal_set_id(&host->hidden, SDL_atoi(fields[2]), SDL_strcmp(fields[3], "1") == 0);
+    }
+}
+
+static bool journal_append(known_hosts_journal_t *journal, const char *op, const char *const *fields,
+                           int num_fields) {
+    if (journal == NULL || journal->fp == NULL) {
+        return false;
+    }
+    char record[JOURNAL_MAX_RECORD];
+    size_t len = SDL_strlcpy(record, op, sizeof(record));
+    for (int i = 0; i < num_fields; i++) {
+        const char *value = fields[i] != NULL ? fields[i] : "";
+        // Room for this field, and the checksum after it
+        if (len + 1 + SDL_strlen(value) + 10 >= sizeof(record)) {
+            commons_log_warn("PCManager", "Journal record %s is too long", op);
+            return false;
+        }
+        record[len++] = '\t';
+        for (const char *ch = value; *ch != '\0'; ch++) {
+            record[len++] = (char) (*ch == '\t' || *ch == '\n' || *ch == '\r' ? ' ' : *ch);
+        }
+    }
+    Uint32 checksum = SDL_crc32(0, record, len);
+    len += SDL_snprintf(record + len, sizeof(record) - len, "\t%08x\n", checksum);
+    // Written through right away, so it won't be lost if the process gets killed
+    if (fwrite(record, 1, len, journal->fp) != len || fflush(journal->fp) != 0) {
+        commons_log_warn("PCManager", "Failed to write journal record %s", op);
+        return false;
+    }
+    journal->records++;
+    journal->unsynced++;
+    if (journal->unsynced >= JOURNAL_SYNC_BATCH ||
+        SDL_TICKS_PASSED(SDL_GetTicks(), journal->last_sync + JOURNAL_SYNC_INTERVAL_MS)) {
+        known_hosts_journal_sync(journal);
+    }
+    return true;
+}
+
+static bool journal_rewrite(const char *path, const char *data, size_t size) {
+    size_t tmp_path_len = strlen(path) + 5;
+    char *tmp_path = malloc(tmp_path_len);
+    snprintf(tmp_path, tmp_path_len, "%s.tmp", path);
+    bool ok = false;
+    FILE *fp = fopen(tmp_path, "wb");
+    if (fp != NULL) {
+        ok = size == 0 || fwrite(data, 1, size, fp) == size;
+        journal_fsync(fp);
+        ok = fclose(fp) == 0 && ok;
+    }
+    if (ok) {
+        ok = path_replace(tmp_path, path) == 0;
+    }
+    if (!ok) {
+        remove(tmp_path);
+    }
+    free(tmp_path);
+    return ok;
+}
+
+static void journal_fsync(FILE *fp) {
+    fflush(fp);
+#ifdef __WIN32
+    _commit(_fileno(fp));
+#else
+    fsync(fileno(fp));
+#endif
+}
+
+static known_host_t *journal_find_host(known_host_t *hosts, const char *uuid) {
+    for (known_host_t *cur = hosts; cur != NULL; cur = cur->next) {
+        if (uuidstr_t_equals_s(&cur->uuid, uuid)) {
+            return cur;
+        }
+    }
+    return NULL;
+}
+
+static void journal_set_id(appid_list_t **list, int appid, bool present) {
+    appid_list_t *existing = appid_list_jl_find_by(*list, &appid, journal_find_id);
+    if (present && existing == NULL) {
+        appid_list_t *item = appid_list_jl_new();
+        item->id = appid;
+        *list = appid_list_jl_append(*list, item);
+    } else if (!present && existing != NULL) {
+        *list = appid_list_jl_remove(*list, existing);
+    }
+}
+
+static int journal_find_id(appid_list_t *other, const void *v) {
+    return other->id - *((const int *) v);
+}
+
+static void journal_replace_str(char **dst, const char *value) {
+    if (*dst != NULL) {
+        SDL_free(*dst);
+    }
+    *dst = value != NULL && value[0] != '\0' ? SDL_strdup(value) : NULL;
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "known_hosts.h"
+
+/**
+ * Append-only log of changes made to known hosts since hosts.ini was last written. Each change is a single line
+ * ending with a checksum, so a line torn by a crash is detected and dropped together with everything after it.
+ *
+ * Every record sets the final value of something (a host's address, whether an app is a favorite), so replaying the
+ * journal over a hosts.ini already containing some of its changes gives the same result.
+ */
+typedef struct known_hosts_journal_t known_hosts_journal_t;
+
+/**
+ * Apply changes in the journal to hosts, drop any incomplete record at its end, and open it for appending.
+ *
+ * @param path Journal file, doesn't need to exist
+ * @param hosts Hosts loaded from hosts.ini, will be updated with changes from the journal
+ * @return NULL if the journal can't be written
+ */
+known_hosts_journal_t *known_hosts_journal_open(const char *path, known_host_t **hosts);
+
+/**
+ * Flush pending records to disk and close the journal.
+ */
+void known_hosts_journal_close(known_hosts_journal_t *journal);
+
+/**
+ * Apply changes in the journal to hosts without modifying the file.
+ *
+ * @return Number of intact records applied
+ */
+size_t known_hosts_journal_replay(const char *path, known_host_t **hosts);
+
+bool known_hosts_journal_host(known_hosts_journal_t *journal, const char *uuid, const char *mac,
+                              const char *hostname, const char *address);
+
+bool known_hosts_journal_forget(known_hosts_journal_t *journal, const char *uuid);
+
+bool known_hosts_journal_select(known_hosts_journal_t *journal, const char *uuid);
+
+bool known_hosts_journal_favorite(known_hosts_journal_t *journal, const char *uuid, int appid, bool favorite);
+
+bool known_hosts_journal_hidden(known_hosts_journal_t *journal, const char *uuid, int appid, bool hidden);
+
+/**
+ * Make sure all records written so far will survive a power loss. Records are written to the file right away, so they
+ * survive the process being killed, but only synced to disk in batches.
+ */
+void known_hosts_journal_sync(known_hosts_journal_t *journal);
+
+/**
+ * Discard all records, after their changes have been written to hosts.ini.
+ */
+void known_hosts_journal_reset(known_hosts_journal_t *journal);
+
+/**
+ * @return Records written since the journal was opened or reset, including ones recovered when opened
+ */
+size_t known_hosts_journal_records(const known_hosts_journal_t *journal);
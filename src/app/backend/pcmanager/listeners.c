@@ -1,4 +1,7 @@
 #include "priv.h"
+#include "listeners.h"
+#include "app.h"
+#include "util/bus.h"
 
 #include <assert.h>
 
@@ -23,8 +26,15 @@ typedef struct pcmanager_listener_list {
 #undef LINKEDLIST_TYPE
 #undef LINKEDLIST_PREFIX
 
+struct pcmanager_notify_flush_t {
+    /* NULL if the manager has been destroyed before flush runs */
+    pcmanager_t *manager;
+};
+
 static int pcmanager_callbacks_comparator(pcmanager_listener_list *p1, const void *p2);
 
+static void notify_flush(pcmanager_notify_flush_t *flush);
+
 void pcmanager_listeners_notify(pcmanager_t *manager, const uuidstr_t *uuid, pcmanager_notify_type_t type) {
     assert(manager != NULL);
     assert(SDL_ThreadID() == manager->thread_id);
@@ -37,7 +47,9 @@ void pcmanager_listeners_notify(pcmanager_t *manager, const uuidstr_t *uuid, pcm
                 fn = l->added;
                 break;
             case PCMANAGER_NOTIFY_UPDATED:
-                fn = l->updated;
+                if (l->updated) {
+                    l->updated(uuid, PCMANAGER_CHANGE_ALL, cur->userdata);
+                }
                 break;
             case PCMANAGER_NOTIFY_REMOVED:
                 fn = l->removed;
@@ -52,6 +64,28 @@ void pcmanager_listeners_notify(pcmanager_t *manager, const uuidstr_t *uuid, pcm
     }
 }
 
+void pcmanager_listeners_notify_updated(pcmanager_t *manager, pclist_t *node, pcmanager_change_t changes) {
+    assert(SDL_ThreadID() == manager->thread_id);
+    if (changes == PCMANAGER_CHANGE_NONE) {
+        return;
+    }
+    node->pending_changes |= changes;
+    if (manager->notify_flush != NULL) {
+        return;
+    }
+    pcmanager_notify_flush_t *flush = malloc(sizeof(pcmanager_notify_flush_t));
+    flush->manager = manager;
+    manager->notify_flush = flush;
+    app_bus_post(manager->app, (bus_actionfunc) notify_flush, flush);
+}
+
+void pcmanager_listeners_cancel_updates(pcmanager_t *manager) {
+    if (manager->notify_flush != NULL) {
+        manager->notify_flush->manager = NULL;
+        manager->notify_flush = NULL;
+    }
+}
+
 void pcmanager_register_listener(pcmanager_t *manager, const pcmanager_listener_t *listener, void *userdata) {
     assert(manager != NULL);
     assert(listener != NULL);
@@ -76,3 +110,27 @@ void pcmanager_unregister_listener(pcmanager_t *manager, const pcmanager_listene
 static int pcmanager_callbacks_comparator(pcmanager_listener_list *p1, const void *p2) {
     return p1->listener != p2;
 }
+
+static void notify_flush(pcmanager_notify_flush_t *flush) {
+    pcmanager_t *manager = flush->manager;
+    free(flush);
+    if (manager == NULL) {
+        return;
+    }
+    manager->notify_flush = NULL;
+    for (pclist_t *node = manager->servers; node != NULL; node = node->next) {
+        pcmanager_change_t changes = node->pending_changes;
+        if (changes == PCMANAGER_CHANGE_NONE) {
+            continue;
+        }
+        node->pending_changes = PCMANAGER_CHANGE_NONE;
+        uuidstr_t uuid = node->id;
+        for (pcmanager_listener_list *cur = manager->listeners; cur != NULL;) {
+            pcmanager_listener_list *next = cur->next;
+            if (cur->listener->updated) {
+                cur->listener->updated(&uuid, changes, cur->userdata);
+            }
+            cur = next;
+        }
+    }
+}
@@ -2,4 +2,15 @@
 
 #include "../pcmanager.h"
 
-void pcmanager_listeners_notify(pcmanager_t *manager, const uuidstr_t *uuid, pcmanager_notify_type_t type);
\ No newline at end of file
+void pcmanager_listeners_notify(pcmanager_t *manager, const uuidstr_t *uuid, pcmanager_notify_type_t type);
+
+/**
+ * Accumulates changes of the node, and notifies listeners of all pending changes once in next main loop iteration.
+ * Must be called on main thread.
+ */
+void pcmanager_listeners_notify_updated(pcmanager_t *manager, pclist_t *node, pcmanager_change_t changes);
+
+/**
+ * Drops scheduled update notifications, called before the manager is destroyed.
+ */
+void pcmanager_listeners_cancel_updates(pcmanager_t *manager);
\ No newline at end of file
@@ -45,6 +45,14 @@ static int pclist_ll_compare_uuid(pclist_t *other, const void *v);
 
 static int appid_list_find_id(appid_list_t *other, const void *v);
 
+static pcmanager_change_t state_diff(const SERVER_STATE *a, const SERVER_STATE *b);
+
+static bool str_differs(const char *a, const char *b);
+
+static bool modes_differ(const DISPLAY_MODE *a, const DISPLAY_MODE *b);
+
+static bool saved_fields_differ(const SERVER_DATA *a, const SERVER_DATA *b);
+
 pclist_t *pclist_insert_known(pcmanager_t *manager, const uuidstr_t *id, SERVER_DATA *server) {
     pclist_t *node = pclist_ll_new();
     node->id = *id;
@@ -129,12 +137,15 @@ bool pclist_node_set_app_hidden(pclist_t *node, int appid, bool hidden) {
     return true;
 }
 
-void pclist_node_apply(pclist_t *node, const SERVER_STATE *state, SERVER_DATA *server) {
+pcmanager_change_t pclist_node_apply(pclist_t *node, const SERVER_STATE *state, SERVER_DATA *server) {
+    pcmanager_change_t changes = PCMANAGER_CHANGE_NONE;
     if (state != NULL && state->code != SERVER_STATE_NONE) {
+        changes |= state_diff(&node->state, state);
         node->state = *state;
     }
     if (server != NULL) {
         if (node->server != server) {
+            changes |= pclist_server_diff(node->server, server);
             if (node->server) {
                 serverdata_free(node->server);
             }
@@ -143,6 +154,37 @@ void pclist_node_apply(pclist_t *node, const SERVER_STATE *state, SERVER_DATA *s
         }
         node->known |= server->paired;
     }
+    return changes;
+}
+
+pcmanager_change_t pclist_server_diff(const SERVER_DATA *a, const SERVER_DATA *b) {
+    if (a == b) {
+        return PCMANAGER_CHANGE_NONE;
+    }
+    if (a == NULL || b == NULL) {
+        return PCMANAGER_CHANGE_ALL & ~PCMANAGER_CHANGE_STATE;
+    }
+    pcmanager_change_t changes = PCMANAGER_CHANGE_NONE;
+    if (a->paired != b->paired) {
+        changes |= PCMANAGER_CHANGE_PAIRED;
+    }
+    if (a->currentGame != b->currentGame) {
+        changes |= PCMANAGER_CHANGE_CURRENT_APP;
+    }
+    if (a->extPort != b->extPort || a->httpsPort != b->httpsPort ||
+        str_differs(a->serverInfo.address, b->serverInfo.address)) {
+        changes |= PCMANAGER_CHANGE_ADDRESS;
+    }
+    if (str_differs(a->uuid, b->uuid) || str_differs(a->hostname, b->hostname) || str_differs(a->mac, b->mac) ||
+        str_differs(a->gpuType, b->gpuType) || str_differs(a->gsVersion, b->gsVersion) ||
+        str_differs(a->serverInfo.serverInfoAppVersion, b->serverInfo.serverInfoAppVersion) ||
+        str_differs(a->serverInfo.serverInfoGfeVersion, b->serverInfo.serverInfoGfeVersion) ||
+        a->serverInfo.serverCodecModeSupport != b->serverInfo.serverCodecModeSupport ||
+        a->supports4K != b->supports4K || a->supportsHdr != b->supportsHdr || a->unsupported != b->unsupported ||
+        a->isGfe != b->isGfe || a->serverMajorVersion != b->serverMajorVersion || modes_differ(a->modes, b->modes)) {
+        changes |= PCMANAGER_CHANGE_INFO;
+    }
+    return changes;
 }
 
 void pclist_ll_nodefree(pclist_t *node) {
@@ -211,6 +253,50 @@ static int appid_list_find_id(appid_list_t *other, const void *v) {
     return other->id - *((const int *) v);
 }
 
+static pcmanager_change_t state_diff(const SERVER_STATE *a, const SERVER_STATE *b) {
+    if (a->code != b->code) {
+        return PCMANAGER_CHANGE_STATE;
+    }
+    if (a->code == SERVER_STATE_ERROR &&
+        (a->error.errcode != b->error.errcode || str_differs(a->error.errmsg, b->error.errmsg))) {
+        return PCMANAGER_CHANGE_STATE;
+    }
+    return PCMANAGER_CHANGE_NONE;
+}
+
+static bool str_differs(const char *a, const char *b) {
+    if (a == b) {
+        return false;
+    }
+    if (a == NULL || b == NULL) {
+        return true;
+    }
+    return SDL_strcmp(a, b) != 0;
+}
+
+static bool modes_differ(const DISPLAY_MODE *a, const DISPLAY_MODE *b) {
+    for (; a != NULL && b != NULL; a = a->next, b = b->next) {
+        if (a->width != b->width || a->height != b->height || a->refresh != b->refresh) {
+            return true;
+        }
+    }
+    return a != b;
+}
+
+/**
+ * @return Whether fields saved in hosts.ini are different
+ */
+static bool saved_fields_differ(const SERVER_DATA *a, const SERVER_DATA *b) {
+    if (a == b) {
+        return false;
+    }
+    if (a == NULL || b == NULL) {
+        return true;
+    }
+    return a->extPort != b->extPort || str_differs(a->uuid, b->uuid) || str_differs(a->mac, b->mac) ||
+           str_differs(a->hostname, b->hostname) || str_differs(a->serverInfo.address, b->serverInfo.address);
+}
+
 static void upsert_perform(pclist_update_context_t *context) {
     pcmanager_t *manager = context->manager;
     pcmanager_lock(manager);
@@ -220,9 +306,24 @@ static void upsert_perform(pclist_update_context_t *context) {
         node = pclist_ll_new();
         manager->servers = pclist_ll_append(manager->servers, node);
     }
-    pclist_node_apply(node, &context->state, context->server);
+    bool was_known = node->known;
+    bool saved_changed = context->server != NULL && saved_fields_differ(node->server, context->server);
+    pcmanager_change_t changes = pclist_node_apply(node, &context->state, context->server);
+    if (node->known && (!was_known || saved_changed)) {
+        // Newly paired, or address changed
+        pcmanager_journal_host(manager, node);
+    }
+    if (node->known && (changes & (PCMANAGER_CHANGE_PAIRED | PCMANAGER_CHANGE_ADDRESS | PCMANAGER_CHANGE_INFO))) {
+        // Keep capabilities on disk up to date, they're needed to launch before the host responds after a cold start
+        pcmanager_host_caps_changed(manager);
+    }
     pcmanager_unlock(manager);
-    pcmanager_listeners_notify(manager, &context->uuid, updated ? PCMANAGER_NOTIFY_UPDATED : PCMANAGER_NOTIFY_ADDED);
+    if (updated) {
+        // Polling reports the same info most of the time, listeners only need to know when something has changed
+        pcmanager_listeners_notify_updated(manager, node, changes);
+    } else {
+        pcmanager_listeners_notify(manager, &context->uuid, PCMANAGER_NOTIFY_ADDED);
+    }
 }
 
 static void remove_perform(pclist_update_context_t *context) {
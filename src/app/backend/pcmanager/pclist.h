@@ -16,7 +16,16 @@ pclist_t *pclist_insert_known(pcmanager_t *manager, const uuidstr_t *uuid, SERVE
  */
 void pclist_upsert(pcmanager_t *manager, const uuidstr_t *uuid, const SERVER_STATE *state, SERVER_DATA *server);
 
-void pclist_node_apply(pclist_t *node, const SERVER_STATE *state, SERVER_DATA *server);
+/**
+ * @return Fields changed by this update
+ */
+pcmanager_change_t pclist_node_apply(pclist_t *node, const SERVER_STATE *state, SERVER_DATA *server);
+
+/**
+ * Compare server info, without taking state into account.
+ * @return Changed fields between two server info
+ */
+pcmanager_change_t pclist_server_diff(const SERVER_DATA *a, const SERVER_DATA *b);
 
 bool pclist_node_set_app_favorite(pclist_t *node, int appid, bool favorite);
 
@@ -3,8 +3,11 @@
 #include "priv.h"
 
 #include "pclist.h"
+#include "listeners.h"
 #include "app.h"
 #include "backend/pcmanager/worker/worker.h"
+#include "host_probe.h"
+#include "known_hosts_journal.h"
 #include "logging.h"
 
 pcmanager_t *pcmanager_new(app_t *app, executor_t *executor) {
@@ -13,16 +16,22 @@ pcmanager_t *pcmanager_new(app_t *app, executor_t *executor) {
     manager->executor = executor;
     manager->thread_id = SDL_ThreadID();
     manager->lock = SDL_CreateMutex();
+    manager->host_caps_cond = SDL_CreateCond();
     discovery_init(&manager->discovery, (discovery_callback) pcmanager_lan_host_discovered, manager);
-    pcmanager_load_known_hosts(manager);
+    pcmanager_poller_init(manager);
     return manager;
 }
 
 void pcmanager_destroy(pcmanager_t *manager) {
     pcmanager_auto_discovery_stop(manager);
+    pcmanager_poller_deinit(manager);
     pcmanager_save_known_hosts(manager);
+    known_hosts_journal_close(manager->journal);
+    pcmanager_save_host_caps(manager);
+    pcmanager_listeners_cancel_updates(manager);
     pclist_free(manager);
     discovery_deinit(&manager->discovery);
+    SDL_DestroyCond(manager->host_caps_cond);
     SDL_DestroyMutex(manager->lock);
     SDL_free(manager);
 }
@@ -66,7 +75,9 @@ void pcmanager_favorite_app(pcmanager_t *manager, const uuidstr_t *uuid, int app
     if (!node) {
         goto unlock;
     }
-    pclist_node_set_app_favorite(node, appid, favorite);
+    if (pclist_node_set_app_favorite(node, appid, favorite)) {
+        pcmanager_journal_favorite(manager, uuid, appid, favorite);
+    }
     unlock:
     pcmanager_unlock(manager);
 }
@@ -77,7 +88,9 @@ void pcmanager_set_app_hidden(pcmanager_t *manager, const uuidstr_t *uuid, int a
     if (!node) {
         goto unlock;
     }
-    pclist_node_set_app_hidden(node, appid, hidden);
+    if (pclist_node_set_app_hidden(node, appid, hidden)) {
+        pcmanager_journal_hidden(manager, uuid, appid, hidden);
+    }
     unlock:
     pcmanager_unlock(manager);
 }
@@ -92,6 +105,7 @@ bool pcmanager_select(pcmanager_t *manager, const uuidstr_t *uuid) {
     for (pclist_t *cur = pcmanager->servers; cur; cur = cur->next) {
         cur->selected = node == cur;
     }
+    pcmanager_journal_select(manager, uuid);
     pcmanager_unlock(manager);
     return true;
 }
@@ -102,6 +116,9 @@ bool pcmanager_forget(pcmanager_t *manager, const uuidstr_t *uuid) {
         return false;
     }
     pclist_remove(manager, uuid);
+    pcmanager_lock(manager);
+    pcmanager_journal_forget(manager, uuid);
+    pcmanager_unlock(manager);
     return true;
 }
 
@@ -134,9 +151,45 @@ bool pcmanager_send_wol(pcmanager_t *manager, const uuidstr_t *uuid, pcmanager_c
                         void *userdata) {
     worker_context_t *ctx = worker_context_new(manager, uuid, callback, userdata);
     pcmanager_worker_queue(manager, worker_wol, ctx);
+    pcmanager_polling_host_waking(manager, uuid);
     return true;
 }
 
+bool pcmanager_probe_register(pcmanager_t *manager, host_probe_t *probe) {
+    bool registered = false;
+    pcmanager_lock(manager);
+    for (int i = 0; i < PCMANAGER_MAX_PROBES; i++) {
+        if (manager->probes[i] == NULL) {
+            manager->probes[i] = probe;
+            registered = true;
+            break;
+        }
+    }
+    pcmanager_unlock(manager);
+    return registered;
+}
+
+void pcmanager_probe_unregister(pcmanager_t *manager, host_probe_t *probe) {
+    pcmanager_lock(manager);
+    for (int i = 0; i < PCMANAGER_MAX_PROBES; i++) {
+        if (manager->probes[i] == probe) {
+            manager->probes[i] = NULL;
+        }
+    }
+    pcmanager_unlock(manager);
+}
+
+void pcmanager_probe_trigger(pcmanager_t *manager, const char *address) {
+    pcmanager_lock(manager);
+    for (int i = 0; i < PCMANAGER_MAX_PROBES; i++) {
+        host_probe_t *probe = manager->probes[i];
+        if (probe != NULL && SDL_strcmp(host_probe_address(probe), address) == 0) {
+            host_probe_trigger(probe);
+        }
+    }
+    pcmanager_unlock(manager);
+}
+
 const pclist_t *pcmanager_servers(pcmanager_t *manager) {
     return manager->servers;
 }
@@ -28,6 +28,7 @@ PSERVER_DATA serverdata_clone(const SERVER_DATA *src) {
     server->supports4K = src->supports4K;
     server->supportsHdr = src->supportsHdr;
     server->unsupported = src->unsupported;
+    server->isGfe = src->isGfe;
     server->currentGame = src->currentGame;
     server->serverMajorVersion = src->serverMajorVersion;
     server->gsVersion = strdup_nullable(src->gsVersion);
@@ -36,6 +37,7 @@ PSERVER_DATA serverdata_clone(const SERVER_DATA *src) {
     server->serverInfo.rtspSessionUrl = strdup_nullable(src->serverInfo.rtspSessionUrl);
     server->serverInfo.serverInfoAppVersion = strdup_nullable(src->serverInfo.serverInfoAppVersion);
     server->serverInfo.serverInfoGfeVersion = strdup_nullable(src->serverInfo.serverInfoGfeVersion);
+    server->serverInfo.serverCodecModeSupport = src->serverInfo.serverCodecModeSupport;
     return server;
 }
 
@@ -0,0 +1,260 @@
+#include "poll_schedule.h"
+
+#include <assert.h>
+#include <stdlib.h>
+
+const poll_schedule_options_t poll_schedule_default_options = {
+        .booting_interval_ms = 2000,
+        .streaming_interval_ms = 5000,
+        .idle_interval_ms = 15000,
+        .offline_interval_ms = 30000,
+        .offline_max_interval_ms = 120000,
+        .boot_window_ms = 90000,
+        .jitter_percent = 20,
+        .stagger_ms = 3000,
+        .max_in_flight = 2,
+};
+
+static poll_host_t *host_find(const poll_schedule_t *schedule, const uuidstr_t *uuid);
+
+static Uint32 host_interval(const poll_schedule_t *schedule, const poll_host_t *host, Uint64 now);
+
+static Uint32 next_random(poll_schedule_t *schedule);
+
+static Uint64 jittered(poll_schedule_t *schedule, Uint64 now, Uint32 interval);
+
+static Uint64 staggered(poll_schedule_t *schedule, Uint64 now);
+
+void poll_schedule_init(poll_schedule_t *schedule, const poll_schedule_options_t *options, Uint32 seed) {
+    SDL_memset(schedule, 0, sizeof(poll_schedule_t));
+    schedule->options = options != NULL ? *options : poll_schedule_default_options;
+    assert(schedule->options.max_in_flight > 0);
+    // Xorshift gets stuck at 0
+    schedule->seed = seed != 0 ? seed : 0x9E3779B9;
+}
+
+void poll_schedule_deinit(poll_schedule_t *schedule) {
+    free(schedule->hosts);
+    schedule->hosts = NULL;
+    schedule->count = 0;
+    schedule->capacity = 0;
+}
+
+void poll_schedule_set_host(poll_schedule_t *schedule, const uuidstr_t *uuid, SERVER_STATE_ENUM state,
+                            bool app_running, Uint64 now) {
+    poll_host_t *host = host_find(schedule, uuid);
+    if (host == NULL) {
+        if (schedule->count == schedule->capacity) {
+            size_t capacity = schedule->capacity ? schedule->capacity * 2 : 8;
+            poll_host_t *hosts = realloc(schedule->hosts, capacity * sizeof(poll_host_t));
+            if (hosts == NULL) {
+                return;
+            }
+            schedule->hosts = hosts;
+            schedule->capacity = capacity;
+        }
+        host = &schedule->hosts[schedule->count++];
+        SDL_memset(host, 0, sizeof(poll_host_t));
+        host->uuid = *uuid;
+        host->state = state;
+        host->app_running = app_running;
+        host->due = staggered(schedule, now);
+        return;
+    }
+    poll_host_class_t old_class = poll_schedule_host_class(schedule, host, now);
+    if (state != SERVER_STATE_NONE && state != SERVER_STATE_QUERYING) {
+        host->state = state;
+    }
+    host->app_running = app_running;
+    if (host->state & SERVER_STATE_ONLINE) {
+        // Host has finished booting
+        host->wake_until = 0;
+        host->offline_interval = 0;
+    }
+    if (host->in_flight || poll_schedule_host_class(schedule, host, now) == old_class) {
+        return;
+    }
+    // Only bring the next poll closer, so frequent state changes can't postpone it forever
+    Uint64 due = jittered(schedule, now, host_interval(schedule, host, now));
+    if (due < host->due) {
+        host->due = due;
+    }
+}
+
+void poll_schedule_remove_host(poll_schedule_t *schedule, const uuidstr_t *uuid) {
+    poll_host_t *host = host_find(schedule, uuid);
+    if (host == NULL) {
+        return;
+    }
+    if (host->in_flight) {
+        schedule->in_flight--;
+    }
+    size_t index = host - schedule->hosts;
+    SDL_memmove(host, host + 1, (schedule->count - index - 1) * sizeof(poll_host_t));
+    schedule->count--;
+}
+
+void poll_schedule_host_waking(poll_schedule_t *schedule, const uuidstr_t *uuid, Uint64 now) {
+    poll_host_t *host = host_find(schedule, uuid);
+    if (host == NULL) {
+        return;
+    }
+    host->wake_until = now + schedule->options.boot_window_ms;
+    host->offline_interval = 0;
+    if (!host->in_flight && host->due > now + schedule->options.booting_interval_ms) {
+        host->due = now + schedule->options.booting_interval_ms;
+    }
+}
+
+void poll_schedule_kick(poll_schedule_t *schedule, Uint64 now) {
+    for (size_t i = 0; i < schedule->count; i++) {
+        poll_host_t *host = &schedule->hosts[i];
+        if (host->in_flight) {
+            continue;
+        }
+        Uint64 due = staggered(schedule, now);
+        if (due < host->due) {
+            host->due = due;
+        }
+    }
+}
+
+void poll_schedule_set_suspended(poll_schedule_t *schedule, bool suspended, Uint64 now) {
+    if (schedule->suspended == suspended) {
+        return;
+    }
+    schedule->suspended = suspended;
+    if (suspended) {
+        return;
+    }
+    // Everything is stale after a long suspension, refresh but don't hit all hosts at once
+    for (size_t i = 0; i < schedule->count; i++) {
+        poll_host_t *host = &schedule->hosts[i];
+        if (host->in_flight) {
+            continue;
+        }
+        host->due = staggered(schedule, now);
+    }
+}
+
+bool poll_schedule_next(poll_schedule_t *schedule, Uint64 now, uuidstr_t *uuid) {
+    if (schedule->suspended || schedule->in_flight >= schedule->options.max_in_flight) {
+        return false;
+    }
+    poll_host_t *next = NULL;
+    for (size_t i = 0; i < schedule->count; i++) {
+        poll_host_t *host = &schedule->hosts[i];
+        if (host->in_flight || host->due > now) {
+            continue;
+        }
+        if (next == NULL || host->due < next->due) {
+            next = host;
+        }
+    }
+    if (next == NULL) {
+        return false;
+    }
+    next->in_flight = true;
+    schedule->in_flight++;
+    *uuid = next->uuid;
+    return true;
+}
+
+void poll_schedule_done(poll_schedule_t *schedule, const uuidstr_t *uuid, bool reachable, Uint64 now) {
+    poll_host_t *host = host_find(schedule, uuid);
+    if (host == NULL || !host->in_flight) {
+        return;
+    }
+    host->in_flight = false;
+    schedule->in_flight--;
+    if (reachable) {
+        host->offline_interval = 0;
+    } else if (poll_schedule_host_class(schedule, host, now) == POLL_HOST_OFFLINE) {
+        Uint32 max = schedule->options.offline_max_interval_ms;
+        if (host->offline_interval == 0) {
+            host->offline_interval = schedule->options.offline_interval_ms;
+        } else {
+            host->offline_interval = host->offline_interval >= max / 2 ? max : host->offline_interval * 2;
+        }
+    }
+    host->due = jittered(schedule, now, host_interval(schedule, host, now));
+}
+
+Sint64 poll_schedule_next_delay(const poll_schedule_t *schedule, Uint64 now) {
+    if (schedule->suspended || schedule->in_flight >= schedule->options.max_in_flight) {
+        return -1;
+    }
+    Sint64 delay = -1;
+    for (size_t i = 0; i < schedule->count; i++) {
+        const poll_host_t *host = &schedule->hosts[i];
+        if (host->in_flight) {
+            continue;
+        }
+        Sint64 host_delay = host->due > now ? (Sint64) (host->due - now) : 0;
+        if (delay < 0 || host_delay < delay) {
+            delay = host_delay;
+        }
+    }
+    return delay;
+}
+
+poll_host_class_t poll_schedule_host_class(const poll_schedule_t *schedule, const poll_host_t *host, Uint64 now) {
+    (void) schedule;
+    if (host->state & SERVER_STATE_ONLINE) {
+        return host->app_running ? POLL_HOST_STREAMING : POLL_HOST_IDLE;
+    }
+    if (now < host->wake_until) {
+        return POLL_HOST_BOOTING;
+    }
+    if (host->state == SERVER_STATE_OFFLINE || host->state == SERVER_STATE_ERROR) {
+        return POLL_HOST_OFFLINE;
+    }
+    return POLL_HOST_IDLE;
+}
+
+static poll_host_t *host_find(const poll_schedule_t *schedule, const uuidstr_t *uuid) {
+    for (size_t i = 0; i < schedule->count; i++) {
+        if (uuidstr_t_equals_t(&schedule->hosts[i].uuid, uuid)) {
+            return &schedule->hosts[i];
+        }
+    }
+    return NULL;
+}
+
+static Uint32 host_interval(const poll_schedule_t *schedule, const poll_host_t *host, Uint64 now) {
+    const poll_schedule_options_t *options = &schedule->options;
+    switch (poll_schedule_host_class(schedule, host, now)) {
+        case POLL_HOST_BOOTING:
+            return options->booting_interval_ms;
+        case POLL_HOST_STREAMING:
+            return options->streaming_interval_ms;
+        case POLL_HOST_OFFLINE:
+            return host->offline_interval ? host->offline_interval : options->offline_interval_ms;
+        default:
+            return options->idle_interval_ms;
+    }
+}
+
+static Uint32 next_random(poll_schedule_t *schedule) {
+    Uint32 x = schedule->seed;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    schedule->seed = x;
+    return x;
+}
+
+static Uint64 jittered(poll_schedule_t *schedule, Uint64 now, Uint32 interval) {
+    Uint32 jitter = (Uint32) ((Uint64) interval * schedule->options.jitter_percent / 100);
+    if (jitter == 0) {
+        return now + interval;
+    }
+    return now + interval - jitter + next_random(schedule) % (2 * jitter + 1);
+}
+
+static Uint64 staggered(poll_schedule_t *schedule, Uint64 now) {
+    if (schedule->options.stagger_ms == 0) {
+        return now;
+    }
+    return now + next_random(schedule) % schedule->options.stagger_ms;
+}
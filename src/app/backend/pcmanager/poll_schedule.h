@@ -0,0 +1,112 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <SDL_stdinc.h>
+
+#include "backend/types.h"
+#include "uuidstr.h"
+
+/**
+ * Decides when each host should be polled for server info. Doesn't read any clock by itself, all times are passed in
+ * as milliseconds, so it behaves the same under a fake clock.
+ */
+typedef struct poll_schedule_options_t {
+    /* Host has been woken up recently, but isn't online yet */
+    Uint32 booting_interval_ms;
+    /* Host is running a game */
+    Uint32 streaming_interval_ms;
+    /* Host is online and idle */
+    Uint32 idle_interval_ms;
+    /* Host is offline, doubled after each failed poll until offline_max_interval_ms */
+    Uint32 offline_interval_ms;
+    Uint32 offline_max_interval_ms;
+    /* How long a host is considered booting after being woken up */
+    Uint32 boot_window_ms;
+    /* Intervals are randomly shortened or extended by this percentage */
+    Uint32 jitter_percent;
+    /* Spread hosts over this period when polling starts or resumes, instead of polling all of them at once */
+    Uint32 stagger_ms;
+    /* Maximum number of polls running at the same time */
+    int max_in_flight;
+} poll_schedule_options_t;
+
+typedef enum poll_host_class_t {
+    POLL_HOST_IDLE,
+    POLL_HOST_BOOTING,
+    POLL_HOST_STREAMING,
+    POLL_HOST_OFFLINE,
+} poll_host_class_t;
+
+typedef struct poll_host_t {
+    uuidstr_t uuid;
+    SERVER_STATE_ENUM state;
+    bool app_running;
+    bool in_flight;
+    Uint64 due;
+    Uint64 wake_until;
+    Uint32 offline_interval;
+} poll_host_t;
+
+typedef struct poll_schedule_t {
+    poll_schedule_options_t options;
+    poll_host_t *hosts;
+    size_t count, capacity;
+    int in_flight;
+    bool suspended;
+    Uint32 seed;
+} poll_schedule_t;
+
+extern const poll_schedule_options_t poll_schedule_default_options;
+
+/**
+ * @param options Intervals to use, or NULL for defaults
+ * @param seed Seed for interval jitter
+ */
+void poll_schedule_init(poll_schedule_t *schedule, const poll_schedule_options_t *options, Uint32 seed);
+
+void poll_schedule_deinit(poll_schedule_t *schedule);
+
+/**
+ * Add the host, or update its interval after its state changed. New hosts are staggered over stagger_ms.
+ */
+void poll_schedule_set_host(poll_schedule_t *schedule, const uuidstr_t *uuid, SERVER_STATE_ENUM state,
+                            bool app_running, Uint64 now);
+
+void poll_schedule_remove_host(poll_schedule_t *schedule, const uuidstr_t *uuid);
+
+/**
+ * Poll the host frequently for a while, as it has been sent a Wake-on-LAN packet.
+ */
+void poll_schedule_host_waking(poll_schedule_t *schedule, const uuidstr_t *uuid, Uint64 now);
+
+/**
+ * Make all hosts due within stagger_ms.
+ */
+void poll_schedule_kick(poll_schedule_t *schedule, Uint64 now);
+
+/**
+ * While suspended, no host will be polled. Hosts are staggered again after resuming.
+ */
+void poll_schedule_set_suspended(poll_schedule_t *schedule, bool suspended, Uint64 now);
+
+/**
+ * Take the most overdue host, and mark it as being polled.
+ *
+ * @return false if no host is due, or too many polls are running
+ */
+bool poll_schedule_next(poll_schedule_t *schedule, Uint64 now, uuidstr_t *uuid);
+
+/**
+ * Poll started by poll_schedule_next has finished, schedule the next one for this host.
+ *
+ * @param reachable Whether the host has responded
+ */
+void poll_schedule_done(poll_schedule_t *schedule, const uuidstr_t *uuid, bool reachable, Uint64 now);
+
+/**
+ * @return Milliseconds until poll_schedule_next could return a host, or -1 if it won't until something changes
+ */
+Sint64 poll_schedule_next_delay(const poll_schedule_t *schedule, Uint64 now);
+
+poll_host_class_t poll_schedule_host_class(const poll_schedule_t *schedule, const poll_host_t *host, Uint64 now);
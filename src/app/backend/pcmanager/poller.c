@@ -0,0 +1,201 @@
+#include "priv.h"
+#include "poll_schedule.h"
+#include "worker/worker.h"
+
+#include <assert.h>
+#include <stdlib.h>
+
+#include "app.h"
+#include "errors.h"
+#include "util/bus.h"
+#include "logging.h"
+
+/* Don't wake up more often than this, even if hosts are due at slightly different times */
+#define POLL_MIN_DELAY_MS 50
+
+struct pcmanager_poll_tick_t {
+    /* NULL if the tick has been replaced or the poller stopped after the timer fired */
+    pcmanager_t *manager;
+    /* Used by the timer thread, which must not touch the manager */
+    app_t *app;
+    SDL_TimerID timer;
+};
+
+static void poller_host_added(const uuidstr_t *uuid, void *userdata);
+
+static void poller_host_updated(const uuidstr_t *uuid, pcmanager_change_t changes, void *userdata);
+
+static void poller_host_removed(const uuidstr_t *uuid, void *userdata);
+
+static void poller_sync_host(pcmanager_t *manager, const pclist_t *node);
+
+static void poller_tick(pcmanager_poll_tick_t *tick);
+
+static void poller_poll_done(int result, const char *error, const uuidstr_t *uuid, void *userdata);
+
+static void poller_arm(pcmanager_t *manager);
+
+static void poller_disarm(pcmanager_t *manager);
+
+static Uint32 poller_timer_cb(Uint32 interval, void *param);
+
+static Uint64 poller_now();
+
+static const pcmanager_listener_t poller_listener = {
+        .added = poller_host_added,
+        .updated = poller_host_updated,
+        .removed = poller_host_removed,
+};
+
+void pcmanager_poller_init(pcmanager_t *manager) {
+    poll_schedule_init(&manager->poll_schedule, NULL, (Uint32) SDL_GetPerformanceCounter());
+    pcmanager_register_listener(manager, &poller_listener, manager);
+}
+
+void pcmanager_poller_deinit(pcmanager_t *manager) {
+    pcmanager_polling_stop(manager);
+    pcmanager_unregister_listener(manager, &poller_listener);
+    poll_schedule_deinit(&manager->poll_schedule);
+}
+
+void pcmanager_polling_start(pcmanager_t *manager) {
+    assert(SDL_ThreadID() == manager->thread_id);
+    // Hosts loaded from hosts.ini don't go through listeners
+    for (const pclist_t *cur = pcmanager_servers(manager); cur != NULL; cur = cur->next) {
+        poller_sync_host(manager, cur);
+    }
+    poll_schedule_kick(&manager->poll_schedule, poller_now());
+    manager->polling = true;
+    poller_arm(manager);
+}
+
+void pcmanager_polling_stop(pcmanager_t *manager) {
+    assert(SDL_ThreadID() == manager->thread_id);
+    manager->polling = false;
+    poller_disarm(manager);
+}
+
+void pcmanager_polling_suspend(pcmanager_t *manager, bool suspend) {
+    assert(SDL_ThreadID() == manager->thread_id);
+    commons_log_debug("PcManager", "Host polling %s", suspend ? "suspended" : "resumed");
+    poll_schedule_set_suspended(&manager->poll_schedule, suspend, poller_now());
+    poller_arm(manager);
+}
+
+void pcmanager_polling_host_waking(pcmanager_t *manager, const uuidstr_t *uuid) {
+    assert(SDL_ThreadID() == manager->thread_id);
+    poll_schedule_host_waking(&manager->poll_schedule, uuid, poller_now());
+    poller_arm(manager);
+}
+
+static void poller_host_added(const uuidstr_t *uuid, void *userdata) {
+    pcmanager_t *manager = userdata;
+    const pclist_t *node = pcmanager_node(manager, uuid);
+    if (node == NULL) {
+        return;
+    }
+    poller_sync_host(manager, node);
+    poller_arm(manager);
+}
+
+static void poller_host_updated(const uuidstr_t *uuid, pcmanager_change_t changes, void *userdata) {
+    if (!(changes & (PCMANAGER_CHANGE_STATE | PCMANAGER_CHANGE_CURRENT_APP))) {
+        return;
+    }
+    poller_host_added(uuid, userdata);
+}
+
+static void poller_host_removed(const uuidstr_t *uuid, void *userdata) {
+    pcmanager_t *manager = userdata;
+    poll_schedule_remove_host(&manager->poll_schedule, uuid);
+    poller_arm(manager);
+}
+
+static void poller_sync_host(pcmanager_t *manager, const pclist_t *node) {
+    bool app_running = node->server != NULL && node->server->currentGame != 0;
+    poll_schedule_set_host(&manager->poll_schedule, &node->id, node->state.code, app_running, poller_now());
+}
+
+static void poller_tick(pcmanager_poll_tick_t *tick) {
+    pcmanager_t *manager = tick->manager;
+    free(tick);
+    if (manager == NULL) {
+        return;
+    }
+    // Not cancelled, so this is still the armed tick
+    manager->poll_tick = NULL;
+    if (!manager->polling) {
+        return;
+    }
+    uuidstr_t uuid;
+    while (poll_schedule_next(&manager->poll_schedule, poller_now(), &uuid)) {
+        worker_context_t *ctx = worker_context_new(manager, &uuid, poller_poll_done, manager);
+        pcmanager_worker_queue(manager, worker_host_update, ctx);
+    }
+    poller_arm(manager);
+}
+
+static void poller_poll_done(int result, const char *error, const uuidstr_t *uuid, void *userdata) {
+    (void) error;
+    pcmanager_t *manager = userdata;
+    const pclist_t *node = pcmanager_node(manager, uuid);
+    if (node == NULL) {
+        poll_schedule_remove_host(&manager->poll_schedule, uuid);
+    } else {
+        // Node has been updated already, but the change notification may not have been delivered yet
+        poller_sync_host(manager, node);
+        poll_schedule_done(&manager->poll_schedule, uuid, result == GS_OK, poller_now());
+    }
+    poller_arm(manager);
+}
+
+/**
+ * Schedule a tick for the next due host, replacing the current one.
+ */
+static void poller_arm(pcmanager_t *manager) {
+    poller_disarm(manager);
+    if (!manager->polling) {
+        return;
+    }
+    Sint64 delay = poll_schedule_next_delay(&manager->poll_schedule, poller_now());
+    if (delay < 0) {
+        return;
+    }
+    pcmanager_poll_tick_t *tick = malloc(sizeof(pcmanager_poll_tick_t));
+    tick->manager = manager;
+    tick->app = manager->app;
+    tick->timer = SDL_AddTimer((Uint32) SDL_max(delay, POLL_MIN_DELAY_MS), poller_timer_cb, tick);
+    if (tick->timer == 0) {
+        free(tick);
+        return;
+    }
+    manager->poll_tick = tick;
+}
+
+/**
+ * Cancel the armed tick. If the timer has already fired, the tick is on the bus, and frees itself when it runs.
+ */
+static void poller_disarm(pcmanager_t *manager) {
+    pcmanager_poll_tick_t *tick = manager->poll_tick;
+    if (tick == NULL) {
+        return;
+    }
+    manager->poll_tick = NULL;
+    if (SDL_RemoveTimer(tick->timer)) {
+        free(tick);
+    } else {
+        tick->manager = NULL;
+    }
+}
+
+static Uint32 poller_timer_cb(Uint32 interval, void *param) {
+    (void) interval;
+    pcmanager_poll_tick_t *tick = param;
+    app_bus_post(tick->app, (bus_actionfunc) poller_tick, tick);
+    return 0;
+}
+
+static Uint64 poller_now() {
+    Uint64 counter = SDL_GetPerformanceCounter(), freq = SDL_GetPerformanceFrequency();
+    return counter / freq * 1000 + counter % freq * 1000 / freq;
+}
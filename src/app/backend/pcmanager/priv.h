@@ -2,6 +2,7 @@
 
 #include "../pcmanager.h"
 #include "discovery/discovery.h"
+#include "poll_schedule.h"
 #include "executor.h"
 #include "uuidstr.h"
 #include <SDL.h>
@@ -9,6 +10,12 @@
 typedef struct app_t app_t;
 typedef struct pcmanager_listener_list pcmanager_listener_list;
 typedef struct discovery_task_t discovery_task_t;
+typedef struct host_probe_t host_probe_t;
+typedef struct pcmanager_notify_flush_t pcmanager_notify_flush_t;
+typedef struct pcmanager_poll_tick_t pcmanager_poll_tick_t;
+typedef struct known_hosts_journal_t known_hosts_journal_t;
+
+#define PCMANAGER_MAX_PROBES 4
 
 typedef enum pcmanager_notify_type_t {
     PCMANAGER_NOTIFY_ADDED,
@@ -31,10 +38,28 @@ struct pcmanager_t {
     SDL_mutex *lock;
     pcmanager_listener_list *listeners;
     discovery_t discovery;
+    /* Hosts waiting to wake up, guarded by lock */
+    host_probe_t *probes[PCMANAGER_MAX_PROBES];
+    /* Scheduled delivery of pending updates, main thread only */
+    pcmanager_notify_flush_t *notify_flush;
+    /* Background host polling, main thread only */
+    poll_schedule_t poll_schedule;
+    pcmanager_poll_tick_t *poll_tick;
+    bool polling;
+    /* Changes to known hosts not yet in hosts.ini, guarded by lock */
+    known_hosts_journal_t *journal;
+    /* Capabilities not yet in host_caps.ini, and whether a write is scheduled, guarded by lock */
+    bool host_caps_dirty;
+    bool host_caps_saving;
+    SDL_cond *host_caps_cond;
 };
 
 void serverdata_free(PSERVER_DATA data);
 
+void pcmanager_poller_init(pcmanager_t *manager);
+
+void pcmanager_poller_deinit(pcmanager_t *manager);
+
 PSERVER_DATA serverdata_new();
 
 PSERVER_DATA serverdata_clone(const SERVER_DATA *src);
@@ -43,8 +68,47 @@ void pcmanager_lock(pcmanager_t *manager);
 
 void pcmanager_unlock(pcmanager_t *manager);
 
-void pcmanager_load_known_hosts(pcmanager_t *manager);
-
+/**
+ * Write hosts.ini, and discard the journal as everything in it has been saved.
+ */
 void pcmanager_save_known_hosts(pcmanager_t *manager);
 
-void pcmanager_lan_host_discovered(const sockaddr_t *addr, pcmanager_t *manager);
\ No newline at end of file
+/**
+ * Record changes to known hosts in the journal, so they won't be lost if the app doesn't exit normally. Must be called
+ * with lock held.
+ */
+void pcmanager_journal_host(pcmanager_t *manager, const pclist_t *node);
+
+void pcmanager_journal_forget(pcmanager_t *manager, const uuidstr_t *uuid);
+
+void pcmanager_journal_select(pcmanager_t *manager, const uuidstr_t *uuid);
+
+void pcmanager_journal_favorite(pcmanager_t *manager, const uuidstr_t *uuid, int appid, bool favorite);
+
+void pcmanager_journal_hidden(pcmanager_t *manager, const uuidstr_t *uuid, int appid, bool hidden);
+
+/**
+ * Fill in last known capabilities of hosts loaded from hosts.ini. Must be called with lock held.
+ */
+void pcmanager_load_host_caps(pcmanager_t *manager);
+
+/**
+ * Mark capabilities of known hosts changed, and schedule writing them on the executor. Must be called with lock held.
+ */
+void pcmanager_host_caps_changed(pcmanager_t *manager);
+
+/**
+ * Wait for the scheduled write, and write capabilities still not saved. Called on exit.
+ */
+void pcmanager_save_host_caps(pcmanager_t *manager);
+
+void pcmanager_lan_host_discovered(const sockaddr_t *addr, pcmanager_t *manager);
+
+bool pcmanager_probe_register(pcmanager_t *manager, host_probe_t *probe);
+
+void pcmanager_probe_unregister(pcmanager_t *manager, host_probe_t *probe);
+
+/**
+ * Wake up probes waiting for the address, so they don't need to wait for next attempt.
+ */
+void pcmanager_probe_trigger(pcmanager_t *manager, const char *address);
\ No newline at end of file
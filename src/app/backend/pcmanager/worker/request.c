@@ -1,6 +1,7 @@
 #include "worker.h"
 #include "backend/pcmanager/priv.h"
 #include "util/bus.h"
+#include "util/metrics_executor.h"
 #include <errno.h>
 #include <stdlib.h>
 
@@ -34,8 +35,8 @@ void worker_context_finalize(worker_context_t *context, int result) {
 }
 
 void pcmanager_worker_queue(pcmanager_t *manager, worker_action action, worker_context_t *context) {
-    executor_submit(manager->executor, (executor_action_cb) action,
-                    (executor_cleanup_cb) worker_context_finalize, context);
+    metrics_executor_submit(manager->executor, (executor_action_cb) action,
+                            (executor_cleanup_cb) worker_context_finalize, context);
 }
 
 static void worker_callback(worker_context_t *ctx) {
@@ -1,35 +1,59 @@
 #include "worker.h"
 #include "app.h"
 #include "logging.h"
+#include "errors.h"
 #include "../pclist.h"
 #include "../priv.h"
+#include "../host_probe.h"
 
 #include "wol.h"
 
 #include <errno.h>
 #include <SDL.h>
 
+#define WOL_DEFAULT_HTTP_PORT 47989
+#define WOL_HTTPS_PORT_OFFSET 5
+
+static const host_probe_options_t wol_probe_options = {
+        .timeout_ms = 15000,
+        .initial_interval_ms = 250,
+        .max_interval_ms = 2000,
+};
+
 int worker_wol(worker_context_t *context) {
+    pcmanager_lock(context->manager);
     const pclist_t *node = pcmanager_node(context->manager, &context->uuid);
     if (node == NULL) {
         pcmanager_unlock(context->manager);
         return ENOENT;
     }
     SERVER_DATA *server = node->server;
+    char *address = strdup(server->serverInfo.address);
+    uint16_t ext_port = server->extPort;
+    uint16_t http_port = ext_port != 0 ? ext_port : WOL_DEFAULT_HTTP_PORT;
+    // Default offset only applies when the host hasn't told its HTTPS port yet
+    uint16_t https_port = server->httpsPort != 0 ? server->httpsPort : http_port - WOL_HTTPS_PORT_OFFSET;
     wol_broadcast(server->mac);
-    Uint32 timeout = SDL_GetTicks() + 15000;
-    GS_CLIENT gs = app_gs_client_new(context->app);
+    pcmanager_unlock(context->manager);
+
+    // Only check if the ports accept connections, and fetch server info once they do
+    uint16_t ports[] = {http_port, https_port};
+    host_probe_t *probe = host_probe_new(address, ports, sizeof(ports) / sizeof(ports[0]));
+    bool registered = pcmanager_probe_register(context->manager, probe);
+    int answered = host_probe_wait(probe, &wol_probe_options);
+    if (registered) {
+        pcmanager_probe_unregister(context->manager, probe);
+    }
+    host_probe_destroy(probe);
+
     int ret;
-    while (!SDL_TICKS_PASSED(SDL_GetTicks(), timeout)) {
-        PSERVER_DATA tmpserver = serverdata_new();
-        ret = gs_get_status(gs, tmpserver, strdup(server->serverInfo.address), server->extPort, false);
-        serverdata_free(tmpserver);
-        commons_log_debug("WoL", "gs_get_status returned %d, errno=%d", (int) ret, errno);
-        if (ret == 0 || errno == ECONNREFUSED) {
-            break;
-        }
-        SDL_Delay(3000);
+    if (answered >= 0) {
+        ret = pcmanager_update_by_host(context, address, ext_port, true);
+        commons_log_debug("WoL", "Host %s woke up, status update returned %d", address, ret);
+    } else {
+        commons_log_info("WoL", "Host %s didn't wake up in time", address);
+        ret = GS_IO_ERROR;
     }
-    gs_destroy(gs);
+    free(address);
     return ret;
 }
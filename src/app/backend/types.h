@@ -35,10 +35,25 @@ typedef struct appid_list_t {
     struct appid_list_t *next;
 } appid_list_t;
 
+typedef enum pcmanager_change_t {
+    PCMANAGER_CHANGE_NONE = 0,
+    /** State code or error */
+    PCMANAGER_CHANGE_STATE = 0x01,
+    PCMANAGER_CHANGE_PAIRED = 0x02,
+    PCMANAGER_CHANGE_CURRENT_APP = 0x04,
+    /** Address or ports */
+    PCMANAGER_CHANGE_ADDRESS = 0x08,
+    /** Name, versions, capabilities and display modes */
+    PCMANAGER_CHANGE_INFO = 0x10,
+    PCMANAGER_CHANGE_ALL = 0x1F,
+} pcmanager_change_t;
+
 typedef struct pclist_t {
     uuidstr_t id;
     bool known, selected;
     SERVER_STATE state;
+    /* Changes not yet notified to listeners */
+    pcmanager_change_t pending_changes;
     /* DO NOT HOLD reference to this field*/
     SERVER_DATA *server;
     appid_list_t *favs;
@@ -7,12 +7,7 @@
 
 void app_input_init(app_input_t *input, app_t *app) {
     input->app = app;
-    if (app->settings.condb_path != NULL) {
-        app_input_copy_initial_gamepad_mapping(&app->settings);
-#if SDL_VERSION_ATLEAST(2, 0, 10)
-        SDL_SetHint(SDL_HINT_GAMECONTROLLERCONFIG_FILE, app->settings.condb_path);
-#endif
-    }
+    // Mappings from gamecontrollerdb.txt are added from the index when a joystick is connected
     SDL_InitSubSystem(SDL_INIT_JOYSTICK | SDL_INIT_GAMECONTROLLER);
     input->max_num_gamepads = 4;
     input->gamepads_count = 0;
@@ -26,9 +21,6 @@ void app_input_init(app_input_t *input, app_t *app) {
     if (input->blank_cursor_surface->userdata == NULL) {
         commons_log_warn("Input", "Failed to create blank cursor: %s", SDL_GetError());
     }
-#if !SDL_VERSION_ATLEAST(2, 0, 10)
-    SDL_GameControllerAddMappingsFromFile(app->settings.condb_path);
-#endif
     app_input_init_gamepad_mapping(input, app->backend.executor, &app->settings);
 }
 
@@ -4,15 +4,17 @@
 #include <SDL_joystick.h>
 #include <SDL_version.h>
 #include "gamecontrollerdb_updater.h"
+#include "sensor_resampler.h"
 
 #include "lvgl.h"
 #include "lvgl/input/lv_drv_sdl_key.h"
 
 typedef struct app_t app_t;
+typedef struct gamepad_mapping_index_t gamepad_mapping_index_t;
 
 typedef struct app_gamepad_sensor_state_t {
-    uint32_t periodMs;
-    uint32_t lastTimestamp;
+    sensor_resampler_t resampler;
+    /* Last sent value */
     float data[3];
 } app_gamepad_sensor_state_t;
 
@@ -41,6 +43,8 @@ typedef struct app_gamepad_state_t {
 typedef struct app_input_t {
     struct app_t *app;
     commons_gcdb_updater_t gcdb_updater;
+    gamepad_mapping_index_t *gcdb_index;
+    bool gcdb_index_loaded;
     SDL_Surface *blank_cursor_surface;
     size_t max_num_gamepads;
     app_gamepad_state_t gamepads[16];
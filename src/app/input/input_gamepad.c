@@ -207,11 +207,11 @@ void app_input_gamepad_set_motion_event_state(app_input_t *input, unsigned short
     switch (motionType) {
         case LI_MOTION_TYPE_ACCEL:
             sensor_type = SDL_SENSOR_ACCEL;
-            gamepad->accelState.periodMs = reportRateHz > 0 ? 1000 / reportRateHz : 0;
+            sensor_resampler_set_rate(&gamepad->accelState.resampler, reportRateHz);
             break;
         case LI_MOTION_TYPE_GYRO:
             sensor_type = SDL_SENSOR_GYRO;
-            gamepad->gyroState.periodMs = reportRateHz > 0 ? 1000 / reportRateHz : 0;
+            sensor_resampler_set_rate(&gamepad->gyroState.resampler, reportRateHz);
             break;
         default:
             break;
@@ -4,6 +4,7 @@
 #include "app_settings.h"
 #include "executor.h"
 #include "gamecontrollerdb_updater.h"
+#include "input_gamepad_mapping_index.h"
 #include "util/user_event.h"
 #include "util/path.h"
 #include "copyfile.h"
@@ -16,25 +17,32 @@ static char *gamecontrollerdb_builtin_path();
 
 static char *gamecontrollerdb_extra_path();
 
+static char *gamecontrollerdb_index_path(const char *condb_path);
+
+static void mapping_index_update(const char *condb_path, bool force);
+
+static const gamepad_mapping_index_t *mapping_index_get(app_input_t *input);
+
+static void mapping_index_reset(app_input_t *input);
+
+/* Database path for the updater callback, there is only one app_input_t */
+static const char *condb_path = NULL;
+
 void app_input_init_gamepad_mapping(app_input_t *input, executor_t *executor, const app_settings_t *settings) {
     input->gcdb_updater.callback = gcdb_updated;
     input->gcdb_updater.path = settings->condb_path;
+    condb_path = settings->condb_path;
     input->gcdb_updater.platform = GAMECONTROLLERDB_PLATFORM;
 #ifdef GAMECONTROLLERDB_PLATFORM_USE
     input->gcdb_updater.platform_use = GAMECONTROLLERDB_PLATFORM_USE;
 #endif
-    char *condb_extra = gamecontrollerdb_extra_path();
-    if (condb_extra != NULL) {
-        int num_mapping = SDL_GameControllerAddMappingsFromRW(SDL_RWFromFile(condb_extra, "r"), SDL_TRUE);
-        free(condb_extra);
-        commons_log_debug("Input", "Added %d gamepad mapping from extra controller db", num_mapping);
-    }
     commons_gcdb_updater_init(&input->gcdb_updater, executor);
     commons_gcdb_updater_update(&input->gcdb_updater);
 }
 
 void app_input_deinit_gamepad_mapping(app_input_t *input) {
     commons_gcdb_updater_deinit(&input->gcdb_updater);
+    mapping_index_reset(input);
 }
 
 void app_input_copy_initial_gamepad_mapping(const app_settings_t *settings) {
@@ -52,17 +60,47 @@ void app_input_copy_initial_gamepad_mapping(const app_settings_t *settings) {
     free(builtin_path);
 }
 
+void app_input_update_gamepad_mapping_index(const app_settings_t *settings) {
+    if (settings->condb_path == NULL) {
+        return;
+    }
+    mapping_index_update(settings->condb_path, false);
+}
+
+bool app_input_register_gamepad_mapping(app_input_t *input, int device_index) {
+    const gamepad_mapping_index_t *index = mapping_index_get(input);
+    if (index == NULL) {
+        return false;
+    }
+    const char *mapping = gamepad_mapping_index_find(index, SDL_JoystickGetDeviceGUID(device_index));
+    if (mapping == NULL) {
+        return false;
+    }
+    if (SDL_GameControllerAddMapping(mapping) < 0) {
+        commons_log_warn("Input", "Failed to add gamepad mapping: %s", SDL_GetError());
+        return false;
+    }
+    return true;
+}
+
 void app_input_reload_gamepad_mapping(app_input_t *input) {
-    int num_mapping = SDL_GameControllerAddMappingsFromRW(SDL_RWFromFile(input->gcdb_updater.path, "r"),
-                                                          SDL_TRUE);
-    commons_log_debug("Input", "Added %d gamepad mapping", num_mapping);
+    // Index has been rebuilt, load it again and only update mappings of connected devices
+    mapping_index_reset(input);
+    int num_mapping = 0;
+    for (int i = 0, j = SDL_NumJoysticks(); i < j; i++) {
+        if (app_input_register_gamepad_mapping(input, i)) {
+            num_mapping++;
+        }
+    }
+    commons_log_debug("Input", "Updated %d gamepad mapping", num_mapping);
 }
 
 static void gcdb_updated(commons_gcdb_status_t result, void *context) {
     (void) context;
-    if (result != COMMONS_GCDB_UPDATER_UPDATED) {
+    if (result != COMMONS_GCDB_UPDATER_UPDATED || condb_path == NULL) {
         return;
     }
+    mapping_index_update(condb_path, true);
     SDL_Event event = {
             .user = {
                     .type = SDL_USEREVENT,
@@ -91,4 +129,61 @@ static char *gamecontrollerdb_extra_path() {
         return NULL;
     }
     return condb;
-}
\ No newline at end of file
+}
+static char *gamecontrollerdb_index_path(const char *condb_path) {
+    size_t len = strlen(condb_path) + 5;
+    char *index_path = malloc(len);
+    snprintf(index_path, len, "%s.idx", condb_path);
+    return index_path;
+}
+
+/**
+ * Mappings from extra controller db override ones from downloaded db, same as before they were indexed.
+ */
+static void mapping_index_update(const char *condb_path, bool force) {
+    char *condb_extra = gamecontrollerdb_extra_path();
+    const char *db_paths[] = {condb_path, condb_extra};
+    char *index_path = gamecontrollerdb_index_path(condb_path);
+    if (force || gamepad_mapping_index_is_stale(db_paths, 2, index_path)) {
+        gamepad_mapping_index_build(db_paths, 2, index_path, SDL_GetPlatform());
+    }
+    free(index_path);
+    free(condb_extra);
+}
+
+/**
+ * Index is only loaded when a controller is connected.
+ */
+static const gamepad_mapping_index_t *mapping_index_get(app_input_t *input) {
+    if (!input->gcdb_index_loaded) {
+        input->gcdb_index_loaded = true;
+        if (input->gcdb_updater.path == NULL) {
+            return NULL;
+        }
+        char *index_path = gamecontrollerdb_index_path(input->gcdb_updater.path);
+        input->gcdb_index = gamepad_mapping_index_open(index_path);
+        free(index_path);
+        if (input->gcdb_index != NULL) {
+            commons_log_debug("Input", "Loaded %zu gamepad mappings from index",
+                              gamepad_mapping_index_count(input->gcdb_index));
+        } else {
+            // Fallback to add all mappings, extra db is added last so it overrides like in the index
+            int num_mapping = SDL_GameControllerAddMappingsFromRW(SDL_RWFromFile(input->gcdb_updater.path, "r"),
+                                                                  SDL_TRUE);
+            commons_log_warn("Input", "Gamepad mapping index unavailable, added %d gamepad mapping", num_mapping);
+            char *condb_extra = gamecontrollerdb_extra_path();
+            if (condb_extra != NULL) {
+                num_mapping = SDL_GameControllerAddMappingsFromRW(SDL_RWFromFile(condb_extra, "r"), SDL_TRUE);
+                free(condb_extra);
+                commons_log_debug("Input", "Added %d gamepad mapping from extra controller db", num_mapping);
+            }
+        }
+    }
+    return input->gcdb_index;
+}
+
+static void mapping_index_reset(app_input_t *input) {
+    gamepad_mapping_index_close(input->gcdb_index);
+    input->gcdb_index = NULL;
+    input->gcdb_index_loaded = false;
+}
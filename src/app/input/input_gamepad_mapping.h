@@ -11,4 +11,14 @@ void app_input_deinit_gamepad_mapping(app_input_t *input);
 
 void app_input_copy_initial_gamepad_mapping(const app_settings_t *settings);
 
+/**
+ * Rebuild the platform filtered mapping index if the database has changed. Can be called from any thread.
+ */
+void app_input_update_gamepad_mapping_index(const app_settings_t *settings);
+
+/**
+ * Add mapping from the index for the joystick, if there is one.
+ */
+bool app_input_register_gamepad_mapping(app_input_t *input, int device_index);
+
 void app_input_reload_gamepad_mapping(app_input_t *input);
\ No newline at end of file
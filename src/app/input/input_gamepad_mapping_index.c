@@ -0,0 +1,272 @@
+#include "input_gamepad_mapping_index.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#include "logging.h"
+#include "util/path.h"
+
+#define INDEX_MAGIC "MLGCDBI1"
+#define INDEX_LINE_MAX 4096
+
+typedef struct index_header_t {
+    char magic[8];
+    uint32_t count;
+    uint32_t strings_size;
+    /* Total size and latest modification time of text databases this index was built from */
+    int64_t source_size;
+    int64_t source_mtime;
+} index_header_t;
+
+typedef struct index_entry_t {
+    uint8_t guid[16];
+    uint32_t offset;
+    uint32_t length;
+} index_entry_t;
+
+struct gamepad_mapping_index_t {
+    index_header_t header;
+    index_entry_t *entries;
+    char *strings;
+};
+
+typedef struct build_entry_t {
+    index_entry_t entry;
+    /* Line number in database, later lines override earlier ones */
+    size_t line;
+} build_entry_t;
+
+static bool sources_stat(const char *const *db_paths, size_t db_count, int64_t *size, int64_t *mtime);
+
+static bool mapping_platform_matches(const char *mapping, const char *platform);
+
+static int build_entry_compare(const void *a, const void *b);
+
+static int index_entry_compare(const void *a, const void *b);
+
+static const char *index_lookup(const gamepad_mapping_index_t *index, const uint8_t *guid);
+
+int gamepad_mapping_index_build(const char *const *db_paths, size_t db_count, const char *index_path,
+                                const char *platform) {
+    int64_t source_size = 0, source_mtime = 0;
+    if (!sources_stat(db_paths, db_count, &source_size, &source_mtime)) {
+        return -1;
+    }
+    size_t entries_cap = 256, entries_count = 0, strings_cap = 256 * 128, strings_size = 0, line_num = 0;
+    build_entry_t *entries = malloc(entries_cap * sizeof(build_entry_t));
+    char *strings = malloc(strings_cap);
+    char *line = malloc(INDEX_LINE_MAX);
+    for (size_t db_index = 0; db_index < db_count; db_index++) {
+        FILE *db = fopen(db_paths[db_index], "r");
+        if (db == NULL) {
+            continue;
+        }
+        while (fgets(line, INDEX_LINE_MAX, db) != NULL) {
+            line_num++;
+            size_t len = strcspn(line, "\r\n");
+            line[len] = '\0';
+            if (len < 33 || line[0] == '#' || line[32] != ',') {
+                continue;
+            }
+            if (!mapping_platform_matches(line, platform)) {
+                continue;
+            }
+            line[32] = '\0';
+            SDL_JoystickGUID guid = SDL_JoystickGetGUIDFromString(line);
+            line[32] = ',';
+            if (entries_count == entries_cap) {
+                entries_cap *= 2;
+                entries = realloc(entries, entries_cap * sizeof(build_entry_t));
+            }
+            while (strings_size + len + 1 > strings_cap) {
+                strings_cap *= 2;
+                strings = realloc(strings, strings_cap);
+            }
+            build_entry_t *entry = &entries[entries_count++];
+            memcpy(entry->entry.guid, guid.data, sizeof(entry->entry.guid));
+            entry->entry.offset = (uint32_t) strings_size;
+            entry->entry.length = (uint32_t) len;
+            entry->line = line_num;
+            memcpy(strings + strings_size, line, len + 1);
+            strings_size += len + 1;
+        }
+        fclose(db);
+    }
+    free(line);
+
+    qsort(entries, entries_count, sizeof(build_entry_t), build_entry_compare);
+    // Keep the last mapping of each GUID
+    size_t unique_count = 0;
+    for (size_t i = 0; i < entries_count; i++) {
+        if (i + 1 < entries_count && memcmp(entries[i].entry.guid, entries[i + 1].entry.guid, 16) == 0) {
+            continue;
+        }
+        entries[unique_count++] = entries[i];
+    }
+
+    size_t tmp_path_len = strlen(index_path) + 5;
+    char *tmp_path = malloc(tmp_path_len);
+    snprintf(tmp_path, tmp_path_len, "%s.tmp", index_path);
+    int result = -1;
+    FILE *out = fopen(tmp_path, "wb");
+    if (out != NULL) {
+        index_header_t header = {
+                .count = (uint32_t) unique_count,
+                .strings_size = (uint32_t) strings_size,
+                .source_size = source_size,
+                .source_mtime = source_mtime,
+        };
+        memcpy(header.magic, INDEX_MAGIC, sizeof(header.magic));
+        bool ok = fwrite(&header, sizeof(header), 1, out) == 1;
+        for (size_t i = 0; ok && i < unique_count; i++) {
+            ok = fwrite(&entries[i].entry, sizeof(index_entry_t), 1, out) == 1;
+        }
+        ok = ok && (strings_size == 0 || fwrite(strings, strings_size, 1, out) == 1);
+        ok = fclose(out) == 0 && ok;
+        if (ok && path_replace(tmp_path, index_path) == 0) {
+            result = (int) unique_count;
+        } else {
+            remove(tmp_path);
+        }
+    }
+    free(tmp_path);
+    free(strings);
+    free(entries);
+    if (result >= 0) {
+        commons_log_info("Input", "Indexed %d of %zu gamepad mappings for %s", result, line_num, platform);
+    } else {
+        commons_log_warn("Input", "Failed to write gamepad mapping index %s", index_path);
+    }
+    return result;
+}
+
+bool gamepad_mapping_index_is_stale(const char *const *db_paths, size_t db_count, const char *index_path) {
+    int64_t source_size = 0, source_mtime = 0;
+    if (!sources_stat(db_paths, db_count, &source_size, &source_mtime)) {
+        // Nothing to build from
+        return false;
+    }
+    FILE *fp = fopen(index_path, "rb");
+    if (fp == NULL) {
+        return true;
+    }
+    index_header_t header;
+    bool stale = fread(&header, sizeof(header), 1, fp) != 1 ||
+                 memcmp(header.magic, INDEX_MAGIC, sizeof(header.magic)) != 0 ||
+                 header.source_size != source_size || header.source_mtime != source_mtime;
+    fclose(fp);
+    return stale;
+}
+
+gamepad_mapping_index_t *gamepad_mapping_index_open(const char *index_path) {
+    FILE *fp = fopen(index_path, "rb");
+    if (fp == NULL) {
+        return NULL;
+    }
+    gamepad_mapping_index_t *index = calloc(1, sizeof(gamepad_mapping_index_t));
+    if (fread(&index->header, sizeof(index_header_t), 1, fp) != 1 ||
+        memcmp(index->header.magic, INDEX_MAGIC, sizeof(index->header.magic)) != 0) {
+        goto fail;
+    }
+    index->entries = malloc(index->header.count * sizeof(index_entry_t) + 1);
+    index->strings = malloc(index->header.strings_size + 1);
+    if (fread(index->entries, sizeof(index_entry_t), index->header.count, fp) != index->header.count ||
+        fread(index->strings, 1, index->header.strings_size, fp) != index->header.strings_size) {
+        goto fail;
+    }
+    index->strings[index->header.strings_size] = '\0';
+    for (uint32_t i = 0; i < index->header.count; i++) {
+        const index_entry_t *entry = &index->entries[i];
+        if ((uint64_t) entry->offset + entry->length >= index->header.strings_size) {
+            goto fail;
+        }
+    }
+    fclose(fp);
+    return index;
+
+    fail:
+    commons_log_warn("Input", "Invalid gamepad mapping index %s", index_path);
+    fclose(fp);
+    gamepad_mapping_index_close(index);
+    return NULL;
+}
+
+void gamepad_mapping_index_close(gamepad_mapping_index_t *index) {
+    if (index == NULL) {
+        return;
+    }
+    free(index->entries);
+    free(index->strings);
+    free(index);
+}
+
+size_t gamepad_mapping_index_count(const gamepad_mapping_index_t *index) {
+    return index->header.count;
+}
+
+const char *gamepad_mapping_index_find(const gamepad_mapping_index_t *index, SDL_JoystickGUID guid) {
+    const char *mapping = index_lookup(index, guid.data);
+    if (mapping == NULL) {
+        // Newer SDL puts CRC of device name in bytes 2-3, mappings in database usually don't have it
+        guid.data[2] = 0;
+        guid.data[3] = 0;
+        mapping = index_lookup(index, guid.data);
+    }
+    return mapping;
+}
+
+/**
+ * @return false if none of the databases exists
+ */
+static bool sources_stat(const char *const *db_paths, size_t db_count, int64_t *size, int64_t *mtime) {
+    bool found = false;
+    for (size_t i = 0; i < db_count; i++) {
+        struct stat st;
+        if (db_paths[i] == NULL || stat(db_paths[i], &st) != 0) {
+            continue;
+        }
+        found = true;
+        *size += (int64_t) st.st_size;
+        if ((int64_t) st.st_mtime > *mtime) {
+            *mtime = (int64_t) st.st_mtime;
+        }
+    }
+    return found;
+}
+
+static bool mapping_platform_matches(const char *mapping, const char *platform) {
+    const char *field = strstr(mapping, "platform:");
+    if (field == NULL) {
+        return true;
+    }
+    field += 9;
+    size_t len = strcspn(field, ",");
+    return len == strlen(platform) && strncmp(field, platform, len) == 0;
+}
+
+static int build_entry_compare(const void *a, const void *b) {
+    const build_entry_t *x = a, *y = b;
+    int result = memcmp(x->entry.guid, y->entry.guid, sizeof(x->entry.guid));
+    if (result != 0) {
+        return result;
+    }
+    return x->line < y->line ? -1 : (x->line > y->line ? 1 : 0);
+}
+
+static int index_entry_compare(const void *a, const void *b) {
+    return memcmp(((const index_entry_t *) a)->guid, ((const index_entry_t *) b)->guid, 16);
+}
+
+static const char *index_lookup(const gamepad_mapping_index_t *index, const uint8_t *guid) {
+    index_entry_t key;
+    memcpy(key.guid, guid, sizeof(key.guid));
+    const index_entry_t *found = bsearch(&key, index->entries, index->header.count, sizeof(index_entry_t),
+                                         index_entry_compare);
+    if (found == NULL) {
+        return NULL;
+    }
+    return index->strings + found->offset;
+}
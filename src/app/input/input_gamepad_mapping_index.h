@@ -0,0 +1,40 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <SDL_joystick.h>
+
+/**
+ * Compact index of controller mappings for a single platform, keyed by joystick GUID.
+ *
+ * The index file is a sorted table of GUIDs followed by mapping strings, so looking up a mapping doesn't require
+ * parsing the whole gamecontrollerdb.txt.
+ */
+typedef struct gamepad_mapping_index_t gamepad_mapping_index_t;
+
+/**
+ * Filter mappings of the platform in text databases, and write them into index file.
+ *
+ * @param db_paths Text databases, mappings in later files override earlier ones. Missing files are skipped.
+ * @param platform Value of "platform:" field to keep. Mappings without this field are always kept.
+ * @return Number of mappings written, or -1 on failure
+ */
+int gamepad_mapping_index_build(const char *const *db_paths, size_t db_count, const char *index_path,
+                                const char *platform);
+
+/**
+ * @return true if the index file is missing, invalid or doesn't match the text databases
+ */
+bool gamepad_mapping_index_is_stale(const char *const *db_paths, size_t db_count, const char *index_path);
+
+gamepad_mapping_index_t *gamepad_mapping_index_open(const char *index_path);
+
+void gamepad_mapping_index_close(gamepad_mapping_index_t *index);
+
+size_t gamepad_mapping_index_count(const gamepad_mapping_index_t *index);
+
+/**
+ * @return Mapping string can be passed to SDL_GameControllerAddMapping, or NULL if not found.
+ *         Valid until the index is closed.
+ */
+const char *gamepad_mapping_index_find(const gamepad_mapping_index_t *index, SDL_JoystickGUID guid);
@@ -0,0 +1,67 @@
+#include "sensor_resampler.h"
+
+#include <string.h>
+
+#define NS_PER_SEC 1000000000ULL
+
+void sensor_resampler_set_rate(sensor_resampler_t *resampler, uint16_t rate_hz) {
+    memset(resampler, 0, sizeof(*resampler));
+    resampler->period_ns = rate_hz > 0 ? NS_PER_SEC / rate_hz : 0;
+}
+
+bool sensor_resampler_feed(sensor_resampler_t *resampler, uint64_t timestamp_ns, const float data[3], float out[3]) {
+    if (resampler->period_ns == 0) {
+        return false;
+    }
+    if (!resampler->has_sample) {
+        resampler->has_sample = true;
+        resampler->next_send_ns = timestamp_ns;
+        resampler->window_start_ns = timestamp_ns;
+    } else if (timestamp_ns > resampler->last_sample_ns) {
+        // Previous value holds until this sample
+        uint64_t dt = timestamp_ns - resampler->last_sample_ns;
+        for (int i = 0; i < 3; i++) {
+            resampler->sum[i] += (double) resampler->last[i] * (double) dt;
+        }
+        resampler->sum_ns += dt;
+    }
+    resampler->last_sample_ns = timestamp_ns;
+    memcpy(resampler->last, data, sizeof(resampler->last));
+
+    if (timestamp_ns < resampler->next_send_ns) {
+        return false;
+    }
+    if (resampler->sum_ns > 0) {
+        for (int i = 0; i < 3; i++) {
+            out[i] = (float) (resampler->sum[i] / (double) resampler->sum_ns);
+            resampler->sum[i] = 0;
+        }
+        resampler->sum_ns = 0;
+    } else {
+        memcpy(out, data, sizeof(resampler->last));
+    }
+    resampler->next_send_ns += resampler->period_ns;
+    if (resampler->next_send_ns <= timestamp_ns) {
+        // Sensor paused for more than a period, don't send a burst to catch up
+        resampler->next_send_ns = timestamp_ns + resampler->period_ns;
+    }
+    return true;
+}
+
+void sensor_resampler_mark_sent(sensor_resampler_t *resampler, uint64_t timestamp_ns) {
+    resampler->sent++;
+    // Send at window start belongs to the previous window
+    if (timestamp_ns > resampler->window_start_ns) {
+        resampler->window_sent++;
+    }
+    if (timestamp_ns - resampler->window_start_ns >= NS_PER_SEC) {
+        resampler->achieved_hz = (float) ((double) resampler->window_sent * NS_PER_SEC /
+                                          (double) (timestamp_ns - resampler->window_start_ns));
+        resampler->window_start_ns = timestamp_ns;
+        resampler->window_sent = 0;
+    }
+}
+
+float sensor_resampler_achieved_hz(const sensor_resampler_t *resampler) {
+    return resampler->achieved_hz;
+}
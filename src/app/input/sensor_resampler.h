@@ -0,0 +1,52 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * Turns sensor samples arriving at the device rate into samples at the rate host requested.
+ *
+ * Samples between sends are integrated over time and averaged, instead of dropped, so no rotation is lost for gyro.
+ * Send deadlines advance by exactly one period each time, so the average rate is the requested one even when it
+ * doesn't divide into milliseconds.
+ */
+typedef struct sensor_resampler_t {
+    uint64_t period_ns;
+    uint64_t next_send_ns;
+    uint64_t last_sample_ns;
+    bool has_sample;
+    float last[3];
+    /* Time weighted sum of samples since last send */
+    double sum[3];
+    uint64_t sum_ns;
+    /* Send rate measured over the last window */
+    uint64_t window_start_ns;
+    uint32_t window_sent;
+    float achieved_hz;
+    uint32_t sent;
+} sensor_resampler_t;
+
+/**
+ * Resets the state. Rate of 0 disables sending.
+ */
+void sensor_resampler_set_rate(sensor_resampler_t *resampler, uint16_t rate_hz);
+
+/**
+ * @param timestamp_ns Time of the sample from a monotonic clock
+ * @param out Averaged value to send
+ * @return true if it's time to send. Call sensor_resampler_mark_sent if the value is actually sent.
+ */
+bool sensor_resampler_feed(sensor_resampler_t *resampler, uint64_t timestamp_ns, const float data[3], float out[3]);
+
+/**
+ * Counts a send for the achieved rate. Senders may skip a value, e.g. when it's the same as the last one, so only
+ * sends that really happened are counted.
+ *
+ * @param timestamp_ns Timestamp of the sample sensor_resampler_feed returned true for
+ */
+void sensor_resampler_mark_sent(sensor_resampler_t *resampler, uint64_t timestamp_ns);
+
+/**
+ * @return Sends per second in the last complete second, or 0 if not available yet
+ */
+float sensor_resampler_achieved_hz(const sensor_resampler_t *resampler);
@@ -0,0 +1,35 @@
+#include "lv_fragment_arena.h"
+
+static void arena_release_cb(lv_event_t *event);
+
+lv_mem_app_arena_t *lv_fragment_arena_begin(const char *name) {
+    lv_mem_app_arena_t *arena = lv_mem_app_arena_create(name);
+    if (arena != NULL) {
+        lv_mem_app_arena_push(arena);
+    }
+    return arena;
+}
+
+void lv_fragment_arena_end(lv_mem_app_arena_t *arena, lv_fragment_t *fragment) {
+    if (arena == NULL) {
+        return;
+    }
+    lv_mem_app_arena_pop(arena);
+    if (fragment->obj == NULL) {
+        lv_mem_app_arena_release(arena);
+        return;
+    }
+    // Children are deleted after this event, the arena will be freed after the last of them
+    lv_obj_add_event_cb(fragment->obj, arena_release_cb, LV_EVENT_DELETE, arena);
+}
+
+lv_obj_t *lv_fragment_create_obj_arena(lv_fragment_t *fragment, lv_obj_t *container, const char *name) {
+    lv_mem_app_arena_t *arena = lv_fragment_arena_begin(name);
+    lv_obj_t *obj = lv_fragment_create_obj(fragment, container);
+    lv_fragment_arena_end(arena, fragment);
+    return obj;
+}
+
+static void arena_release_cb(lv_event_t *event) {
+    lv_mem_app_arena_release(lv_event_get_user_data(event));
+}
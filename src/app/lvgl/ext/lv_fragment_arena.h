@@ -0,0 +1,20 @@
+#pragma once
+
+#include "lvgl.h"
+#include "lvgl/lv_mem_app.h"
+
+/**
+ * Allocate objects created from now on in a new arena, until lv_fragment_arena_end is called.
+ * @param name For debugging, not copied
+ */
+lv_mem_app_arena_t *lv_fragment_arena_begin(const char *name);
+
+/**
+ * Stop allocating from the arena, and release it when the fragment view gets deleted.
+ */
+void lv_fragment_arena_end(lv_mem_app_arena_t *arena, lv_fragment_t *fragment);
+
+/**
+ * Same as lv_fragment_create_obj, but the view is allocated in its own arena.
+ */
+lv_obj_t *lv_fragment_create_obj_arena(lv_fragment_t *fragment, lv_obj_t *container, const char *name);
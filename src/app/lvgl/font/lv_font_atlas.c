@@ -0,0 +1,431 @@
+#include "lv_font_atlas.h"
+#include "util/path.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define ATLAS_MAGIC "MLGA"
+#define ATLAS_VERSION 1
+#define ATLAS_MAX_GLYPHS 4096
+#define ATLAS_MAX_ID_LEN 1024
+
+typedef struct atlas_header_t {
+    char magic[4];
+    uint32_t version;
+    int32_t line_height, base_line;
+    uint32_t id_len;
+    uint32_t num_glyphs;
+    uint32_t bitmap_size;
+} atlas_header_t;
+
+typedef struct atlas_glyph_t {
+    uint32_t unicode;
+    uint32_t bitmap_offset;
+    uint16_t adv_w, box_w, box_h;
+    int16_t ofs_x, ofs_y;
+    uint8_t bpp, reserved;
+} atlas_glyph_t;
+
+typedef struct atlas_t {
+    lv_font_t *base;
+    char *path, *id;
+    /* Sorted by unicode */
+    atlas_glyph_t *glyphs;
+    uint32_t num_glyphs;
+    uint8_t *bitmaps;
+    uint32_t bitmap_size;
+    /* Letters rasterized by base font, sorted */
+    uint32_t *misses;
+    uint32_t num_misses, cap_misses;
+    lv_font_atlas_stats_t stats;
+} atlas_t;
+
+struct lv_font_atlas_snapshot_t {
+    char *path, *id;
+    int32_t line_height, base_line;
+    atlas_glyph_t *glyphs;
+    uint32_t num_glyphs;
+    uint8_t *bitmaps;
+    uint32_t bitmap_size;
+};
+
+static bool atlas_get_glyph_dsc(const lv_font_t *font, lv_font_glyph_dsc_t *dsc, uint32_t letter,
+                                uint32_t letter_next);
+
+static const uint8_t *atlas_get_glyph_bitmap(const lv_font_t *font, uint32_t letter);
+
+static bool atlas_load(atlas_t *atlas);
+
+static void atlas_unload(atlas_t *atlas);
+
+static const atlas_glyph_t *atlas_find(const atlas_t *atlas, uint32_t letter);
+
+static void atlas_record_miss(atlas_t *atlas, uint32_t letter);
+
+static bool atlas_add_misses(atlas_t *atlas);
+
+static uint32_t bitmap_size_of(uint16_t box_w, uint16_t box_h, uint8_t bpp);
+
+static int glyph_compare(const void *a, const void *b);
+
+lv_font_t *lv_font_atlas_create(lv_font_t *base, const char *path, const char *id) {
+    lv_font_t *font = calloc(1, sizeof(lv_font_t));
+    atlas_t *atlas = calloc(1, sizeof(atlas_t));
+    if (font == NULL || atlas == NULL) {
+        free(font);
+        free(atlas);
+        return NULL;
+    }
+    atlas->base = base;
+    atlas->path = strdup(path);
+    atlas->id = strdup(id);
+    font->dsc = atlas;
+    font->get_glyph_dsc = atlas_get_glyph_dsc;
+    font->get_glyph_bitmap = atlas_get_glyph_bitmap;
+    font->line_height = base->line_height;
+    font->base_line = base->base_line;
+    font->subpx = base->subpx;
+    font->underline_position = base->underline_position;
+    font->underline_thickness = base->underline_thickness;
+    if (atlas_load(atlas)) {
+        atlas->stats.glyphs = atlas->num_glyphs;
+    }
+    return font;
+}
+
+void lv_font_atlas_destroy(lv_font_t *font) {
+    if (font == NULL) {
+        return;
+    }
+    atlas_t *atlas = (atlas_t *) font->dsc;
+    atlas_unload(atlas);
+    free(atlas->misses);
+    free(atlas->path);
+    free(atlas->id);
+    free(atlas);
+    free(font);
+}
+
+bool lv_font_atlas_is_atlas(const lv_font_t *font) {
+    return font != NULL && font->get_glyph_dsc == atlas_get_glyph_dsc;
+}
+
+lv_font_t *lv_font_atlas_get_base(const lv_font_t *font) {
+    return ((const atlas_t *) font->dsc)->base;
+}
+
+bool lv_font_atlas_save(lv_font_t *font) {
+    if (((const atlas_t *) font->dsc)->num_misses == 0) {
+        return true;
+    }
+    lv_font_atlas_snapshot_t *snapshot = lv_font_atlas_snapshot(font);
+    if (snapshot == NULL) {
+        return false;
+    }
+    bool written = lv_font_atlas_snapshot_write(snapshot);
+    lv_font_atlas_snapshot_free(snapshot);
+    return written;
+}
+
+lv_font_atlas_snapshot_t *lv_font_atlas_snapshot(lv_font_t *font) {
+    atlas_t *atlas = (atlas_t *) font->dsc;
+    if (atlas->num_misses == 0 || !atlas_add_misses(atlas)) {
+        return NULL;
+    }
+    lv_font_atlas_snapshot_t *snapshot = calloc(1, sizeof(lv_font_atlas_snapshot_t));
+    if (snapshot == NULL) {
+        return NULL;
+    }
+    snapshot->path = strdup(atlas->path);
+    snapshot->id = strdup(atlas->id);
+    snapshot->line_height = atlas->base->line_height;
+    snapshot->base_line = atlas->base->base_line;
+    snapshot->glyphs = malloc((atlas->num_glyphs ? atlas->num_glyphs : 1) * sizeof(atlas_glyph_t));
+    snapshot->bitmaps = malloc(atlas->bitmap_size ? atlas->bitmap_size : 1);
+    if (snapshot->path == NULL || snapshot->id == NULL || snapshot->glyphs == NULL || snapshot->bitmaps == NULL) {
+        lv_font_atlas_snapshot_free(snapshot);
+        return NULL;
+    }
+    memcpy(snapshot->glyphs, atlas->glyphs, atlas->num_glyphs * sizeof(atlas_glyph_t));
+    snapshot->num_glyphs = atlas->num_glyphs;
+    memcpy(snapshot->bitmaps, atlas->bitmaps, atlas->bitmap_size);
+    snapshot->bitmap_size = atlas->bitmap_size;
+    return snapshot;
+}
+
+void lv_font_atlas_snapshot_free(lv_font_atlas_snapshot_t *snapshot) {
+    if (snapshot == NULL) {
+        return;
+    }
+    free(snapshot->path);
+    free(snapshot->id);
+    free(snapshot->glyphs);
+    free(snapshot->bitmaps);
+    free(snapshot);
+}
+
+bool lv_font_atlas_snapshot_write(const lv_font_atlas_snapshot_t *snapshot) {
+    size_t path_len = strlen(snapshot->path);
+    char *tmp_path = malloc(path_len + 5);
+    if (tmp_path == NULL) {
+        return false;
+    }
+    memcpy(tmp_path, snapshot->path, path_len);
+    memcpy(tmp_path + path_len, ".tmp", 5);
+    FILE *fp = fopen(tmp_path, "wb");
+    if (fp == NULL) {
+        free(tmp_path);
+        return false;
+    }
+    atlas_header_t header = {
+            .magic = ATLAS_MAGIC,
+            .version = ATLAS_VERSION,
+            .line_height = snapshot->line_height,
+            .base_line = snapshot->base_line,
+            .id_len = (uint32_t) strlen(snapshot->id),
+            .num_glyphs = snapshot->num_glyphs,
+            .bitmap_size = snapshot->bitmap_size,
+    };
+    bool ok = fwrite(&header, sizeof(header), 1, fp) == 1 &&
+              fwrite(snapshot->id, 1, header.id_len, fp) == header.id_len &&
+              fwrite(snapshot->glyphs, sizeof(atlas_glyph_t), header.num_glyphs, fp) == header.num_glyphs &&
+              fwrite(snapshot->bitmaps, 1, header.bitmap_size, fp) == header.bitmap_size;
+    ok = fclose(fp) == 0 && ok;
+    // Never leave a partially written atlas in place of a good one
+    if (ok) {
+        ok = path_replace(tmp_path, snapshot->path) == 0;
+    }
+    if (!ok) {
+        remove(tmp_path);
+    }
+    free(tmp_path);
+    return ok;
+}
+
+void lv_font_atlas_get_stats(const lv_font_t *font, lv_font_atlas_stats_t *stats) {
+    *stats = ((const atlas_t *) font->dsc)->stats;
+}
+
+static bool atlas_get_glyph_dsc(const lv_font_t *font, lv_font_glyph_dsc_t *dsc, uint32_t letter,
+                                uint32_t letter_next) {
+    atlas_t *atlas = (atlas_t *) font->dsc;
+    const atlas_glyph_t *glyph = atlas_find(atlas, letter);
+    if (glyph != NULL) {
+        atlas->stats.hits++;
+        dsc->adv_w = glyph->adv_w;
+        dsc->box_w = glyph->box_w;
+        dsc->box_h = glyph->box_h;
+        dsc->ofs_x = glyph->ofs_x;
+        dsc->ofs_y = glyph->ofs_y;
+        dsc->bpp = glyph->bpp;
+#ifdef LV_USE_FONT_PLACEHOLDER
+        dsc->is_placeholder = 0;
+#endif
+        return true;
+    }
+    lv_font_t *base = atlas->base;
+    if (!base->get_glyph_dsc(base, dsc, letter, letter_next)) {
+        return false;
+    }
+    atlas->stats.misses++;
+    atlas_record_miss(atlas, letter);
+    return true;
+}
+
+static const uint8_t *atlas_get_glyph_bitmap(const lv_font_t *font, uint32_t letter) {
+    const atlas_t *atlas = (const atlas_t *) font->dsc;
+    const atlas_glyph_t *glyph = atlas_find(atlas, letter);
+    if (glyph != NULL) {
+        return atlas->bitmaps + glyph->bitmap_offset;
+    }
+    lv_font_t *base = atlas->base;
+    return base->get_glyph_bitmap(base, letter);
+}
+
+static bool atlas_load(atlas_t *atlas) {
+    FILE *fp = fopen(atlas->path, "rb");
+    if (fp == NULL) {
+        return false;
+    }
+    atlas_header_t header;
+    char id[ATLAS_MAX_ID_LEN];
+    atlas_glyph_t *glyphs = NULL;
+    uint8_t *bitmaps = NULL;
+    if (fread(&header, sizeof(header), 1, fp) != 1 || memcmp(header.magic, ATLAS_MAGIC, 4) != 0 ||
+        header.version != ATLAS_VERSION || header.num_glyphs > ATLAS_MAX_GLYPHS) {
+        goto error;
+    }
+    // Atlas was made for another font or size
+    if (header.id_len != strlen(atlas->id) || header.id_len >= sizeof(id) ||
+        fread(id, 1, header.id_len, fp) != header.id_len || memcmp(id, atlas->id, header.id_len) != 0) {
+        goto error;
+    }
+    if (header.line_height != atlas->base->line_height || header.base_line != atlas->base->base_line) {
+        goto error;
+    }
+    glyphs = malloc((header.num_glyphs ? header.num_glyphs : 1) * sizeof(atlas_glyph_t));
+    bitmaps = malloc(header.bitmap_size ? header.bitmap_size : 1);
+    if (glyphs == NULL || bitmaps == NULL) {
+        goto error;
+    }
+    if (fread(glyphs, sizeof(atlas_glyph_t), header.num_glyphs, fp) != header.num_glyphs ||
+        fread(bitmaps, 1, header.bitmap_size, fp) != header.bitmap_size) {
+        goto error;
+    }
+    for (uint32_t i = 0; i < header.num_glyphs; i++) {
+        const atlas_glyph_t *glyph = &glyphs[i];
+        uint32_t size = bitmap_size_of(glyph->box_w, glyph->box_h, glyph->bpp);
+        if (glyph->bitmap_offset > header.bitmap_size || size > header.bitmap_size - glyph->bitmap_offset) {
+            goto error;
+        }
+        if (i > 0 && glyphs[i - 1].unicode >= glyph->unicode) {
+            goto error;
+        }
+    }
+    fclose(fp);
+    atlas->glyphs = glyphs;
+    atlas->num_glyphs = header.num_glyphs;
+    atlas->bitmaps = bitmaps;
+    atlas->bitmap_size = header.bitmap_size;
+    return true;
+
+    error:
+    LV_LOG_WARN("Ignoring glyph atlas %s", atlas->path);
+    free(glyphs);
+    free(bitmaps);
+    fclose(fp);
+    return false;
+}
+
+static void atlas_unload(atlas_t *atlas) {
+    free(atlas->glyphs);
+    free(atlas->bitmaps);
+    atlas->glyphs = NULL;
+    atlas->bitmaps = NULL;
+    atlas->num_glyphs = 0;
+    atlas->bitmap_size = 0;
+}
+
+static const atlas_glyph_t *atlas_find(const atlas_t *atlas, uint32_t letter) {
+    uint32_t low = 0, high = atlas->num_glyphs;
+    while (low < high) {
+        uint32_t mid = low + (high - low) / 2;
+        uint32_t unicode = atlas->glyphs[mid].unicode;
+        if (unicode == letter) {
+            return &atlas->glyphs[mid];
+        } else if (unicode < letter) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return NULL;
+}
+
+static void atlas_record_miss(atlas_t *atlas, uint32_t letter) {
+    uint32_t low = 0, high = atlas->num_misses;
+    while (low < high) {
+        uint32_t mid = low + (high - low) / 2;
+        if (atlas->misses[mid] == letter) {
+            return;
+        } else if (atlas->misses[mid] < letter) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    if (atlas->num_glyphs + atlas->num_misses >= ATLAS_MAX_GLYPHS) {
+        return;
+    }
+    if (atlas->num_misses == atlas->cap_misses) {
+        uint32_t capacity = atlas->cap_misses ? atlas->cap_misses * 2 : 64;
+        uint32_t *misses = realloc(atlas->misses, capacity * sizeof(uint32_t));
+        if (misses == NULL) {
+            return;
+        }
+        atlas->misses = misses;
+        atlas->cap_misses = capacity;
+    }
+    memmove(&atlas->misses[low + 1], &atlas->misses[low], (atlas->num_misses - low) * sizeof(uint32_t));
+    atlas->misses[low] = letter;
+    atlas->num_misses++;
+}
+
+/**
+ * Rasterize missed glyphs with base font, and serve them from the atlas from now on.
+ */
+static bool atlas_add_misses(atlas_t *atlas) {
+    lv_font_t *base = atlas->base;
+    uint32_t capacity = atlas->num_glyphs + atlas->num_misses;
+    if (capacity > ATLAS_MAX_GLYPHS) {
+        capacity = ATLAS_MAX_GLYPHS;
+    }
+    atlas_glyph_t *glyphs = malloc(capacity * sizeof(atlas_glyph_t));
+    if (glyphs == NULL) {
+        return false;
+    }
+    uint32_t num_glyphs = atlas->num_glyphs, bitmap_size = atlas->bitmap_size;
+    // Keep glyphs already in atlas, then add new ones as long as there's room
+    if (num_glyphs > 0) {
+        memcpy(glyphs, atlas->glyphs, num_glyphs * sizeof(atlas_glyph_t));
+    }
+    uint32_t first_miss = num_glyphs;
+    for (uint32_t i = 0; i < atlas->num_misses && num_glyphs < capacity; i++) {
+        lv_font_glyph_dsc_t dsc;
+        memset(&dsc, 0, sizeof(dsc));
+        if (!base->get_glyph_dsc(base, &dsc, atlas->misses[i], 0)) {
+            continue;
+        }
+        atlas_glyph_t *glyph = &glyphs[num_glyphs++];
+        glyph->unicode = atlas->misses[i];
+        glyph->bitmap_offset = bitmap_size;
+        glyph->adv_w = dsc.adv_w;
+        glyph->box_w = dsc.box_w;
+        glyph->box_h = dsc.box_h;
+        glyph->ofs_x = dsc.ofs_x;
+        glyph->ofs_y = dsc.ofs_y;
+        glyph->bpp = dsc.bpp;
+        glyph->reserved = 0;
+        bitmap_size += bitmap_size_of(glyph->box_w, glyph->box_h, glyph->bpp);
+    }
+    uint8_t *bitmaps = malloc(bitmap_size ? bitmap_size : 1);
+    if (bitmaps == NULL) {
+        free(glyphs);
+        return false;
+    }
+    if (atlas->bitmap_size > 0) {
+        memcpy(bitmaps, atlas->bitmaps, atlas->bitmap_size);
+    }
+    for (uint32_t i = first_miss; i < num_glyphs; i++) {
+        atlas_glyph_t *glyph = &glyphs[i];
+        uint32_t size = bitmap_size_of(glyph->box_w, glyph->box_h, glyph->bpp);
+        if (size == 0) {
+            continue;
+        }
+        // Base font may only keep the last rasterized bitmap, so get it right before copying
+        const uint8_t *bitmap = base->get_glyph_bitmap(base, glyph->unicode);
+        if (bitmap != NULL) {
+            memcpy(bitmaps + glyph->bitmap_offset, bitmap, size);
+        } else {
+            memset(bitmaps + glyph->bitmap_offset, 0, size);
+        }
+    }
+    qsort(glyphs, num_glyphs, sizeof(atlas_glyph_t), glyph_compare);
+    atlas_unload(atlas);
+    atlas->glyphs = glyphs;
+    atlas->num_glyphs = num_glyphs;
+    atlas->bitmaps = bitmaps;
+    atlas->bitmap_size = bitmap_size;
+    atlas->num_misses = 0;
+    return true;
+}
+
+static uint32_t bitmap_size_of(uint16_t box_w, uint16_t box_h, uint8_t bpp) {
+    return ((uint32_t) box_w * box_h * bpp + 7) / 8;
+}
+
+static int glyph_compare(const void *a, const void *b) {
+    uint32_t ua = ((const atlas_glyph_t *) a)->unicode, ub = ((const atlas_glyph_t *) b)->unicode;
+    return ua < ub ? -1 : ua > ub;
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "lvgl.h"
+
+/**
+ * Font serving pre-rasterized glyphs from an atlas file, and everything else from its base font. Glyphs drawn from the
+ * base font are added to the atlas when it's saved, so next time they can be drawn without rasterizing.
+ */
+
+typedef struct lv_font_atlas_stats_t {
+    /* Glyphs loaded from atlas file */
+    uint32_t glyphs;
+    /* Glyph lookups served from atlas, and ones needed the base font */
+    uint32_t hits, misses;
+} lv_font_atlas_stats_t;
+
+/**
+ * Copy of an atlas to be written to its file, so writing can be done on another thread.
+ */
+typedef struct lv_font_atlas_snapshot_t lv_font_atlas_snapshot_t;
+
+/**
+ * @param base Font to rasterize glyphs not in atlas. Not owned by the atlas font.
+ * @param path Atlas file, doesn't need to exist
+ * @param id Identifies base font and its size, atlas file made for a different font will be ignored
+ * @return Font to use in place of base
+ */
+lv_font_t *lv_font_atlas_create(lv_font_t *base, const char *path, const char *id);
+
+void lv_font_atlas_destroy(lv_font_t *font);
+
+bool lv_font_atlas_is_atlas(const lv_font_t *font);
+
+lv_font_t *lv_font_atlas_get_base(const lv_font_t *font);
+
+/**
+ * Write atlas file if any glyph has been rasterized by base font since it was loaded.
+ * @return false if failed to write
+ */
+bool lv_font_atlas_save(lv_font_t *font);
+
+/**
+ * Add glyphs rasterized by base font since last save to the atlas, and copy it for writing. Base font is used, so
+ * call it from the thread drawing with the font.
+ * @return NULL if there's nothing new to write, or failed to allocate
+ */
+lv_font_atlas_snapshot_t *lv_font_atlas_snapshot(lv_font_t *font);
+
+/**
+ * Write the snapshot to its atlas file. Can be called from any thread, but not for two snapshots of the same atlas at
+ * the same time.
+ * @return false if failed to write
+ */
+bool lv_font_atlas_snapshot_write(const lv_font_atlas_snapshot_t *snapshot);
+
+void lv_font_atlas_snapshot_free(lv_font_atlas_snapshot_t *snapshot);
+
+void lv_font_atlas_get_stats(const lv_font_t *font, lv_font_atlas_stats_t *stats);
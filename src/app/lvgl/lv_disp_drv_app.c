@@ -3,25 +3,47 @@
 
 #include "draw/sdl/lv_draw_sdl.h"
 
+typedef struct lv_app_disp_drv_data_t {
+    /* Must be the first member, other code casts driver->user_data to lv_draw_sdl_drv_param_t */
+    lv_draw_sdl_drv_param_t param;
+    /* Union of areas flushed in current refresh */
+    lv_area_t dirty;
+    bool dirty_valid;
+    /* Renderer keeps backbuffer content after present, so we can update only the dirty area */
+    bool partial_present;
+    lv_app_disp_stats_t stats;
+} lv_app_disp_drv_data_t;
+
 static void lv_sdl_drv_fb_flush(lv_disp_drv_t *disp_drv, const lv_area_t *area, lv_color_t *src);
 
 static void lv_sdl_drv_fb_clear(lv_disp_drv_t *disp_drv, uint8_t *buf, uint32_t size);
 
+static void present_area(lv_disp_drv_t *disp_drv, const lv_area_t *area);
+
 lv_disp_drv_t *lv_app_disp_drv_create(SDL_Window *window, int dpi) {
     int width = 0, height = 0;
     SDL_GetWindowSize(window, &width, &height);
     LV_ASSERT(width > 0 && height > 0);
     SDL_SetHint(SDL_HINT_RENDER_SCALE_QUALITY, "1");
     SDL_Renderer *renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED);
+    if (renderer == NULL) {
+        renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_SOFTWARE);
+    }
+    LV_ASSERT(renderer != NULL);
     lv_disp_draw_buf_t *draw_buf = lv_mem_alloc(sizeof(lv_disp_draw_buf_t));
     SDL_Texture *texture = lv_draw_sdl_create_screen_texture(renderer, width, height);
     lv_disp_draw_buf_init(draw_buf, texture, NULL, width * height);
     lv_disp_drv_t *driver = lv_mem_alloc(sizeof(lv_disp_drv_t));
     lv_disp_drv_init(driver);
 
-    lv_draw_sdl_drv_param_t *param = lv_mem_alloc(sizeof(lv_draw_sdl_drv_param_t));
-    param->renderer = renderer;
-    driver->user_data = param;
+    lv_app_disp_drv_data_t *data = lv_mem_alloc(sizeof(lv_app_disp_drv_data_t));
+    lv_memset_00(data, sizeof(lv_app_disp_drv_data_t));
+    data->param.renderer = renderer;
+    SDL_RendererInfo info;
+    if (SDL_GetRendererInfo(renderer, &info) == 0) {
+        data->partial_present = (info.flags & SDL_RENDERER_SOFTWARE) != 0;
+    }
+    driver->user_data = data;
     driver->draw_buf = draw_buf;
     driver->dpi = dpi;
     driver->flush_cb = lv_sdl_drv_fb_flush;
@@ -36,9 +58,9 @@ void lv_app_disp_drv_deinit(lv_disp_drv_t *driver) {
     SDL_DestroyTexture(driver->draw_buf->buf1);
     lv_mem_free(driver->draw_buf);
 
-    lv_draw_sdl_drv_param_t *param = driver->user_data;
-    SDL_Renderer *renderer = param->renderer;
-    lv_mem_free(param);
+    lv_app_disp_drv_data_t *data = driver->user_data;
+    SDL_Renderer *renderer = data->param.renderer;
+    lv_mem_free(data);
 
     driver->draw_ctx_deinit(driver, driver->draw_ctx);
 
@@ -67,36 +89,35 @@ void lv_app_display_resize(lv_disp_t *disp, int width, int height) {
 }
 
 void lv_app_redraw_now(lv_disp_drv_t *disp_drv) {
-    lv_draw_sdl_drv_param_t *param = disp_drv->user_data;
-    SDL_Renderer *renderer = param->renderer;
-    SDL_Texture *texture = disp_drv->draw_buf->buf1;
-    SDL_SetRenderTarget(renderer, NULL);
-    if (!ui_render_background()) {
-        bool has_renderer = false;
-        if (has_renderer) {
-            SDL_SetRenderDrawColor(renderer, 0, 0, 0, 0xFF);
-            SDL_RenderFillRect(renderer, NULL);
-        } else {
-            SDL_SetRenderDrawColor(renderer, 0, 0, 0, 0);
-            SDL_RenderClear(renderer);
-        }
-    }
-    SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
-    SDL_RenderCopy(renderer, texture, NULL, NULL);
-    SDL_RenderPresent(renderer);
-    SDL_SetRenderTarget(renderer, texture);
+    present_area(disp_drv, NULL);
+}
+
+void lv_app_disp_drv_get_stats(const lv_disp_drv_t *driver, lv_app_disp_stats_t *stats) {
+    const lv_app_disp_drv_data_t *data = driver->user_data;
+    *stats = data->stats;
 }
 
 static void lv_sdl_drv_fb_flush(lv_disp_drv_t *disp_drv, const lv_area_t *area, lv_color_t *src) {
     LV_UNUSED(src);
-    if (area->x2 < 0 || area->y2 < 0 ||
-        area->x1 > disp_drv->hor_res - 1 || area->y1 > disp_drv->ver_res - 1) {
-        lv_disp_flush_ready(disp_drv);
-        return;
+    lv_app_disp_drv_data_t *data = disp_drv->user_data;
+    lv_area_t screen = {0, 0, (lv_coord_t) (disp_drv->hor_res - 1), (lv_coord_t) (disp_drv->ver_res - 1)};
+    lv_area_t visible;
+    if (_lv_area_intersect(&visible, area, &screen)) {
+        if (data->dirty_valid) {
+            _lv_area_join(&data->dirty, &data->dirty, &visible);
+        } else {
+            data->dirty = visible;
+            data->dirty_valid = true;
+        }
     }
 
     if (lv_disp_flush_is_last(disp_drv)) {
-        lv_app_redraw_now(disp_drv);
+        if (data->dirty_valid) {
+            present_area(disp_drv, &data->dirty);
+            data->dirty_valid = false;
+        } else {
+            data->stats.skipped++;
+        }
     }
     lv_disp_flush_ready(disp_drv);
 }
@@ -104,3 +125,50 @@ static void lv_sdl_drv_fb_flush(lv_disp_drv_t *disp_drv, const lv_area_t *area,
 static void lv_sdl_drv_fb_clear(lv_disp_drv_t *disp_drv, uint8_t *buf, uint32_t size) {
     // No-op
 }
+
+/**
+ * @param area Area to present, or NULL to present the whole screen
+ */
+static void present_area(lv_disp_drv_t *disp_drv, const lv_area_t *area) {
+    lv_app_disp_drv_data_t *data = disp_drv->user_data;
+    SDL_Renderer *renderer = data->param.renderer;
+    SDL_Texture *texture = disp_drv->draw_buf->buf1;
+    SDL_SetRenderTarget(renderer, NULL);
+
+    bool partial = area != NULL && data->partial_present;
+    if (partial) {
+        // Output may be scaled for high DPI windows, partial coordinates only work when it's 1:1
+        int output_w = 0, output_h = 0;
+        SDL_GetRendererOutputSize(renderer, &output_w, &output_h);
+        partial = output_w == disp_drv->hor_res && output_h == disp_drv->ver_res;
+    }
+    if (partial && ui_has_stream_renderer()) {
+        // Stream renderer draws the background of whole screen
+        partial = false;
+    }
+
+    SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
+    if (partial) {
+        SDL_Rect rect = {area->x1, area->y1, lv_area_get_width(area), lv_area_get_height(area)};
+        SDL_BlendMode blend_mode;
+        SDL_GetRenderDrawBlendMode(renderer, &blend_mode);
+        // SDL_RenderClear ignores clip rect, so fill the area without blending instead
+        SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_NONE);
+        SDL_SetRenderDrawColor(renderer, 0, 0, 0, 0);
+        SDL_RenderFillRect(renderer, &rect);
+        SDL_SetRenderDrawBlendMode(renderer, blend_mode);
+        SDL_RenderCopy(renderer, texture, &rect, &rect);
+        data->stats.partial++;
+        data->stats.presented_pixels += (uint64_t) rect.w * rect.h;
+    } else {
+        if (!ui_render_background()) {
+            SDL_SetRenderDrawColor(renderer, 0, 0, 0, 0);
+            SDL_RenderClear(renderer);
+        }
+        SDL_RenderCopy(renderer, texture, NULL, NULL);
+        data->stats.presented_pixels += (uint64_t) disp_drv->hor_res * disp_drv->ver_res;
+    }
+    SDL_RenderPresent(renderer);
+    SDL_SetRenderTarget(renderer, texture);
+    data->stats.presented++;
+}
@@ -3,6 +3,14 @@
 #include "lvgl.h"
 #include <SDL.h>
 
+typedef struct lv_app_disp_stats_t {
+    /* Number of frames presented, and how many of them only updated the dirty area */
+    uint32_t presented, partial;
+    /* Number of refreshes didn't need presenting, as nothing visible changed */
+    uint32_t skipped;
+    uint64_t presented_pixels;
+} lv_app_disp_stats_t;
+
 lv_disp_drv_t *lv_app_disp_drv_create(SDL_Window *window, int dpi);
 
 void lv_app_disp_drv_deinit(lv_disp_drv_t *driver);
@@ -11,3 +19,4 @@ void lv_app_display_resize(lv_disp_t *disp, int width, int height);
 
 void lv_app_redraw_now(lv_disp_drv_t *disp_drv);
 
+void lv_app_disp_drv_get_stats(const lv_disp_drv_t *driver, lv_app_disp_stats_t *stats);
@@ -0,0 +1,430 @@
+#include "lv_mem_app.h"
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <SDL.h>
+
+#define SLAB_SIZE (16 * 1024)
+#define ARENA_STACK_MAX 8
+
+typedef struct slab_t slab_t;
+
+/* Block sizes including header, all multiples of header size */
+static const uint16_t class_sizes[] = {32, 48, 64, 80, 96, 128, 160, 192, 256, 320, 384, 448, 512};
+#define NUM_CLASSES (sizeof(class_sizes) / sizeof(class_sizes[0]))
+
+typedef struct pool_t {
+    /* Slabs with free blocks, by size class */
+    slab_t *partial[NUM_CLASSES];
+    /* Every slab owned by this pool */
+    slab_t *slabs;
+    size_t live;
+    /* Arena this pool belongs to, NULL for the shared pool */
+    struct lv_mem_app_arena_t *arena;
+} pool_t;
+
+struct lv_mem_app_arena_t {
+    pool_t pool;
+    const char *name;
+    bool released;
+};
+
+typedef union block_header_t {
+    struct {
+        /* NULL for large blocks */
+        slab_t *slab;
+        uint32_t size;
+    };
+    max_align_t align;
+} block_header_t;
+
+/* A free block stores the next free block where the header was */
+typedef union free_block_t {
+    union free_block_t *next;
+    block_header_t header;
+} free_block_t;
+
+struct slab_t {
+    pool_t *pool;
+    slab_t *prev, *next;
+    slab_t *prev_partial, *next_partial;
+    free_block_t *free_list;
+    uint8_t *blocks;
+    uint16_t cls, capacity, carved, live;
+    bool in_partial;
+};
+
+static SDL_SpinLock lock = 0;
+static pool_t shared_pool;
+static lv_mem_app_arena_t *arena_stack[ARENA_STACK_MAX];
+static int arena_depth = 0;
+static SDL_threadID arena_thread = 0;
+static struct {
+    size_t used, peak_used;
+    size_t slab_used;
+    size_t slab_bytes, peak_slab_bytes;
+    size_t large_bytes;
+    uint32_t slabs;
+    uint64_t allocs, frees;
+    uint32_t arenas, arenas_draining;
+} stats;
+
+static int size_class(size_t size);
+
+static pool_t *current_pool();
+
+static void *slab_alloc(pool_t *pool, int cls, size_t size);
+
+static void slab_free(block_header_t *header);
+
+static slab_t *slab_new(pool_t *pool, int cls);
+
+static void slab_destroy(slab_t *slab);
+
+static void partial_add(slab_t *slab);
+
+static void partial_remove(slab_t *slab);
+
+static bool pool_has_empty_slab(const pool_t *pool, int cls, const slab_t *except);
+
+static void arena_destroy(lv_mem_app_arena_t *arena);
+
+static void stats_used_add(size_t size, bool slab);
+
+static void stats_used_sub(size_t size, bool slab);
+
+void *lv_mem_app_alloc(size_t size) {
+    if (size == 0) {
+        size = 1;
+    }
+    int cls = size_class(size);
+    if (cls < 0) {
+        block_header_t *header = malloc(sizeof(block_header_t) + size);
+        if (header == NULL) {
+            return NULL;
+        }
+        header->slab = NULL;
+        header->size = (uint32_t) size;
+        SDL_AtomicLock(&lock);
+        stats.large_bytes += size;
+        stats.allocs++;
+        stats_used_add(size, false);
+        SDL_AtomicUnlock(&lock);
+        return header + 1;
+    }
+    SDL_AtomicLock(&lock);
+    void *ptr = slab_alloc(current_pool(), cls, size);
+    SDL_AtomicUnlock(&lock);
+    return ptr;
+}
+
+void lv_mem_app_free(void *ptr) {
+    if (ptr == NULL) {
+        return;
+    }
+    block_header_t *header = ((block_header_t *) ptr) - 1;
+    SDL_AtomicLock(&lock);
+    stats.frees++;
+    if (header->slab == NULL) {
+        stats.large_bytes -= header->size;
+        stats_used_sub(header->size, false);
+        SDL_AtomicUnlock(&lock);
+        free(header);
+        return;
+    }
+    slab_free(header);
+    SDL_AtomicUnlock(&lock);
+}
+
+void *lv_mem_app_realloc(void *ptr, size_t size) {
+    if (ptr == NULL) {
+        return lv_mem_app_alloc(size);
+    }
+    if (size == 0) {
+        size = 1;
+    }
+    block_header_t *header = ((block_header_t *) ptr) - 1;
+    int cls = size_class(size);
+    if (header->slab == NULL && cls < 0) {
+        size_t old_size = header->size;
+        block_header_t *resized = realloc(header, sizeof(block_header_t) + size);
+        if (resized == NULL) {
+            return NULL;
+        }
+        resized->size = (uint32_t) size;
+        SDL_AtomicLock(&lock);
+        stats.large_bytes = stats.large_bytes - old_size + size;
+        stats_used_sub(old_size, false);
+        stats_used_add(size, false);
+        SDL_AtomicUnlock(&lock);
+        return resized + 1;
+    }
+    if (header->slab != NULL && cls == header->slab->cls) {
+        // Still fits in the same block
+        SDL_AtomicLock(&lock);
+        stats_used_sub(header->size, true);
+        stats_used_add(size, true);
+        SDL_AtomicUnlock(&lock);
+        header->size = (uint32_t) size;
+        return ptr;
+    }
+    void *moved = lv_mem_app_alloc(size);
+    if (moved == NULL) {
+        return NULL;
+    }
+    memcpy(moved, ptr, header->size < size ? header->size : size);
+    lv_mem_app_free(ptr);
+    return moved;
+}
+
+void lv_mem_app_get_stats(lv_mem_app_stats_t *out) {
+    SDL_AtomicLock(&lock);
+    out->used = stats.used;
+    out->peak_used = stats.peak_used;
+    out->slab_bytes = stats.slab_bytes;
+    out->peak_slab_bytes = stats.peak_slab_bytes;
+    out->large_bytes = stats.large_bytes;
+    out->slabs = stats.slabs;
+    out->allocs = stats.allocs;
+    out->frees = stats.frees;
+    out->frag_pct = stats.slab_bytes ? (uint8_t) (100 - stats.slab_used * 100 / stats.slab_bytes) : 0;
+    out->arenas = stats.arenas;
+    out->arenas_draining = stats.arenas_draining;
+    SDL_AtomicUnlock(&lock);
+}
+
+lv_mem_app_arena_t *lv_mem_app_arena_create(const char *name) {
+    lv_mem_app_arena_t *arena = calloc(1, sizeof(lv_mem_app_arena_t));
+    if (arena == NULL) {
+        return NULL;
+    }
+    arena->pool.arena = arena;
+    arena->name = name;
+    SDL_AtomicLock(&lock);
+    stats.arenas++;
+    SDL_AtomicUnlock(&lock);
+    return arena;
+}
+
+void lv_mem_app_arena_push(lv_mem_app_arena_t *arena) {
+    SDL_AtomicLock(&lock);
+    assert(arena_depth == 0 || arena_thread == SDL_ThreadID());
+    assert(arena_depth < ARENA_STACK_MAX);
+    assert(!arena->released);
+    arena_thread = SDL_ThreadID();
+    arena_stack[arena_depth++] = arena;
+    SDL_AtomicUnlock(&lock);
+}
+
+void lv_mem_app_arena_pop(lv_mem_app_arena_t *arena) {
+    SDL_AtomicLock(&lock);
+    assert(arena_depth > 0 && arena_stack[arena_depth - 1] == arena);
+    (void) arena;
+    arena_stack[--arena_depth] = NULL;
+    SDL_AtomicUnlock(&lock);
+}
+
+void lv_mem_app_arena_release(lv_mem_app_arena_t *arena) {
+    if (arena == NULL) {
+        return;
+    }
+    SDL_AtomicLock(&lock);
+    assert(!arena->released);
+    arena->released = true;
+    stats.arenas--;
+    if (arena->pool.live == 0) {
+        arena_destroy(arena);
+        SDL_AtomicUnlock(&lock);
+        return;
+    }
+    // Empty slabs won't be used again
+    slab_t *slab = arena->pool.slabs;
+    while (slab != NULL) {
+        slab_t *next = slab->next;
+        if (slab->live == 0) {
+            slab_destroy(slab);
+        }
+        slab = next;
+    }
+    stats.arenas_draining++;
+    SDL_AtomicUnlock(&lock);
+}
+
+static int size_class(size_t size) {
+    size_t block_size = sizeof(block_header_t) + size;
+    for (int i = 0; i < (int) NUM_CLASSES; i++) {
+        if (block_size <= class_sizes[i]) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static pool_t *current_pool() {
+    if (arena_depth > 0 && arena_thread == SDL_ThreadID()) {
+        return &arena_stack[arena_depth - 1]->pool;
+    }
+    return &shared_pool;
+}
+
+static void *slab_alloc(pool_t *pool, int cls, size_t size) {
+    slab_t *slab = pool->partial[cls];
+    if (slab == NULL) {
+        slab = slab_new(pool, cls);
+        if (slab == NULL) {
+            return NULL;
+        }
+    }
+    block_header_t *header;
+    if (slab->free_list != NULL) {
+        free_block_t *block = slab->free_list;
+        slab->free_list = block->next;
+        header = &block->header;
+    } else {
+        header = (block_header_t *) (slab->blocks + (size_t) slab->carved * class_sizes[cls]);
+        slab->carved++;
+    }
+    slab->live++;
+    pool->live++;
+    if (slab->live == slab->capacity) {
+        partial_remove(slab);
+    }
+    header->slab = slab;
+    header->size = (uint32_t) size;
+    stats.allocs++;
+    stats_used_add(size, true);
+    return header + 1;
+}
+
+static void slab_free(block_header_t *header) {
+    slab_t *slab = header->slab;
+    pool_t *pool = slab->pool;
+    stats_used_sub(header->size, true);
+    free_block_t *block = (free_block_t *) header;
+    block->next = slab->free_list;
+    slab->free_list = block;
+    slab->live--;
+    pool->live--;
+    lv_mem_app_arena_t *arena = pool->arena;
+    if (arena != NULL && arena->released) {
+        if (pool->live == 0) {
+            stats.arenas_draining--;
+            arena_destroy(arena);
+        } else if (slab->live == 0) {
+            slab_destroy(slab);
+        }
+        return;
+    }
+    if (!slab->in_partial) {
+        partial_add(slab);
+    }
+    // Keep one empty slab per class in the shared pool, so alloc/free around the boundary doesn't hit malloc every time
+    if (slab->live == 0 && arena == NULL && pool_has_empty_slab(pool, slab->cls, slab)) {
+        slab_destroy(slab);
+    }
+}
+
+static slab_t *slab_new(pool_t *pool, int cls) {
+    size_t header_size = (sizeof(slab_t) + sizeof(block_header_t) - 1) / sizeof(block_header_t) *
+                         sizeof(block_header_t);
+    slab_t *slab = malloc(SLAB_SIZE);
+    if (slab == NULL) {
+        return NULL;
+    }
+    memset(slab, 0, sizeof(slab_t));
+    slab->pool = pool;
+    slab->cls = (uint16_t) cls;
+    slab->blocks = (uint8_t *) slab + header_size;
+    slab->capacity = (uint16_t) ((SLAB_SIZE - header_size) / class_sizes[cls]);
+    slab->next = pool->slabs;
+    if (pool->slabs != NULL) {
+        pool->slabs->prev = slab;
+    }
+    pool->slabs = slab;
+    partial_add(slab);
+    stats.slabs++;
+    stats.slab_bytes += SLAB_SIZE;
+    if (stats.slab_bytes > stats.peak_slab_bytes) {
+        stats.peak_slab_bytes = stats.slab_bytes;
+    }
+    return slab;
+}
+
+static void slab_destroy(slab_t *slab) {
+    pool_t *pool = slab->pool;
+    if (slab->in_partial) {
+        partial_remove(slab);
+    }
+    if (slab->prev != NULL) {
+        slab->prev->next = slab->next;
+    } else {
+        pool->slabs = slab->next;
+    }
+    if (slab->next != NULL) {
+        slab->next->prev = slab->prev;
+    }
+    stats.slabs--;
+    stats.slab_bytes -= SLAB_SIZE;
+    free(slab);
+}
+
+static void partial_add(slab_t *slab) {
+    pool_t *pool = slab->pool;
+    slab->prev_partial = NULL;
+    slab->next_partial = pool->partial[slab->cls];
+    if (slab->next_partial != NULL) {
+        slab->next_partial->prev_partial = slab;
+    }
+    pool->partial[slab->cls] = slab;
+    slab->in_partial = true;
+}
+
+static void partial_remove(slab_t *slab) {
+    pool_t *pool = slab->pool;
+    if (slab->prev_partial != NULL) {
+        slab->prev_partial->next_partial = slab->next_partial;
+    } else {
+        pool->partial[slab->cls] = slab->next_partial;
+    }
+    if (slab->next_partial != NULL) {
+        slab->next_partial->prev_partial = slab->prev_partial;
+    }
+    slab->prev_partial = slab->next_partial = NULL;
+    slab->in_partial = false;
+}
+
+static bool pool_has_empty_slab(const pool_t *pool, int cls, const slab_t *except) {
+    for (const slab_t *slab = pool->partial[cls]; slab != NULL; slab = slab->next_partial) {
+        if (slab != except && slab->live == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void arena_destroy(lv_mem_app_arena_t *arena) {
+    while (arena->pool.slabs != NULL) {
+        slab_destroy(arena->pool.slabs);
+    }
+    free(arena);
+}
+
+static void stats_used_add(size_t size, bool slab) {
+    stats.used += size;
+    if (slab) {
+        stats.slab_used += size;
+    }
+    if (stats.used > stats.peak_used) {
+        stats.peak_used = stats.used;
+    }
+}
+
+static void stats_used_sub(size_t size, bool slab) {
+    stats.used -= size;
+    if (slab) {
+        stats.slab_used -= size;
+    }
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Memory backend for LVGL. Small blocks come from size-class slabs, so creating and deleting lots of objects doesn't
+ * leave holes all over the heap. Large blocks go to malloc directly.
+ */
+
+typedef struct lv_mem_app_stats_t {
+    /* Bytes requested by live allocations, and the highest it has been */
+    size_t used, peak_used;
+    /* Bytes held by slabs, and the highest it has been */
+    size_t slab_bytes, peak_slab_bytes;
+    /* Bytes of allocations too large for slabs */
+    size_t large_bytes;
+    uint32_t slabs;
+    uint64_t allocs, frees;
+    /* Percentage of slab bytes not used by live allocations */
+    uint8_t frag_pct;
+    /* Arenas not released yet, and released ones still waiting for their blocks to be freed */
+    uint32_t arenas, arenas_draining;
+} lv_mem_app_stats_t;
+
+typedef struct lv_mem_app_arena_t lv_mem_app_arena_t;
+
+void *lv_mem_app_alloc(size_t size);
+
+void lv_mem_app_free(void *ptr);
+
+void *lv_mem_app_realloc(void *ptr, size_t size);
+
+void lv_mem_app_get_stats(lv_mem_app_stats_t *stats);
+
+/**
+ * Create an arena with its own slabs. Blocks allocated while it's pushed stay in these slabs, so a view tree doesn't
+ * get mixed with long living objects, and all of its memory can be given back at once.
+ * @param name For debugging, not copied
+ */
+lv_mem_app_arena_t *lv_mem_app_arena_create(const char *name);
+
+/**
+ * Make small allocations from the calling thread go to this arena, until it's popped.
+ */
+void lv_mem_app_arena_push(lv_mem_app_arena_t *arena);
+
+void lv_mem_app_arena_pop(lv_mem_app_arena_t *arena);
+
+/**
+ * No more allocations will be made from this arena. Its slabs are freed as soon as they become empty, and the arena
+ * itself is freed after its last block.
+ */
+void lv_mem_app_arena_release(lv_mem_app_arena_t *arena);
@@ -17,9 +17,34 @@
 
 #define TV_REMOTE_TOGGLE_SOFT_INPUT 0
 
+bool stream_input_webos_handle_ui_keys(stream_input_t *input, const SDL_Event *event) {
+    if (event->type != SDL_KEYDOWN && event->type != SDL_KEYUP) {
+        return false;
+    }
+    app_t *app = input->session->app;
+    const SDL_KeyboardEvent *key = &event->key;
+    switch ((unsigned int) key->keysym.scancode) {
+        case SDL_SCANCODE_WEBOS_HOME: {
+            if (key->state == SDL_RELEASED) {
+                app_webos_open_ribbon();
+            }
+            return true;
+        }
+        case SDL_SCANCODE_WEBOS_YELLOW: {
+            // Right click in pointer mode, otherwise it's sent as a key on the sender thread
+            if (input->view_only || !(app_ui_get_input_mode(&app->ui.input) & UI_INPUT_MODE_POINTER_FLAG)) {
+                return false;
+            }
+            LiSendMouseButtonEvent(key->type == SDL_KEYDOWN ? BUTTON_ACTION_PRESS : BUTTON_ACTION_RELEASE,
+                                   BUTTON_RIGHT);
+            return true;
+        }
+        default:
+            return false;
+    }
+}
+
 bool stream_input_webos_intercept_remote_keys(stream_input_t *input, const SDL_KeyboardEvent *event, short *keyCode) {
-    session_t *session = input->session;
-    app_t *app = session->app;
     switch ((unsigned int) event->keysym.scancode) {
         case SDL_SCANCODE_WEBOS_EXIT: {
             if (event->state == SDL_PRESSED) {
@@ -27,12 +52,6 @@ bool stream_input_webos_intercept_remote_keys(stream_input_t *input, const SDL_K
             }
             return true;
         }
-        case SDL_SCANCODE_WEBOS_HOME: {
-            if (event->state == SDL_RELEASED) {
-                app_webos_open_ribbon();
-            }
-            return true;
-        }
         case SDL_SCANCODE_WEBOS_BACK:
             *keyCode = VK_ESCAPE /* SDL_SCANCODE_ESCAPE */;
             return false;
@@ -46,14 +65,9 @@ bool stream_input_webos_intercept_remote_keys(stream_input_t *input, const SDL_K
             if (input->view_only) {
                 return true;
             }
-            if (app_ui_get_input_mode(&app->ui.input) & UI_INPUT_MODE_POINTER_FLAG) {
-                LiSendMouseButtonEvent(event->type == SDL_KEYDOWN ? BUTTON_ACTION_PRESS : BUTTON_ACTION_RELEASE,
-                                       BUTTON_RIGHT);
-                return true;
-            } else {
-                *keyCode = VK_MENU;
-                return false;
-            }
+            // Pointer mode is handled by stream_input_webos_handle_ui_keys before the event is queued
+            *keyCode = VK_MENU;
+            return false;
 #if TV_REMOTE_TOGGLE_SOFT_INPUT
             case SDL_SCANCODE_WEBOS_BLUE:
                 if (absinput_no_control) return true;
@@ -65,7 +79,7 @@ bool stream_input_webos_intercept_remote_keys(stream_input_t *input, const SDL_K
                 return true;
             case SDL_SCANCODE_WEBOS_GREEN:
                 if (absinput_no_control) return true;
-                session_toggle_vmouse(session);
+                app_bus_post(input->session->app, (bus_actionfunc) session_toggle_vmouse, input->session);
                 return true;
 #endif
         default:
@@ -6,7 +6,9 @@
 #include "ss4s.h"
 #include "stream/connection/session_connection.h"
 #include "stream/session_priv.h"
+#include "stream/session_timeline.h"
 #include "logging.h"
+#include "util/metrics.h"
 
 #define SAMPLES_PER_FRAME  240
 
@@ -18,10 +20,26 @@ static int frame_size = 0, unit_size = 0;
 
 AUDIO_INFO audio_stream_info;
 
+METRICS_COUNTER(audio_frames, "audio.frames");
+METRICS_COUNTER(audio_bytes, "audio.bytes");
+METRICS_COUNTER(audio_decode_errors, "audio.decode_errors");
+METRICS_HISTOGRAM(audio_feed_time, "audio.feed_us");
+
 static size_t opus_head_serialize(const OPUS_MULTISTREAM_CONFIGURATION *config, unsigned char *data);
 
+static int aud_setup(int audioConfiguration, const POPUS_MULTISTREAM_CONFIGURATION opusConfig, void *context,
+                     int arFlags);
+
 static int aud_init(int audioConfiguration, const POPUS_MULTISTREAM_CONFIGURATION opusConfig, void *context,
                     int arFlags) {
+    session_timeline_begin(&session_timeline.audio_setup);
+    int ret = aud_setup(audioConfiguration, opusConfig, context, arFlags);
+    session_timeline_end(&session_timeline.audio_setup);
+    return ret;
+}
+
+static int aud_setup(int audioConfiguration, const POPUS_MULTISTREAM_CONFIGURATION opusConfig, void *context,
+                     int arFlags) {
     (void) audioConfiguration;
     (void) arFlags;
     memset(&audio_stream_info, 0, sizeof(audio_stream_info));
@@ -77,13 +95,23 @@ static void aud_cleanup() {
 }
 
 static void aud_feed(char *sampleData, int sampleLength) {
+    Uint64 feed_start = SDL_GetPerformanceCounter();
+    metrics_count(&audio_frames, 1);
+    metrics_count(&audio_bytes, sampleLength);
     if (decoder != NULL) {
         int decode_len = opus_multistream_decode(decoder, (unsigned char *) sampleData, sampleLength,
                                                  (opus_int16 *) buffer, frame_size, 0);
+        if (decode_len < 0) {
+            metrics_count(&audio_decode_errors, 1);
+            return;
+        }
         SS4S_PlayerAudioFeed(player, buffer, unit_size * decode_len);
     } else {
         SS4S_PlayerAudioFeed(player, (unsigned char *) sampleData, sampleLength);
     }
+    // Includes decoding when it's done here
+    metrics_observe(&audio_feed_time,
+                    (SDL_GetPerformanceCounter() - feed_start) * 1000000 / SDL_GetPerformanceFrequency());
 }
 
 static size_t opus_head_serialize(const OPUS_MULTISTREAM_CONFIGURATION *config, unsigned char *data) {
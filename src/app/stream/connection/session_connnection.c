@@ -3,9 +3,12 @@
 
 #include "util/i18n.h"
 #include "logging.h"
+#include "util/async_log.h"
 #include "input/input_gamepad.h"
 #include "app.h"
+#include "util/bus.h"
 #include "stream/session_priv.h"
+#include "stream/session_timeline.h"
 
 static session_t *current_session = NULL;
 
@@ -13,7 +16,7 @@ static void connection_terminated(int errorCode) {
     if (errorCode == ML_ERROR_GRACEFUL_TERMINATION) {
         session_interrupt(current_session, false, STREAMING_INTERRUPT_HOST);
     } else {
-        commons_log_error("Session", "Connection terminated, errorCode = 0x%x", errorCode);
+        async_log_error("Session", "Connection terminated, errorCode = 0x%x", errorCode);
         streaming_error(current_session, 0, "Connection terminated, errorCode = 0x%x", errorCode);
         session_interrupt(current_session, false, STREAMING_INTERRUPT_NETWORK);
     }
@@ -22,28 +25,40 @@ static void connection_terminated(int errorCode) {
 static void connection_log_message(const char *format, ...) {
     va_list arglist;
     va_start(arglist, format);
-    commons_log_vprintf(COMMONS_LOG_LEVEL_INFO, "Limelight", format, arglist);
+    async_log_default_vprintf(COMMONS_LOG_LEVEL_INFO, "Limelight", format, arglist);
     va_end(arglist);
 }
 
 static void connection_status_update(int status) {
     switch (status) {
         case CONN_STATUS_OKAY:
-            commons_log_info("Session", "Connection is okay");
-            streaming_notice_show(NULL);
+            async_log_info("Session", "Connection is okay");
+            app_bus_post(global, (bus_actionfunc) streaming_notice_show, NULL);
             break;
         case CONN_STATUS_POOR:
-            commons_log_warn("Session", "Connection is poor");
-            streaming_notice_show(locstr("Unstable connection."));
+            async_log_warn("Session", "Connection is poor");
+            app_bus_post(global, (bus_actionfunc) streaming_notice_show, (void *) locstr("Unstable connection."));
             break;
         default:
             break;
     }
 }
 
+static void connection_stage_starting(int stage) {
+    session_timeline_begin(&session_timeline.stages[stage]);
+}
+
+static void connection_stage_complete(int stage) {
+    session_timeline_end(&session_timeline.stages[stage]);
+}
+
+static void connection_started() {
+    session_timeline_mark(&session_timeline.connection_started);
+}
+
 static void connection_stage_failed(int stage, int errorCode) {
     const char *stageName = LiGetStageName(stage);
-    commons_log_error("Session", "Connection failed at stage %d (%s), errorCode = %d (%s)", stage, stageName, errorCode,
+    async_log_error("Session", "Connection failed at stage %d (%s), errorCode = %d (%s)", stage, stageName, errorCode,
                       strerror(errorCode));
     streaming_error(current_session, errorCode, "Connection failed at stage %d (%s), errorCode = %d (%s)", stage,
                     stageName, errorCode, strerror(errorCode));
@@ -72,10 +87,10 @@ static void connection_set_hdr(bool hdrEnabled) {
 }
 
 CONNECTION_LISTENER_CALLBACKS connection_callbacks = {
-        .stageStarting = NULL,
-        .stageComplete = NULL,
+        .stageStarting = connection_stage_starting,
+        .stageComplete = connection_stage_complete,
         .stageFailed = connection_stage_failed,
-        .connectionStarted = NULL,
+        .connectionStarted = connection_started,
         .connectionTerminated = connection_terminated,
         .logMessage = connection_log_message,
         .rumble = connection_rumble,
@@ -0,0 +1,124 @@
+#include "input_sender.h"
+
+#include <stdlib.h>
+
+#include <SDL_timer.h>
+
+#include "util/metrics.h"
+
+/* Wake up occasionally even without a post, in case the semaphore is missed while stopping */
+#define SENDER_WAIT_MS 100
+
+METRICS_COUNTER(input_dispatched, "input.events");
+METRICS_COUNTER(input_queue_full, "input.queue_full");
+METRICS_GAUGE(input_queue_depth, "input.queue_depth");
+METRICS_HISTOGRAM(input_latency, "input.latency_ms");
+
+static int sender_worker(input_sender_t *sender);
+
+static void sender_dispatch(input_sender_t *sender, const SDL_Event *event);
+
+int input_sender_init(input_sender_t *sender, size_t capacity, input_sender_dispatch_fn dispatch, void *userdata) {
+    SDL_memset(sender, 0, sizeof(*sender));
+    unsigned int size = 2;
+    while (size < capacity) {
+        size <<= 1;
+    }
+    sender->dispatch = dispatch;
+    sender->userdata = userdata;
+    sender->events = calloc(size, sizeof(SDL_Event));
+    if (sender->events == NULL) {
+        return -1;
+    }
+    sender->mask = size - 1;
+    sender->wake = SDL_CreateSemaphore(0);
+    SDL_AtomicSet(&sender->running, 1);
+    sender->thread = SDL_CreateThread((SDL_ThreadFunction) sender_worker, "sessinsend", sender);
+    if (sender->thread == NULL) {
+        SDL_AtomicSet(&sender->running, 0);
+        return -1;
+    }
+    return 0;
+}
+
+void input_sender_deinit(input_sender_t *sender) {
+    if (sender->thread != NULL) {
+        SDL_AtomicSet(&sender->running, 0);
+        SDL_SemPost(sender->wake);
+        SDL_WaitThread(sender->thread, NULL);
+        sender->thread = NULL;
+    }
+    if (sender->wake != NULL) {
+        SDL_DestroySemaphore(sender->wake);
+        sender->wake = NULL;
+    }
+    free(sender->events);
+    sender->events = NULL;
+}
+
+void input_sender_post(input_sender_t *sender, const SDL_Event *event) {
+    if (sender->thread == NULL) {
+        sender_dispatch(sender, event);
+        return;
+    }
+    unsigned int head = (unsigned int) SDL_AtomicGet(&sender->head);
+    if (head - (unsigned int) SDL_AtomicGet(&sender->tail) > sender->mask) {
+        // Dropping input would leave keys or buttons stuck, so wait for the sender instead
+        sender->stats.full++;
+        metrics_count(&input_queue_full, 1);
+        while (head - (unsigned int) SDL_AtomicGet(&sender->tail) > sender->mask) {
+            SDL_Delay(0);
+        }
+    }
+    sender->events[head & sender->mask] = *event;
+    SDL_AtomicSet(&sender->head, (int) (head + 1));
+    metrics_gauge_set(&input_queue_depth, head + 1 - (unsigned int) SDL_AtomicGet(&sender->tail));
+    SDL_SemPost(sender->wake);
+}
+
+void input_sender_flush(input_sender_t *sender) {
+    if (sender->thread == NULL) {
+        return;
+    }
+    while (SDL_AtomicGet(&sender->tail) != SDL_AtomicGet(&sender->head)) {
+        SDL_Delay(1);
+    }
+}
+
+const input_sender_stats_t *input_sender_get_stats(const input_sender_t *sender) {
+    return &sender->stats;
+}
+
+static int sender_worker(input_sender_t *sender) {
+    SDL_SetThreadPriority(SDL_THREAD_PRIORITY_HIGH);
+    for (;;) {
+        unsigned int tail = (unsigned int) SDL_AtomicGet(&sender->tail);
+        if (tail == (unsigned int) SDL_AtomicGet(&sender->head)) {
+            if (!SDL_AtomicGet(&sender->running)) {
+                break;
+            }
+            SDL_SemWaitTimeout(sender->wake, SENDER_WAIT_MS);
+            continue;
+        }
+        sender_dispatch(sender, &sender->events[tail & sender->mask]);
+        // Tail is moved after dispatch, so flush returns only after the last event is fully handled
+        SDL_AtomicSet(&sender->tail, (int) (tail + 1));
+    }
+    return 0;
+}
+
+static void sender_dispatch(input_sender_t *sender, const SDL_Event *event) {
+    Uint32 timestamp = event->common.timestamp;
+    if (timestamp != 0) {
+        Uint32 latency = SDL_GetTicks() - timestamp;
+        sender->stats.latency_samples++;
+        sender->stats.latency_total_ms += latency;
+        if (latency > sender->stats.latency_max_ms) {
+            sender->stats.latency_max_ms = latency;
+        }
+        metrics_observe(&input_latency, latency);
+    }
+    sender->stats.dispatched++;
+    metrics_count(&input_dispatched, 1);
+    sender->dispatch(event, sender->userdata);
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <SDL_atomic.h>
+#include <SDL_events.h>
+#include <SDL_mutex.h>
+#include <SDL_thread.h>
+
+/**
+ * Called on the sender thread for each posted event, in posting order.
+ */
+typedef void (*input_sender_dispatch_fn)(const SDL_Event *event, void *userdata);
+
+typedef struct input_sender_stats_t {
+    Uint32 dispatched;
+    /* Time between event creation (SDL timestamp) and dispatch, for events with timestamp */
+    Uint32 latency_samples;
+    Uint64 latency_total_ms;
+    Uint32 latency_max_ms;
+    /* Times the queue was full and posting had to wait */
+    Uint32 full;
+} input_sender_stats_t;
+
+/**
+ * Hands input events from the main thread to a high priority thread, so a slow UI frame doesn't delay sending them.
+ * There must be only one thread posting events.
+ */
+typedef struct input_sender_t {
+    SDL_Event *events;
+    unsigned int mask;
+    /* Written by the poster */
+    SDL_atomic_t head;
+    /* Written by the sender thread */
+    SDL_atomic_t tail;
+    SDL_atomic_t running;
+    SDL_sem *wake;
+    SDL_Thread *thread;
+    input_sender_dispatch_fn dispatch;
+    void *userdata;
+    input_sender_stats_t stats;
+} input_sender_t;
+
+/**
+ * @param capacity Number of events can be queued, rounded up to power of 2
+ * @return 0 if the sender thread has been started
+ */
+int input_sender_init(input_sender_t *sender, size_t capacity, input_sender_dispatch_fn dispatch, void *userdata);
+
+/**
+ * Dispatches remaining events and stops the thread.
+ */
+void input_sender_deinit(input_sender_t *sender);
+
+/**
+ * Queues the event, or dispatches it on the calling thread if the sender isn't running.
+ */
+void input_sender_post(input_sender_t *sender, const SDL_Event *event);
+
+/**
+ * Waits until all posted events have been dispatched.
+ */
+void input_sender_flush(input_sender_t *sender);
+
+/**
+ * Safe to read only after flush or deinit.
+ */
+const input_sender_stats_t *input_sender_get_stats(const input_sender_t *sender);
@@ -21,8 +21,8 @@ static void release_buttons(stream_input_t *input, app_gamepad_state_t *gamepad)
 
 static bool gamepad_combo_check(int buttons, short combo);
 
-static bool sensor_state_needs_update(const app_gamepad_sensor_state_t *state, uint32_t timestamp,
-                                      const float data[3]);
+static bool sensor_state_needs_update(app_gamepad_sensor_state_t *state, const SDL_ControllerSensorEvent *event,
+                                      float out[3]);
 
 static bool vmouse_intercepted(stream_input_t *input, const app_gamepad_state_t *gamepad);
 
@@ -124,7 +124,8 @@ void stream_input_handle_cbutton(stream_input_t *input, const SDL_ControllerButt
         } else if (vmouse_combo_pressed) {
             vmouse_combo_pressed = false;
             release_buttons(input, gamepad);
-            session_toggle_vmouse(input->session);
+            // Overlay toggles it on main thread too, so it's only changed there
+            app_bus_post(input->session->app, (bus_actionfunc) session_toggle_vmouse, input->session);
             return;
         }
     }
@@ -205,23 +206,18 @@ void stream_input_handle_csensor(stream_input_t *input, const SDL_ControllerSens
     }
     switch (event->sensor) {
         case SDL_SENSOR_ACCEL: {
-            if (sensor_state_needs_update(&gamepad->accelState, event->timestamp, event->data)) {
-                gamepad->accelState.lastTimestamp = event->timestamp;
-                memcpy(gamepad->accelState.data, event->data, sizeof(gamepad->accelState.data));
-                LiSendControllerMotionEvent(gamepad->gs_id, LI_MOTION_TYPE_ACCEL, event->data[0], event->data[1],
-                                            event->data[2]);
+            float data[3];
+            if (sensor_state_needs_update(&gamepad->accelState, event, data)) {
+                LiSendControllerMotionEvent(gamepad->gs_id, LI_MOTION_TYPE_ACCEL, data[0], data[1], data[2]);
             }
             break;
         }
         case SDL_SENSOR_GYRO: {
-            if (sensor_state_needs_update(&gamepad->gyroState, event->timestamp, event->data)) {
-                gamepad->gyroState.lastTimestamp = event->timestamp;
-                memcpy(gamepad->gyroState.data, event->data, sizeof(gamepad->gyroState.data));
+            float data[3];
+            if (sensor_state_needs_update(&gamepad->gyroState, event, data)) {
                 // Convert rad/s to deg/s
-                LiSendControllerMotionEvent(gamepad->gs_id, LI_MOTION_TYPE_GYRO,
-                                            event->data[0] * 57.2957795f,
-                                            event->data[1] * 57.2957795f,
-                                            event->data[2] * 57.2957795f);
+                LiSendControllerMotionEvent(gamepad->gs_id, LI_MOTION_TYPE_GYRO, data[0] * 57.2957795f,
+                                            data[1] * 57.2957795f, data[2] * 57.2957795f);
             }
             break;
         }
@@ -355,17 +351,24 @@ static bool gamepad_combo_check(int buttons, short combo) {
     return (buttons & combo) == combo;
 }
 
-static bool sensor_state_needs_update(const app_gamepad_sensor_state_t *state, uint32_t timestamp,
-                                      const float data[3]) {
-    if (state->periodMs == 0 || !SDL_TICKS_PASSED(timestamp, state->lastTimestamp + state->periodMs)) {
+static bool sensor_state_needs_update(app_gamepad_sensor_state_t *state, const SDL_ControllerSensorEvent *event,
+                                      float out[3]) {
+    uint64_t timestamp_ns = (uint64_t) event->timestamp * 1000000;
+#if SDL_VERSION_ATLEAST(2, 26, 0)
+    // Sensor timestamp has microsecond resolution, when the driver provides it
+    if (event->timestamp_us != 0) {
+        timestamp_ns = event->timestamp_us * 1000;
+    }
+#endif
+    if (!sensor_resampler_feed(&state->resampler, timestamp_ns, event->data, out)) {
         return false;
     }
-    for (int i = 0; i < 3; i++) {
-        if (state->data[i] != data[i]) {
-            return true;
-        }
+    if (memcmp(state->data, out, sizeof(state->data)) == 0) {
+        return false;
     }
-    return false;
+    memcpy(state->data, out, sizeof(state->data));
+    sensor_resampler_mark_sent(&state->resampler, timestamp_ns);
+    return true;
 }
 
 static bool vmouse_intercepted(stream_input_t *input, const app_gamepad_state_t *gamepad) {
@@ -20,6 +20,10 @@
 #include "stream/session.h"
 #include "stream/session_priv.h"
 #include "session_evmouse.h"
+#include "stream/session_events.h"
+#include "logging.h"
+
+#define INPUT_SENDER_CAPACITY 256
 
 void session_input_init(stream_input_t *input, session_t *session, app_input_t *app_input,
                         const session_config_t *config) {
@@ -28,6 +32,10 @@ void session_input_init(stream_input_t *input, session_t *session, app_input_t *
     input->view_only = config->view_only;
     input->stick_deadzone = config->stick_deadzone;
     input->no_sdl_mouse = config->hardware_mouse;
+    if (input_sender_init(&input->sender, INPUT_SENDER_CAPACITY, (input_sender_dispatch_fn) session_dispatch_input_event,
+                          session) != 0) {
+        commons_log_warn("Session", "Failed to start input sender, input will be sent from main thread");
+    }
 #if FEATURE_INPUT_EVMOUSE
     if (!config->view_only && config->hardware_mouse) {
         session_evmouse_init(&input->evmouse, session);
@@ -36,6 +44,13 @@ void session_input_init(stream_input_t *input, session_t *session, app_input_t *
 }
 
 void session_input_deinit(stream_input_t *input) {
+    input_sender_deinit(&input->sender);
+    const input_sender_stats_t *stats = input_sender_get_stats(&input->sender);
+    if (stats->latency_samples > 0) {
+        commons_log_info("Session", "Input: %u events sent, latency avg %.2f ms, max %u ms, queue full %u times",
+                         stats->dispatched, (double) stats->latency_total_ms / stats->latency_samples,
+                         stats->latency_max_ms, stats->full);
+    }
 #if FEATURE_INPUT_EVMOUSE
     const session_config_t *config = &input->session->config;
     if (!config->view_only && config->hardware_mouse) {
@@ -66,6 +81,19 @@ void session_input_started(stream_input_t *input) {
 
 void session_input_stopped(stream_input_t *input) {
     input->started = false;
+#if SDL_VERSION_ATLEAST(2, 0, 14)
+    for (int i = 0, j = app_input_get_max_gamepads(input->input); i < j; ++i) {
+        const app_gamepad_state_t *gamepad = app_input_gamepad_state_by_index(input->input, i);
+        if (gamepad == NULL || (gamepad->accelState.resampler.sent == 0 && gamepad->gyroState.resampler.sent == 0)) {
+            continue;
+        }
+        commons_log_info("Input", "Controller %d motion sent: accel %u (%.1f Hz), gyro %u (%.1f Hz)", gamepad->gs_id,
+                         gamepad->accelState.resampler.sent,
+                         sensor_resampler_achieved_hz(&gamepad->accelState.resampler),
+                         gamepad->gyroState.resampler.sent,
+                         sensor_resampler_achieved_hz(&gamepad->gyroState.resampler));
+    }
+#endif
 }
 
 void session_input_screen_keyboard_opened(stream_input_t *input) {
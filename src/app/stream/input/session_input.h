@@ -4,9 +4,11 @@
 #include <Limelight.h>
 #include <SDL_events.h>
 #include <SDL_timer.h>
+#include <SDL_atomic.h>
 
 #include "config.h"
 #include "input/input_gamepad.h"
+#include "input_sender.h"
 
 #if FEATURE_INPUT_EVMOUSE
 
@@ -25,6 +27,8 @@ typedef struct session_input_vmouse_t {
         bool l, r;
         bool modifier;
     } state;
+    /* Vector is set on the input sender thread, and cleared on main thread when virtual mouse is turned off */
+    SDL_SpinLock timer_lock;
     SDL_TimerID timer_id;
 } session_input_vmouse_t;
 
@@ -35,6 +39,7 @@ typedef struct stream_input_t {
     bool view_only, no_sdl_mouse;
     uint8_t stick_deadzone;
     session_input_vmouse_t vmouse;
+    input_sender_t sender;
 #if FEATURE_INPUT_EVMOUSE
     session_evmouse_t evmouse;
 #endif
@@ -22,6 +22,7 @@ bool session_input_is_vmouse_active(session_input_vmouse_t *vmouse) {
 void vmouse_set_vector(session_input_vmouse_t *vmouse, short x, short y) {
     vmouse->state.x = calc_mouse_movement(x);
     vmouse->state.y = calc_mouse_movement((short) -SDL_max(y, -32767));
+    SDL_AtomicLock(&vmouse->timer_lock);
     if (vmouse->state.x || vmouse->state.y) {
         if (!vmouse->timer_id) {
             vmouse->timer_id = SDL_AddTimer(0, vmouse_timer_callback, vmouse);
@@ -30,6 +31,7 @@ void vmouse_set_vector(session_input_vmouse_t *vmouse, short x, short y) {
         SDL_RemoveTimer(vmouse->timer_id);
         vmouse->timer_id = 0;
     }
+    SDL_AtomicUnlock(&vmouse->timer_lock);
 }
 
 void vmouse_set_trigger(session_input_vmouse_t *vmouse, char l, char r) {
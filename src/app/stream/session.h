@@ -29,6 +29,8 @@ typedef struct VIDEO_STATS {
     uint32_t receivedFrames;
     uint32_t networkDroppedFrames;
     uint32_t submittedFrames;
+    /* Non-reference frames skipped because decoder couldn't keep up */
+    uint32_t backpressureDroppedFrames;
     uint32_t totalReassemblyTime;
     uint32_t totalSubmitTime;
     unsigned long measurementStartTimestamp;
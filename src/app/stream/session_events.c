@@ -2,10 +2,33 @@
 #include "session_priv.h"
 
 
+static bool is_session_input_event(Uint32 type);
+
+#if TARGET_WEBOS
+/**
+ * Handles remote keys that need UI state, or open system UI. Called on main thread before events are queued.
+ */
+bool stream_input_webos_handle_ui_keys(stream_input_t *input, const SDL_Event *event);
+#endif
+
 bool session_handle_input_event(session_t *session, const SDL_Event *event) {
-    if (!session_accepting_input(session)) {
+    if (!session_accepting_input(session) || !is_session_input_event(event->type)) {
         return false;
     }
+#if TARGET_WEBOS
+    if (stream_input_webos_handle_ui_keys(&session->input, event)) {
+        return true;
+    }
+#endif
+    input_sender_post(&session->input.sender, event);
+    return true;
+}
+
+void session_flush_input_events(session_t *session) {
+    input_sender_flush(&session->input.sender);
+}
+
+void session_dispatch_input_event(const SDL_Event *event, session_t *session) {
     stream_input_t *input = &session->input;
     switch (event->type) {
         case SDL_KEYDOWN:
@@ -63,8 +86,33 @@ bool session_handle_input_event(session_t *session, const SDL_Event *event) {
             stream_input_handle_touch(input, &event->tfinger);
             break;
         }
+        default:
+            break;
+    }
+}
+
+static bool is_session_input_event(Uint32 type) {
+    switch (type) {
+        case SDL_KEYDOWN:
+        case SDL_KEYUP:
+        case SDL_CONTROLLERAXISMOTION:
+        case SDL_CONTROLLERBUTTONDOWN:
+        case SDL_CONTROLLERBUTTONUP:
+        case SDL_CONTROLLERSENSORUPDATE:
+        case SDL_CONTROLLERTOUCHPADDOWN:
+        case SDL_CONTROLLERTOUCHPADMOTION:
+        case SDL_CONTROLLERTOUCHPADUP:
+        case SDL_CONTROLLERDEVICEADDED:
+        case SDL_MOUSEMOTION:
+        case SDL_MOUSEWHEEL:
+        case SDL_MOUSEBUTTONDOWN:
+        case SDL_MOUSEBUTTONUP:
+        case SDL_TEXTINPUT:
+        case SDL_FINGERDOWN:
+        case SDL_FINGERUP:
+        case SDL_FINGERMOTION:
+            return true;
         default:
             return false;
     }
-    return true;
 }
@@ -5,4 +5,17 @@
 
 typedef struct session_t session_t;
 
+/**
+ * Queues the event to be sent on the input sender thread.
+ *
+ * @return true if the event is consumed by the session
+ */
 bool session_handle_input_event(session_t *session, const SDL_Event *event);
+
+/**
+ * Waits until queued input events have been handled. Call this before changing state the handlers rely on,
+ * e.g. before removing a gamepad.
+ */
+void session_flush_input_events(session_t *session);
+
+void session_dispatch_input_event(const SDL_Event *event, session_t *session);
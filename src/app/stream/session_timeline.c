@@ -0,0 +1,149 @@
+#include "session_timeline.h"
+
+#include <time.h>
+#include <sys/stat.h>
+
+#include <SDL_atomic.h>
+#include <SDL_timer.h>
+
+#include "logging.h"
+#include "util/path.h"
+
+/* Keep the history of a few hundred launches */
+#define TIMELINE_FILE_MAX_SIZE (256 * 1024)
+
+session_timeline_t session_timeline;
+
+/* Marks are cheap and rarely contended, so a spin lock is enough */
+static SDL_SpinLock timeline_lock = 0;
+
+static void write_span(FILE *fp, const char *name, const session_timeline_span_t *span);
+
+void session_timeline_reset() {
+    Uint64 now = SDL_GetPerformanceCounter();
+    SDL_AtomicLock(&timeline_lock);
+    SDL_memset(&session_timeline, 0, sizeof(session_timeline));
+    session_timeline.origin = now;
+    SDL_AtomicUnlock(&timeline_lock);
+}
+
+void session_timeline_begin(session_timeline_span_t *span) {
+    Uint64 now = SDL_GetPerformanceCounter();
+    SDL_AtomicLock(&timeline_lock);
+    span->begin = now;
+    span->end = 0;
+    SDL_AtomicUnlock(&timeline_lock);
+}
+
+void session_timeline_end(session_timeline_span_t *span) {
+    Uint64 now = SDL_GetPerformanceCounter();
+    SDL_AtomicLock(&timeline_lock);
+    if (span->begin != 0) {
+        span->end = now;
+    }
+    SDL_AtomicUnlock(&timeline_lock);
+}
+
+void session_timeline_mark(Uint64 *mark) {
+    Uint64 now = SDL_GetPerformanceCounter();
+    SDL_AtomicLock(&timeline_lock);
+    if (*mark == 0) {
+        *mark = now;
+    }
+    SDL_AtomicUnlock(&timeline_lock);
+}
+
+void session_timeline_snapshot(session_timeline_t *snapshot) {
+    SDL_AtomicLock(&timeline_lock);
+    *snapshot = session_timeline;
+    SDL_AtomicUnlock(&timeline_lock);
+}
+
+double session_timeline_offset_ms(const session_timeline_t *snapshot, Uint64 timestamp) {
+    if (timestamp == 0 || snapshot->origin == 0) {
+        return -1;
+    }
+    return (double) (timestamp - snapshot->origin) * 1000.0 / (double) SDL_GetPerformanceFrequency();
+}
+
+double session_timeline_span_ms(const session_timeline_span_t *span) {
+    if (span->begin == 0 || span->end == 0) {
+        return -1;
+    }
+    return (double) (span->end - span->begin) * 1000.0 / (double) SDL_GetPerformanceFrequency();
+}
+
+void session_timeline_summary(char *buf, size_t len) {
+    session_timeline_t timeline;
+    session_timeline_snapshot(&timeline);
+    double launched = session_timeline_offset_ms(&timeline, timeline.launch.end);
+    double connected = session_timeline_offset_ms(&timeline, timeline.connection_started);
+    double first_frame = session_timeline_offset_ms(&timeline, timeline.first_frame);
+    if (launched < 0 || connected < 0 || first_frame < 0) {
+        SDL_snprintf(buf, len, "-");
+        return;
+    }
+    SDL_snprintf(buf, len, "%.0f ms (launch %.0f, connect %.0f, decode %.0f)", first_frame, launched,
+                 connected - launched, first_frame - connected);
+}
+
+void session_timeline_save(const char *path, int result) {
+    session_timeline_log(result);
+    struct stat st;
+    if (stat(path, &st) == 0 && st.st_size > TIMELINE_FILE_MAX_SIZE) {
+        char old_path[4096];
+        SDL_snprintf(old_path, sizeof(old_path), "%s.old", path);
+        path_replace(path, old_path);
+    }
+    FILE *fp = fopen(path, "a");
+    if (fp == NULL) {
+        commons_log_warn("Session", "Failed to save launch timeline to %s", path);
+        return;
+    }
+    session_timeline_write(fp, result);
+    fclose(fp);
+}
+
+void session_timeline_log(int result) {
+    session_timeline_t timeline;
+    session_timeline_snapshot(&timeline);
+    commons_log_info("Session", "Launch timeline (result %d):", result);
+    for (int stage = 0; stage < STAGE_MAX; stage++) {
+        double ms = session_timeline_span_ms(&timeline.stages[stage]);
+        if (ms >= 0) {
+            commons_log_info("Session", "  %-24s %8.2f ms", LiGetStageName(stage), ms);
+        }
+    }
+    commons_log_info("Session", "  %-24s %8.2f ms", "Launch request", session_timeline_span_ms(&timeline.launch));
+    commons_log_info("Session", "  %-24s %8.2f ms", "Player open", session_timeline_span_ms(&timeline.player_open));
+    commons_log_info("Session", "  %-24s %8.2f ms", "Video setup", session_timeline_span_ms(&timeline.video_setup));
+    commons_log_info("Session", "  %-24s %8.2f ms", "Audio setup", session_timeline_span_ms(&timeline.audio_setup));
+    commons_log_info("Session", "  %-24s %8.2f ms", "First frame at",
+                     session_timeline_offset_ms(&timeline, timeline.first_frame));
+}
+
+void session_timeline_write(FILE *fp, int result) {
+    session_timeline_t timeline;
+    session_timeline_snapshot(&timeline);
+    fprintf(fp, "%ld\t%s\t%d", (long) time(NULL), APP_VERSION, result);
+    write_span(fp, "launch", &timeline.launch);
+    write_span(fp, "player_open", &timeline.player_open);
+    for (int stage = 0; stage < STAGE_MAX; stage++) {
+        write_span(fp, LiGetStageName(stage), &timeline.stages[stage]);
+    }
+    write_span(fp, "video_setup", &timeline.video_setup);
+    write_span(fp, "audio_setup", &timeline.audio_setup);
+    fprintf(fp, "\tconnection_started@%.2f", session_timeline_offset_ms(&timeline, timeline.connection_started));
+    fprintf(fp, "\tfirst_frame@%.2f\n", session_timeline_offset_ms(&timeline, timeline.first_frame));
+}
+
+/**
+ * Writes "name=duration" of recorded span.
+ */
+static void write_span(FILE *fp, const char *name, const session_timeline_span_t *span) {
+    double ms = session_timeline_span_ms(span);
+    if (ms < 0) {
+        return;
+    }
+    fprintf(fp, "\t%s=%.2f", name, ms);
+}
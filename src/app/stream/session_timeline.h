@@ -0,0 +1,71 @@
+#pragma once
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <SDL_stdinc.h>
+#include <Limelight.h>
+
+typedef struct session_timeline_span_t {
+    /* Performance counter values, 0 if not recorded */
+    Uint64 begin, end;
+} session_timeline_span_t;
+
+/**
+ * Where the time between pressing Play and the first frame goes. Marks are recorded from several threads, so fields
+ * are only written through functions below, and read from a snapshot.
+ */
+typedef struct session_timeline_t {
+    Uint64 origin;
+    /* gs_start_app */
+    session_timeline_span_t launch;
+    /* SS4S_PlayerOpen, runs in parallel with launch */
+    session_timeline_span_t player_open;
+    /* Limelight connection stages, indexed by STAGE_* */
+    session_timeline_span_t stages[STAGE_MAX];
+    session_timeline_span_t video_setup;
+    session_timeline_span_t audio_setup;
+    Uint64 connection_started;
+    Uint64 first_frame;
+} session_timeline_t;
+
+extern session_timeline_t session_timeline;
+
+/**
+ * Clears the timeline and sets origin to now. Call this when launch begins.
+ */
+void session_timeline_reset();
+
+void session_timeline_begin(session_timeline_span_t *span);
+
+void session_timeline_end(session_timeline_span_t *span);
+
+void session_timeline_mark(Uint64 *mark);
+
+/**
+ * Copies the timeline, consistent with marks being recorded on other threads.
+ */
+void session_timeline_snapshot(session_timeline_t *snapshot);
+
+/**
+ * @return Milliseconds from origin of the snapshot to the timestamp, or -1 if not recorded
+ */
+double session_timeline_offset_ms(const session_timeline_t *snapshot, Uint64 timestamp);
+
+/**
+ * @return Duration of the span in milliseconds, or -1 if not finished
+ */
+double session_timeline_span_ms(const session_timeline_span_t *span);
+
+/**
+ * Short summary for stats overlay.
+ */
+void session_timeline_summary(char *buf, size_t len);
+
+/**
+ * Logs the timeline and appends it as a single line to the file, along with app version and result of the session.
+ */
+void session_timeline_save(const char *path, int result);
+
+void session_timeline_log(int result);
+
+void session_timeline_write(FILE *fp, int result);
@@ -10,7 +10,35 @@
 #include "stream/audio/session_audio.h"
 #include "stream/video/session_video.h"
 #include "app_session.h"
-#include "backend/pcmanager/worker/worker.h"
+#include "backend/pcmanager.h"
+#include "session_timeline.h"
+#include "util/path.h"
+#include "app_settings.h"
+#include "util/metrics.h"
+
+METRICS_COUNTER(session_starts, "session.starts");
+METRICS_COUNTER(session_failures, "session.failures");
+METRICS_HISTOGRAM(session_duration, "session.duration_s");
+
+/**
+ * Shared by the session worker and the thread opening the player. If launch fails before the player is opened, the
+ * session worker abandons it, and the thread closes the player and frees this when done.
+ */
+typedef struct player_open_context_t {
+    app_t *app;
+    int width, height;
+    SDL_SpinLock lock;
+    bool finished, abandoned;
+    SS4S_Player *player;
+} player_open_context_t;
+
+static int player_open_worker(player_open_context_t *context);
+
+static SS4S_Player *player_open(const player_open_context_t *context);
+
+static void player_open_abandon(player_open_context_t *context, SDL_Thread *thread);
+
+static void save_timeline(app_t *app, int result);
 
 int session_worker(session_t *session) {
     app_t *app = session->app;
@@ -20,6 +48,8 @@ int session_worker(session_t *session) {
     PSERVER_DATA server = session->server;
     int appId = session->app_id;
     session->player = NULL;
+    session_timeline_reset();
+    metrics_count(&session_starts, 1);
 
 #if FEATURE_INPUT_EVMOUSE
     if (!session->config.view_only && session->config.hardware_mouse) {
@@ -28,6 +58,13 @@ int session_worker(session_t *session) {
 #endif
 
     commons_log_info("Session", "Launch app %d...", appId);
+    // Opening the player takes a while on some TVs, do it while the host is launching the app
+    player_open_context_t *player_context = SDL_calloc(1, sizeof(player_open_context_t));
+    player_context->app = app;
+    player_context->width = app->ui.width;
+    player_context->height = app->ui.height;
+    SDL_Thread *player_thread = SDL_CreateThread((SDL_ThreadFunction) player_open_worker, "sessplayer",
+                                                 player_context);
     GS_CLIENT client = app_gs_client_new(app);
     const char *surround_params = NULL;
 #if TARGET_WEBOS
@@ -36,9 +73,18 @@ int session_worker(session_t *session) {
         surround_params = "642014523";
     }
 #endif
+    int startResult = 0;
+    session_timeline_begin(&session_timeline.launch);
     int ret = gs_start_app(client, server, &session->config.stream, appId, server->isGfe, session->config.sops,
                            session->config.local_audio, app_input_gamepads_mask(&app->input), surround_params);
+    session_timeline_end(&session_timeline.launch);
     if (ret != GS_OK) {
+        if (player_thread != NULL) {
+            // Opening the player can't be interrupted, so the error is shown without waiting for it
+            player_open_abandon(player_context, player_thread);
+        } else {
+            SDL_free(player_context);
+        }
         session_set_state(session, STREAMING_ERROR);
         const char *gs_error = NULL;
         gs_get_error(&gs_error);
@@ -56,12 +102,16 @@ int session_worker(session_t *session) {
     commons_log_info("Session", "Audio %d channels",
                      CHANNEL_COUNT_FROM_AUDIO_CONFIGURATION(session->config.stream.audioConfiguration));
 
-    session->player = SS4S_PlayerOpen();
-    SS4S_PlayerSetWaitAudioVideoReady(session->player, true);
-    SS4S_PlayerSetViewportSize(session->player, app->ui.width, app->ui.height);
-    SS4S_PlayerSetUserdata(session->player, app);
+    if (player_thread != NULL) {
+        SDL_WaitThread(player_thread, NULL);
+        session->player = player_context->player;
+    } else {
+        session->player = player_open(player_context);
+        session_timeline_end(&session_timeline.player_open);
+    }
+    SDL_free(player_context);
 
-    int startResult = LiStartConnection(&server->serverInfo, &session->config.stream,
+    startResult = LiStartConnection(&server->serverInfo, &session->config.stream,
                                         session_connection_callbacks_prepare(session),
                                         &ss4s_dec_callbacks, &ss4s_aud_callbacks, session, 0, session, 0);
     if (startResult != 0) {
@@ -92,6 +142,7 @@ int session_worker(session_t *session) {
     }
     session_set_state(session, STREAMING_STREAMING);
     bus_pushevent(USER_STREAM_OPEN, NULL, NULL);
+    Uint32 stream_start = SDL_GetTicks();
     SDL_LockMutex(session->mutex);
     while (!session->interrupted) {
         // Wait until interrupted
@@ -99,6 +150,7 @@ int session_worker(session_t *session) {
     }
     SDL_UnlockMutex(session->mutex);
     bus_pushevent(USER_STREAM_CLOSE, NULL, NULL);
+    metrics_observe(&session_duration, (SDL_GetTicks() - stream_start) / 1000);
 
     session_set_state(session, STREAMING_DISCONNECTING);
     LiStopConnection();
@@ -107,17 +159,20 @@ int session_worker(session_t *session) {
         commons_log_info("Session", "Sending app quit request ...");
         gs_quit_app(client, server);
     }
-    worker_context_t update_ctx = {
-            .app = app,
-            .manager = pcmanager,
-    };
-    uuidstr_fromstr(&update_ctx.uuid, server->uuid);
-    pcmanager_update_by_host(&update_ctx, server->serverInfo.address, server->extPort, true);
+    // Refresh host status in background, so teardown doesn't wait for it
+    uuidstr_t uuid;
+    uuidstr_fromstr(&uuid, server->uuid);
+    pcmanager_request_update(pcmanager, &uuid, NULL, NULL);
 
     // Don't always reset status as error state should be kept
     session_set_state(session, STREAMING_NONE);
     thread_cleanup:
     session_connection_callbacks_reset(session);
+    save_timeline(app, ret != GS_OK ? ret : startResult);
+    if (ret != GS_OK || startResult != 0) {
+        metrics_count(&session_failures, 1);
+    }
+    metrics_report();
     if (session->player != NULL) {
         SS4S_PlayerClose(session->player);
     }
@@ -125,4 +180,53 @@ int session_worker(session_t *session) {
     bus_pushevent(USER_STREAM_FINISHED, NULL, NULL);
     app_bus_post(app, (bus_actionfunc) app_session_destroy, app);
     return 0;
-}
\ No newline at end of file
+}
+
+static int player_open_worker(player_open_context_t *context) {
+    SS4S_Player *player = player_open(context);
+    SDL_AtomicLock(&context->lock);
+    bool abandoned = context->abandoned;
+    context->player = player;
+    context->finished = true;
+    SDL_AtomicUnlock(&context->lock);
+    if (abandoned) {
+        if (player != NULL) {
+            SS4S_PlayerClose(player);
+        }
+        SDL_free(context);
+    } else {
+        session_timeline_end(&session_timeline.player_open);
+    }
+    return 0;
+}
+
+static SS4S_Player *player_open(const player_open_context_t *context) {
+    session_timeline_begin(&session_timeline.player_open);
+    SS4S_Player *player = SS4S_PlayerOpen();
+    SS4S_PlayerSetWaitAudioVideoReady(player, true);
+    SS4S_PlayerSetViewportSize(player, context->width, context->height);
+    SS4S_PlayerSetUserdata(player, context->app);
+    return player;
+}
+
+static void player_open_abandon(player_open_context_t *context, SDL_Thread *thread) {
+    SDL_AtomicLock(&context->lock);
+    bool finished = context->finished;
+    context->abandoned = !finished;
+    SDL_AtomicUnlock(&context->lock);
+    if (!finished) {
+        SDL_DetachThread(thread);
+        return;
+    }
+    SDL_WaitThread(thread, NULL);
+    if (context->player != NULL) {
+        SS4S_PlayerClose(context->player);
+    }
+    SDL_free(context);
+}
+
+static void save_timeline(app_t *app, int result) {
+    char *path = path_join(app->settings.conf_dir, CONF_NAME_LAUNCH_TIMELINE);
+    session_timeline_save(path, result);
+    free(path);
+}
@@ -24,8 +24,9 @@
 #include "errors.h"
 #include "app_session.h"
 #include "logging.h"
-#include "backend/pcmanager/worker/worker.h"
+#include "backend/pcmanager.h"
 #include "embed_wrapper.h"
+#include "session_timeline.h"
 
 #include <errno.h>
 
@@ -35,7 +36,8 @@ int session_worker_embedded(session_t *session) {
     session_set_state(session, STREAMING_CONNECTING);
     bus_pushevent(USER_STREAM_CONNECTING, NULL, NULL);
     streaming_error(session, GS_OK, "");
-
+    // Stages happen in the child process, so there's nothing to record
+    session_timeline_reset();
 
     embed_process_t *proc = embed_spawn(session->app_name, app->settings.key_dir, session->server->serverInfo.address,
                                         session->config.stream.width, session->config.stream.height,
@@ -99,12 +101,10 @@ int session_worker_embedded(session_t *session) {
             gs_quit_app(client, server);
             gs_destroy(client);
         }
-        worker_context_t update_ctx = {
-                .app = app,
-                .manager = pcmanager,
-        };
-        uuidstr_fromstr(&update_ctx.uuid, server->uuid);
-        pcmanager_update_by_host(&update_ctx, server->serverInfo.address, server->extPort, true);
+        // Refresh host status in background, so teardown doesn't wait for it
+        uuidstr_t uuid;
+        uuidstr_fromstr(&uuid, server->uuid);
+        pcmanager_request_update(pcmanager, &uuid, NULL, NULL);
 
         // Don't always reset status as error state should be kept
         session_set_state(session, STREAMING_NONE);
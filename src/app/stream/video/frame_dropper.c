@@ -0,0 +1,110 @@
+#include "frame_dropper.h"
+
+#include <Limelight.h>
+
+/* Weight of the latest sample in the moving average */
+#define FEED_AVG_WEIGHT 0.125f
+/* Leave congested state only when the decoder has enough headroom, so it doesn't flip on every frame */
+#define CONGESTION_RELEASE_RATIO 0.5f
+
+#define H264_NAL_SLICE 1
+#define H264_NAL_IDR 5
+
+#define HEVC_NAL_VCL_MAX 31
+#define HEVC_NAL_IRAP_MIN 16
+#define HEVC_NAL_IRAP_MAX 23
+/* Sub-layer non-reference types below 16 are even numbered (TRAIL_N, TSA_N, STSA_N, RADL_N, RASL_N) */
+#define HEVC_NAL_SUB_LAYER_NON_REF_MAX 14
+
+static const unsigned char *next_nal(const unsigned char *data, const unsigned char *end);
+
+static frame_class_t classify_h264(const unsigned char *nal);
+
+static frame_class_t classify_hevc(const unsigned char *nal);
+
+frame_class_t frame_classify(int videoFormat, const unsigned char *data, size_t length) {
+    const unsigned char *end = data + length;
+    for (const unsigned char *nal = next_nal(data, end); nal != NULL && nal < end; nal = next_nal(nal, end)) {
+        frame_class_t result;
+        if (videoFormat & VIDEO_FORMAT_MASK_H264) {
+            result = classify_h264(nal);
+        } else if (videoFormat & VIDEO_FORMAT_MASK_H265) {
+            if (end - nal < 2) {
+                return FRAME_CLASS_UNKNOWN;
+            }
+            result = classify_hevc(nal);
+        } else {
+            return FRAME_CLASS_UNKNOWN;
+        }
+        // Parameter sets and SEI come before the first slice
+        if (result != FRAME_CLASS_UNKNOWN) {
+            return result;
+        }
+    }
+    return FRAME_CLASS_UNKNOWN;
+}
+
+void frame_dropper_init(frame_dropper_t *dropper, int fps) {
+    dropper->budget_ms = fps > 0 ? 1000.0f / (float) fps : 1000.0f / 60.0f;
+    dropper->avg_feed_ms = 0;
+    dropper->congested = false;
+    dropper->stats.dropped = 0;
+    dropper->stats.congested = 0;
+}
+
+bool frame_dropper_should_drop(frame_dropper_t *dropper, frame_class_t frame_class) {
+    if (!dropper->congested) {
+        return false;
+    }
+    if (frame_class == FRAME_CLASS_DISPOSABLE) {
+        dropper->stats.dropped++;
+        return true;
+    }
+    dropper->stats.congested++;
+    return false;
+}
+
+void frame_dropper_feed_done(frame_dropper_t *dropper, float feed_ms) {
+    dropper->avg_feed_ms += (feed_ms - dropper->avg_feed_ms) * FEED_AVG_WEIGHT;
+    if (dropper->avg_feed_ms > dropper->budget_ms) {
+        dropper->congested = true;
+    } else if (dropper->avg_feed_ms < dropper->budget_ms * CONGESTION_RELEASE_RATIO) {
+        dropper->congested = false;
+    }
+}
+
+/**
+ * @return Pointer to the NAL header after the next start code, or NULL if there's none
+ */
+static const unsigned char *next_nal(const unsigned char *data, const unsigned char *end) {
+    for (const unsigned char *p = data; p + 3 < end; p++) {
+        if (p[0] == 0 && p[1] == 0 && p[2] == 1) {
+            return p + 3;
+        }
+    }
+    return NULL;
+}
+
+static frame_class_t classify_h264(const unsigned char *nal) {
+    int nal_ref_idc = (nal[0] >> 5) & 0x3;
+    int nal_type = nal[0] & 0x1f;
+    if (nal_type == H264_NAL_IDR) {
+        return FRAME_CLASS_KEY;
+    } else if (nal_type != H264_NAL_SLICE) {
+        return FRAME_CLASS_UNKNOWN;
+    }
+    return nal_ref_idc == 0 ? FRAME_CLASS_DISPOSABLE : FRAME_CLASS_REFERENCE;
+}
+
+static frame_class_t classify_hevc(const unsigned char *nal) {
+    int nal_type = (nal[0] >> 1) & 0x3f;
+    if (nal_type > HEVC_NAL_VCL_MAX) {
+        return FRAME_CLASS_UNKNOWN;
+    } else if (nal_type >= HEVC_NAL_IRAP_MIN && nal_type <= HEVC_NAL_IRAP_MAX) {
+        return FRAME_CLASS_KEY;
+    } else if (nal_type <= HEVC_NAL_SUB_LAYER_NON_REF_MAX && nal_type % 2 == 0) {
+        // Host encoders use a single temporal layer, so nothing references a sub-layer non-reference picture
+        return FRAME_CLASS_DISPOSABLE;
+    }
+    return FRAME_CLASS_REFERENCE;
+}
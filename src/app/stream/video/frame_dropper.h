@@ -0,0 +1,50 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+typedef enum frame_class_t {
+    /* Can't tell, or the codec isn't supported. Never dropped */
+    FRAME_CLASS_UNKNOWN = 0,
+    FRAME_CLASS_KEY,
+    /* Other frames may depend on it */
+    FRAME_CLASS_REFERENCE,
+    /* No other frame depends on it, so it can be dropped without corrupting the picture */
+    FRAME_CLASS_DISPOSABLE,
+} frame_class_t;
+
+typedef struct frame_drop_stats_t {
+    /* Disposable frames dropped under backpressure */
+    uint32_t dropped;
+    /* Frames submitted while the decoder was congested, because they couldn't be dropped */
+    uint32_t congested;
+} frame_drop_stats_t;
+
+typedef struct frame_dropper_t {
+    /* Time a frame can spend in feed before the decoder falls behind */
+    float budget_ms;
+    /* Moving average of feed time */
+    float avg_feed_ms;
+    bool congested;
+    frame_drop_stats_t stats;
+} frame_dropper_t;
+
+/**
+ * Looks at NAL headers of the first slice in an Annex B access unit. AV1 isn't supported.
+ *
+ * @param videoFormat VIDEO_FORMAT_* of Limelight
+ */
+frame_class_t frame_classify(int videoFormat, const unsigned char *data, size_t length);
+
+void frame_dropper_init(frame_dropper_t *dropper, int fps);
+
+/**
+ * @return true if the frame should be dropped instead of being fed to the decoder
+ */
+bool frame_dropper_should_drop(frame_dropper_t *dropper, frame_class_t frame_class);
+
+/**
+ * Updates congestion state with the time the decoder took to accept a frame.
+ */
+void frame_dropper_feed_done(frame_dropper_t *dropper, float feed_ms);
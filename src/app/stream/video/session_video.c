@@ -5,14 +5,18 @@
 #include "stream/session.h"
 
 #include "sps_parser.h"
+#include "frame_dropper.h"
 
 #include "ui/streaming/streaming.controller.h"
 #include "util/bus.h"
 #include "logging.h"
+#include "util/async_log.h"
 #include "ss4s.h"
 #include "stream/connection/session_connection.h"
 #include "stream/session_priv.h"
+#include "stream/session_timeline.h"
 #include "app.h"
+#include "util/metrics.h"
 
 #include <SDL.h>
 #include <assert.h>
@@ -26,11 +30,23 @@ static unsigned char *buffer = NULL;
 static int lastFrameNumber;
 static struct VIDEO_STATS vdec_temp_stats;
 static int vdec_stream_format = 0;
+static frame_dropper_t dropper;
 VIDEO_STATS vdec_summary_stats;
 VIDEO_INFO vdec_stream_info;
 
+METRICS_COUNTER(video_received, "video.frames.received");
+METRICS_COUNTER(video_network_dropped, "video.frames.network_dropped");
+METRICS_COUNTER(video_backpressure_dropped, "video.frames.backpressure_dropped");
+METRICS_COUNTER(video_submitted, "video.frames.submitted");
+METRICS_COUNTER(video_bytes, "video.bytes");
+METRICS_COUNTER(video_keyframe_requests, "video.keyframe_requests");
+METRICS_COUNTER(video_feed_errors, "video.feed_errors");
+METRICS_HISTOGRAM(video_feed_time, "video.feed_us");
+
 static int vdec_delegate_setup(int videoFormat, int width, int height, int redrawRate, void *context, int drFlags);
 
+static int vdec_setup(int videoFormat, int width, int height, int redrawRate, void *context, int drFlags);
+
 static void vdec_delegate_cleanup();
 
 static int vdec_delegate_submit(PDECODE_UNIT decodeUnit);
@@ -39,6 +55,8 @@ static void vdec_stat_submit(const struct VIDEO_STATS *src, unsigned long now);
 
 static void stream_info_parse_size(PDECODE_UNIT decodeUnit, struct VIDEO_INFO *info);
 
+static frame_class_t classify_decode_unit(PDECODE_UNIT decodeUnit);
+
 DECODER_RENDERER_CALLBACKS ss4s_dec_callbacks = {
         .setup = vdec_delegate_setup,
         .cleanup = vdec_delegate_cleanup,
@@ -64,7 +82,13 @@ static const char *video_format_name(int videoFormat) {
 }
 
 int vdec_delegate_setup(int videoFormat, int width, int height, int redrawRate, void *context, int drFlags) {
-    (void) redrawRate;
+    session_timeline_begin(&session_timeline.video_setup);
+    int ret = vdec_setup(videoFormat, width, height, redrawRate, context, drFlags);
+    session_timeline_end(&session_timeline.video_setup);
+    return ret;
+}
+
+int vdec_setup(int videoFormat, int width, int height, int redrawRate, void *context, int drFlags) {
     (void) drFlags;
     session = context;
     player = session->player;
@@ -74,6 +98,7 @@ int vdec_delegate_setup(int videoFormat, int width, int height, int redrawRate,
     vdec_stream_format = videoFormat;
     vdec_stream_info.format = video_format_name(videoFormat);
     lastFrameNumber = 0;
+    frame_dropper_init(&dropper, redrawRate);
     SS4S_VideoInfo info = {
             .width = width,
             .height = height,
@@ -116,6 +141,10 @@ int vdec_delegate_setup(int videoFormat, int width, int height, int redrawRate,
 
 void vdec_delegate_cleanup() {
     assert(player != NULL);
+    if (dropper.stats.dropped > 0 || dropper.stats.congested > 0) {
+        commons_log_info("Session", "Decoder backpressure: dropped %u frames, submitted %u frames while congested",
+                         dropper.stats.dropped, dropper.stats.congested);
+    }
     free(buffer);
     SS4S_PlayerVideoClose(player);
     session = NULL;
@@ -133,6 +162,7 @@ int vdec_delegate_submit(PDECODE_UNIT decodeUnit) {
         // Any frame number greater than m_LastFrameNumber + 1 represents a dropped frame
         vdec_temp_stats.networkDroppedFrames += decodeUnit->frameNumber - (lastFrameNumber + 1);
         vdec_temp_stats.totalFrames += decodeUnit->frameNumber - (lastFrameNumber + 1);
+        metrics_count(&video_network_dropped, decodeUnit->frameNumber - (lastFrameNumber + 1));
         lastFrameNumber = decodeUnit->frameNumber;
     }
     // Flip stats windows roughly every second
@@ -146,6 +176,7 @@ int vdec_delegate_submit(PDECODE_UNIT decodeUnit) {
 
     vdec_temp_stats.receivedFrames++;
     vdec_temp_stats.totalFrames++;
+    metrics_count(&video_received, 1);
 
     vdec_temp_stats.totalCaptureLatency += decodeUnit->frameHostProcessingLatency;
     vdec_temp_stats.totalReassemblyTime += decodeUnit->enqueueTimeMs - decodeUnit->receiveTimeMs;
@@ -155,22 +186,38 @@ int vdec_delegate_submit(PDECODE_UNIT decodeUnit) {
         memcpy(buffer + length, entry->data, entry->length);
         length += entry->length;
     }
+    // Only look into the frame when decoder is falling behind
+    if (dropper.congested && decodeUnit->frameType != FRAME_TYPE_IDR &&
+        frame_dropper_should_drop(&dropper, classify_decode_unit(decodeUnit))) {
+        vdec_temp_stats.backpressureDroppedFrames++;
+        metrics_count(&video_backpressure_dropped, 1);
+        return DR_OK;
+    }
     SS4S_VideoFeedFlags flags = SS4S_VIDEO_FEED_DATA_FRAME_START | SS4S_VIDEO_FEED_DATA_FRAME_END;
     if (decodeUnit->frameType == FRAME_TYPE_IDR) {
         flags |= SS4S_VIDEO_FEED_DATA_KEYFRAME;
     }
+    Uint64 feed_start = SDL_GetPerformanceCounter();
     SS4S_VideoFeedResult result = SS4S_PlayerVideoFeed(player, buffer, length, flags);
+    Uint64 feed_ticks = SDL_GetPerformanceCounter() - feed_start;
+    frame_dropper_feed_done(&dropper, (float) feed_ticks * 1000.0f / (float) SDL_GetPerformanceFrequency());
+    metrics_observe(&video_feed_time, feed_ticks * 1000000 / SDL_GetPerformanceFrequency());
     if (result == SS4S_VIDEO_FEED_OK) {
+        session_timeline_mark(&session_timeline.first_frame);
         if (vdec_stream_info.width == 0 || vdec_stream_info.height == 0) {
             stream_info_parse_size(decodeUnit, &vdec_stream_info);
         }
         vdec_temp_stats.totalSubmitTime += LiGetMillis() - decodeUnit->enqueueTimeMs;
         vdec_temp_stats.submittedFrames++;
+        metrics_count(&video_submitted, 1);
+        metrics_count(&video_bytes, length);
         return DR_OK;
     } else if (result == SS4S_VIDEO_FEED_REQUEST_KEYFRAME) {
+        metrics_count(&video_keyframe_requests, 1);
         return DR_NEED_IDR;
     } else {
-        commons_log_error("Session", "Video feed error %d", result);
+        metrics_count(&video_feed_errors, 1);
+        async_log_error("Session", "Video feed error %d", result);
         session_interrupt(session, false, STREAMING_INTERRUPT_DECODER);
         return DR_OK;
     }
@@ -215,4 +262,15 @@ void stream_info_parse_size(PDECODE_UNIT decodeUnit, struct VIDEO_INFO *info) {
         info->height = dimension.height;
         return;
     }
-}
\ No newline at end of file
+}
+
+/**
+ * Like stream_info_parse_size, uses buffer types Limelight already assigned, so parameter sets aren't scanned.
+ */
+static frame_class_t classify_decode_unit(PDECODE_UNIT decodeUnit) {
+    for (PLENTRY entry = decodeUnit->bufferList; entry != NULL; entry = entry->next) {
+        if (entry->bufferType != BUFFER_TYPE_PICDATA) { continue; }
+        return frame_classify(vdec_stream_format, (const unsigned char *) entry->data, entry->length);
+    }
+    return FRAME_CLASS_UNKNOWN;
+}
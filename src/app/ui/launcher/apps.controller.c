@@ -38,7 +38,7 @@ static void host_info_cb(int result, const char *error, const uuidstr_t *uuid, v
 
 static void send_wol_cb(int result, const char *error, const uuidstr_t *uuid, void *userdata);
 
-static void on_host_updated(const uuidstr_t *uuid, void *userdata);
+static void on_host_updated(const uuidstr_t *uuid, pcmanager_change_t changes, void *userdata);
 
 static void on_host_removed(const uuidstr_t *uuid, void *userdata);
 
@@ -294,6 +294,7 @@ static void on_destroy_view(lv_fragment_t *self, lv_obj_t *view) {
     controller->show_hidden_apps = false;
     pcmanager_unregister_listener(pcmanager, &pc_listeners);
     coverloader_unref(controller->coverloader);
+    controller->coverloader = NULL;
 }
 
 static bool on_event(lv_fragment_t *self, int code, void *userdata) {
@@ -305,6 +306,12 @@ static bool on_event(lv_fragment_t *self, int code, void *userdata) {
             lv_gridview_rebind(controller->applist);
             break;
         }
+        case USER_LOW_MEMORY: {
+            if (controller->coverloader != NULL) {
+                coverloader_trim_memory(controller->coverloader);
+            }
+            break;
+        }
         case USER_SHOW_HIDDEN_APPS: {
             ui_userevent_t *event = userdata;
             if (uuidstr_t_equals_t(&controller->uuid, event->data1)) {
@@ -320,10 +327,12 @@ static bool on_event(lv_fragment_t *self, int code, void *userdata) {
     return false;
 }
 
-static void on_host_updated(const uuidstr_t *uuid, void *userdata) {
+static void on_host_updated(const uuidstr_t *uuid, pcmanager_change_t changes, void *userdata) {
     apps_fragment_t *controller = (apps_fragment_t *) userdata;
     if (controller != current_instance) { return; }
     if (!uuidstr_t_equals_t(&controller->uuid, uuid)) { return; }
+    // App list and view don't depend on address or host info
+    if (!(changes & (PCMANAGER_CHANGE_STATE | PCMANAGER_CHANGE_PAIRED | PCMANAGER_CHANGE_CURRENT_APP))) { return; }
     const SERVER_STATE *state = pcmanager_state(pcmanager, uuid);
     assert(state != NULL);
     if (state->code == SERVER_STATE_AVAILABLE) {
@@ -3,6 +3,7 @@
 #include "appitem.view.h"
 
 #include <stddef.h>
+#include <stdio.h>
 
 #include "util/bus.h"
 #include "util/path.h"
@@ -19,15 +20,19 @@
 #include "res.h"
 
 typedef struct memcache_key_t {
+    uuidstr_t server_id;
     int id;
     lv_coord_t target_width, target_height;
 } memcache_key_t;
 
 typedef struct memcache_item_t {
+    struct coverloader_t *loader;
     lv_img_dsc_t src;
     lv_sdl_img_data_t data;
     lv_ll_t objs;
     lv_coord_t target_width, target_height, target_radius;
+    /* Bytes accounted in the cache budget */
+    size_t size;
 } memcache_item_t;
 
 typedef struct img_loader_req_t {
@@ -63,12 +68,20 @@ typedef struct img_loader_req_t {
 #define DEBUG 0
 #endif
 
+#define MEMCACHE_MIN_BYTES (8 * 1024 * 1024)
+#define MEMCACHE_SCREENS 2
+#define MEMCACHE_COVERS_PER_SCREEN 10
+
 static const char *coverloader_cache_dir(coverloader_t *loader);
 
 static GS_CLIENT coverloader_gs_client(coverloader_t *loader);
 
 static void coverloader_cache_item_path(char path[4096], const coverloader_req_t *req);
 
+static size_t coverloader_memcache_budget(const app_t *app);
+
+static void memcache_key_init(memcache_key_t *key, const coverloader_req_t *req);
+
 static bool coverloader_memcache_get(coverloader_req_t *req);
 
 static void coverloader_memcache_put(coverloader_req_t *req);
@@ -94,10 +107,12 @@ static void img_loader_cancel_cb(coverloader_req_t *req);
  */
 static void img_set_cover(lv_obj_t *obj, memcache_item_t *src);
 
-static struct memcache_item_t *memcache_item_new();
+static struct memcache_item_t *memcache_item_new(coverloader_t *loader);
 
 static void memcache_item_free(memcache_item_t *item);
 
+static void memcache_evict_to(coverloader_t *loader, size_t budget);
+
 static void coverloader_req_free(coverloader_req_t *req);
 
 static int reqlist_find_by_target(coverloader_req_t *p, const void *v);
@@ -139,6 +154,9 @@ struct coverloader_t {
     lazy_t cache_dir;
     coverloader_req_t *reqlist;
     refcounter_t refcounter;
+    /* Tracked here, as lv_lru doesn't expose its usage */
+    size_t budget_bytes, used_bytes;
+    unsigned int hits, misses, evictions;
 };
 
 typedef struct subimage_info_t {
@@ -149,7 +167,13 @@ typedef struct subimage_info_t {
 coverloader_t *coverloader_new(app_t *app) {
     coverloader_t *loader = malloc(sizeof(coverloader_t));
     refcounter_init(&loader->refcounter);
-    loader->mem_cache = lv_lru_create(1024 * 1024 * 32, 720 * 1024, (lv_lru_free_t *) memcache_item_free, NULL);
+    size_t budget = coverloader_memcache_budget(app);
+    size_t average = app->ui.width * app->ui.height * 4 / MEMCACHE_COVERS_PER_SCREEN;
+    loader->mem_cache = lv_lru_create(budget, LV_MAX(average, 64 * 1024), (lv_lru_free_t *) memcache_item_free,
+                                      NULL);
+    loader->budget_bytes = budget;
+    loader->used_bytes = 0;
+    loader->hits = loader->misses = loader->evictions = 0;
     loader->base_loader = img_loader_create(&coverloader_impl, app->backend.executor);
     lazy_init(&loader->client, (lazy_supplier) app_gs_client_new, app);
     lazy_init(&loader->cache_dir, (lazy_supplier) path_cache, NULL);
@@ -161,6 +185,10 @@ void coverloader_unref(coverloader_t *loader) {
     if (!refcounter_unref(&loader->refcounter)) {
         return;
     }
+    coverloader_stats_t stats;
+    coverloader_get_stats(loader, &stats);
+    commons_log_debug("CoverLoader", "Memory cache: %u hits, %u misses, %u evictions, %zu/%zu bytes used",
+                      stats.hits, stats.misses, stats.evictions, stats.used_bytes, stats.budget_bytes);
     GS_CLIENT client = lazy_deinit(&loader->client);
     if (client != NULL) {
         gs_destroy(client);
@@ -199,6 +227,32 @@ void coverloader_display(coverloader_t *loader, const uuidstr_t *uuid, int id, l
     req->task = task;
 }
 
+void coverloader_trim_memory(coverloader_t *loader) {
+    loader->budget_bytes = LV_MAX(loader->budget_bytes / 2, MEMCACHE_MIN_BYTES);
+    memcache_evict_to(loader, loader->budget_bytes);
+    commons_log_info("CoverLoader", "Memory cache trimmed to %zu bytes", loader->budget_bytes);
+}
+
+void coverloader_get_stats(const coverloader_t *loader, coverloader_stats_t *stats) {
+    stats->hits = loader->hits;
+    stats->misses = loader->misses;
+    stats->evictions = loader->evictions;
+    stats->used_bytes = loader->used_bytes;
+    stats->budget_bytes = loader->budget_bytes;
+}
+
+/**
+ * Size the cache to hold a few screens of covers, but never more than the configured ceiling.
+ */
+static size_t coverloader_memcache_budget(const app_t *app) {
+    size_t budget = (size_t) app->ui.width * app->ui.height * 4 * MEMCACHE_SCREENS;
+    size_t ceiling = (size_t) app->settings.cover_cache_limit * 1024 * 1024;
+    if (ceiling > 0 && budget > ceiling) {
+        budget = ceiling;
+    }
+    return LV_MAX(budget, MEMCACHE_MIN_BYTES);
+}
+
 static const char *coverloader_cache_dir(coverloader_t *loader) {
     return lazy_obtain(&loader->cache_dir);
 }
@@ -214,21 +268,29 @@ static void coverloader_cache_item_path(char path[4096], const coverloader_req_t
     path_join_to(path, 4096, cachedir, basename);
 }
 
+static void memcache_key_init(memcache_key_t *key, const coverloader_req_t *req) {
+    // Zero the padding too, as the key is hashed and compared bytewise
+    memset(key, 0, sizeof(*key));
+    key->server_id = req->server_id;
+    key->id = req->id;
+    key->target_width = req->target_width;
+    key->target_height = req->target_height;
+}
+
 static bool coverloader_memcache_get(coverloader_req_t *req) {
     // Uses result cache instead
     memcache_item_t *result = NULL;
     memcache_key_t key;
-    memset(&key, 0, sizeof(key));
-    key.id = req->id;
-    key.target_width = req->target_width;
-    key.target_height = req->target_height;
-
-    (void) key.target_width;
-    (void) key.target_height;
+    memcache_key_init(&key, req);
 
     lv_lru_get(req->loader->mem_cache, &key, sizeof(key), (void **) &result);
     req->src = result;
 
+    if (result != NULL) {
+        req->loader->hits++;
+    } else {
+        req->loader->misses++;
+    }
     return result != NULL;
 }
 
@@ -238,17 +300,14 @@ static void coverloader_memcache_put(coverloader_req_t *req) {
         return;
     }
     memcache_item_t *result = NULL;
-    memcache_key_t key = {
-            .id = req->id,
-            .target_width = req->target_width,
-            .target_height = req->target_height
-    };
+    memcache_key_t key;
+    memcache_key_init(&key, req);
     lv_lru_get(req->loader->mem_cache, &key, sizeof(key), (void **) &result);
     if (result == NULL) {
         lv_draw_sdl_drv_param_t *param = lv_disp_get_default()->driver->user_data;
         SDL_Renderer *renderer = param->renderer;
 
-        result = memcache_item_new();
+        result = memcache_item_new(req->loader);
         result->target_width = req->target_width;
         result->target_height = req->target_height;
         result->target_radius = lv_obj_get_style_radius(req->target, 0);
@@ -259,11 +318,11 @@ static void coverloader_memcache_put(coverloader_req_t *req) {
         if (SDL_ISPIXELFORMAT_ALPHA(cached->format->format)) {
             src->header.cf = LV_IMG_CF_TRUE_COLOR_ALPHA;
         }
-        int value_length = cached->w * cached->h;
+        // Texture size in bytes, the cache budget is in bytes as well
+        size_t value_length = (size_t) cached->w * cached->h * 4;
         if (cached->userdata) {
             subimage_info_t *info = cached->userdata;
             data->rect = info->rect;
-            value_length = info->w * info->h;
             src->header.w = info->w;
             src->header.h = info->h;
         } else {
@@ -273,7 +332,12 @@ static void coverloader_memcache_put(coverloader_req_t *req) {
         data->data.texture = SDL_CreateTextureFromSurface(renderer, cached);
         src->data_size = sizeof(lv_sdl_img_data_t);
         src->data = (const uint8_t *) data;
-        lv_lru_set(req->loader->mem_cache, &key, sizeof(key), result, value_length);
+        // Make room first, the LRU itself never has to evict as the budget never exceeds its capacity
+        coverloader_t *loader = req->loader;
+        memcache_evict_to(loader, loader->budget_bytes > value_length ? loader->budget_bytes - value_length : 0);
+        result->size = value_length;
+        loader->used_bytes += value_length;
+        lv_lru_set(loader->mem_cache, &key, sizeof(key), result, value_length);
     }
     req->src = result;
     req->finished = true;
@@ -296,6 +360,8 @@ static bool coverloader_filecache_get(coverloader_req_t *req) {
     SDL_Surface *decoded = IMG_Load(path);
     if (!decoded) {
         commons_log_warn("CoverLoader", "Failed to load cover from %s: %s", path, IMG_GetError());
+        // Don't let a broken file pass revalidation in fetch step
+        remove(path);
         return false;
     }
     if (cover_is_placeholder(decoded)) {
@@ -465,13 +531,15 @@ static void img_set_cover(lv_obj_t *obj, memcache_item_t *src) {
     }
 }
 
-struct memcache_item_t *memcache_item_new() {
+struct memcache_item_t *memcache_item_new(coverloader_t *loader) {
     memcache_item_t *item = calloc(1, sizeof(memcache_item_t));
+    item->loader = loader;
     _lv_ll_init(&item->objs, sizeof(lv_obj_t *));
     return item;
 }
 
 static void memcache_item_free(memcache_item_t *item) {
+    item->loader->used_bytes -= item->size;
     lv_disp_drv_t *driver = lv_disp_get_default()->driver;
     lv_draw_sdl_ctx_t *ctx = (lv_draw_sdl_ctx_t *) driver->draw_ctx;
 
@@ -496,6 +564,21 @@ static void memcache_item_free(memcache_item_t *item) {
     free(item);
 }
 
+/**
+ * Evict least recently used covers until used memory fits in budget. Only these count as evictions, items freed when
+ * the loader is released don't.
+ */
+static void memcache_evict_to(coverloader_t *loader, size_t budget) {
+    while (loader->used_bytes > budget) {
+        size_t used_before = loader->used_bytes;
+        lv_lru_remove_lru_item(loader->mem_cache);
+        if (loader->used_bytes == used_before) {
+            break;
+        }
+        loader->evictions++;
+    }
+}
+
 static void purge_img_cache(lv_draw_sdl_ctx_t *ctx, const memcache_item_t *item) {
     struct __attribute__ ((__packed__)) {
         lv_draw_sdl_cache_key_head_img_t header;
@@ -3,6 +3,7 @@
 #include "backend/pcmanager.h"
 
 #include <stdbool.h>
+#include <stddef.h>
 
 #include "libgamestream/client.h"
 #include "lv_sdl_img.h"
@@ -12,9 +13,21 @@ struct coverloader_t;
 typedef struct app_t app_t;
 typedef struct coverloader_t coverloader_t;
 
+typedef struct coverloader_stats_t {
+    unsigned int hits, misses, evictions;
+    size_t used_bytes, budget_bytes;
+} coverloader_stats_t;
+
 coverloader_t *coverloader_new(app_t *app);
 
 void coverloader_unref(coverloader_t *loader);
 
 void coverloader_display(coverloader_t *loader, const uuidstr_t *uuid, int id, lv_obj_t *target,
-                         lv_coord_t target_width, lv_coord_t target_height);
\ No newline at end of file
+                         lv_coord_t target_width, lv_coord_t target_height);
+
+/**
+ * Evict least recently used covers and halve the memory cache budget. Called on memory pressure.
+ */
+void coverloader_trim_memory(coverloader_t *loader);
+
+void coverloader_get_stats(const coverloader_t *loader, coverloader_stats_t *stats);
\ No newline at end of file
@@ -0,0 +1,129 @@
+#include "hostlist.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+static unsigned int uuid_hash(const uuidstr_t *uuid);
+
+static int slot_find(const hostlist_t *list, const uuidstr_t *uuid);
+
+static bool index_rebuild(hostlist_t *list, int num_slots);
+
+void hostlist_init(hostlist_t *list) {
+    memset(list, 0, sizeof(hostlist_t));
+}
+
+void hostlist_deinit(hostlist_t *list) {
+    free(list->items);
+    free(list->slots);
+    memset(list, 0, sizeof(hostlist_t));
+}
+
+void hostlist_clear(hostlist_t *list) {
+    list->count = 0;
+    if (list->slots != NULL) {
+        memset(list->slots, 0, list->num_slots * sizeof(int));
+    }
+}
+
+int hostlist_append(hostlist_t *list, const uuidstr_t *uuid) {
+    int existing = hostlist_index_of(list, uuid);
+    if (existing >= 0) {
+        return existing;
+    }
+    if (list->count == list->capacity) {
+        int capacity = list->capacity ? list->capacity * 2 : 16;
+        uuidstr_t *items = realloc(list->items, capacity * sizeof(uuidstr_t));
+        if (items == NULL) {
+            return -1;
+        }
+        list->items = items;
+        list->capacity = capacity;
+    }
+    // Keep load factor under 1/2
+    if ((list->count + 1) * 2 > list->num_slots) {
+        if (!index_rebuild(list, list->num_slots ? list->num_slots * 2 : 32)) {
+            return -1;
+        }
+    }
+    int index = list->count++;
+    list->items[index] = *uuid;
+    int slot = slot_find(list, uuid);
+    list->slots[slot] = index + 1;
+    return index;
+}
+
+int hostlist_remove(hostlist_t *list, const uuidstr_t *uuid) {
+    int index = hostlist_index_of(list, uuid);
+    if (index < 0) {
+        return -1;
+    }
+    memmove(&list->items[index], &list->items[index + 1], (list->count - index - 1) * sizeof(uuidstr_t));
+    list->count--;
+    // Indices after the removed row have all changed, removal is rare so just rebuild
+    index_rebuild(list, list->num_slots);
+    return index;
+}
+
+int hostlist_index_of(const hostlist_t *list, const uuidstr_t *uuid) {
+    if (list->num_slots == 0) {
+        return -1;
+    }
+    return list->slots[slot_find(list, uuid)] - 1;
+}
+
+const uuidstr_t *hostlist_get(const hostlist_t *list, int index) {
+    if (index < 0 || index >= list->count) {
+        return NULL;
+    }
+    return &list->items[index];
+}
+
+int hostlist_size(const hostlist_t *list) {
+    if (list == NULL) {
+        return 0;
+    }
+    return list->count;
+}
+
+static unsigned int uuid_hash(const uuidstr_t *uuid) {
+    // FNV-1a
+    unsigned int hash = 2166136261u;
+    const char *str = (const char *) uuid;
+    for (size_t i = 0; i < sizeof(uuidstr_t) && str[i] != '\0'; i++) {
+        hash ^= (unsigned char) str[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+/**
+ * @return Slot holding the UUID, or the empty slot it should be put in
+ */
+static int slot_find(const hostlist_t *list, const uuidstr_t *uuid) {
+    unsigned int mask = list->num_slots - 1;
+    unsigned int slot = uuid_hash(uuid) & mask;
+    while (list->slots[slot] != 0) {
+        if (uuidstr_t_equals_t(&list->items[list->slots[slot] - 1], uuid)) {
+            break;
+        }
+        slot = (slot + 1) & mask;
+    }
+    return (int) slot;
+}
+
+static bool index_rebuild(hostlist_t *list, int num_slots) {
+    if (num_slots != list->num_slots) {
+        int *slots = realloc(list->slots, num_slots * sizeof(int));
+        if (slots == NULL) {
+            return false;
+        }
+        list->slots = slots;
+        list->num_slots = num_slots;
+    }
+    memset(list->slots, 0, num_slots * sizeof(int));
+    for (int i = 0; i < list->count; i++) {
+        list->slots[slot_find(list, &list->items[i])] = i + 1;
+    }
+    return true;
+}
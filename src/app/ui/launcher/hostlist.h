@@ -0,0 +1,47 @@
+#pragma once
+
+#include <stdbool.h>
+
+#include "uuidstr.h"
+
+/**
+ * Rows of host sidebar, in display order. Lookup by UUID is constant time, so change notifications don't need to scan
+ * the whole list.
+ */
+typedef struct hostlist_t {
+    uuidstr_t *items;
+    int count, capacity;
+    /* Open addressing table of row index + 1, 0 means empty slot */
+    int *slots;
+    int num_slots;
+} hostlist_t;
+
+void hostlist_init(hostlist_t *list);
+
+void hostlist_deinit(hostlist_t *list);
+
+void hostlist_clear(hostlist_t *list);
+
+/**
+ * @return Index of the row, or -1 if failed to allocate
+ */
+int hostlist_append(hostlist_t *list, const uuidstr_t *uuid);
+
+/**
+ * Remove the row, rows after it are moved up by one.
+ * @return Index of removed row, or -1 if not found
+ */
+int hostlist_remove(hostlist_t *list, const uuidstr_t *uuid);
+
+/**
+ * @return Index of the row, or -1 if not found
+ */
+int hostlist_index_of(const hostlist_t *list, const uuidstr_t *uuid);
+
+const uuidstr_t *hostlist_get(const hostlist_t *list, int index);
+
+/**
+ * Rows are virtualized, so every host is shown, without LVGL's 255 rows limit of grid layout.
+ * @return Number of rows, 0 if list is NULL
+ */
+int hostlist_size(const hostlist_t *list);
@@ -11,6 +11,7 @@
 #include "ui/root.h"
 #include "ui/settings/settings.controller.h"
 
+#include "lvgl/ext/lv_fragment_arena.h"
 #include "lvgl/font/material_icons_regular_symbols.h"
 #include "lvgl/util/lv_app_utils.h"
 #include "lv_gridview.h"
@@ -32,12 +33,26 @@ static bool launcher_event_cb(lv_fragment_t *self, int code, void *userdata);
 
 static void on_pc_added(const uuidstr_t *uuid, void *userdata);
 
-static void on_pc_updated(const uuidstr_t *uuid, void *userdata);
+static void on_pc_updated(const uuidstr_t *uuid, pcmanager_change_t changes, void *userdata);
 
 static void on_pc_removed(const uuidstr_t *uuid, void *userdata);
 
 static void update_pclist(launcher_fragment_t *controller);
 
+static void pclist_data_changed(launcher_fragment_t *controller);
+
+static lv_obj_t *pclist_find_view(launcher_fragment_t *controller, const uuidstr_t *uuid);
+
+static int pclist_item_count(lv_obj_t *grid, void *data);
+
+static lv_obj_t *pclist_create_view(lv_obj_t *grid);
+
+static void pclist_bind_view(lv_obj_t *grid, lv_obj_t *view, void *data, int position);
+
+static void pclist_focus_enter(lv_event_t *event);
+
+static void pclist_focus_leave(lv_event_t *event);
+
 static void cb_pc_selected(lv_event_t *event);
 
 static void cb_pc_longpress(lv_event_t *event);
@@ -60,7 +75,11 @@ static void select_pc(launcher_fragment_t *controller, const uuidstr_t *uuid, bo
 
 static void set_detail_opened(launcher_fragment_t *controller, bool opened);
 
-static lv_obj_t *pclist_item_create(launcher_fragment_t *fragment, const pclist_t *node);
+static bool pclist_key_handled(launcher_fragment_t *fragment, lv_event_t *event);
+
+static lv_obj_t *pclist_item_create(launcher_fragment_t *fragment, lv_obj_t *parent);
+
+static void pclist_item_bind(lv_obj_t *pcitem, const pclist_t *node);
 
 static void pclist_item_deleted(lv_event_t *e);
 
@@ -86,6 +105,12 @@ const lv_fragment_class_t launcher_controller_class = {
         .instance_size = sizeof(launcher_fragment_t),
 };
 
+static const lv_gridview_adapter_t pclist_adapter = {
+        .item_count = pclist_item_count,
+        .create_view = pclist_create_view,
+        .bind_view = pclist_bind_view,
+};
+
 static const pcmanager_listener_t pcmanager_callbacks = {
         .added = on_pc_added,
         .updated = on_pc_updated,
@@ -131,6 +156,8 @@ static void launcher_controller(lv_fragment_t *self, void *args) {
     int host_icon_pad = (LV_DPX(NAV_WIDTH_COLLAPSED) - ico_width_def) / 2;
     lv_style_set_pad_left(&fragment->nav_host_style, host_icon_pad);
     lv_style_set_pad_gap(&fragment->nav_host_style, host_icon_pad);
+    // Rows are recycled with a fixed height
+    lv_style_set_pad_ver(&fragment->nav_host_style, LV_DPX(NAV_HOST_PAD_VER));
 
     lv_style_init(&fragment->nav_menu_style);
     lv_style_set_border_side(&fragment->nav_menu_style, LV_BORDER_SIDE_NONE);
@@ -144,12 +171,14 @@ static void launcher_controller(lv_fragment_t *self, void *args) {
     fragment->pane_initialized = false;
     fragment->first_created = true;
     fragment->launch_params = fargs->params;
+    hostlist_init(&fragment->hosts);
 }
 
 static void controller_dtor(lv_fragment_t *self) {
     launcher_fragment_t *controller = (launcher_fragment_t *) self;
     lv_style_reset(&controller->nav_menu_style);
     lv_style_reset(&controller->nav_host_style);
+    hostlist_deinit(&controller->hosts);
 }
 
 static void launcher_view_init(lv_fragment_t *self, lv_obj_t *view) {
@@ -163,11 +192,16 @@ static void launcher_view_init(lv_fragment_t *self, lv_obj_t *view) {
     lv_obj_add_event_cb(fragment->detail, cb_detail_cancel, LV_EVENT_CANCEL, fragment);
     lv_obj_add_event_cb(fragment->pclist, cb_pc_selected, LV_EVENT_SHORT_CLICKED, fragment);
     lv_obj_add_event_cb(fragment->pclist, cb_pc_longpress, LV_EVENT_LONG_PRESSED, fragment);
+    lv_obj_add_event_cb(fragment->pclist, pclist_focus_enter, LV_EVENT_FOCUSED, fragment);
+    lv_obj_add_event_cb(fragment->pclist, pclist_focus_leave, LV_EVENT_DEFOCUSED, fragment);
     lv_obj_add_event_cb(fragment->add_btn, open_manual_add, LV_EVENT_CLICKED, fragment);
     lv_obj_add_event_cb(fragment->pref_btn, open_settings, LV_EVENT_CLICKED, fragment);
     lv_obj_add_event_cb(fragment->help_btn, open_help, LV_EVENT_CLICKED, fragment);
     lv_obj_add_event_cb(fragment->quit_btn, app_quit_confirm, LV_EVENT_CLICKED, fragment);
 
+    lv_obj_set_user_data(fragment->pclist, fragment);
+    lv_gridview_set_adapter(fragment->pclist, &pclist_adapter);
+    fragment->pclist_focus = -1;
     update_pclist(fragment);
 
     populate_selected_host(fragment);
@@ -178,13 +212,12 @@ static void launcher_view_init(lv_fragment_t *self, lv_obj_t *view) {
             if (fragment->first_created) {
                 fragment->detail_opened = true;
             }
-            continue;
         }
-        pcmanager_request_update(pcmanager, &cur->id, NULL, NULL);
     }
     fragment->pane_initialized = true;
     set_detail_opened(fragment, fragment->detail_opened);
     pcmanager_auto_discovery_start(pcmanager);
+    pcmanager_polling_start(pcmanager);
 
     lv_obj_set_style_transition(fragment->detail, &fragment->tr_nav, 0);
     lv_obj_set_style_transition(fragment->detail, &fragment->tr_detail, LV_STATE_USER_1);
@@ -207,6 +240,7 @@ static void launcher_view_destroy(lv_fragment_t *self, lv_obj_t *view) {
     current_instance = NULL;
     app_input_set_group(&controller->global->ui.input, NULL);
     pcmanager_auto_discovery_stop(pcmanager);
+    pcmanager_polling_stop(pcmanager);
 
     controller->pane_initialized = false;
     controller->launch_params = NULL;
@@ -228,35 +262,28 @@ static bool launcher_event_cb(lv_fragment_t *self, int code, void *userdata) {
 
 void on_pc_added(const uuidstr_t *uuid, void *userdata) {
     launcher_fragment_t *controller = userdata;
-    const pclist_t *node = pcmanager_node(pcmanager, uuid);
-    if (node == NULL) { return; }
-    pclist_item_create(controller, node);
+    if (hostlist_append(&controller->hosts, uuid) < 0) { return; }
+    pclist_data_changed(controller);
 
     populate_selected_host(controller);
 }
 
-void on_pc_updated(const uuidstr_t *uuid, void *userdata) {
+void on_pc_updated(const uuidstr_t *uuid, pcmanager_change_t changes, void *userdata) {
     launcher_fragment_t *controller = userdata;
-    for (uint16_t i = 0, j = lv_obj_get_child_cnt(controller->pclist); i < j; i++) {
-        lv_obj_t *child = lv_obj_get_child(controller->pclist, i);
-        const uuidstr_t *item_id = (const uuidstr_t *) lv_obj_get_user_data(child);
-        if (!uuidstr_t_equals_t(uuid, item_id)) { continue; }
-        const pclist_t *node = pcmanager_node(pcmanager, item_id);
-        const char *icon = server_item_icon(node);
-        lv_btn_set_icon(child, icon);
-        break;
-    }
+    // Row only shows state, running game and host name
+    if (!(changes & (PCMANAGER_CHANGE_STATE | PCMANAGER_CHANGE_PAIRED | PCMANAGER_CHANGE_CURRENT_APP |
+                     PCMANAGER_CHANGE_INFO))) { return; }
+    if (hostlist_index_of(&controller->hosts, uuid) < 0) { return; }
+    // Rows scrolled out of view will be bound with latest info when they come back
+    lv_obj_t *pcitem = pclist_find_view(controller, uuid);
+    if (pcitem == NULL) { return; }
+    pclist_item_bind(pcitem, pcmanager_node(pcmanager, uuid));
 }
 
 void on_pc_removed(const uuidstr_t *uuid, void *userdata) {
     launcher_fragment_t *controller = userdata;
-    for (uint16_t i = 0, j = lv_obj_get_child_cnt(controller->pclist); i < j; i++) {
-        lv_obj_t *child = lv_obj_get_child(controller->pclist, i);
-        const uuidstr_t *item_id = (const uuidstr_t *) lv_obj_get_user_data(child);
-        if (!uuidstr_t_equals_t(uuid, item_id)) { continue; }
-        lv_obj_del(child);
-        break;
-    }
+    if (hostlist_remove(&controller->hosts, uuid) < 0) { return; }
+    pclist_data_changed(controller);
 }
 
 static void cb_pc_selected(lv_event_t *event) {
@@ -273,7 +300,7 @@ static void cb_pc_longpress(lv_event_t *event) {
     if (lv_obj_get_parent(target) != lv_event_get_current_target(event)) { return; }
     const uuidstr_t *uuid = (const uuidstr_t *) lv_obj_get_user_data(target);
     lv_fragment_t *fragment = lv_fragment_create(&server_menu_class, (void *) uuid);
-    lv_obj_t *msgbox = lv_fragment_create_obj(fragment, NULL);
+    lv_obj_t *msgbox = lv_fragment_create_obj_arena(fragment, NULL, "server_menu");
     lv_obj_add_event_cb(msgbox, ui_cb_destroy_fragment, LV_EVENT_DELETE, fragment);
 }
 
@@ -286,31 +313,90 @@ static void select_pc(launcher_fragment_t *controller, const uuidstr_t *uuid, bo
             arg.def_app = params->default_app_id;
         }
         lv_fragment_t *fragment = lv_fragment_create(&apps_controller_class, &arg);
+        lv_mem_app_arena_t *arena = lv_fragment_arena_begin("apps");
         lv_fragment_manager_replace(controller->base.child_manager, fragment, &controller->detail);
+        lv_fragment_arena_end(arena, fragment);
     } else {
         lv_fragment_manager_pop(controller->base.child_manager);
     }
-    for (int i = 0, pclen = (int) lv_obj_get_child_cnt(controller->pclist); i < pclen; i++) {
-        lv_obj_t *pcitem = lv_obj_get_child(controller->pclist, i);
-        const uuidstr_t *cur_id = (const uuidstr_t *) lv_obj_get_user_data(pcitem);
-        if (uuidstr_t_equals_t(cur_id, uuid)) {
-            pcmanager_select(pcmanager, uuid);
-            pcitem_set_selected(pcitem, true);
-            if (refocus) {
-                lv_group_focus_obj(pcitem);
-            }
-        } else {
-            pcitem_set_selected(pcitem, false);
-        }
+    if (uuid) {
+        pcmanager_select(pcmanager, uuid);
+    }
+    // Selection is stored in pcmanager, visible rows only need to be bound again
+    lv_gridview_rebind(controller->pclist);
+    int index = uuid ? hostlist_index_of(&controller->hosts, uuid) : -1;
+    if (refocus && index >= 0) {
+        lv_group_focus_obj(controller->pclist);
+        lv_gridview_focus(controller->pclist, index);
+        controller->pclist_focus = index;
     }
 }
 
 static void update_pclist(launcher_fragment_t *controller) {
-    lv_obj_clean(controller->pclist);
+    hostlist_clear(&controller->hosts);
     for (const pclist_t *cur = pcmanager_servers(pcmanager); cur != NULL; cur = cur->next) {
-        lv_obj_t *pcitem = pclist_item_create(controller, cur);
-        pcitem_set_selected(pcitem, cur->selected);
+        hostlist_append(&controller->hosts, &cur->id);
+    }
+    pclist_data_changed(controller);
+}
+
+static void pclist_data_changed(launcher_fragment_t *controller) {
+    lv_gridview_set_data_advanced(controller->pclist, &controller->hosts, NULL, -1);
+}
+
+/**
+ * Only visible rows have views, so this is bounded by the viewport rather than number of hosts.
+ */
+static lv_obj_t *pclist_find_view(launcher_fragment_t *controller, const uuidstr_t *uuid) {
+    for (uint32_t i = 0, j = lv_obj_get_child_cnt(controller->pclist); i < j; i++) {
+        lv_obj_t *child = lv_obj_get_child(controller->pclist, i);
+        const uuidstr_t *item_id = (const uuidstr_t *) lv_obj_get_user_data(child);
+        if (item_id != NULL && uuidstr_t_equals_t(uuid, item_id)) {
+            return child;
+        }
     }
+    return NULL;
+}
+
+static int pclist_item_count(lv_obj_t *grid, void *data) {
+    LV_UNUSED(grid);
+    return hostlist_size(data);
+}
+
+static lv_obj_t *pclist_create_view(lv_obj_t *grid) {
+    launcher_fragment_t *fragment = lv_obj_get_user_data(grid);
+    return pclist_item_create(fragment, grid);
+}
+
+static void pclist_bind_view(lv_obj_t *grid, lv_obj_t *view, void *data, int position) {
+    LV_UNUSED(grid);
+    const uuidstr_t *uuid = hostlist_get(data, position);
+    *((uuidstr_t *) lv_obj_get_user_data(view)) = *uuid;
+    pclist_item_bind(view, pcmanager_node(pcmanager, uuid));
+}
+
+static void pclist_focus_enter(lv_event_t *event) {
+    if (event->target != event->current_target) { return; }
+    launcher_fragment_t *controller = lv_event_get_user_data(event);
+    int index = controller->pclist_focus;
+    if (index < 0 || index >= controller->hosts.count) {
+        index = 0;
+        for (const pclist_t *cur = pcmanager_servers(pcmanager); cur != NULL; cur = cur->next) {
+            if (cur->selected) {
+                index = LV_MAX(hostlist_index_of(&controller->hosts, &cur->id), 0);
+                break;
+            }
+        }
+    }
+    lv_gridview_focus(controller->pclist, index);
+    controller->pclist_focus = index;
+}
+
+static void pclist_focus_leave(lv_event_t *event) {
+    if (event->target != event->current_target) { return; }
+    launcher_fragment_t *controller = lv_event_get_user_data(event);
+    controller->pclist_focus = lv_gridview_get_focused_index(controller->pclist);
+    lv_gridview_focus(controller->pclist, -1);
 }
 
 static void pcitem_set_selected(lv_obj_t *pcitem, bool selected) {
@@ -324,12 +410,14 @@ static void pcitem_set_selected(lv_obj_t *pcitem, bool selected) {
     }
 }
 
-static lv_obj_t *pclist_item_create(launcher_fragment_t *fragment, const pclist_t *node) {
+static lv_obj_t *pclist_item_create(launcher_fragment_t *fragment, lv_obj_t *parent) {
     app_ui_t *ui = &fragment->global->ui;
 
-    const SERVER_DATA *server = node->server;
-    const char *icon = server_item_icon(node);
-    lv_obj_t *pcitem = lv_list_add_btn(fragment->pclist, icon, server->hostname);
+    lv_obj_t *pcitem = lv_list_add_btn(parent, MAT_SYMBOL_TV, "");
+    // Recycled rows are focused through the list, not the navigation group
+    if (lv_obj_get_group(pcitem)) {
+        lv_group_remove_obj(pcitem);
+    }
     lv_obj_add_flag(pcitem, LV_OBJ_FLAG_EVENT_BUBBLE);
     lv_obj_add_style(pcitem, &fragment->nav_host_style, 0);
     lv_obj_t *btn_img = lv_btn_find_img(pcitem);
@@ -340,13 +428,21 @@ static lv_obj_t *pclist_item_create(launcher_fragment_t *fragment, const pclist_
     lv_obj_set_style_outline_color(btn_img, lv_color_white(), LV_STATE_CHECKED);
     lv_obj_set_style_outline_opa(btn_img, LV_OPA_COVER, LV_STATE_CHECKED);
     lv_obj_set_style_outline_width(btn_img, LV_DPX(2), LV_STATE_CHECKED);
-    uuidstr_t *uuid = SDL_malloc(sizeof(uuidstr_t));
-    *uuid = node->id;
+    uuidstr_t *uuid = SDL_calloc(1, sizeof(uuidstr_t));
     lv_obj_set_user_data(pcitem, uuid);
     lv_obj_add_event_cb(pcitem, pclist_item_deleted, LV_EVENT_DELETE, NULL);
     return pcitem;
 }
 
+static void pclist_item_bind(lv_obj_t *pcitem, const pclist_t *node) {
+    lv_btn_set_icon(pcitem, server_item_icon(node));
+    lv_obj_t *label = lv_btn_find_label(pcitem);
+    if (label != NULL) {
+        lv_label_set_text(label, node != NULL && node->server != NULL ? node->server->hostname : "");
+    }
+    pcitem_set_selected(pcitem, node != NULL && node->selected);
+}
+
 static void pclist_item_deleted(lv_event_t *e) {
     lv_obj_t *target = lv_event_get_target(e);
     void *uuid = lv_obj_get_user_data(target);
@@ -402,11 +498,13 @@ static void cb_nav_key(lv_event_t *event) {
     launcher_fragment_t *fragment = lv_event_get_user_data(event);
     switch (lv_event_get_key(event)) {
         case LV_KEY_UP: {
+            if (pclist_key_handled(fragment, event)) { break; }
             lv_group_t *group = fragment->nav_group;
             lv_group_focus_prev(group);
             break;
         }
         case LV_KEY_DOWN: {
+            if (pclist_key_handled(fragment, event)) { break; }
             lv_group_t *group = fragment->nav_group;
             lv_group_focus_next(group);
             break;
@@ -422,6 +520,16 @@ static void cb_nav_key(lv_event_t *event) {
     }
 }
 
+/**
+ * Host list moves its focus by itself, navigation group only takes over when the focus is already on first or last row.
+ */
+static bool pclist_key_handled(launcher_fragment_t *fragment, lv_event_t *event) {
+    if (lv_event_get_target(event) != fragment->pclist) { return false; }
+    int prev = fragment->pclist_focus;
+    fragment->pclist_focus = lv_gridview_get_focused_index(fragment->pclist);
+    return fragment->pclist_focus != prev;
+}
+
 static void set_detail_opened(launcher_fragment_t *controller, bool opened) {
     bool key = app_ui_get_input_mode(&controller->global->ui.input) & UI_INPUT_MODE_BUTTON_FLAG;
     if (opened) {
@@ -452,7 +560,7 @@ static void set_detail_opened(launcher_fragment_t *controller, bool opened) {
 static void open_manual_add(lv_event_t *event) {
     LV_UNUSED(event);
     lv_fragment_t *fragment = lv_fragment_create(&add_dialog_class, NULL);
-    lv_obj_t *msgbox = lv_fragment_create_obj(fragment, NULL);
+    lv_obj_t *msgbox = lv_fragment_create_obj_arena(fragment, NULL, "add_dialog");
     lv_obj_add_event_cb(msgbox, ui_cb_destroy_fragment, LV_EVENT_DELETE, fragment);
 }
 
@@ -460,7 +568,9 @@ static void open_settings(lv_event_t *event) {
     launcher_fragment_t *self = lv_event_get_user_data(event);
     lv_fragment_t *fragment = lv_fragment_create(&settings_controller_cls, self->global);
     lv_obj_t *const *container = lv_fragment_get_container(lv_fragment_manager_get_top(self->global->ui.fm));
+    lv_mem_app_arena_t *arena = lv_fragment_arena_begin("settings");
     lv_fragment_manager_push(self->global->ui.fm, fragment, container);
+    lv_fragment_arena_end(arena, fragment);
 }
 
 static void show_decoder_error() {
@@ -7,6 +7,7 @@
 #include "lv_sdl_img.h"
 
 #include "backend/pcmanager.h"
+#include "hostlist.h"
 
 typedef struct app_t app_t;
 typedef struct app_launch_params_t app_launch_params_t;
@@ -24,6 +25,10 @@ typedef struct launcher_fragment_t {
     lv_obj_t *nav;
     lv_obj_t *detail;
     lv_obj_t *pclist;
+    /* Rows of pclist, only visible rows have views */
+    hostlist_t hosts;
+    /* Focused row before the last key event, or when pclist isn't focused */
+    int pclist_focus;
     lv_obj_t *add_btn, *pref_btn, *help_btn, *quit_btn;
     lv_group_t *nav_group, *detail_group;
     lv_style_transition_dsc_t tr_nav;
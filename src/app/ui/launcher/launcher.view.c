@@ -4,6 +4,7 @@
 #include "ui/root.h"
 
 #include "lvgl.h"
+#include "lv_gridview.h"
 
 #include "lvgl/ext/lv_child_group.h"
 #include "lvgl/util/lv_app_utils.h"
@@ -93,13 +94,19 @@ lv_obj_t *launcher_win_create(lv_fragment_t *self, lv_obj_t *parent) {
     lv_label_set_text_static(title_label, "Moonlight");
     lv_obj_get_style_flex_grow(title_label, 1);
 
-    lv_obj_t *pclist = lv_list_create(nav);
+    // Only visible hosts have their rows created, so the list stays light with hundreds of hosts
+    lv_obj_t *pclist = lv_gridview_create(nav);
     lv_obj_add_flag(pclist, LV_OBJ_FLAG_EVENT_BUBBLE);
     lv_obj_set_width(pclist, LV_PCT(100));
+    lv_obj_set_scroll_dir(pclist, LV_DIR_VER);
+    lv_obj_set_scrollbar_mode(pclist, LV_SCROLLBAR_MODE_ACTIVE);
     lv_obj_set_style_pad_all(pclist, 0, 0);
+    lv_obj_set_style_pad_gap(pclist, 0, 0);
     lv_obj_set_style_radius(pclist, 0, 0);
     lv_obj_set_style_border_width(pclist, 0, 0);
     lv_obj_set_style_bg_opa(pclist, 0, 0);
+    lv_coord_t row_height = lv_font_get_line_height(ui->fonts.icons.normal) + 2 * LV_DPX(NAV_HOST_PAD_VER);
+    lv_gridview_set_config(pclist, 1, row_height, LV_GRID_ALIGN_STRETCH, LV_GRID_ALIGN_CENTER);
 
     lv_obj_set_flex_grow(pclist, 1);
 
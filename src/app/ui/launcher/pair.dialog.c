@@ -1,5 +1,6 @@
 #include "app.h"
 #include "launcher.controller.h"
+#include "lvgl/ext/lv_fragment_arena.h"
 #include "lvgl/util/lv_app_utils.h"
 
 #include "errors.h"
@@ -35,7 +36,7 @@ const lv_fragment_class_t pair_dialog_class = {
 
 void pair_dialog_open(const uuidstr_t *uuid) {
     lv_fragment_t *fragment = lv_fragment_create(&pair_dialog_class, (void *) uuid);
-    lv_obj_t *msgbox = lv_fragment_create_obj(fragment, NULL);
+    lv_obj_t *msgbox = lv_fragment_create_obj_arena(fragment, NULL, "pair_dialog");
     lv_obj_add_event_cb(msgbox, ui_cb_destroy_fragment, LV_EVENT_DELETE, fragment);
 }
 
@@ -16,8 +16,11 @@
 #include "util/bus.h"
 #include "util/user_event.h"
 #include "util/font.h"
+#include "util/path.h"
+#include "util/startup_trace.h"
 
 #include <SDL_image.h>
+#include <time.h>
 
 #include "logging_ext_lvgl.h"
 #include "fatal_error.h"
@@ -48,13 +51,29 @@ static void session_error();
 
 static void session_error_dialog_cb(lv_event_t *event);
 
+static void ui_timers_set_paused(bool paused);
+
+static uint64_t thread_cpu_time_ns();
+
+static void stream_stats_begin(app_ui_t *ui);
+
+static void stream_stats_end(app_ui_t *ui);
+
+static void first_frame_monitor(lv_disp_drv_t *driver, uint32_t time, uint32_t px);
+
+static bool first_frame_presented = false;
+
 void app_ui_init(app_ui_t *ui, app_t *app) {
     ui->app = app;
     ui->window = app_ui_create_window(ui);
     lv_log_register_print_cb(commons_lv_log);
     lv_init();
     ui->img_decoder = lv_sdl_img_decoder_init(IMG_INIT_JPG | IMG_INIT_PNG);
-    app_font_init(&ui->fonts, ui->dpi);
+    char *cache_dir = path_cache();
+    int fonts_trace = startup_trace_begin("fonts");
+    app_font_init(&ui->fonts, ui->dpi, cache_dir, app_configuration->glyph_atlas);
+    startup_trace_end(fonts_trace);
+    free(cache_dir);
     lv_memset_00(&ui->theme, sizeof(lv_theme_t));
     lv_theme_moonlight_init(&ui->theme, &ui->fonts, app);
 }
@@ -76,6 +95,9 @@ void app_ui_open(app_ui_t *ui, const app_launch_params_t *params) {
         ui->window = app_ui_create_window(ui);
     }
     lv_disp_drv_t *driver = lv_app_disp_drv_create(ui->window, ui->dpi);
+    if (!first_frame_presented) {
+        driver->monitor_cb = first_frame_monitor;
+    }
     lv_disp_t *disp = lv_disp_drv_register(driver);
     disp->bg_color = lv_color_make(0, 0, 0);
     disp->bg_opa = 0;
@@ -110,6 +132,7 @@ void app_ui_close(app_ui_t *ui) {
     if (ui->disp == NULL) {
         return;
     }
+    app_ui_set_suspended(ui, false);
 
     lv_fragment_manager_del(ui->fm);
 
@@ -131,6 +154,30 @@ bool app_ui_is_opened(const app_ui_t *ui) {
     return ui->disp != NULL;
 }
 
+void app_ui_set_suspended(app_ui_t *ui, bool suspended) {
+    if (ui->suspended == suspended || (suspended && ui->disp == NULL)) {
+        return;
+    }
+    ui->suspended = suspended;
+    ui_timers_set_paused(suspended);
+    Uint64 now = SDL_GetPerformanceCounter();
+    if (suspended) {
+        ui->stream_stats.suspended_since = now;
+    } else {
+        if (ui->stream_stats.suspended_since != 0) {
+            ui->stream_stats.suspended_total += now - ui->stream_stats.suspended_since;
+            ui->stream_stats.suspended_since = 0;
+        }
+        // Draw changes happened while suspended right away
+        lv_timer_ready(ui->disp->refr_timer);
+    }
+    commons_log_debug("UI", "UI %s", suspended ? "suspended" : "resumed");
+}
+
+bool app_ui_is_suspended(const app_ui_t *ui) {
+    return ui->suspended;
+}
+
 bool ui_has_stream_renderer() {
 //    return ui_stream_render != NULL && ui_stream_render->renderDraw;
     return false;
@@ -167,9 +214,11 @@ bool ui_dispatch_userevent(app_t *app, int which, void *data1, void *data2) {
                 app_set_keep_awake(app, true);
                 streaming_enter_fullscreen(app->session);
                 last_pts = 0;
+                stream_stats_begin(&app->ui);
                 return true;
             }
             case USER_STREAM_CLOSE: {
+                stream_stats_end(&app->ui);
                 if (app->ss4s.video_cap.transform & SS4S_VIDEO_CAP_TRANSFORM_UI_EXCLUSIVE) {
                     SDL_ShowCursor(SDL_TRUE);
                 } else {
@@ -335,6 +384,70 @@ static SDL_AssertState app_assertion_handler_ui(const SDL_AssertData *data, void
     return SDL_ASSERTION_ALWAYS_IGNORE;
 }
 
+static void ui_timers_set_paused(bool paused) {
+    void (*set_state)(lv_timer_t *) = paused ? lv_timer_pause : lv_timer_resume;
+    lv_disp_t *disp = lv_disp_get_default();
+    if (disp != NULL && disp->refr_timer != NULL) {
+        set_state(disp->refr_timer);
+    }
+    for (lv_indev_t *indev = lv_indev_get_next(NULL); indev != NULL; indev = lv_indev_get_next(indev)) {
+        lv_timer_t *read_timer = lv_indev_get_read_timer(indev);
+        if (read_timer != NULL) {
+            set_state(read_timer);
+        }
+    }
+    set_state(lv_anim_get_timer());
+}
+
+static uint64_t thread_cpu_time_ns() {
+#ifdef CLOCK_THREAD_CPUTIME_ID
+    struct timespec ts;
+    if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) == 0) {
+        return (uint64_t) ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+    }
+#endif
+    return 0;
+}
+
+static void stream_stats_begin(app_ui_t *ui) {
+    ui->stream_stats.started = SDL_GetPerformanceCounter();
+    ui->stream_stats.suspended_total = 0;
+    ui->stream_stats.suspended_since = ui->suspended ? ui->stream_stats.started : 0;
+    ui->stream_stats.cpu_started = thread_cpu_time_ns();
+}
+
+static void stream_stats_end(app_ui_t *ui) {
+    if (ui->stream_stats.started == 0) {
+        return;
+    }
+    Uint64 now = SDL_GetPerformanceCounter();
+    Uint64 suspended = ui->stream_stats.suspended_total;
+    if (ui->stream_stats.suspended_since != 0) {
+        suspended += now - ui->stream_stats.suspended_since;
+    }
+    Uint64 elapsed = now - ui->stream_stats.started;
+    ui->stream_stats.started = 0;
+    if (elapsed == 0) {
+        return;
+    }
+    double elapsed_s = (double) elapsed / (double) SDL_GetPerformanceFrequency();
+    double cpu_s = (double) (thread_cpu_time_ns() - ui->stream_stats.cpu_started) / 1e9;
+    commons_log_info("UI", "Main thread CPU while streaming: %.1f%% of %.1f s, UI suspended for %.0f%% of the time",
+                     cpu_s / elapsed_s * 100, elapsed_s, (double) suspended / (double) elapsed * 100);
+}
+
+static void first_frame_monitor(lv_disp_drv_t *driver, uint32_t time, uint32_t px) {
+    LV_UNUSED(time);
+    LV_UNUSED(px);
+    driver->monitor_cb = NULL;
+    first_frame_presented = true;
+    startup_trace_mark("first_frame");
+    startup_trace_report();
+    // Glyphs on the first screen are now known, the next launch can skip rasterizing them. Only copying them out of
+    // FreeType cache is done here, files are written in background.
+    app_font_save_atlas_async(&global->ui.fonts, global->backend.executor);
+}
+
 static void session_error() {
     static const char *btn_texts[] = {translatable("OK"), ""};
     lv_obj_t *dialog = lv_msgbox_create_i18n(NULL, locstr("Failed to start streaming"), streaming_errmsg,
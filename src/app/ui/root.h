@@ -33,6 +33,13 @@ struct app_ui_t {
     lv_disp_t *disp;
     lv_obj_t *container;
     lv_fragment_manager_t *fm;
+
+    // Streaming render mode, see app_ui_set_suspended
+    bool suspended;
+    struct {
+        Uint64 started, suspended_since, suspended_total;
+        uint64_t cpu_started;
+    } stream_stats;
 };
 
 typedef struct {
@@ -42,6 +49,7 @@ typedef struct {
 
 #define NAV_WIDTH_COLLAPSED 44
 #define NAV_LOGO_SIZE 24
+#define NAV_HOST_PAD_VER 10
 
 const lv_img_dsc_t *ui_logo_src();
 
@@ -55,6 +63,14 @@ void app_ui_close(app_ui_t *ui);
 
 bool app_ui_is_opened(const app_ui_t *ui);
 
+/**
+ * @brief Pause LVGL refresh, input device polling and animations while nothing is drawn on top of the video.
+ * Input events will be sent to the session directly when suspended.
+ */
+void app_ui_set_suspended(app_ui_t *ui, bool suspended);
+
+bool app_ui_is_suspended(const app_ui_t *ui);
+
 bool ui_has_stream_renderer();
 
 bool ui_render_background();
@@ -4,6 +4,7 @@
 
 #include "lvgl/font/material_icons_regular_symbols.h"
 #include "lvgl/ext/lv_child_group.h"
+#include "lvgl/ext/lv_fragment_arena.h"
 #include "lvgl/util/lv_app_utils.h"
 
 #include "util/user_event.h"
@@ -113,7 +114,7 @@ static void on_view_created(lv_fragment_t *self, lv_obj_t *view) {
             lv_obj_add_event_cb(page, cb_child_group_add, LV_EVENT_CHILD_CREATED, tab_group);
             lv_obj_add_event_cb(page, pane_child_added, LV_EVENT_CHILD_CREATED, controller);
             lv_fragment_t *pane = lv_fragment_create(entry.cls, controller);
-            lv_fragment_create_obj(pane, page);
+            lv_fragment_create_obj_arena(pane, page, "settings_pane");
             lv_obj_set_user_data(page, pane);
 
             lv_obj_t *tab_focused = lv_group_get_focused(tab_group);
@@ -209,7 +210,9 @@ static void on_entry_focus(lv_event_t *event) {
 
 static void show_pane(settings_controller_t *controller, const lv_fragment_class_t *cls) {
     lv_fragment_t *fragment = lv_fragment_create(cls, controller);
+    lv_mem_app_arena_t *arena = lv_fragment_arena_begin("settings_pane");
     lv_fragment_manager_replace(controller->base.child_manager, fragment, &controller->detail);
+    lv_fragment_arena_end(arena, fragment);
     lv_obj_scroll_to_y(controller->detail, 0, LV_ANIM_OFF);
     lv_obj_t *focused = lv_group_get_focused(controller->detail_group);
     lv_event_send(focused, LV_EVENT_DEFOCUSED, NULL);
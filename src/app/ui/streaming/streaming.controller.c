@@ -2,6 +2,7 @@
 #include "app_session.h"
 #include "streaming.controller.h"
 #include "stream/video/session_video.h"
+#include "stream/session_timeline.h"
 #include "ui/root.h"
 #include "ui/common/progress_dialog.h"
 #include "lvgl/lv_ext_utils.h"
@@ -40,6 +41,8 @@ static void update_buttons_layout(streaming_controller_t *controller);
 
 static void pin_toggle(lv_event_t *e);
 
+static void update_ui_suspended(streaming_controller_t *controller);
+
 const lv_fragment_class_t streaming_controller_class = {
         .constructor_cb = constructor,
         .destructor_cb = controller_dtor,
@@ -84,8 +87,14 @@ bool streaming_refresh_stats() {
     lv_label_set_text_fmt(controller->stats_items.net_fps, "%.2f FPS", dst->receivedFps);
 
     if (dst->submittedFrames) {
-        lv_label_set_text_fmt(controller->stats_items.drop_rate, "%.2f%%",
-                              (float) dst->networkDroppedFrames / (float) dst->totalFrames * 100);
+        if (dst->backpressureDroppedFrames) {
+            lv_label_set_text_fmt(controller->stats_items.drop_rate, "%.2f%% (decoder %.2f%%)",
+                                  (float) dst->networkDroppedFrames / (float) dst->totalFrames * 100,
+                                  (float) dst->backpressureDroppedFrames / (float) dst->totalFrames * 100);
+        } else {
+            lv_label_set_text_fmt(controller->stats_items.drop_rate, "%.2f%%",
+                                  (float) dst->networkDroppedFrames / (float) dst->totalFrames * 100);
+        }
         if (vdec_stream_info.has_host_latency) {
             float avgCapLatency = (float) dst->totalCaptureLatency / (float) dst->submittedFrames / 10.0f;
             lv_label_set_text_fmt(controller->stats_items.host_latency, "avg %.2f ms", avgCapLatency);
@@ -104,6 +113,9 @@ bool streaming_refresh_stats() {
         lv_label_set_text_fmt(controller->stats_items.host_latency, "-");
         lv_label_set_text_fmt(controller->stats_items.vdec_latency, "-");
     }
+    char startup[64];
+    session_timeline_summary(startup, sizeof(startup));
+    lv_label_set_text(controller->stats_items.startup, startup);
     return true;
 }
 
@@ -116,6 +128,7 @@ void streaming_notice_show(const char *message) {
     } else {
         lv_obj_add_flag(controller->notice, LV_OBJ_FLAG_HIDDEN);
     }
+    update_ui_suspended(controller);
 }
 
 static void constructor(lv_fragment_t *self, void *args) {
@@ -161,9 +174,13 @@ static bool on_event(lv_fragment_t *self, int code, void *userdata) {
             }
             lv_obj_add_flag(controller->overlay, LV_OBJ_FLAG_HIDDEN);
             lv_obj_add_flag(controller->hint, LV_OBJ_FLAG_HIDDEN);
+            controller->stream_opened = true;
+            update_ui_suspended(controller);
             break;
         }
         case USER_STREAM_CLOSE: {
+            controller->stream_opened = false;
+            update_ui_suspended(controller);
             controller->progress = progress_dialog_create(locstr("Disconnecting..."));
             lv_obj_add_flag(controller->overlay, LV_OBJ_FLAG_HIDDEN);
             lv_obj_add_flag(controller->stats, LV_OBJ_FLAG_HIDDEN);
@@ -235,8 +252,11 @@ static void on_view_created(lv_fragment_t *self, lv_obj_t *view) {
 static void on_delete_obj(lv_fragment_t *self, lv_obj_t *view) {
     LV_UNUSED(view);
     streaming_controller_t *controller = (streaming_controller_t *) self;
+    controller->stream_opened = false;
+    update_ui_suspended(controller);
     if (controller->notice) {
         lv_obj_del(controller->notice);
+        controller->notice = NULL;
     }
     if (controller->stats->parent != controller->overlay) {
         lv_obj_del(controller->stats);
@@ -285,6 +305,7 @@ bool show_overlay(streaming_controller_t *controller) {
         return false;
     }
     overlay_showing = true;
+    update_ui_suspended(controller);
     lv_obj_clear_flag(controller->base.obj, LV_OBJ_FLAG_HIDDEN);
 
     lv_area_t coords = controller->video->coords;
@@ -308,6 +329,7 @@ static void hide_overlay(lv_event_t *event) {
     overlay_showing = false;
     app_set_mouse_grab(&global->input, true);
     streaming_enter_fullscreen(controller->global->session);
+    update_ui_suspended(controller);
 }
 
 static void overlay_key_cb(lv_event_t *e) {
@@ -342,6 +364,9 @@ static void pin_toggle(lv_event_t *e) {
     bool checked = lv_obj_has_state(lv_event_get_current_target(e), LV_STATE_CHECKED);
     bool pinned = toggle_view->parent != fragment->obj;
     overlay_pinned = checked;
+    if (current_controller != NULL) {
+        update_ui_suspended(current_controller);
+    }
     if (checked == pinned) {
         return;
     }
@@ -353,3 +378,12 @@ static void pin_toggle(lv_event_t *e) {
         lv_obj_clear_state(toggle_view, LV_STATE_USER_1);
     }
 }
+
+/**
+ * Nothing needs to be drawn on top of the video when overlay, pinned stats and notice are all hidden.
+ */
+static void update_ui_suspended(streaming_controller_t *controller) {
+    bool notice_shown = controller->notice != NULL && !lv_obj_has_flag(controller->notice, LV_OBJ_FLAG_HIDDEN);
+    bool suspended = controller->stream_opened && !overlay_showing && !overlay_pinned && !notice_shown;
+    app_ui_set_suspended(&controller->global->ui, suspended);
+}
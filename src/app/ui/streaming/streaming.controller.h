@@ -29,6 +29,7 @@ typedef struct {
         lv_obj_t *drop_rate;
         lv_obj_t *host_latency;
         lv_obj_t *vdec_latency;
+        lv_obj_t *startup;
     } stats_items;
     lv_obj_t *stats_pin;
     lv_obj_t *notice, *notice_label;
@@ -36,6 +37,7 @@ typedef struct {
     lv_style_t overlay_button_style_focused;
     lv_style_t overlay_button_label_style;
     lv_point_t button_points[5];
+    bool stream_opened;
 } streaming_controller_t;
 
 /* Usually references to SERVER_DATA and APP_LIST should not be kept, but in this struct, they will only be used once */
@@ -128,6 +128,7 @@ lv_obj_t *streaming_scene_create(lv_fragment_t *self, lv_obj_t *parent) {
     controller->stats_items.drop_rate = stat_label(stats, "Network frame drop");
     controller->stats_items.host_latency = stat_label(stats, "Host processing latency");
     controller->stats_items.vdec_latency = stat_label(stats, "Decoder latency");
+    controller->stats_items.startup = stat_label(stats, "Time to first frame");
 
 
     lv_obj_add_flag(overlay, LV_OBJ_FLAG_HIDDEN);
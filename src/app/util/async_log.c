@@ -0,0 +1,247 @@
+#include "async_log.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <SDL_atomic.h>
+#include <SDL_thread.h>
+#include <SDL_timer.h>
+
+/* How long the writer sleeps when the queue is empty */
+#define WRITER_IDLE_MS 10
+
+/**
+ * Slot of a bounded multi-producer queue. Producers claim a position with CAS on the enqueue position, and sequence
+ * tells whether the slot is free (equals position), filled (position + 1), or still held by previous lap.
+ */
+typedef struct async_log_cell_t {
+    SDL_atomic_t sequence;
+    int level;
+    const char *tag;
+    char message[ASYNC_LOG_MESSAGE_MAX];
+} async_log_cell_t;
+
+struct async_log_t {
+    async_log_cell_t *cells;
+    unsigned int mask;
+    SDL_atomic_t enqueue_pos;
+    /* Only touched by the consumer */
+    unsigned int dequeue_pos;
+    SDL_mutex *drain_lock;
+    SDL_atomic_t written, dropped;
+    /* Least severe level kept, see level_severity */
+    SDL_atomic_t min_severity;
+    /* Drop count already reported to the sink */
+    int dropped_reported;
+    async_log_sink_fn sink;
+    void *userdata;
+    SDL_Thread *writer;
+    SDL_atomic_t running;
+};
+
+static async_log_t *default_log = NULL;
+
+static int writer_worker(async_log_t *logger);
+
+static void sink_write(async_log_t *logger, int level, const char *tag, const char *message);
+
+static int level_severity(int level);
+
+async_log_t *async_log_create(size_t capacity, async_log_sink_fn sink, void *userdata) {
+    unsigned int size = 2;
+    while (size < capacity) {
+        size <<= 1;
+    }
+    async_log_t *logger = calloc(1, sizeof(async_log_t));
+    if (logger == NULL) {
+        return NULL;
+    }
+    logger->cells = calloc(size, sizeof(async_log_cell_t));
+    if (logger->cells == NULL) {
+        free(logger);
+        return NULL;
+    }
+    for (unsigned int i = 0; i < size; i++) {
+        SDL_AtomicSet(&logger->cells[i].sequence, (int) i);
+    }
+    logger->mask = size - 1;
+    logger->drain_lock = SDL_CreateMutex();
+    logger->sink = sink;
+    logger->userdata = userdata;
+    return logger;
+}
+
+bool async_log_start(async_log_t *logger) {
+    if (logger->writer != NULL) {
+        return true;
+    }
+    SDL_AtomicSet(&logger->running, 1);
+    logger->writer = SDL_CreateThread((SDL_ThreadFunction) writer_worker, "logwriter", logger);
+    if (logger->writer == NULL) {
+        SDL_AtomicSet(&logger->running, 0);
+        return false;
+    }
+    return true;
+}
+
+void async_log_destroy(async_log_t *logger) {
+    if (default_log == logger) {
+        async_log_set_default(NULL);
+    }
+    if (logger->writer != NULL) {
+        SDL_AtomicSet(&logger->running, 0);
+        SDL_WaitThread(logger->writer, NULL);
+        logger->writer = NULL;
+    }
+    async_log_drain(logger);
+    SDL_DestroyMutex(logger->drain_lock);
+    free(logger->cells);
+    free(logger);
+}
+
+void async_log_set_level(async_log_t *logger, int level) {
+    SDL_AtomicSet(&logger->min_severity, level_severity(level));
+}
+
+bool async_log_is_loggable(async_log_t *logger, int level) {
+    return level_severity(level) >= SDL_AtomicGet(&logger->min_severity);
+}
+
+bool async_log_vprintf(async_log_t *logger, int level, const char *tag, const char *fmt, va_list args) {
+    if (!async_log_is_loggable(logger, level)) {
+        // Filtered, not dropped
+        return true;
+    }
+    async_log_cell_t *cell;
+    unsigned int pos = (unsigned int) SDL_AtomicGet(&logger->enqueue_pos);
+    for (;;) {
+        cell = &logger->cells[pos & logger->mask];
+        int diff = (int) ((unsigned int) SDL_AtomicGet(&cell->sequence) - pos);
+        if (diff == 0) {
+            if (SDL_AtomicCAS(&logger->enqueue_pos, (int) pos, (int) (pos + 1))) {
+                break;
+            }
+        } else if (diff < 0) {
+            // Writer hasn't caught up, don't wait for it
+            SDL_AtomicIncRef(&logger->dropped);
+            return false;
+        }
+        pos = (unsigned int) SDL_AtomicGet(&logger->enqueue_pos);
+    }
+    cell->level = level;
+    cell->tag = tag;
+    vsnprintf(cell->message, sizeof(cell->message), fmt, args);
+    SDL_AtomicSet(&cell->sequence, (int) (pos + 1));
+    return true;
+}
+
+bool async_log_printf(async_log_t *logger, int level, const char *tag, const char *fmt, ...) {
+    va_list args;
+    va_start(args, fmt);
+    bool ret = async_log_vprintf(logger, level, tag, fmt, args);
+    va_end(args);
+    return ret;
+}
+
+size_t async_log_drain(async_log_t *logger) {
+    size_t count = 0;
+    SDL_LockMutex(logger->drain_lock);
+    for (;;) {
+        unsigned int pos = logger->dequeue_pos;
+        async_log_cell_t *cell = &logger->cells[pos & logger->mask];
+        if ((unsigned int) SDL_AtomicGet(&cell->sequence) != pos + 1) {
+            break;
+        }
+        sink_write(logger, cell->level, cell->tag, cell->message);
+        SDL_AtomicSet(&cell->sequence, (int) (pos + logger->mask + 1));
+        logger->dequeue_pos = pos + 1;
+        count++;
+    }
+    int dropped = SDL_AtomicGet(&logger->dropped);
+    if (dropped != logger->dropped_reported) {
+        char message[64];
+        snprintf(message, sizeof(message), "%d logger messages dropped", dropped - logger->dropped_reported);
+        sink_write(logger, COMMONS_LOG_LEVEL_WARN, "Logging", message);
+        logger->dropped_reported = dropped;
+    }
+    // Counted under the lock, so stats read after a drain include everything written by the writer thread
+    SDL_AtomicAdd(&logger->written, (int) count);
+    SDL_UnlockMutex(logger->drain_lock);
+    return count;
+}
+
+void async_log_get_stats(async_log_t *logger, async_log_stats_t *stats) {
+    stats->written = SDL_AtomicGet(&logger->written);
+    stats->dropped = SDL_AtomicGet(&logger->dropped);
+}
+
+void async_log_set_default(async_log_t *logger) {
+    SDL_AtomicSetPtr((void **) &default_log, logger);
+}
+
+async_log_t *async_log_default() {
+    return SDL_AtomicGetPtr((void **) &default_log);
+}
+
+void async_log_default_printf(int level, const char *tag, const char *fmt, ...) {
+    va_list args;
+    va_start(args, fmt);
+    async_log_default_vprintf(level, tag, fmt, args);
+    va_end(args);
+}
+
+void async_log_default_vprintf(int level, const char *tag, const char *fmt, va_list args) {
+    async_log_t *logger = async_log_default();
+    if (logger != NULL) {
+        async_log_vprintf(logger, level, tag, fmt, args);
+    } else {
+        commons_log_vprintf(level, tag, fmt, args);
+    }
+}
+
+bool async_log_default_is_loggable(int level) {
+    async_log_t *logger = async_log_default();
+    return logger == NULL || async_log_is_loggable(logger, level);
+}
+
+static int writer_worker(async_log_t *logger) {
+    while (SDL_AtomicGet(&logger->running)) {
+        if (async_log_drain(logger) == 0) {
+            SDL_Delay(WRITER_IDLE_MS);
+        }
+    }
+    return 0;
+}
+
+static void sink_printf(int level, const char *tag, const char *fmt, ...) {
+    va_list args;
+    va_start(args, fmt);
+    commons_log_vprintf(level, tag, fmt, args);
+    va_end(args);
+}
+
+static void sink_write(async_log_t *logger, int level, const char *tag, const char *message) {
+    if (logger->sink != NULL) {
+        logger->sink(level, tag, message, logger->userdata);
+    } else {
+        sink_printf(level, tag, "%s", message);
+    }
+}
+
+/**
+ * Levels ordered from least to most severe, without relying on values of the enum.
+ */
+static int level_severity(int level) {
+    switch (level) {
+        case COMMONS_LOG_LEVEL_VERBOSE:
+            return 0;
+        case COMMONS_LOG_LEVEL_DEBUG:
+            return 1;
+        case COMMONS_LOG_LEVEL_INFO:
+            return 2;
+        case COMMONS_LOG_LEVEL_WARN:
+            return 3;
+        default:
+            return 4;
+    }
+}
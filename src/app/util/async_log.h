@@ -0,0 +1,85 @@
+#pragma once
+
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "logging.h"
+
+#define ASYNC_LOG_MESSAGE_MAX 256
+
+typedef struct async_log_t async_log_t;
+
+/**
+ * Receives messages on the writer thread.
+ */
+typedef void (*async_log_sink_fn)(int level, const char *tag, const char *message, void *userdata);
+
+typedef struct async_log_stats_t {
+    size_t written;
+    size_t dropped;
+} async_log_stats_t;
+
+/**
+ * @param capacity Number of messages can be queued, rounded up to power of 2
+ * @param sink Where messages go, or NULL to pass them to commons_log_vprintf
+ */
+async_log_t *async_log_create(size_t capacity, async_log_sink_fn sink, void *userdata);
+
+/**
+ * Starts the writer thread. Without it, messages are only written by async_log_drain.
+ */
+bool async_log_start(async_log_t *logger);
+
+/**
+ * Stops the writer thread and writes remaining messages.
+ */
+void async_log_destroy(async_log_t *logger);
+
+/**
+ * Messages less severe than level are discarded before they're formatted or queued. Everything is logged by default.
+ */
+void async_log_set_level(async_log_t *logger, int level);
+
+bool async_log_is_loggable(async_log_t *logger, int level);
+
+/**
+ * Queues a message without blocking. Tag must be a string literal, as it's stored by pointer.
+ *
+ * @return false if the queue is full and the message has been dropped
+ */
+bool async_log_vprintf(async_log_t *logger, int level, const char *tag, const char *fmt, va_list args);
+
+bool async_log_printf(async_log_t *logger, int level, const char *tag, const char *fmt, ...)
+__attribute__ ((format (printf, 4, 5)));
+
+/**
+ * Writes all queued messages to the sink on the calling thread.
+ *
+ * @return Number of messages written
+ */
+size_t async_log_drain(async_log_t *logger);
+
+void async_log_get_stats(async_log_t *logger, async_log_stats_t *stats);
+
+/**
+ * Logger used by async_log_* macros. If not set, they log synchronously.
+ */
+void async_log_set_default(async_log_t *logger);
+
+async_log_t *async_log_default();
+
+void async_log_default_printf(int level, const char *tag, const char *fmt, ...)
+__attribute__ ((format (printf, 3, 4)));
+
+void async_log_default_vprintf(int level, const char *tag, const char *fmt, va_list args);
+
+/**
+ * @return Whether the default logger keeps messages of this level, always true if it's not set
+ */
+bool async_log_default_is_loggable(int level);
+
+#define async_log_error(tag, ...) async_log_default_printf(COMMONS_LOG_LEVEL_ERROR, tag, __VA_ARGS__)
+#define async_log_warn(tag, ...) async_log_default_printf(COMMONS_LOG_LEVEL_WARN, tag, __VA_ARGS__)
+#define async_log_info(tag, ...) async_log_default_printf(COMMONS_LOG_LEVEL_INFO, tag, __VA_ARGS__)
+#define async_log_debug(tag, ...) async_log_default_printf(COMMONS_LOG_LEVEL_DEBUG, tag, __VA_ARGS__)
@@ -1,18 +1,60 @@
 #include "font.h"
+#include "font_cache.h"
 #include "ui/config.h"
 #include "i18n.h"
+#include "path.h"
 #include "res.h"
+#include "lvgl/font/lv_font_atlas.h"
+#include "metrics_executor.h"
+
+#include <sys/stat.h>
+
+#include <SDL_stdinc.h>
 
 #include <fontconfig/fontconfig.h>
 
+#define FONT_CACHE_NAME "font_cache.ini"
+#define GLYPH_ATLAS_DIR "glyphs"
+/* Small, normal and large of primary, fallback and icon fonts */
+#define ATLAS_MAX_SNAPSHOTS 9
+
+typedef struct atlas_save_task_t {
+    app_fonts_t *fonts;
+    lv_font_atlas_snapshot_t *snapshots[ATLAS_MAX_SNAPSHOTS];
+    int count;
+} atlas_save_task_t;
+
+static bool fonts_resolve(font_cache_entry_t *files);
 
-static bool fontset_load_fc(app_fontset_t *set, FcPattern *font);
+static char *font_match_file(FcPattern *pattern);
+
+static bool fontset_load_file(app_fontset_t *set, const char *file);
 
 static bool fontset_load_mem(app_fontset_t *set, const char *name, const void *mem, size_t size);
 
+static void fontset_wrap_atlas(app_fontset_t *set, const char *atlas_dir, const char *source);
+
+static lv_font_t *font_wrap_atlas(lv_font_t *font, const char *atlas_dir, const char *source, int size);
+
+static void fontset_save_atlas(app_fontset_t *set);
+
+static void fontset_snapshot_atlas(app_fontset_t *set, atlas_save_task_t *task);
+
+static int atlas_save_task_run(atlas_save_task_t *task);
+
+static void atlas_save_task_finalize(atlas_save_task_t *task, int result);
+
+static void atlas_save_wait(app_fonts_t *fonts);
+
 static void fontset_destroy_fonts(app_fontset_t *fontset);
 
-int app_font_init(app_fonts_t *fonts, int dpi) {
+static void font_destroy(lv_font_t *font);
+
+int app_font_config_init() {
+    return FcInit() ? 0 : -1;
+}
+
+int app_font_init(app_fonts_t *fonts, int dpi, const char *cache_dir, bool glyph_atlas) {
     app_fontset_t fontset = {
             .small_size = _LV_DPX_CALC(dpi, 14),
             .normal_size = _LV_DPX_CALC(dpi, 16),
@@ -22,31 +64,124 @@ int app_font_init(app_fonts_t *fonts, int dpi) {
     if (!fontset_load_mem(&iconfonts, "MaterialIcons", res_mat_iconfont_data, res_mat_iconfont_size)) {
         return -1;
     }
-    //does not necessarily have to be a specific name.  You could put anything here and Fontconfig WILL find a font for you
-    FcPattern *pattern = FcNameParse((const FcChar8 *) FONT_FAMILY);
-    if (!pattern) {
+    font_cache_entry_t files = {NULL, NULL};
+    char *cache_file = cache_dir != NULL ? path_join(cache_dir, FONT_CACHE_NAME) : NULL;
+    char cache_key[64];
+    SDL_snprintf(cache_key, sizeof(cache_key), "%s@%d", i18n_locale(), dpi);
+    if (cache_file == NULL || !font_cache_lookup(cache_file, cache_key, &files)) {
+        if (!fonts_resolve(&files)) {
+            free(cache_file);
+            fontset_destroy_fonts(&iconfonts);
+            return -1;
+        }
+        if (cache_file != NULL) {
+            font_cache_store(cache_file, cache_key, &files);
+        }
+    }
+    free(cache_file);
+    if (!fontset_load_file(&fontset, files.primary)) {
+        font_cache_entry_clear(&files);
+        fontset_destroy_fonts(&fontset);
         fontset_destroy_fonts(&iconfonts);
         return -1;
     }
+    if (files.fallback != NULL) {
+        fontset.fallback = calloc(1, sizeof(app_fontset_t));
+        fontset.fallback->small_size = fontset.small_size;
+        fontset.fallback->normal_size = fontset.normal_size;
+        fontset.fallback->large_size = fontset.large_size;
+        if (!fontset_load_file(fontset.fallback, files.fallback)) {
+            fontset_destroy_fonts(fontset.fallback);
+            free(fontset.fallback);
+            fontset.fallback = NULL;
+        }
+    }
+    if (glyph_atlas && cache_dir != NULL) {
+        char *atlas_dir = path_join(cache_dir, GLYPH_ATLAS_DIR);
+        if (path_dir_ensure(atlas_dir) == 0) {
+            fontset_wrap_atlas(&fontset, atlas_dir, files.primary);
+            if (fontset.fallback != NULL) {
+                fontset_wrap_atlas(fontset.fallback, atlas_dir, files.fallback);
+            }
+            char icons_source[64];
+            SDL_snprintf(icons_source, sizeof(icons_source), "MaterialIcons-%u", (unsigned) res_mat_iconfont_size);
+            fontset_wrap_atlas(&iconfonts, atlas_dir, icons_source);
+        }
+        free(atlas_dir);
+    }
+    if (fontset.fallback != NULL) {
+        fontset.normal->fallback = fontset.fallback->normal;
+        fontset.large->fallback = fontset.fallback->large;
+        fontset.small->fallback = fontset.fallback->small;
+    }
+    font_cache_entry_clear(&files);
+    fonts->fonts = fontset;
+    fonts->icons = iconfonts;
+    fonts->atlas_saving = 0;
+    fonts->atlas_lock = SDL_CreateMutex();
+    fonts->atlas_cond = SDL_CreateCond();
+    return 0;
+}
 
-    FcConfigSubstitute(NULL, pattern, FcMatchPattern);
-    FcDefaultSubstitute(pattern);
-
-    FcResult result;
+void app_font_save_atlas(app_fonts_t *fonts) {
+    // Snapshots already being written are older, don't let them overwrite this one
+    atlas_save_wait(fonts);
+    fontset_save_atlas(&fonts->fonts);
+    if (fonts->fonts.fallback != NULL) {
+        fontset_save_atlas(fonts->fonts.fallback);
+    }
+    fontset_save_atlas(&fonts->icons);
+}
 
-    FcPattern *font = FcFontMatch(NULL, pattern, &result);
-    if (font == NULL) {
-        return -1;
+void app_font_save_atlas_async(app_fonts_t *fonts, executor_t *executor) {
+    atlas_save_task_t *task = calloc(1, sizeof(atlas_save_task_t));
+    if (task == NULL) {
+        return;
     }
-    if (!fontset_load_fc(&fontset, font)) {
-        return -1;
+    task->fonts = fonts;
+    fontset_snapshot_atlas(&fonts->fonts, task);
+    if (fonts->fonts.fallback != NULL) {
+        fontset_snapshot_atlas(fonts->fonts.fallback, task);
+    }
+    fontset_snapshot_atlas(&fonts->icons, task);
+    if (task->count == 0) {
+        free(task);
+        return;
     }
-    if (font) {
-        FcPatternDestroy(font);
-        font = NULL;
+    SDL_LockMutex(fonts->atlas_lock);
+    fonts->atlas_saving++;
+    SDL_UnlockMutex(fonts->atlas_lock);
+    metrics_executor_submit(executor, (executor_action_cb) atlas_save_task_run,
+                            (executor_cleanup_cb) atlas_save_task_finalize, task);
+}
+
+void app_font_deinit(app_fonts_t *fonts) {
+    app_font_save_atlas(fonts);
+    fontset_destroy_fonts(&fonts->fonts);
+    fontset_destroy_fonts(&fonts->icons);
+    SDL_DestroyCond(fonts->atlas_cond);
+    SDL_DestroyMutex(fonts->atlas_lock);
+}
+
+/**
+ * Find font files with fontconfig. This is slow, especially for the first match after startup.
+ */
+static bool fonts_resolve(font_cache_entry_t *files) {
+    //does not necessarily have to be a specific name.  You could put anything here and Fontconfig WILL find a font for you
+    FcPattern *pattern = FcNameParse((const FcChar8 *) FONT_FAMILY);
+    if (!pattern) {
+        return false;
     }
+
+    FcConfigSubstitute(NULL, pattern, FcMatchPattern);
+    FcDefaultSubstitute(pattern);
+
+    files->primary = font_match_file(pattern);
     FcPatternDestroy(pattern);
     pattern = NULL;
+    if (files->primary == NULL) {
+        return false;
+    }
 #ifdef FONT_FAMILY_FALLBACK
     const i18n_entry_t *loc_entry = i18n_entry(i18n_locale());
     pattern = FcNameParse((const FcChar8 *) ((loc_entry && loc_entry->font) ? loc_entry->font : FONT_FAMILY_FALLBACK));
@@ -60,59 +195,45 @@ int app_font_init(app_fonts_t *fonts, int dpi) {
         FcConfigSubstitute(NULL, pattern, FcMatchPattern);
         FcDefaultSubstitute(pattern);
 
-        font = FcFontMatch(NULL, pattern, &result);
-        if (font != NULL) {
-            fontset.fallback = calloc(1, sizeof(app_fontset_t));
-            fontset.fallback->small_size = fontset.small_size;
-            fontset.fallback->normal_size = fontset.normal_size;
-            fontset.fallback->large_size = fontset.large_size;
-            if (fontset_load_fc(fontset.fallback, font)) {
-                fontset.normal->fallback = fontset.fallback->normal;
-                fontset.large->fallback = fontset.fallback->large;
-                fontset.small->fallback = fontset.fallback->small;
-            } else {
-                free(fontset.fallback);
-                fontset.fallback = NULL;
-            }
-            FcPatternDestroy(font);
-            font = NULL;
-        }
+        files->fallback = font_match_file(pattern);
         FcLangSetDestroy(ls);
         FcPatternDestroy(pattern);
         pattern = NULL;
     }
 #endif
-    fonts->fonts = fontset;
-    fonts->icons = iconfonts;
-    return 0;
-}
-
-void app_font_deinit(app_fonts_t *fonts) {
-    fontset_destroy_fonts(&fonts->fonts);
-    fontset_destroy_fonts(&fonts->icons);
+    return true;
 }
 
-static bool fontset_load_fc(app_fontset_t *set, FcPattern *font) {
+static char *font_match_file(FcPattern *pattern) {
+    FcResult result;
+    FcPattern *font = FcFontMatch(NULL, pattern, &result);
+    if (font == NULL) {
+        return NULL;
+    }
     //The pointer stored in 'file' is tied to 'font'; therefore, when 'font' is freed, this pointer is freed automatically.
-    //If you want to return the filename of the selected font, pass a buffer and copy the file name into that buffer
     FcChar8 *file = NULL;
-
+    char *path = NULL;
     if (FcPatternGetString(font, FC_FILE, 0, &file) == FcResultMatch) {
-        lv_ft_info_t ft_info = {.name=(char *) file, .style = FT_FONT_STYLE_NORMAL, .weight = set->normal_size};
-        if (lv_ft_font_init(&ft_info)) {
-            set->normal = ft_info.font;
-        }
-        lv_ft_info_t ft_info_lg = {.name=(char *) file, .style = FT_FONT_STYLE_NORMAL, .weight = set->large_size};
-        if (lv_ft_font_init(&ft_info_lg)) {
-            set->large = ft_info_lg.font;
-        }
-        lv_ft_info_t ft_info_sm = {.name=(char *) file, .style = FT_FONT_STYLE_NORMAL, .weight = set->small_size};
-        if (lv_ft_font_init(&ft_info_sm)) {
-            set->small = ft_info_sm.font;
-        }
-        return true;
+        path = SDL_strdup((const char *) file);
     }
-    return false;
+    FcPatternDestroy(font);
+    return path;
+}
+
+static bool fontset_load_file(app_fontset_t *set, const char *file) {
+    lv_ft_info_t ft_info = {.name = file, .style = FT_FONT_STYLE_NORMAL, .weight = set->normal_size};
+    if (lv_ft_font_init(&ft_info)) {
+        set->normal = ft_info.font;
+    }
+    lv_ft_info_t ft_info_lg = {.name = file, .style = FT_FONT_STYLE_NORMAL, .weight = set->large_size};
+    if (lv_ft_font_init(&ft_info_lg)) {
+        set->large = ft_info_lg.font;
+    }
+    lv_ft_info_t ft_info_sm = {.name = file, .style = FT_FONT_STYLE_NORMAL, .weight = set->small_size};
+    if (lv_ft_font_init(&ft_info_sm)) {
+        set->small = ft_info_sm.font;
+    }
+    return set->small != NULL && set->normal != NULL && set->large != NULL;
 }
 
 static bool fontset_load_mem(app_fontset_t *set, const char *name, const void *mem, size_t size) {
@@ -149,15 +270,102 @@ static bool fontset_load_mem(app_fontset_t *set, const char *name, const void *m
     return true;
 }
 
+static void fontset_wrap_atlas(app_fontset_t *set, const char *atlas_dir, const char *source) {
+    set->small = font_wrap_atlas(set->small, atlas_dir, source, set->small_size);
+    set->normal = font_wrap_atlas(set->normal, atlas_dir, source, set->normal_size);
+    set->large = font_wrap_atlas(set->large, atlas_dir, source, set->large_size);
+}
+
+static lv_font_t *font_wrap_atlas(lv_font_t *font, const char *atlas_dir, const char *source, int size) {
+    if (font == NULL) {
+        return NULL;
+    }
+    // Font file may be replaced by a different version with the same name
+    struct stat st;
+    long long mtime = stat(source, &st) == 0 ? (long long) st.st_mtime : 0;
+    char id[1024];
+    SDL_snprintf(id, sizeof(id), "%s|%lld|%d", source, mtime, size);
+    // FNV-1a
+    Uint32 hash = 2166136261u;
+    for (const char *p = id; *p; p++) {
+        hash ^= (unsigned char) *p;
+        hash *= 16777619u;
+    }
+    char name[32], path[4096];
+    SDL_snprintf(name, sizeof(name), "%08x.atlas", hash);
+    path_join_to(path, sizeof(path), atlas_dir, name);
+    lv_font_t *atlas = lv_font_atlas_create(font, path, id);
+    return atlas != NULL ? atlas : font;
+}
+
+static void fontset_save_atlas(app_fontset_t *set) {
+    lv_font_t *fonts[] = {set->small, set->normal, set->large};
+    for (int i = 0; i < 3; i++) {
+        if (lv_font_atlas_is_atlas(fonts[i])) {
+            lv_font_atlas_save(fonts[i]);
+        }
+    }
+}
+
+static void fontset_snapshot_atlas(app_fontset_t *set, atlas_save_task_t *task) {
+    lv_font_t *fonts[] = {set->small, set->normal, set->large};
+    for (int i = 0; i < 3 && task->count < ATLAS_MAX_SNAPSHOTS; i++) {
+        if (!lv_font_atlas_is_atlas(fonts[i])) {
+            continue;
+        }
+        lv_font_atlas_snapshot_t *snapshot = lv_font_atlas_snapshot(fonts[i]);
+        if (snapshot != NULL) {
+            task->snapshots[task->count++] = snapshot;
+        }
+    }
+}
+
+static int atlas_save_task_run(atlas_save_task_t *task) {
+    for (int i = 0; i < task->count; i++) {
+        lv_font_atlas_snapshot_write(task->snapshots[i]);
+    }
+    return 0;
+}
+
+static void atlas_save_task_finalize(atlas_save_task_t *task, int result) {
+    (void) result;
+    for (int i = 0; i < task->count; i++) {
+        lv_font_atlas_snapshot_free(task->snapshots[i]);
+    }
+    app_fonts_t *fonts = task->fonts;
+    SDL_LockMutex(fonts->atlas_lock);
+    fonts->atlas_saving--;
+    SDL_CondBroadcast(fonts->atlas_cond);
+    SDL_UnlockMutex(fonts->atlas_lock);
+    free(task);
+}
+
+static void atlas_save_wait(app_fonts_t *fonts) {
+    SDL_LockMutex(fonts->atlas_lock);
+    while (fonts->atlas_saving > 0) {
+        SDL_CondWait(fonts->atlas_cond, fonts->atlas_lock);
+    }
+    SDL_UnlockMutex(fonts->atlas_lock);
+}
+
 static void fontset_destroy_fonts(app_fontset_t *fontset) {
-    lv_ft_font_destroy(fontset->large);
-    lv_ft_font_destroy(fontset->normal);
-    lv_ft_font_destroy(fontset->small);
+    font_destroy(fontset->large);
+    font_destroy(fontset->normal);
+    font_destroy(fontset->small);
     app_fontset_t *fallback = fontset->fallback;
     if (fallback) {
-        lv_ft_font_destroy(fallback->large);
-        lv_ft_font_destroy(fallback->normal);
-        lv_ft_font_destroy(fallback->small);
+        font_destroy(fallback->large);
+        font_destroy(fallback->normal);
+        font_destroy(fallback->small);
         free(fallback);
     }
-}
\ No newline at end of file
+}
+
+static void font_destroy(lv_font_t *font) {
+    if (lv_font_atlas_is_atlas(font)) {
+        lv_font_t *base = lv_font_atlas_get_base(font);
+        lv_font_atlas_destroy(font);
+        font = base;
+    }
+    lv_ft_font_destroy(font);
+}
@@ -2,6 +2,10 @@
 
 #include "lvgl.h"
 
+#include <SDL_mutex.h>
+
+typedef struct executor_t executor_t;
+
 typedef struct app_fontset_t {
     int small_size;
     int normal_size;
@@ -15,8 +19,33 @@ typedef struct app_fontset_t {
 typedef struct app_fonts_t {
     app_fontset_t fonts;
     app_fontset_t icons;
+    /* Number of atlas saves running on executor, guarded by atlas_lock */
+    int atlas_saving;
+    SDL_mutex *atlas_lock;
+    SDL_cond *atlas_cond;
 } app_fonts_t;
 
-int app_font_init(app_fonts_t *fonts, int dpi);
+/**
+ * Loads fontconfig configuration and caches, so font matching in app_font_init will be fast.
+ * Can be called from any thread.
+ */
+int app_font_config_init();
+
+/**
+ * @param cache_dir Where resolved font files and glyph atlases are cached, NULL to disable caching
+ * @param glyph_atlas Draw glyphs from pre-rasterized atlas files when available
+ */
+int app_font_init(app_fonts_t *fonts, int dpi, const char *cache_dir, bool glyph_atlas);
+
+/**
+ * Write glyphs rasterized so far to atlas files, so next launch can draw them without FreeType.
+ */
+void app_font_save_atlas(app_fonts_t *fonts);
+
+/**
+ * Like app_font_save_atlas, but only copies glyphs on this thread, and writes files on executor.
+ * Must be called from the thread drawing with the fonts.
+ */
+void app_font_save_atlas_async(app_fonts_t *fonts, executor_t *executor);
 
 void app_font_deinit(app_fonts_t *fonts);
@@ -0,0 +1,187 @@
+#include "font_cache.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#include <ini.h>
+#include <SDL_stdinc.h>
+
+#include "ini_writer.h"
+#include "ini_ext.h"
+
+typedef struct cache_section_t {
+    char *key;
+    font_cache_entry_t entry;
+    long long primary_mtime, fallback_mtime;
+} cache_section_t;
+
+typedef struct cache_contents_t {
+    /* One extra slot for the entry being stored */
+    cache_section_t sections[FONT_CACHE_MAX_ENTRIES + 1];
+    int count;
+} cache_contents_t;
+
+static bool cache_read(const char *cache_file, cache_contents_t *contents);
+
+static int cache_handle(cache_contents_t *contents, const char *section, const char *name, const char *value);
+
+static void cache_contents_clear(cache_contents_t *contents);
+
+static bool file_mtime(const char *path, long long *mtime);
+
+static bool file_unchanged(const char *path, long long mtime);
+
+bool font_cache_lookup(const char *cache_file, const char *key, font_cache_entry_t *entry) {
+    cache_contents_t contents;
+    if (!cache_read(cache_file, &contents)) {
+        return false;
+    }
+    bool found = false;
+    for (int i = 0; i < contents.count; i++) {
+        cache_section_t *section = &contents.sections[i];
+        if (strcmp(section->key, key) != 0) {
+            continue;
+        }
+        if (!file_unchanged(section->entry.primary, section->primary_mtime)) {
+            break;
+        }
+        if (section->entry.fallback != NULL && !file_unchanged(section->entry.fallback, section->fallback_mtime)) {
+            break;
+        }
+        *entry = section->entry;
+        memset(&section->entry, 0, sizeof(font_cache_entry_t));
+        found = true;
+        break;
+    }
+    cache_contents_clear(&contents);
+    return found;
+}
+
+bool font_cache_store(const char *cache_file, const char *key, const font_cache_entry_t *entry) {
+    cache_section_t stored = {.key = SDL_strdup(key)};
+    if (entry->primary == NULL || !file_mtime(entry->primary, &stored.primary_mtime)) {
+        free(stored.key);
+        return false;
+    }
+    if (entry->fallback != NULL && !file_mtime(entry->fallback, &stored.fallback_mtime)) {
+        free(stored.key);
+        return false;
+    }
+    stored.entry.primary = SDL_strdup(entry->primary);
+    stored.entry.fallback = entry->fallback != NULL ? SDL_strdup(entry->fallback) : NULL;
+
+    cache_contents_t contents;
+    cache_read(cache_file, &contents);
+    // Remove the old entry of this key, and the oldest ones if there are too many
+    int write_index = 0;
+    for (int i = 0; i < contents.count; i++) {
+        cache_section_t *section = &contents.sections[i];
+        if (strcmp(section->key, key) == 0 || contents.count - i >= FONT_CACHE_MAX_ENTRIES) {
+            free(section->key);
+            font_cache_entry_clear(&section->entry);
+            continue;
+        }
+        contents.sections[write_index++] = *section;
+    }
+    contents.sections[write_index++] = stored;
+    contents.count = write_index;
+
+    bool ok = false;
+    FILE *fp = fopen(cache_file, "wb");
+    if (fp != NULL) {
+        for (int i = 0; i < contents.count; i++) {
+            const cache_section_t *section = &contents.sections[i];
+            char mtime[24];
+            ini_write_section(fp, section->key);
+            ini_write_string(fp, "primary", section->entry.primary);
+            SDL_snprintf(mtime, sizeof(mtime), "%lld", section->primary_mtime);
+            ini_write_string(fp, "primary_mtime", mtime);
+            if (section->entry.fallback != NULL) {
+                ini_write_string(fp, "fallback", section->entry.fallback);
+                SDL_snprintf(mtime, sizeof(mtime), "%lld", section->fallback_mtime);
+                ini_write_string(fp, "fallback_mtime", mtime);
+            }
+        }
+        ok = fclose(fp) == 0;
+    }
+    cache_contents_clear(&contents);
+    return ok;
+}
+
+void font_cache_entry_clear(font_cache_entry_t *entry) {
+    free(entry->primary);
+    free(entry->fallback);
+    entry->primary = NULL;
+    entry->fallback = NULL;
+}
+
+static bool cache_read(const char *cache_file, cache_contents_t *contents) {
+    memset(contents, 0, sizeof(cache_contents_t));
+    if (ini_parse(cache_file, (ini_handler) cache_handle, contents) != 0) {
+        cache_contents_clear(contents);
+        return false;
+    }
+    // Entries without a font file are useless
+    int write_index = 0;
+    for (int i = 0; i < contents->count; i++) {
+        cache_section_t *section = &contents->sections[i];
+        if (section->entry.primary == NULL) {
+            free(section->key);
+            font_cache_entry_clear(&section->entry);
+            continue;
+        }
+        contents->sections[write_index++] = *section;
+    }
+    contents->count = write_index;
+    return true;
+}
+
+static int cache_handle(cache_contents_t *contents, const char *section, const char *name, const char *value) {
+    if (section == NULL || section[0] == '\0') {
+        return 1;
+    }
+    cache_section_t *current = contents->count > 0 ? &contents->sections[contents->count - 1] : NULL;
+    if (current == NULL || strcmp(current->key, section) != 0) {
+        if (contents->count >= FONT_CACHE_MAX_ENTRIES) {
+            return 1;
+        }
+        current = &contents->sections[contents->count++];
+        current->key = SDL_strdup(section);
+    }
+    if (INI_NAME_MATCH("primary")) {
+        free(current->entry.primary);
+        current->entry.primary = SDL_strdup(value);
+    } else if (INI_NAME_MATCH("primary_mtime")) {
+        current->primary_mtime = SDL_strtoll(value, NULL, 10);
+    } else if (INI_NAME_MATCH("fallback")) {
+        free(current->entry.fallback);
+        current->entry.fallback = SDL_strdup(value);
+    } else if (INI_NAME_MATCH("fallback_mtime")) {
+        current->fallback_mtime = SDL_strtoll(value, NULL, 10);
+    }
+    return 1;
+}
+
+static void cache_contents_clear(cache_contents_t *contents) {
+    for (int i = 0; i < contents->count; i++) {
+        free(contents->sections[i].key);
+        font_cache_entry_clear(&contents->sections[i].entry);
+    }
+    contents->count = 0;
+}
+
+static bool file_mtime(const char *path, long long *mtime) {
+    struct stat st;
+    if (stat(path, &st) != 0) {
+        return false;
+    }
+    *mtime = (long long) st.st_mtime;
+    return true;
+}
+
+static bool file_unchanged(const char *path, long long mtime) {
+    long long current;
+    return file_mtime(path, &current) && current == mtime;
+}
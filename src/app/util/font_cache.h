@@ -0,0 +1,29 @@
+#pragma once
+
+#include <stdbool.h>
+
+/**
+ * Font files resolved by fontconfig, so matching doesn't need to run again on next launch. An entry is only used if
+ * its font files haven't been changed since it was stored.
+ */
+
+#define FONT_CACHE_MAX_ENTRIES 8
+
+typedef struct font_cache_entry_t {
+    char *primary;
+    /* NULL if there's no locale fallback font */
+    char *fallback;
+} font_cache_entry_t;
+
+/**
+ * @param key Locale and DPI the fonts were resolved for
+ * @return true if found and font files are unchanged
+ */
+bool font_cache_lookup(const char *cache_file, const char *key, font_cache_entry_t *entry);
+
+/**
+ * Add or replace entry of the key. Oldest entries are dropped if there are more than FONT_CACHE_MAX_ENTRIES.
+ */
+bool font_cache_store(const char *cache_file, const char *key, const font_cache_entry_t *entry);
+
+void font_cache_entry_clear(font_cache_entry_t *entry);
@@ -1,6 +1,7 @@
 #include "app.h"
 #include "img_loader.h"
-#include "executor.h"
+#include "metrics.h"
+#include "metrics_executor.h"
 
 #include <stdlib.h>
 #include <stdbool.h>
@@ -14,6 +15,7 @@ struct img_loader_task_t {
     img_loader_cb_t cb;
     struct img_loader_t *loader;
     const executor_task_t *task;
+    Uint32 queued_at;
 };
 
 struct img_loader_t {
@@ -31,6 +33,12 @@ typedef struct notify_cb_t {
     const bool *destroyed;
 } notify_cb_t;
 
+METRICS_COUNTER(image_requests, "image_loader.requests");
+METRICS_COUNTER(image_memcache_hits, "image_loader.memcache_hits");
+METRICS_COUNTER(image_filecache_hits, "image_loader.filecache_hits");
+METRICS_COUNTER(image_failures, "image_loader.failures");
+METRICS_HISTOGRAM(image_load_time, "image_loader.load_ms");
+
 static int task_execute(img_loader_task_t *task);
 
 static bool task_cancelled(img_loader_task_t *task);
@@ -53,14 +61,16 @@ img_loader_t *img_loader_create(const img_loader_impl_t *impl, executor_t *execu
 void img_loader_destroy(img_loader_t *loader) {
     SDL_assert_release(!loader->destroyed);
     loader->destroyed = true;
-    executor_submit(loader->executor, executor_noop, img_loader_free, loader);
+    metrics_executor_submit(loader->executor, executor_noop, img_loader_free, loader);
 }
 
 img_loader_task_t *img_loader_load(img_loader_t *loader, img_loader_req_t *request, const img_loader_cb_t *cb) {
     SDL_assert_release(!loader->destroyed);
     cb->start_cb(request);
+    metrics_count(&image_requests, 1);
     // Memory cache found, finish loading
     if (loader->impl.memcache_get(request)) {
+        metrics_count(&image_memcache_hits, 1);
         cb->complete_cb(request);
         return NULL;
     }
@@ -68,8 +78,14 @@ img_loader_task_t *img_loader_load(img_loader_t *loader, img_loader_req_t *reque
     task->loader = loader;
     task->request = request;
     task->cb = *cb;
-    task->task = executor_submit(loader->executor, (executor_action_cb) task_execute,
-                                 (executor_cleanup_cb) task_destroy, task);
+    task->queued_at = SDL_GetTicks();
+    const executor_task_t *handle = metrics_executor_submit(loader->executor, (executor_action_cb) task_execute,
+                                                            (executor_cleanup_cb) task_destroy, task);
+    if (handle == NULL) {
+        // Not submitted, task_destroy has already cancelled the request
+        return NULL;
+    }
+    task->task = handle;
     return task;
 }
 
@@ -81,7 +97,9 @@ void img_loader_cancel(img_loader_t *loader, img_loader_task_t *task) {
 static int task_execute(img_loader_task_t *task) {
     img_loader_t *loader = task->loader;
     void *request = task->request;
-    if (!loader->impl.filecache_get(request)) {
+    if (loader->impl.filecache_get(request)) {
+        metrics_count(&image_filecache_hits, 1);
+    } else {
         if (!loader->impl.fetch(request)) {
             return EIO;
         }
@@ -98,10 +116,12 @@ static void task_destroy(img_loader_task_t *task, int result) {
     img_loader_t *loader = task->loader;
     void *request = task->request;
     if (result == 0) {
+        metrics_observe(&image_load_time, SDL_GetTicks() - task->queued_at);
         run_on_main(loader, task->cb.complete_cb, request);
     } else if (result == ECANCELED) {
         run_on_main(loader, task->cb.cancel_cb, request);
     } else {
+        metrics_count(&image_failures, 1);
         run_on_main(loader, task->cb.fail_cb, request);
     }
     SDL_free(task);
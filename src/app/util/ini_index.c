@@ -0,0 +1,391 @@
+#include "ini_index.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+#ifndef __WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+typedef struct index_entry_t {
+    ini_index_entry_t entry;
+    int section;
+    int line;
+} index_entry_t;
+
+typedef struct index_section_t {
+    const char *name;
+    unsigned int hash;
+    int first, last;
+} index_section_t;
+
+struct ini_index_t {
+    char *data;
+    size_t size;
+    bool mapped;
+    index_entry_t *entries;
+    int num_entries, cap_entries;
+    index_section_t *sections;
+    int num_sections, cap_sections;
+    /* Section number + 1, 0 for empty slot */
+    int *slots;
+    int num_slots;
+    int error;
+};
+
+static char *index_load(const char *path, size_t *size, bool *mapped);
+
+static void index_tokenize(ini_index_t *index);
+
+static bool index_add_entry(ini_index_t *index, int section, const char *name, const char *value, int line);
+
+static int index_add_section(ini_index_t *index, const char *name);
+
+static int slot_find(const ini_index_t *index, const char *name, unsigned int hash);
+
+static bool slots_rebuild(ini_index_t *index, int num_slots);
+
+static unsigned int name_hash(const char *name);
+
+static char *lskip(char *s);
+
+static void rstrip(char *s, char *end);
+
+static char *find_chars_or_comment(char *s, const char *chars);
+
+ini_index_t *ini_index_open(const char *path) {
+    size_t size = 0;
+    bool mapped = false;
+    char *data = index_load(path, &size, &mapped);
+    if (data == NULL) {
+        return NULL;
+    }
+    ini_index_t *index = calloc(1, sizeof(ini_index_t));
+    index->data = data;
+    index->size = size;
+    index->mapped = mapped;
+    index_tokenize(index);
+    return index;
+}
+
+void ini_index_close(ini_index_t *index) {
+    if (index == NULL) {
+        return;
+    }
+#ifndef __WIN32
+    if (index->mapped) {
+        munmap(index->data, index->size);
+    } else {
+        free(index->data);
+    }
+#else
+    free(index->data);
+#endif
+    free(index->entries);
+    free(index->sections);
+    free(index->slots);
+    free(index);
+}
+
+int ini_index_error(const ini_index_t *index) {
+    return index->error;
+}
+
+int ini_index_sections_count(const ini_index_t *index) {
+    return index->num_sections;
+}
+
+const char *ini_index_section_name(const ini_index_t *index, int section) {
+    if (section < 0 || section >= index->num_sections) {
+        return NULL;
+    }
+    return index->sections[section].name;
+}
+
+int ini_index_find_section(const ini_index_t *index, const char *name) {
+    if (index->num_slots == 0) {
+        return -1;
+    }
+    return index->slots[slot_find(index, name, name_hash(name))] - 1;
+}
+
+const ini_index_entry_t *ini_index_section_first(const ini_index_t *index, int section) {
+    if (section < 0 || section >= index->num_sections || index->sections[section].first < 0) {
+        return NULL;
+    }
+    return &index->entries[index->sections[section].first].entry;
+}
+
+const ini_index_entry_t *ini_index_entry_next(const ini_index_t *index, const ini_index_entry_t *entry) {
+    if (entry->next < 0) {
+        return NULL;
+    }
+    return &index->entries[entry->next].entry;
+}
+
+const char *ini_index_get(const ini_index_t *index, const char *section, const char *name) {
+    const char *value = NULL;
+    int found = ini_index_find_section(index, section);
+    for (const ini_index_entry_t *entry = ini_index_section_first(index, found); entry != NULL;
+         entry = ini_index_entry_next(index, entry)) {
+        if (strcmp(entry->name, name) == 0) {
+            value = entry->value;
+        }
+    }
+    return value;
+}
+
+int ini_index_parse(const char *path, ini_index_handler handler, void *user) {
+    ini_index_t *index = ini_index_open(path);
+    if (index == NULL) {
+        return -1;
+    }
+    int error = index->error;
+    for (int i = 0; i < index->num_entries; i++) {
+        const index_entry_t *item = &index->entries[i];
+        if (!handler(user, index->sections[item->section].name, item->entry.name, item->entry.value) &&
+            (error == 0 || item->line < error)) {
+            error = item->line;
+        }
+    }
+    ini_index_close(index);
+    return error;
+}
+
+/**
+ * Map the file if possible. Tokenizing writes into the buffer, so it's a private mapping and changes never go back to
+ * the file.
+ */
+static char *index_load(const char *path, size_t *size, bool *mapped) {
+#ifndef __WIN32
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return NULL;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        return NULL;
+    }
+    // Every line needs to be terminated in place, the last one can only be if the file ends with a newline
+    if (st.st_size > 0 && st.st_size < (off_t) SIZE_MAX) {
+        char *data = mmap(NULL, st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+        if (data != MAP_FAILED) {
+            if (data[st.st_size - 1] == '\n') {
+                close(fd);
+                *size = st.st_size;
+                *mapped = true;
+                return data;
+            }
+            munmap(data, st.st_size);
+        }
+    }
+    close(fd);
+#endif
+    FILE *fp = fopen(path, "rb");
+    if (fp == NULL) {
+        return NULL;
+    }
+    long length;
+    if (fseek(fp, 0, SEEK_END) != 0 || (length = ftell(fp)) < 0 || fseek(fp, 0, SEEK_SET) != 0) {
+        fclose(fp);
+        return NULL;
+    }
+    char *data = malloc(length + 1);
+    if (data != NULL && fread(data, 1, length, fp) != (size_t) length) {
+        free(data);
+        data = NULL;
+    }
+    fclose(fp);
+    if (data != NULL) {
+        data[length] = '\0';
+        *size = length;
+        *mapped = false;
+    }
+    return data;
+}
+
+static void index_tokenize(ini_index_t *index) {
+    char *end = index->data + index->size;
+    char *line = index->data;
+    int line_num = 0, section = -1;
+    // UTF-8 BOM
+    if (index->size >= 3 && memcmp(line, "\xEF\xBB\xBF", 3) == 0) {
+        line += 3;
+    }
+    while (line < end) {
+        line_num++;
+        char *eol = memchr(line, '\n', end - line);
+        if (eol == NULL) {
+            // Only happens to a buffer read into memory, which has room for the terminator
+            eol = end;
+        }
+        *eol = '\0';
+        rstrip(line, eol);
+        char *start = lskip(line);
+        line = eol + 1;
+        if (*start == ';' || *start == '#' || *start == '\0') {
+            continue;
+        }
+        if (*start == '[') {
+            char *bracket = find_chars_or_comment(start + 1, "]");
+            if (*bracket == ']') {
+                *bracket = '\0';
+                section = index_add_section(index, start + 1);
+            } else if (index->error == 0) {
+                index->error = line_num;
+            }
+            continue;
+        }
+        char *delim = find_chars_or_comment(start, "=:");
+        if (*delim != '=' && *delim != ':') {
+            if (index->error == 0) {
+                index->error = line_num;
+            }
+            continue;
+        }
+        *delim = '\0';
+        rstrip(start, delim);
+        char *value = lskip(delim + 1);
+        char *comment = find_chars_or_comment(value, NULL);
+        *comment = '\0';
+        rstrip(value, comment);
+        if (section < 0) {
+            section = index_add_section(index, "");
+        }
+        if (section < 0 || !index_add_entry(index, section, start, value, line_num)) {
+            index->error = line_num;
+            return;
+        }
+    }
+}
+
+static bool index_add_entry(ini_index_t *index, int section, const char *name, const char *value, int line) {
+    if (index->num_entries == index->cap_entries) {
+        int cap = index->cap_entries ? index->cap_entries * 2 : 64;
+        index_entry_t *entries = realloc(index->entries, cap * sizeof(index_entry_t));
+        if (entries == NULL) {
+            return false;
+        }
+        index->entries = entries;
+        index->cap_entries = cap;
+    }
+    int id = index->num_entries++;
+    index_entry_t *item = &index->entries[id];
+    item->entry.name = name;
+    item->entry.value = value;
+    item->entry.next = -1;
+    item->section = section;
+    item->line = line;
+    index_section_t *sec = &index->sections[section];
+    if (sec->first < 0) {
+        sec->first = id;
+    } else {
+        index->entries[sec->last].entry.next = id;
+    }
+    sec->last = id;
+    return true;
+}
+
+/**
+ * @return Number of the section, existing one if the name has appeared before
+ */
+static int index_add_section(ini_index_t *index, const char *name) {
+    unsigned int hash = name_hash(name);
+    if (index->num_slots > 0) {
+        int existing = index->slots[slot_find(index, name, hash)];
+        if (existing != 0) {
+            return existing - 1;
+        }
+    }
+    if ((index->num_sections + 1) * 2 > index->num_slots) {
+        if (!slots_rebuild(index, index->num_slots ? index->num_slots * 2 : 32)) {
+            return -1;
+        }
+    }
+    if (index->num_sections == index->cap_sections) {
+        int cap = index->cap_sections ? index->cap_sections * 2 : 16;
+        index_section_t *sections = realloc(index->sections, cap * sizeof(index_section_t));
+        if (sections == NULL) {
+            return -1;
+        }
+        index->sections = sections;
+        index->cap_sections = cap;
+    }
+    int id = index->num_sections++;
+    index->sections[id] = (index_section_t) {.name = name, .hash = hash, .first = -1, .last = -1};
+    index->slots[slot_find(index, name, hash)] = id + 1;
+    return id;
+}
+
+/**
+ * @return Slot holding the section, or the empty slot it should be put in
+ */
+static int slot_find(const ini_index_t *index, const char *name, unsigned int hash) {
+    unsigned int mask = index->num_slots - 1;
+    unsigned int slot = hash & mask;
+    while (index->slots[slot] != 0) {
+        const index_section_t *section = &index->sections[index->slots[slot] - 1];
+        if (section->hash == hash && strcmp(section->name, name) == 0) {
+            break;
+        }
+        slot = (slot + 1) & mask;
+    }
+    return (int) slot;
+}
+
+static bool slots_rebuild(ini_index_t *index, int num_slots) {
+    int *slots = calloc(num_slots, sizeof(int));
+    if (slots == NULL) {
+        return false;
+    }
+    free(index->slots);
+    index->slots = slots;
+    index->num_slots = num_slots;
+    for (int i = 0; i < index->num_sections; i++) {
+        const index_section_t *section = &index->sections[i];
+        slots[slot_find(index, section->name, section->hash)] = i + 1;
+    }
+    return true;
+}
+
+static unsigned int name_hash(const char *name) {
+    // FNV-1a
+    unsigned int hash = 2166136261u;
+    for (const char *ch = name; *ch != '\0'; ch++) {
+        hash ^= (unsigned char) *ch;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static char *lskip(char *s) {
+    while (*s && isspace((unsigned char) *s)) {
+        s++;
+    }
+    return s;
+}
+
+static void rstrip(char *s, char *end) {
+    while (end > s && isspace((unsigned char) *(end - 1))) {
+        *--end = '\0';
+    }
+}
+
+/**
+ * @return First occurrence of any of chars, start of inline comment (';' after whitespace), or end of string
+ */
+static char *find_chars_or_comment(char *s, const char *chars) {
+    bool was_space = false;
+    while (*s && (!chars || !strchr(chars, *s)) && !(was_space && *s == ';')) {
+        was_space = isspace((unsigned char) *s);
+        s++;
+    }
+    return s;
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdbool.h>
+
+/**
+ * INI file mapped into memory and tokenized in a single pass, with sections looked up by name in a hash table.
+ *
+ * Accepts the same format as inih: sections in brackets, "name = value" or "name: value", comments starting with ';'
+ * or '#' at line start, and inline comments starting with " ;". Sections with the same name are merged.
+ */
+typedef struct ini_index_t ini_index_t;
+
+typedef int (*ini_index_handler)(void *user, const char *section, const char *name, const char *value);
+
+typedef struct ini_index_entry_t {
+    const char *name;
+    const char *value;
+    /* Next entry in the same section, or -1 */
+    int next;
+} ini_index_entry_t;
+
+/**
+ * @return NULL if the file can't be read
+ */
+ini_index_t *ini_index_open(const char *path);
+
+void ini_index_close(ini_index_t *index);
+
+/**
+ * @return Line number of the first line couldn't be parsed, or 0
+ */
+int ini_index_error(const ini_index_t *index);
+
+/**
+ * @return Number of distinct sections, including the unnamed one if there are entries before the first section
+ */
+int ini_index_sections_count(const ini_index_t *index);
+
+/**
+ * @param section Sections are numbered in order of their first appearance
+ */
+const char *ini_index_section_name(const ini_index_t *index, int section);
+
+/**
+ * @return Section number, or -1 if not found
+ */
+int ini_index_find_section(const ini_index_t *index, const char *name);
+
+/**
+ * @return First entry of section in file order, or NULL. Use ini_index_entry_next to get the rest.
+ */
+const ini_index_entry_t *ini_index_section_first(const ini_index_t *index, int section);
+
+const ini_index_entry_t *ini_index_entry_next(const ini_index_t *index, const ini_index_entry_t *entry);
+
+/**
+ * @return Value of the last entry with this name in section, or NULL
+ */
+const char *ini_index_get(const ini_index_t *index, const char *section, const char *name);
+
+/**
+ * Drop-in replacement of ini_parse. Handler is called for every entry in file order.
+ *
+ * @return 0 on success, -1 if the file can't be read, or line number of the first error
+ */
+int ini_index_parse(const char *path, ini_index_handler handler, void *user);
@@ -0,0 +1,125 @@
+#include "init_graph.h"
+#include "startup_trace.h"
+
+#include <SDL_mutex.h>
+#include <assert.h>
+
+#include "metrics_executor.h"
+#include "logging.h"
+
+typedef struct init_graph_t {
+    const init_phase_t *phases;
+    size_t count;
+    void *context;
+    SDL_mutex *lock;
+    SDL_cond *cond;
+    uint32_t started, done;
+    int running;
+    int result;
+} init_graph_t;
+
+typedef struct init_job_t {
+    init_graph_t *graph;
+    size_t index;
+} init_job_t;
+
+static int phase_run(const init_phase_t *phase, void *context);
+
+static int job_run(init_job_t *job);
+
+static void job_finalize(init_job_t *job, int result);
+
+static void phase_finished(init_graph_t *graph, size_t index, int result);
+
+int init_graph_run(const init_phase_t *phases, size_t count, executor_t *executor, void *context) {
+    assert(count <= INIT_GRAPH_MAX_PHASES);
+    init_graph_t graph = {
+            .phases = phases,
+            .count = count,
+            .context = context,
+            .lock = SDL_CreateMutex(),
+            .cond = SDL_CreateCond(),
+    };
+    uint32_t all = count == 32 ? UINT32_MAX : INIT_PHASE_DEP(count) - 1;
+    SDL_LockMutex(graph.lock);
+    while (graph.result == 0 ? graph.done != all : graph.running > 0) {
+        bool progressed = false;
+        if (graph.result == 0) {
+            // Submit all background phases ready to run first, so they can overlap with the phase we run here
+            for (size_t i = 0; i < count; i++) {
+                const init_phase_t *phase = &phases[i];
+                if (!phase->background || executor == NULL || graph.started & INIT_PHASE_DEP(i) ||
+                    (phase->deps & ~graph.done) != 0) {
+                    continue;
+                }
+                graph.started |= INIT_PHASE_DEP(i);
+                graph.running++;
+                init_job_t *job = SDL_malloc(sizeof(init_job_t));
+                job->graph = &graph;
+                job->index = i;
+                metrics_executor_submit(executor, (executor_action_cb) job_run, (executor_cleanup_cb) job_finalize,
+                                        job);
+                progressed = true;
+            }
+            for (size_t i = 0; i < count; i++) {
+                const init_phase_t *phase = &phases[i];
+                if ((phase->background && executor != NULL) || graph.started & INIT_PHASE_DEP(i) ||
+                    (phase->deps & ~graph.done) != 0) {
+                    continue;
+                }
+                graph.started |= INIT_PHASE_DEP(i);
+                SDL_UnlockMutex(graph.lock);
+                int result = phase_run(phase, context);
+                SDL_LockMutex(graph.lock);
+                phase_finished(&graph, i, result);
+                progressed = true;
+                break;
+            }
+        }
+        if (progressed) {
+            continue;
+        }
+        if (graph.running == 0) {
+            commons_log_error("Startup", "Init phases have unsatisfiable dependencies");
+            graph.result = -1;
+            break;
+        }
+        SDL_CondWait(graph.cond, graph.lock);
+    }
+    SDL_UnlockMutex(graph.lock);
+    SDL_DestroyCond(graph.cond);
+    SDL_DestroyMutex(graph.lock);
+    return graph.result;
+}
+
+static int phase_run(const init_phase_t *phase, void *context) {
+    int handle = startup_trace_begin(phase->name);
+    int result = phase->run(context);
+    startup_trace_end(handle);
+    if (result != 0) {
+        commons_log_error("Startup", "Init phase %s failed: %d", phase->name, result);
+    }
+    return result;
+}
+
+static int job_run(init_job_t *job) {
+    init_graph_t *graph = job->graph;
+    return phase_run(&graph->phases[job->index], graph->context);
+}
+
+static void job_finalize(init_job_t *job, int result) {
+    init_graph_t *graph = job->graph;
+    SDL_LockMutex(graph->lock);
+    graph->running--;
+    phase_finished(graph, job->index, result);
+    SDL_CondSignal(graph->cond);
+    SDL_UnlockMutex(graph->lock);
+    SDL_free(job);
+}
+
+static void phase_finished(init_graph_t *graph, size_t index, int result) {
+    graph->done |= INIT_PHASE_DEP(index);
+    if (result != 0 && graph->result == 0) {
+        graph->result = result;
+    }
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+typedef struct executor_t executor_t;
+
+#define INIT_GRAPH_MAX_PHASES 32
+
+#define INIT_PHASE_DEP(index) (1u << (index))
+
+typedef int (*init_phase_fn)(void *context);
+
+typedef struct init_phase_t {
+    const char *name;
+    init_phase_fn run;
+    /* Bit mask of phases (INIT_PHASE_DEP) needs to be finished before this one */
+    uint32_t deps;
+    /* Run on the executor instead of the calling thread */
+    bool background;
+} init_phase_t;
+
+/**
+ * Runs phases in dependency order, background phases in parallel on the executor. Each phase is recorded in the
+ * startup trace.
+ *
+ * Returns after all phases finished, or after a phase failed and running phases finished.
+ *
+ * @param executor Executor for background phases, or NULL to run everything on the calling thread
+ * @return 0 on success, or the result of the failed phase
+ */
+int init_graph_run(const init_phase_t *phases, size_t count, executor_t *executor, void *context);
@@ -0,0 +1,453 @@
+#include "metrics.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <SDL_atomic.h>
+#include <SDL_stdinc.h>
+#include <SDL_thread.h>
+#include <SDL_timer.h>
+
+#include "logging.h"
+#include "path.h"
+
+#ifndef __WIN32
+#include <errno.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#ifndef MSG_NOSIGNAL
+/* macOS sets SO_NOSIGPIPE on the socket instead */
+#define MSG_NOSIGNAL 0
+#endif
+#endif
+
+/* How often the server thread checks whether it should stop */
+#define SERVER_POLL_MS 200
+/* Don't let a reader that never reads block the server */
+#define SERVER_SEND_TIMEOUT_MS 1000
+
+typedef struct registry_entry_t {
+    const char *name;
+    metric_type_t type;
+    int first;
+} registry_entry_t;
+
+/**
+ * Each shard is written by the threads assigned to it, so updates from different threads rarely touch the same cache
+ * line. Relaxed atomics are enough as values are only summed up, and never used to publish other data.
+ */
+typedef struct metrics_shard_t {
+    _Alignas(64) _Atomic uint64_t values[METRICS_MAX_SLOTS];
+} metrics_shard_t;
+
+static metrics_shard_t shards[METRICS_MAX_SHARDS];
+static registry_entry_t registry[METRICS_MAX_METRICS];
+static int registry_count = 0;
+static int registry_slots = 0;
+static SDL_SpinLock registry_lock = 0;
+static atomic_uint next_shard;
+static _Thread_local int thread_shard = -1;
+
+#ifndef __WIN32
+static SDL_Thread *server_thread = NULL;
+static SDL_atomic_t server_running;
+static int server_fd = -1;
+static char *server_path = NULL;
+
+static int server_worker(void *unused);
+#endif
+
+static int metric_slot(metric_t *metric);
+
+static int metric_register(metric_t *metric);
+
+static int metric_width(metric_type_t type);
+
+static int current_shard();
+
+static int histogram_bucket(uint64_t value);
+
+static size_t registry_copy(registry_entry_t *entries);
+
+static void value_aggregate(const registry_entry_t *entry, metrics_value_t *value);
+
+static void write_group(FILE *fp, const metrics_value_t *values, size_t count, metric_type_t type, const char *label);
+
+void metrics_count(metric_t *metric, uint64_t value) {
+    int slot = metric_slot(metric);
+    if (slot < 0) {
+        return;
+    }
+    atomic_fetch_add_explicit(&shards[current_shard()].values[slot], value, memory_order_relaxed);
+}
+
+void metrics_gauge_set(metric_t *metric, int64_t value) {
+    int slot = metric_slot(metric);
+    if (slot < 0) {
+        return;
+    }
+    // Gauges are not sharded, the last write wins
+    atomic_store_explicit(&shards[0].values[slot], (uint64_t) value, memory_order_relaxed);
+}
+
+void metrics_gauge_add(metric_t *metric, int64_t delta) {
+    int slot = metric_slot(metric);
+    if (slot < 0) {
+        return;
+    }
+    atomic_fetch_add_explicit(&shards[0].values[slot], (uint64_t) delta, memory_order_relaxed);
+}
+
+void metrics_observe(metric_t *metric, uint64_t value) {
+    int slot = metric_slot(metric);
+    if (slot < 0) {
+        return;
+    }
+    _Atomic uint64_t *values = &shards[current_shard()].values[slot];
+    atomic_fetch_add_explicit(&values[histogram_bucket(value)], 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&values[METRICS_HISTOGRAM_BUCKETS], 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&values[METRICS_HISTOGRAM_BUCKETS + 1], value, memory_order_relaxed);
+}
+
+size_t metrics_snapshot(metrics_value_t *values, size_t max) {
+    registry_entry_t entries[METRICS_MAX_METRICS];
+    size_t count = registry_copy(entries);
+    for (size_t i = 0; i < count && i < max; i++) {
+        value_aggregate(&entries[i], &values[i]);
+    }
+    return count;
+}
+
+bool metrics_get(const char *name, metrics_value_t *value) {
+    registry_entry_t entries[METRICS_MAX_METRICS];
+    size_t count = registry_copy(entries);
+    for (size_t i = 0; i < count; i++) {
+        if (SDL_strcmp(entries[i].name, name) == 0) {
+            value_aggregate(&entries[i], value);
+            return true;
+        }
+    }
+    return false;
+}
+
+void metrics_reset() {
+    registry_entry_t entries[METRICS_MAX_METRICS];
+    size_t count = registry_copy(entries);
+    for (size_t i = 0; i < count; i++) {
+        // Gauges track live state, like tasks still pending, zeroing them would skew later updates
+        if (entries[i].type == METRIC_GAUGE) {
+            continue;
+        }
+        int end = entries[i].first + metric_width(entries[i].type);
+        for (int shard = 0; shard < METRICS_MAX_SHARDS; shard++) {
+            for (int slot = entries[i].first; slot < end; slot++) {
+                atomic_store_explicit(&shards[shard].values[slot], 0, memory_order_relaxed);
+            }
+        }
+    }
+}
+
+void metrics_write_json(FILE *fp) {
+    metrics_value_t *values = calloc(METRICS_MAX_METRICS, sizeof(metrics_value_t));
+    if (values == NULL) {
+        return;
+    }
+    size_t count = metrics_snapshot(values, METRICS_MAX_METRICS);
+    fprintf(fp, "{\n  \"uptime_ms\": %u,\n", (unsigned int) SDL_GetTicks());
+    write_group(fp, values, count, METRIC_COUNTER, "counters");
+    fprintf(fp, ",\n");
+    write_group(fp, values, count, METRIC_GAUGE, "gauges");
+    fprintf(fp, ",\n");
+    write_group(fp, values, count, METRIC_HISTOGRAM, "histograms");
+    fprintf(fp, "\n}\n");
+    free(values);
+}
+
+bool metrics_dump(const char *path) {
+    size_t path_len = SDL_strlen(path);
+    char *tmp_path = malloc(path_len + 5);
+    if (tmp_path == NULL) {
+        return false;
+    }
+    SDL_snprintf(tmp_path, path_len + 5, "%s.tmp", path);
+    FILE *fp = fopen(tmp_path, "w");
+    if (fp == NULL) {
+        free(tmp_path);
+        return false;
+    }
+    metrics_write_json(fp);
+    bool ok = fclose(fp) == 0;
+    if (ok) {
+        ok = path_replace(tmp_path, path) == 0;
+    }
+    if (!ok) {
+        remove(tmp_path);
+    }
+    free(tmp_path);
+    return ok;
+}
+
+void metrics_report() {
+    const char *report_path = SDL_getenv("MOONLIGHT_METRICS_FILE");
+    if (report_path == NULL || report_path[0] == '\0') {
+        return;
+    }
+    if (!metrics_dump(report_path)) {
+        commons_log_warn("Metrics", "Can't write metrics to %s", report_path);
+    }
+}
+
+#ifndef __WIN32
+
+bool metrics_server_start(const char *path) {
+    if (server_thread != NULL) {
+        return false;
+    }
+    struct sockaddr_un addr;
+    SDL_memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (SDL_strlcpy(addr.sun_path, path, sizeof(addr.sun_path)) >= sizeof(addr.sun_path)) {
+        commons_log_warn("Metrics", "Socket path too long: %s", path);
+        return false;
+    }
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) {
+        return false;
+    }
+    // Left behind by a previous run that didn't exit cleanly. Anything else at this path is not ours to delete.
+    struct stat st;
+    if (lstat(path, &st) == 0 && S_ISSOCK(st.st_mode)) {
+        unlink(path);
+    }
+    if (bind(fd, (struct sockaddr *) &addr, sizeof(addr)) != 0 || listen(fd, 4) != 0) {
+        commons_log_warn("Metrics", "Can't listen on %s", path);
+        close(fd);
+        return false;
+    }
+    server_fd = fd;
+    server_path = SDL_strdup(path);
+    SDL_AtomicSet(&server_running, 1);
+    server_thread = SDL_CreateThread(server_worker, "metrics", NULL);
+    if (server_thread == NULL) {
+        SDL_AtomicSet(&server_running, 0);
+        metrics_server_stop();
+        return false;
+    }
+    commons_log_info("Metrics", "Serving metrics on %s", path);
+    return true;
+}
+
+void metrics_server_stop() {
+    if (server_thread != NULL) {
+        SDL_AtomicSet(&server_running, 0);
+        SDL_WaitThread(server_thread, NULL);
+        server_thread = NULL;
+    }
+    if (server_fd >= 0) {
+        close(server_fd);
+        server_fd = -1;
+    }
+    if (server_path != NULL) {
+        unlink(server_path);
+        SDL_free(server_path);
+        server_path = NULL;
+    }
+}
+
+static int server_worker(void *unused) {
+    (void) unused;
+    struct pollfd pfd = {.fd = server_fd, .events = POLLIN};
+    while (SDL_AtomicGet(&server_running)) {
+        if (poll(&pfd, 1, SERVER_POLL_MS) <= 0) {
+            continue;
+        }
+        int client = accept(server_fd, NULL, NULL);
+        if (client < 0) {
+            continue;
+        }
+        struct timeval timeout = {
+                .tv_sec = SERVER_SEND_TIMEOUT_MS / 1000,
+                .tv_usec = (SERVER_SEND_TIMEOUT_MS % 1000) * 1000,
+        };
+        // Without the timeout, a reader that never reads would block the server forever
+        if (setsockopt(client, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout)) != 0) {
+            commons_log_warn("Metrics", "Can't set send timeout: %s", strerror(errno));
+            close(client);
+            continue;
+        }
+        char *json = NULL;
+        size_t json_len = 0;
+        FILE *fp = open_memstream(&json, &json_len);
+        if (fp != NULL) {
+            metrics_write_json(fp);
+            fclose(fp);
+#ifdef SO_NOSIGPIPE
+            int on = 1;
+            setsockopt(client, SOL_SOCKET, SO_NOSIGPIPE, &on, sizeof(on));
+#endif
+            // Reader can go away at any time, which must not raise SIGPIPE
+            for (size_t sent = 0; sent < json_len;) {
+                ssize_t ret = send(client, json + sent, json_len - sent, MSG_NOSIGNAL);
+                if (ret <= 0) {
+                    break;
+                }
+                sent += ret;
+            }
+            free(json);
+        }
+        close(client);
+    }
+    return 0;
+}
+
+#else
+
+bool metrics_server_start(const char *path) {
+    (void) path;
+    commons_log_warn("Metrics", "Metrics socket is not supported on this platform");
+    return false;
+}
+
+void metrics_server_stop() {
+}
+
+#endif
+
+/**
+ * @return Slot of the metric in every shard, or -1 if it couldn't be registered
+ */
+static int metric_slot(metric_t *metric) {
+    int slot = atomic_load_explicit(&metric->slot, memory_order_acquire);
+    if (slot == 0) {
+        slot = metric_register(metric);
+    }
+    return slot > 0 ? slot - 1 : -1;
+}
+
+static int metric_register(metric_t *metric) {
+    SDL_AtomicLock(&registry_lock);
+    int slot = atomic_load_explicit(&metric->slot, memory_order_relaxed);
+    if (slot != 0) {
+        SDL_AtomicUnlock(&registry_lock);
+        return slot;
+    }
+    slot = -1;
+    int found = -1;
+    for (int i = 0; i < registry_count; i++) {
+        if (SDL_strcmp(registry[i].name, metric->name) == 0) {
+            found = i;
+            break;
+        }
+    }
+    int width = metric_width(metric->type);
+    if (found >= 0) {
+        if (registry[found].type == metric->type) {
+            slot = registry[found].first + 1;
+        }
+    } else if (registry_count < METRICS_MAX_METRICS && registry_slots + width <= METRICS_MAX_SLOTS) {
+        registry[registry_count++] = (registry_entry_t) {
+                .name = metric->name,
+                .type = metric->type,
+                .first = registry_slots,
+        };
+        slot = registry_slots + 1;
+        registry_slots += width;
+    }
+    atomic_store_explicit(&metric->slot, slot, memory_order_release);
+    SDL_AtomicUnlock(&registry_lock);
+    if (slot < 0) {
+        commons_log_warn("Metrics", "Can't register metric %s", metric->name);
+    }
+    return slot;
+}
+
+static int metric_width(metric_type_t type) {
+    return type == METRIC_HISTOGRAM ? METRICS_HISTOGRAM_BUCKETS + 2 : 1;
+}
+
+static int current_shard() {
+    if (thread_shard < 0) {
+        thread_shard = (int) (atomic_fetch_add_explicit(&next_shard, 1, memory_order_relaxed) % METRICS_MAX_SHARDS);
+    }
+    return thread_shard;
+}
+
+static int histogram_bucket(uint64_t value) {
+    if (value == 0) {
+        return 0;
+    }
+    int bits = 64 - __builtin_clzll(value);
+    return bits < METRICS_HISTOGRAM_BUCKETS ? bits : METRICS_HISTOGRAM_BUCKETS - 1;
+}
+
+static size_t registry_copy(registry_entry_t *entries) {
+    SDL_AtomicLock(&registry_lock);
+    size_t count = registry_count;
+    SDL_memcpy(entries, registry, count * sizeof(registry_entry_t));
+    SDL_AtomicUnlock(&registry_lock);
+    return count;
+}
+
+static void value_aggregate(const registry_entry_t *entry, metrics_value_t *value) {
+    SDL_memset(value, 0, sizeof(*value));
+    value->name = entry->name;
+    value->type = entry->type;
+    switch (entry->type) {
+        case METRIC_GAUGE:
+            value->value = (int64_t) atomic_load_explicit(&shards[0].values[entry->first], memory_order_relaxed);
+            break;
+        case METRIC_COUNTER:
+            for (int shard = 0; shard < METRICS_MAX_SHARDS; shard++) {
+                value->value += (int64_t) atomic_load_explicit(&shards[shard].values[entry->first],
+                                                               memory_order_relaxed);
+            }
+            break;
+        case METRIC_HISTOGRAM:
+            for (int shard = 0; shard < METRICS_MAX_SHARDS; shard++) {
+                _Atomic uint64_t *values = &shards[shard].values[entry->first];
+                for (int i = 0; i < METRICS_HISTOGRAM_BUCKETS; i++) {
+                    value->buckets[i] += atomic_load_explicit(&values[i], memory_order_relaxed);
+                }
+                value->count += atomic_load_explicit(&values[METRICS_HISTOGRAM_BUCKETS], memory_order_relaxed);
+                value->sum += atomic_load_explicit(&values[METRICS_HISTOGRAM_BUCKETS + 1], memory_order_relaxed);
+            }
+            break;
+    }
+}
+
+/**
+ * Metric names are string literals in the code, so they are written without escaping.
+ */
+static void write_group(FILE *fp, const metrics_value_t *values, size_t count, metric_type_t type, const char *label) {
+    fprintf(fp, "  \"%s\": {", label);
+    bool first = true;
+    for (size_t i = 0; i < count && i < METRICS_MAX_METRICS; i++) {
+        const metrics_value_t *value = &values[i];
+        if (value->type != type) {
+            continue;
+        }
+        fprintf(fp, "%s\n    \"%s\": ", first ? "" : ",", value->name);
+        first = false;
+        if (type != METRIC_HISTOGRAM) {
+            fprintf(fp, "%lld", (long long) value->value);
+            continue;
+        }
+        // Trailing empty buckets are left out
+        int used = METRICS_HISTOGRAM_BUCKETS;
+        while (used > 0 && value->buckets[used - 1] == 0) {
+            used--;
+        }
+        fprintf(fp, "{\"count\": %llu, \"sum\": %llu, \"buckets\": [", (unsigned long long) value->count,
+                (unsigned long long) value->sum);
+        for (int bucket = 0; bucket < used; bucket++) {
+            fprintf(fp, "%s%llu", bucket ? ", " : "", (unsigned long long) value->buckets[bucket]);
+        }
+        fprintf(fp, "]}");
+    }
+    fprintf(fp, "%s}", first ? "" : "\n  ");
+}
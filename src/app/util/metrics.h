@@ -0,0 +1,99 @@
+#pragma once
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+/* Threads are spread over this many copies of every counter and histogram, and summed up on read */
+#define METRICS_MAX_SHARDS 8
+/* 64-bit values per shard. A counter or gauge takes 1, a histogram METRICS_HISTOGRAM_BUCKETS + 2 */
+#define METRICS_MAX_SLOTS 512
+#define METRICS_MAX_METRICS 96
+/* Bucket 0 counts zeros, bucket i counts values in [2^(i-1), 2^i), and the last one everything above */
+#define METRICS_HISTOGRAM_BUCKETS 24
+
+typedef enum metric_type_t {
+    METRIC_COUNTER,
+    METRIC_GAUGE,
+    METRIC_HISTOGRAM,
+} metric_type_t;
+
+/**
+ * Handle of a metric, meant to be a static variable next to the code updating it. It's registered on first update,
+ * and handles with the same name share the value, even in different files.
+ */
+typedef struct metric_t {
+    const char *name;
+    metric_type_t type;
+    /* First slot + 1, 0 before registration, or -1 if the registry is full */
+    atomic_int slot;
+} metric_t;
+
+#define METRICS_COUNTER(var, metric_name) static metric_t var = {.name = metric_name, .type = METRIC_COUNTER}
+#define METRICS_GAUGE(var, metric_name) static metric_t var = {.name = metric_name, .type = METRIC_GAUGE}
+#define METRICS_HISTOGRAM(var, metric_name) static metric_t var = {.name = metric_name, .type = METRIC_HISTOGRAM}
+
+typedef struct metrics_value_t {
+    const char *name;
+    metric_type_t type;
+    /* Sum of a counter, or value of a gauge */
+    int64_t value;
+    /* Histogram only */
+    uint64_t count, sum;
+    uint64_t buckets[METRICS_HISTOGRAM_BUCKETS];
+} metrics_value_t;
+
+/**
+ * Adds to a counter. Lock free, and doesn't contend with other threads unless there are more than METRICS_MAX_SHARDS
+ * of them updating metrics.
+ */
+void metrics_count(metric_t *metric, uint64_t value);
+
+void metrics_gauge_set(metric_t *metric, int64_t value);
+
+void metrics_gauge_add(metric_t *metric, int64_t delta);
+
+/**
+ * Records a sample in a histogram. Pick the unit so interesting values are not all in the first few buckets, and
+ * include it in the name, e.g. "video.feed_us".
+ */
+void metrics_observe(metric_t *metric, uint64_t value);
+
+/**
+ * Aggregates all shards. Updates made while reading may or may not be included, but nothing is counted twice.
+ *
+ * @return Number of registered metrics, can be larger than max
+ */
+size_t metrics_snapshot(metrics_value_t *values, size_t max);
+
+/**
+ * @return false if no metric with this name has been registered
+ */
+bool metrics_get(const char *name, metrics_value_t *value);
+
+/**
+ * Zeroes counters and histograms. Gauges and registrations are kept.
+ */
+void metrics_reset();
+
+void metrics_write_json(FILE *fp);
+
+/**
+ * Writes a snapshot to a temporary file, and renames it over path.
+ */
+bool metrics_dump(const char *path);
+
+/**
+ * Writes a snapshot to a file if MOONLIGHT_METRICS_FILE environment variable is set.
+ */
+void metrics_report();
+
+/**
+ * Listens on a UNIX socket at path, and writes a snapshot to every connection made to it, e.g. `nc -U path`.
+ * Not available on Windows.
+ */
+bool metrics_server_start(const char *path);
+
+void metrics_server_stop();
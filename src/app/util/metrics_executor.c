@@ -0,0 +1,70 @@
+#include "metrics_executor.h"
+#include "metrics.h"
+
+#include <errno.h>
+#include <stdlib.h>
+
+#include <SDL_timer.h>
+
+typedef struct metrics_task_t {
+    executor_action_cb action;
+    executor_cleanup_cb cleanup;
+    void *arg;
+    Uint32 queued_at;
+} metrics_task_t;
+
+METRICS_COUNTER(executor_tasks, "executor.tasks");
+METRICS_COUNTER(executor_failures, "executor.failures");
+METRICS_GAUGE(executor_pending, "executor.pending");
+METRICS_HISTOGRAM(executor_task_time, "executor.task_ms");
+
+static int metrics_task_run(void *arg);
+
+static void metrics_task_finalize(void *arg, int result);
+
+const executor_task_t *metrics_executor_submit(executor_t *executor, executor_action_cb action,
+                                               executor_cleanup_cb cleanup, void *arg) {
+    metrics_task_t *task = malloc(sizeof(metrics_task_t));
+    if (task == NULL) {
+        // Callers rely on cleanup to release arg and wake up waiters, as if the task was cancelled
+        if (cleanup != NULL) {
+            cleanup(arg, ECANCELED);
+        }
+        return NULL;
+    }
+    task->action = action;
+    task->cleanup = cleanup;
+    task->arg = arg;
+    task->queued_at = SDL_GetTicks();
+    // Counted as pending before it's queued, it can finish before executor_submit returns
+    metrics_gauge_add(&executor_pending, 1);
+    const executor_task_t *handle = executor_submit(executor, metrics_task_run, metrics_task_finalize, task);
+    if (handle == NULL) {
+        metrics_gauge_add(&executor_pending, -1);
+        free(task);
+        if (cleanup != NULL) {
+            cleanup(arg, ECANCELED);
+        }
+        return NULL;
+    }
+    metrics_count(&executor_tasks, 1);
+    return handle;
+}
+
+static int metrics_task_run(void *arg) {
+    metrics_task_t *task = arg;
+    return task->action(task->arg);
+}
+
+static void metrics_task_finalize(void *arg, int result) {
+    metrics_task_t *task = arg;
+    metrics_gauge_add(&executor_pending, -1);
+    metrics_observe(&executor_task_time, SDL_GetTicks() - task->queued_at);
+    if (result != 0 && result != ECANCELED) {
+        metrics_count(&executor_failures, 1);
+    }
+    if (task->cleanup != NULL) {
+        task->cleanup(task->arg, result);
+    }
+    free(task);
+}
@@ -0,0 +1,14 @@
+#pragma once
+
+#include "executor.h"
+
+/**
+ * Same as executor_submit, but counts the task in executor.* metrics. Task time includes waiting in queue, which is
+ * what makes the UI wait.
+ *
+ * If the task can't be submitted, cleanup is called right away with ECANCELED.
+ *
+ * @return Task handle, can be used with executor_cancel and executor_task_state as usual. NULL if not submitted
+ */
+const executor_task_t *metrics_executor_submit(executor_t *executor, executor_action_cb action,
+                                               executor_cleanup_cb cleanup, void *arg);
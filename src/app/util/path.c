@@ -9,6 +9,10 @@
 
 #include "util/compat.h"
 
+#ifdef __WIN32
+#include <windows.h>
+#endif
+
 char *path_join(const char *parent, const char *basename) {
     unsigned int parentlen = strlen(parent);
     if (parentlen && parent[parentlen - 1] == PATH_SEPARATOR) {
@@ -44,4 +48,12 @@ int path_dir_ensure(const char *dir) {
         return MKDIR(dir, 0755);
     }
     return -1;
-}
\ No newline at end of file
+}
+
+int path_replace(const char *src, const char *dst) {
+#ifdef __WIN32
+    return MoveFileExA(src, dst, MOVEFILE_REPLACE_EXISTING) ? 0 : -1;
+#else
+    return rename(src, dst);
+#endif
+}
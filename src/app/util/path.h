@@ -19,4 +19,11 @@ char *path_pref(bool *persistent);
 
 char *path_cache();
 
-int path_dir_ensure(const char *dir);
\ No newline at end of file
+int path_dir_ensure(const char *dir);
+
+/**
+ * Rename src to dst, replacing dst if it exists. Unlike rename on Windows, dst is never removed first, so it's kept if
+ * the move fails.
+ * @return 0 on success, -1 on failure
+ */
+int path_replace(const char *src, const char *dst);
\ No newline at end of file
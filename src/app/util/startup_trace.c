@@ -0,0 +1,104 @@
+#include "startup_trace.h"
+
+#include <SDL_atomic.h>
+#include <SDL_timer.h>
+
+#include "logging.h"
+
+static startup_trace_entry_t trace_entries[STARTUP_TRACE_MAX_ENTRIES];
+static SDL_atomic_t trace_count = {0};
+static Uint64 trace_origin = 0;
+
+static int trace_add(const char *name, Uint64 begin);
+
+void startup_trace_reset() {
+    SDL_AtomicSet(&trace_count, 0);
+    SDL_memset(trace_entries, 0, sizeof(trace_entries));
+    trace_origin = SDL_GetPerformanceCounter();
+}
+
+int startup_trace_begin(const char *name) {
+    return trace_add(name, SDL_GetPerformanceCounter() - trace_origin);
+}
+
+void startup_trace_end(int handle) {
+    if (handle < 0 || handle >= STARTUP_TRACE_MAX_ENTRIES) {
+        return;
+    }
+    trace_entries[handle].end = SDL_GetPerformanceCounter() - trace_origin;
+}
+
+void startup_trace_mark(const char *name) {
+    int handle = trace_add(name, SDL_GetPerformanceCounter() - trace_origin);
+    if (handle >= 0) {
+        trace_entries[handle].end = trace_entries[handle].begin;
+    }
+}
+
+size_t startup_trace_get_entries(const startup_trace_entry_t **entries) {
+    int count = SDL_min(SDL_AtomicGet(&trace_count), STARTUP_TRACE_MAX_ENTRIES);
+    *entries = trace_entries;
+    return count;
+}
+
+const startup_trace_entry_t *startup_trace_find(const char *name) {
+    const startup_trace_entry_t *entries;
+    size_t count = startup_trace_get_entries(&entries);
+    for (size_t i = 0; i < count; i++) {
+        if (entries[i].name != NULL && SDL_strcmp(entries[i].name, name) == 0) {
+            return &entries[i];
+        }
+    }
+    return NULL;
+}
+
+double startup_trace_to_ms(Uint64 ticks) {
+    return (double) ticks * 1000.0 / (double) SDL_GetPerformanceFrequency();
+}
+
+void startup_trace_report() {
+    const startup_trace_entry_t *entries;
+    size_t count = startup_trace_get_entries(&entries);
+    for (size_t i = 0; i < count; i++) {
+        const startup_trace_entry_t *entry = &entries[i];
+        commons_log_info("Startup", "%-24s at %8.2f ms, took %8.2f ms on thread %lx", entry->name,
+                         startup_trace_to_ms(entry->begin), startup_trace_to_ms(entry->end - entry->begin),
+                         (unsigned long) entry->thread_id);
+    }
+    const char *report_path = SDL_getenv("MOONLIGHT_STARTUP_TRACE");
+    if (report_path == NULL || report_path[0] == '\0') {
+        return;
+    }
+    FILE *fp = fopen(report_path, "w");
+    if (fp == NULL) {
+        commons_log_warn("Startup", "Can't write startup trace to %s", report_path);
+        return;
+    }
+    startup_trace_write(fp);
+    fclose(fp);
+}
+
+void startup_trace_write(FILE *fp) {
+    const startup_trace_entry_t *entries;
+    size_t count = startup_trace_get_entries(&entries);
+    fprintf(fp, "# phase\tthread\tbegin_ms\tend_ms\tduration_ms\n");
+    for (size_t i = 0; i < count; i++) {
+        const startup_trace_entry_t *entry = &entries[i];
+        fprintf(fp, "%s\t%lx\t%.3f\t%.3f\t%.3f\n", entry->name, (unsigned long) entry->thread_id,
+                startup_trace_to_ms(entry->begin), startup_trace_to_ms(entry->end),
+                startup_trace_to_ms(entry->end - entry->begin));
+    }
+}
+
+static int trace_add(const char *name, Uint64 begin) {
+    int handle = SDL_AtomicAdd(&trace_count, 1);
+    if (handle >= STARTUP_TRACE_MAX_ENTRIES) {
+        return -1;
+    }
+    startup_trace_entry_t *entry = &trace_entries[handle];
+    entry->name = name;
+    entry->thread_id = SDL_ThreadID();
+    entry->begin = begin;
+    entry->end = begin;
+    return handle;
+}
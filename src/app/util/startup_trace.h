@@ -0,0 +1,45 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdio.h>
+#include <SDL_stdinc.h>
+#include <SDL_thread.h>
+
+#define STARTUP_TRACE_MAX_ENTRIES 32
+
+typedef struct startup_trace_entry_t {
+    const char *name;
+    SDL_threadID thread_id;
+    /* Performance counter values, relative to startup_trace_reset */
+    Uint64 begin, end;
+} startup_trace_entry_t;
+
+/**
+ * Clears recorded entries and sets the origin of timestamps.
+ */
+void startup_trace_reset();
+
+/**
+ * @return Handle for startup_trace_end, or -1 if the trace is full
+ */
+int startup_trace_begin(const char *name);
+
+void startup_trace_end(int handle);
+
+/**
+ * Records a point in time, e.g. first frame presented.
+ */
+void startup_trace_mark(const char *name);
+
+size_t startup_trace_get_entries(const startup_trace_entry_t **entries);
+
+const startup_trace_entry_t *startup_trace_find(const char *name);
+
+double startup_trace_to_ms(Uint64 ticks);
+
+/**
+ * Writes all entries to log, and to a file if MOONLIGHT_STARTUP_TRACE environment variable is set.
+ */
+void startup_trace_report();
+
+void startup_trace_write(FILE *fp);
@@ -10,6 +10,7 @@
 #define USER_STREAM_CLOSE 118
 #define USER_STREAM_FINISHED 119
 #define USER_SIZE_CHANGED 150
+#define USER_LOW_MEMORY 151
 #define USER_SHOW_HIDDEN_APPS (USER_EVENT_FLAG_FREE_DATA1 | USER_EVENT_FLAG_FREE_DATA2 | 160)
 
 #define USER_OPEN_OVERLAY 531
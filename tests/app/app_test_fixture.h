@@ -0,0 +1,19 @@
+#pragma once
+
+#include "app.h"
+#include "uuidstr.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+/**
+ * Settings loader for app_init, using a fresh configuration directory for every run.
+ */
+static int app_test_init_settings(app_settings_t *settings) {
+    char *path = malloc(128);
+    uuidstr_t uuid;
+    uuidstr_random(&uuid);
+    snprintf(path, 128, "/tmp/moonlight-test-%s", (char *) &uuid);
+    settings_initialize(settings, path);
+    return 0;
+}
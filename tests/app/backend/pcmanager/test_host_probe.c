@@ -0,0 +1,132 @@
+#include "unity.h"
+#include "backend/pcmanager/host_probe.h"
+
+#include <SDL2/SDL_thread.h>
+#include <SDL2/SDL_timer.h>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+typedef struct late_listener_t {
+    uint16_t port;
+    Uint32 delay_ms;
+    int fd;
+    SDL_Thread *thread;
+} late_listener_t;
+
+static const host_probe_options_t options = {
+        .timeout_ms = 5000,
+        .initial_interval_ms = 50,
+        .max_interval_ms = 400,
+};
+
+static uint16_t unused_port() {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    struct sockaddr_in addr = {.sin_family = AF_INET, .sin_addr.s_addr = htonl(INADDR_LOOPBACK), .sin_port = 0};
+    TEST_ASSERT_EQUAL(0, bind(fd, (struct sockaddr *) &addr, sizeof(addr)));
+    socklen_t len = sizeof(addr);
+    getsockname(fd, (struct sockaddr *) &addr, &len);
+    close(fd);
+    return ntohs(addr.sin_port);
+}
+
+static int listener_run(late_listener_t *listener) {
+    SDL_Delay(listener->delay_ms);
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    int reuse = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+    struct sockaddr_in addr = {
+            .sin_family = AF_INET,
+            .sin_addr.s_addr = htonl(INADDR_LOOPBACK),
+            .sin_port = htons(listener->port),
+    };
+    if (bind(fd, (struct sockaddr *) &addr, sizeof(addr)) != 0 || listen(fd, 4) != 0) {
+        close(fd);
+        return -1;
+    }
+    listener->fd = fd;
+    return 0;
+}
+
+static void listener_start(late_listener_t *listener, Uint32 delay_ms) {
+    listener->port = unused_port();
+    listener->delay_ms = delay_ms;
+    listener->fd = -1;
+    listener->thread = SDL_CreateThread((SDL_ThreadFunction) listener_run, "listener", listener);
+}
+
+static void listener_stop(late_listener_t *listener) {
+    int ret = -1;
+    SDL_WaitThread(listener->thread, &ret);
+    TEST_ASSERT_EQUAL(0, ret);
+    close(listener->fd);
+}
+
+void setUp(void) {
+}
+
+void tearDown(void) {
+}
+
+void test_listener_starts_late(void) {
+    late_listener_t listener;
+    listener_start(&listener, 700);
+    uint16_t ports[] = {unused_port(), listener.port};
+    host_probe_t *probe = host_probe_new("127.0.0.1", ports, 2);
+    Uint32 start = SDL_GetTicks();
+    int index = host_probe_wait(probe, &options);
+    Uint32 elapsed = SDL_GetTicks() - start;
+    host_probe_destroy(probe);
+    listener_stop(&listener);
+
+    TEST_ASSERT_EQUAL(1, index);
+    TEST_ASSERT_GREATER_OR_EQUAL(700, elapsed);
+    // Should notice within one max interval after the listener is up
+    TEST_ASSERT_LESS_THAN(700 + options.max_interval_ms + 200, elapsed);
+}
+
+void test_timeout(void) {
+    uint16_t ports[] = {unused_port()};
+    host_probe_options_t short_options = options;
+    short_options.timeout_ms = 500;
+    host_probe_t *probe = host_probe_new("127.0.0.1", ports, 1);
+    Uint32 start = SDL_GetTicks();
+    TEST_ASSERT_EQUAL(-1, host_probe_wait(probe, &short_options));
+    TEST_ASSERT_LESS_THAN(1000, SDL_GetTicks() - start);
+    host_probe_destroy(probe);
+}
+
+static Uint32 trigger_timer(Uint32 interval, void *param) {
+    (void) interval;
+    host_probe_trigger(param);
+    return 0;
+}
+
+void test_trigger(void) {
+    late_listener_t listener;
+    listener_start(&listener, 100);
+    uint16_t ports[] = {listener.port};
+    // Without trigger, second attempt would happen after 3 seconds
+    host_probe_options_t slow_options = {.timeout_ms = 5000, .initial_interval_ms = 3000, .max_interval_ms = 3000};
+    host_probe_t *probe = host_probe_new("127.0.0.1", ports, 1);
+    SDL_TimerID timer = SDL_AddTimer(300, trigger_timer, probe);
+    Uint32 start = SDL_GetTicks();
+    TEST_ASSERT_EQUAL(0, host_probe_wait(probe, &slow_options));
+    TEST_ASSERT_LESS_THAN(1000, SDL_GetTicks() - start);
+    SDL_RemoveTimer(timer);
+    host_probe_destroy(probe);
+    listener_stop(&listener);
+}
+
+int main() {
+    SDL_Init(SDL_INIT_TIMER);
+    UNITY_BEGIN();
+    RUN_TEST(test_listener_starts_late);
+    RUN_TEST(test_timeout);
+    RUN_TEST(test_trigger);
+    int ret = UNITY_END();
+    SDL_Quit();
+    return ret;
+}
@@ -2,6 +2,28 @@
 #include "backend/pcmanager/known_hosts.h"
 #include "hostport.h"
 
+#include <ini.h>
+#include <SDL.h>
+#include <stdio.h>
+
+#ifndef OUTPUT_PATH_PREFIX
+#define OUTPUT_PATH_PREFIX "./"
+#endif
+
+#define BENCH_PATH OUTPUT_PATH_PREFIX "test_known_hosts-bench.ini"
+#define BENCH_HOSTS 2000
+#define BENCH_FAVORITES 10
+
+static void write_bench_hosts();
+
+static int linear_handle(known_host_t **list, const char *section, const char *name, const char *value);
+
+static int find_uuid(known_host_t *node, void *v);
+
+static double elapsed_ms(Uint64 start);
+
+static void hosts_free(known_host_t *hosts);
+
 void setUp(void) {
 
 }
@@ -19,11 +41,110 @@ void test_parse() {
     TEST_ASSERT_EQUAL_STRING("192.168.1.101", hostport_get_hostname(next->address));
     TEST_ASSERT_EQUAL(47985, hostport_get_port(next->address));
 
+    hosts_free(hosts);
+}
+
+void test_parse_many() {
+    write_bench_hosts();
+
+    // How hosts.ini used to be parsed, looking up the host for every line
+    Uint64 start = SDL_GetPerformanceCounter();
+    known_host_t *expected = NULL;
+    TEST_ASSERT_EQUAL(0, ini_parse(BENCH_PATH, (ini_handler) linear_handle, &expected));
+    double linear_ms = elapsed_ms(start);
+
+    start = SDL_GetPerformanceCounter();
+    known_host_t *hosts = known_hosts_parse(BENCH_PATH);
+    double indexed_ms = elapsed_ms(start);
+
+    int count = 0;
+    for (known_host_t *a = expected, *b = hosts; a != NULL || b != NULL; a = a->next, b = b->next, count++) {
+        TEST_ASSERT_NOT_NULL(a);
+        TEST_ASSERT_NOT_NULL(b);
+        TEST_ASSERT_TRUE(uuidstr_t_equals_t(&a->uuid, &b->uuid));
+        TEST_ASSERT_EQUAL_STRING(a->hostname, b->hostname);
+        TEST_ASSERT_EQUAL(hostport_get_port(a->address), hostport_get_port(b->address));
+        appid_list_t *fa = a->favs, *fb = b->favs;
+        for (; fa != NULL && fb != NULL; fa = fa->next, fb = fb->next) {
+            TEST_ASSERT_EQUAL(fa->id, fb->id);
+        }
+        TEST_ASSERT_TRUE(fa == NULL && fb == NULL);
+        TEST_ASSERT_EQUAL(a->hidden->id, b->hidden->id);
+    }
+    TEST_ASSERT_EQUAL(BENCH_HOSTS, count);
+
+    char message[128];
+    SDL_snprintf(message, sizeof(message), "%d hosts, %d favorites each: %.2f ms linear, %.2f ms indexed",
+                 BENCH_HOSTS, BENCH_FAVORITES, linear_ms, indexed_ms);
+    TEST_MESSAGE(message);
+    hosts_free(expected);
+    hosts_free(hosts);
+    remove(BENCH_PATH);
+}
+
+static void write_bench_hosts() {
+    FILE *fp = fopen(BENCH_PATH, "wb");
+    TEST_ASSERT_NOT_NULL(fp);
+    for (int i = 0; i < BENCH_HOSTS; i++) {
+        fprintf(fp, "[%08X-0000-4000-8000-%012X]\n", i * 7919, i);
+        fprintf(fp, "mac = 00:11:22:33:%02x:%02x\n", (i >> 8) & 0xFF, i & 0xFF);
+        fprintf(fp, "hostname = host-%d\n", i);
+        fprintf(fp, "address = 10.0.%d.%d:%d\n", (i >> 8) & 0xFF, i & 0xFF, 47989 + i % 10);
+        fprintf(fp, "; favorites list\n");
+        for (int j = 0; j < BENCH_FAVORITES; j++) {
+            fprintf(fp, "favorite = %d\n", i * 100 + j);
+        }
+        fprintf(fp, "; hidden apps list\n");
+        fprintf(fp, "hidden = %d\n", i);
+    }
+    fclose(fp);
+}
+
+static int linear_handle(known_host_t **list, const char *section, const char *name, const char *value) {
+    known_host_t *host = known_hosts_find_by(*list, section, (known_hosts_find_fn) find_uuid);
+    if (!host) {
+        host = known_hosts_new();
+        uuidstr_fromstr(&host->uuid, section);
+        *list = known_hosts_append(*list, host);
+    }
+    if (strcmp(name, "hostname") == 0) {
+        host->hostname = SDL_strdup(value);
+    } else if (strcmp(name, "mac") == 0) {
+        host->mac = SDL_strdup(value);
+    } else if (strcmp(name, "address") == 0) {
+        host->address = hostport_parse(value);
+    } else if (strcmp(name, "favorite") == 0 || strcmp(name, "hidden") == 0) {
+        appid_list_t *item = SDL_calloc(1, sizeof(appid_list_t));
+        item->id = SDL_atoi(value);
+        appid_list_t **tail = strcmp(name, "favorite") == 0 ? &host->favs : &host->hidden;
+        while (*tail != NULL) {
+            tail = &(*tail)->next;
+        }
+        *tail = item;
+    }
+    return 1;
+}
+
+static int find_uuid(known_host_t *node, void *v) {
+    return !uuidstr_t_equals_s(&node->uuid, v);
+}
+
+static double elapsed_ms(Uint64 start) {
+    return (double) (SDL_GetPerformanceCounter() - start) * 1000.0 / (double) SDL_GetPerformanceFrequency();
+}
+
+/* known_hosts_node_free leaves mac and hostname to whoever took them over */
+static void hosts_free(known_host_t *hosts) {
+    for (known_host_t *cur = hosts; cur != NULL; cur = cur->next) {
+        SDL_free(cur->mac);
+        SDL_free(cur->hostname);
+    }
     known_hosts_free(hosts, known_hosts_node_free);
 }
 
 int main() {
     UNITY_BEGIN();
     RUN_TEST(test_parse);
+    RUN_TEST(test_parse_many);
     return UNITY_END();
 }
\ No newline at end of file
@@ -0,0 +1,224 @@
+#include "unity.h"
+#include "backend/pcmanager/known_hosts_journal.h"
+#include "hostport.h"
+
+#include <SDL.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define JOURNAL_PATH "/tmp/moonlight-test-hosts.journal"
+#define TRUNCATED_PATH "/tmp/moonlight-test-hosts-truncated.journal"
+
+#define HOST_A "0f4ea5d4-0b4e-4c73-8bf9-bd22b3ee0a6f"
+#define HOST_B "7c1e8a52-6d0b-4f8e-9a4c-2b5d3e1f0a9c"
+
+static known_host_t *hosts = NULL;
+
+static void write_sample_journal();
+
+static char *read_file(const char *path, size_t *size);
+
+static void write_file(const char *path, const char *data, size_t size);
+
+static void free_hosts(known_host_t *list);
+
+static void assert_same_hosts(known_host_t *expected, known_host_t *actual);
+
+void setUp(void) {
+    remove(JOURNAL_PATH);
+    remove(TRUNCATED_PATH);
+    hosts = NULL;
+}
+
+void tearDown(void) {
+    free_hosts(hosts);
+    remove(JOURNAL_PATH);
+    remove(TRUNCATED_PATH);
+}
+
+void test_replay(void) {
+    write_sample_journal();
+    TEST_ASSERT_EQUAL(10, known_hosts_journal_replay(JOURNAL_PATH, &hosts));
+
+    // Host B was forgotten, and added back again
+    known_host_t *a = hosts, *b = hosts->next;
+    TEST_ASSERT_NOT_NULL(b);
+    TEST_ASSERT_NULL(b->next);
+    TEST_ASSERT_TRUE(uuidstr_t_equals_s(&a->uuid, HOST_A));
+    TEST_ASSERT_EQUAL_STRING("gaming-pc", a->hostname);
+    TEST_ASSERT_EQUAL_STRING("192.168.1.120", hostport_get_hostname(a->address));
+    TEST_ASSERT_EQUAL(47989, hostport_get_port(a->address));
+    TEST_ASSERT_NOT_NULL(a->favs);
+    TEST_ASSERT_EQUAL(2, a->favs->id);
+    TEST_ASSERT_NULL(a->favs->next);
+    TEST_ASSERT_NOT_NULL(a->hidden);
+    TEST_ASSERT_EQUAL(5, a->hidden->id);
+    TEST_ASSERT_FALSE(a->selected);
+
+    TEST_ASSERT_TRUE(uuidstr_t_equals_s(&b->uuid, HOST_B));
+    TEST_ASSERT_EQUAL_STRING("living room", b->hostname);
+    TEST_ASSERT_NULL(b->favs);
+    TEST_ASSERT_TRUE(b->selected);
+}
+
+void test_replay_twice(void) {
+    write_sample_journal();
+    known_host_t *once = NULL;
+    known_hosts_journal_replay(JOURNAL_PATH, &once);
+    // Same as crashing after hosts.ini was written, but before the journal was reset
+    known_hosts_journal_replay(JOURNAL_PATH, &hosts);
+    known_hosts_journal_replay(JOURNAL_PATH, &hosts);
+    assert_same_hosts(once, hosts);
+    free_hosts(once);
+}
+
+void test_truncated_anywhere(void) {
+    write_sample_journal();
+    size_t size = 0;
+    char *data = read_file(JOURNAL_PATH, &size);
+    for (size_t cut = 0; cut <= size; cut++) {
+        // Everything up to the last complete line survives, anything after it doesn't
+        size_t complete = 0, complete_size = 0;
+        for (size_t i = 0; i < cut; i++) {
+            if (data[i] == '\n') {
+                complete++;
+                complete_size = i + 1;
+            }
+        }
+        known_host_t *expected = NULL, *actual = NULL;
+        write_file(TRUNCATED_PATH, data, complete_size);
+        known_hosts_journal_replay(TRUNCATED_PATH, &expected);
+
+        write_file(TRUNCATED_PATH, data, cut);
+        known_hosts_journal_t *journal = known_hosts_journal_open(TRUNCATED_PATH, &actual);
+        TEST_ASSERT_NOT_NULL(journal);
+        TEST_ASSERT_EQUAL(complete, known_hosts_journal_records(journal));
+        assert_same_hosts(expected, actual);
+
+        // Changes made after recovery must not be hidden behind the torn record
+        TEST_ASSERT_TRUE(known_hosts_journal_favorite(journal, HOST_A, 42, true));
+        known_hosts_journal_close(journal);
+        free_hosts(actual);
+        actual = NULL;
+        TEST_ASSERT_EQUAL(complete + 1, known_hosts_journal_replay(TRUNCATED_PATH, &actual));
+        free_hosts(expected);
+        free_hosts(actual);
+    }
+    free(data);
+}
+
+void test_corrupted_record(void) {
+    write_sample_journal();
+    size_t size = 0;
+    char *data = read_file(JOURNAL_PATH, &size);
+    // Flip a byte in the second record
+    char *second = strchr(data, '\n') + 1;
+    second[2] ^= 0x20;
+    write_file(JOURNAL_PATH, data, size);
+    TEST_ASSERT_EQUAL(1, known_hosts_journal_replay(JOURNAL_PATH, &hosts));
+    free(data);
+}
+
+void test_reset(void) {
+    write_sample_journal();
+    known_hosts_journal_t *journal = known_hosts_journal_open(JOURNAL_PATH, &hosts);
+    TEST_ASSERT_EQUAL(10, known_hosts_journal_records(journal));
+    known_hosts_journal_reset(journal);
+    TEST_ASSERT_EQUAL(0, known_hosts_journal_records(journal));
+    TEST_ASSERT_TRUE(known_hosts_journal_select(journal, HOST_A));
+    known_hosts_journal_close(journal);
+
+    known_host_t *replayed = NULL;
+    TEST_ASSERT_EQUAL(1, known_hosts_journal_replay(JOURNAL_PATH, &replayed));
+    free_hosts(replayed);
+}
+
+static void write_sample_journal() {
+    known_host_t *ignored = NULL;
+    known_hosts_journal_t *journal = known_hosts_journal_open(JOURNAL_PATH, &ignored);
+    TEST_ASSERT_NOT_NULL(journal);
+    known_hosts_journal_host(journal, HOST_A, "00:11:22:33:44:55", "desktop", "192.168.1.100");
+    known_hosts_journal_favorite(journal, HOST_A, 1, true);
+    known_hosts_journal_favorite(journal, HOST_A, 2, true);
+    known_hosts_journal_hidden(journal, HOST_A, 5, true);
+    known_hosts_journal_host(journal, HOST_B, "66:77:88:99:aa:bb", "living\troom", "192.168.1.101:47999");
+    known_hosts_journal_favorite(journal, HOST_A, 1, false);
+    known_hosts_journal_host(journal, HOST_A, "00:11:22:33:44:55", "gaming-pc", "192.168.1.120:47989");
+    known_hosts_journal_forget(journal, HOST_B);
+    known_hosts_journal_host(journal, HOST_B, "66:77:88:99:aa:bb", "living\troom", "192.168.1.101:47999");
+    known_hosts_journal_close(journal);
+
+    // Selection is set after reopening, also tests appending to an existing journal
+    journal = known_hosts_journal_open(JOURNAL_PATH, &ignored);
+    TEST_ASSERT_EQUAL(9, known_hosts_journal_records(journal));
+    known_hosts_journal_select(journal, HOST_B);
+    known_hosts_journal_close(journal);
+    free_hosts(ignored);
+}
+
+static char *read_file(const char *path, size_t *size) {
+    FILE *fp = fopen(path, "rb");
+    TEST_ASSERT_NOT_NULL(fp);
+    fseek(fp, 0, SEEK_END);
+    *size = ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+    char *data = malloc(*size + 1);
+    TEST_ASSERT_EQUAL(*size, fread(data, 1, *size, fp));
+    data[*size] = '\0';
+    fclose(fp);
+    return data;
+}
+
+static void write_file(const char *path, const char *data, size_t size) {
+    FILE *fp = fopen(path, "wb");
+    TEST_ASSERT_NOT_NULL(fp);
+    TEST_ASSERT_EQUAL(size, fwrite(data, 1, size, fp));
+    fclose(fp);
+}
+
+static void free_hosts(known_host_t *list) {
+    while (list != NULL) {
+        known_host_t *next = list->next;
+        SDL_free(list->mac);
+        SDL_free(list->hostname);
+        known_hosts_node_free(list);
+        list = next;
+    }
+}
+
+static void assert_ids_equal(appid_list_t *expected, appid_list_t *actual) {
+    for (; expected != NULL && actual != NULL; expected = expected->next, actual = actual->next) {
+        TEST_ASSERT_EQUAL(expected->id, actual->id);
+    }
+    TEST_ASSERT_NULL(expected);
+    TEST_ASSERT_NULL(actual);
+}
+
+static void assert_same_hosts(known_host_t *expected, known_host_t *actual) {
+    for (; expected != NULL && actual != NULL; expected = expected->next, actual = actual->next) {
+        TEST_ASSERT_TRUE(uuidstr_t_equals_t(&expected->uuid, &actual->uuid));
+        TEST_ASSERT_EQUAL_STRING(expected->mac, actual->mac);
+        TEST_ASSERT_EQUAL_STRING(expected->hostname, actual->hostname);
+        TEST_ASSERT_EQUAL(expected->address == NULL, actual->address == NULL);
+        if (expected->address != NULL) {
+            TEST_ASSERT_EQUAL_STRING(hostport_get_hostname(expected->address), hostport_get_hostname(actual->address));
+            TEST_ASSERT_EQUAL(hostport_get_port(expected->address), hostport_get_port(actual->address));
+        }
+        TEST_ASSERT_EQUAL(expected->selected, actual->selected);
+        assert_ids_equal(expected->favs, actual->favs);
+        assert_ids_equal(expected->hidden, actual->hidden);
+    }
+    TEST_ASSERT_NULL(expected);
+    TEST_ASSERT_NULL(actual);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_replay);
+    RUN_TEST(test_replay_twice);
+    RUN_TEST(test_truncated_anywhere);
+    RUN_TEST(test_corrupted_record);
+    RUN_TEST(test_reset);
+    return UNITY_END();
+}
@@ -0,0 +1,86 @@
+#include "unity.h"
+#include "backend/pcmanager/pclist.h"
+#include "backend/pcmanager/priv.h"
+
+#include <SDL.h>
+
+static SERVER_DATA *base = NULL;
+
+static SERVER_DATA *server_new() {
+    SERVER_DATA *server = serverdata_new();
+    server->uuid = SDL_strdup("0f4ea5d4-0b4e-4c73-8bf9-bd22b3ee0a6f");
+    server->hostname = SDL_strdup("desktop");
+    server->mac = SDL_strdup("00:11:22:33:44:55");
+    server->serverInfo.address = SDL_strdup("192.168.1.100");
+    server->serverInfo.serverInfoAppVersion = SDL_strdup("7.1.431.-1");
+    server->extPort = 47989;
+    server->httpsPort = 47984;
+    server->paired = true;
+    server->serverMajorVersion = 7;
+    DISPLAY_MODE *mode = SDL_calloc(1, sizeof(DISPLAY_MODE));
+    mode->width = 1920;
+    mode->height = 1080;
+    mode->refresh = 60;
+    server->modes = mode;
+    return server;
+}
+
+void setUp(void) {
+    base = server_new();
+}
+
+void tearDown(void) {
+    serverdata_free(base);
+}
+
+void test_identical_poll() {
+    SERVER_DATA *polled = serverdata_clone(base);
+    TEST_ASSERT_EQUAL(PCMANAGER_CHANGE_NONE, pclist_server_diff(base, polled));
+    serverdata_free(polled);
+}
+
+void test_field_changes() {
+    SERVER_DATA *polled = serverdata_clone(base);
+    polled->currentGame = 1234;
+    TEST_ASSERT_EQUAL(PCMANAGER_CHANGE_CURRENT_APP, pclist_server_diff(base, polled));
+    polled->paired = false;
+    TEST_ASSERT_EQUAL(PCMANAGER_CHANGE_CURRENT_APP | PCMANAGER_CHANGE_PAIRED, pclist_server_diff(base, polled));
+    serverdata_free(polled);
+
+    polled = serverdata_clone(base);
+    SDL_free((void *) polled->serverInfo.address);
+    polled->serverInfo.address = SDL_strdup("192.168.1.101");
+    TEST_ASSERT_EQUAL(PCMANAGER_CHANGE_ADDRESS, pclist_server_diff(base, polled));
+    serverdata_free(polled);
+
+    polled = serverdata_clone(base);
+    polled->modes->refresh = 120;
+    TEST_ASSERT_EQUAL(PCMANAGER_CHANGE_INFO, pclist_server_diff(base, polled));
+    serverdata_free(polled);
+}
+
+void test_node_apply() {
+    pclist_t node = {.state.code = SERVER_STATE_QUERYING, .server = serverdata_clone(base)};
+    SERVER_STATE online = {.code = SERVER_STATE_AVAILABLE};
+    TEST_ASSERT_EQUAL(PCMANAGER_CHANGE_STATE, pclist_node_apply(&node, &online, serverdata_clone(base)));
+    // Same response from the next poll
+    TEST_ASSERT_EQUAL(PCMANAGER_CHANGE_NONE, pclist_node_apply(&node, &online, serverdata_clone(base)));
+    // Only state update without server info
+    SERVER_STATE none = {.code = SERVER_STATE_NONE};
+    TEST_ASSERT_EQUAL(PCMANAGER_CHANGE_NONE, pclist_node_apply(&node, &none, NULL));
+
+    SERVER_STATE error = {.error = {.code = SERVER_STATE_ERROR, .errcode = -1, .errmsg = "Timeout"}};
+    TEST_ASSERT_EQUAL(PCMANAGER_CHANGE_STATE, pclist_node_apply(&node, &error, NULL));
+    TEST_ASSERT_EQUAL(PCMANAGER_CHANGE_NONE, pclist_node_apply(&node, &error, NULL));
+    SERVER_STATE error2 = {.error = {.code = SERVER_STATE_ERROR, .errcode = -2, .errmsg = "Refused"}};
+    TEST_ASSERT_EQUAL(PCMANAGER_CHANGE_STATE, pclist_node_apply(&node, &error2, NULL));
+    serverdata_free(node.server);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_identical_poll);
+    RUN_TEST(test_field_changes);
+    RUN_TEST(test_node_apply);
+    return UNITY_END();
+}
@@ -0,0 +1,151 @@
+#include "unity.h"
+#include "backend/pcmanager/poll_schedule.h"
+
+static const poll_schedule_options_t options = {
+        .booting_interval_ms = 2000,
+        .streaming_interval_ms = 5000,
+        .idle_interval_ms = 15000,
+        .offline_interval_ms = 30000,
+        .offline_max_interval_ms = 120000,
+        .boot_window_ms = 90000,
+        .jitter_percent = 20,
+        .stagger_ms = 3000,
+        .max_in_flight = 2,
+};
+
+static poll_schedule_t schedule;
+static uuidstr_t hosts[4];
+static Uint64 now;
+
+void setUp(void) {
+    now = 1000;
+    poll_schedule_init(&schedule, &options, 1234);
+    for (int i = 0; i < 4; i++) {
+        uuidstr_random(&hosts[i]);
+    }
+}
+
+void tearDown(void) {
+    poll_schedule_deinit(&schedule);
+}
+
+/**
+ * Advance fake clock until the host gets polled.
+ * @return Time elapsed
+ */
+static Uint64 wait_for_poll(const uuidstr_t *expected) {
+    Uint64 start = now;
+    uuidstr_t uuid;
+    while (!poll_schedule_next(&schedule, now, &uuid)) {
+        Sint64 delay = poll_schedule_next_delay(&schedule, now);
+        TEST_ASSERT_TRUE(delay >= 0);
+        now += delay > 0 ? delay : 1;
+    }
+    TEST_ASSERT_TRUE(uuidstr_t_equals_t(expected, &uuid));
+    return now - start;
+}
+
+static void assert_within_jitter(Uint32 interval, Uint64 elapsed) {
+    TEST_ASSERT_TRUE(elapsed >= interval * 8 / 10);
+    TEST_ASSERT_TRUE(elapsed <= interval * 12 / 10);
+}
+
+void test_interval_by_state(void) {
+    poll_schedule_set_host(&schedule, &hosts[0], SERVER_STATE_AVAILABLE, false, now);
+    wait_for_poll(&hosts[0]);
+    poll_schedule_done(&schedule, &hosts[0], true, now);
+    assert_within_jitter(options.idle_interval_ms, wait_for_poll(&hosts[0]));
+
+    // A game has been started on the host
+    poll_schedule_set_host(&schedule, &hosts[0], SERVER_STATE_AVAILABLE, true, now);
+    poll_schedule_done(&schedule, &hosts[0], true, now);
+    assert_within_jitter(options.streaming_interval_ms, wait_for_poll(&hosts[0]));
+}
+
+void test_offline_backoff(void) {
+    poll_schedule_set_host(&schedule, &hosts[0], SERVER_STATE_OFFLINE, false, now);
+    wait_for_poll(&hosts[0]);
+    Uint32 expected[] = {30000, 60000, 120000, 120000};
+    for (int i = 0; i < 4; i++) {
+        poll_schedule_done(&schedule, &hosts[0], false, now);
+        assert_within_jitter(expected[i], wait_for_poll(&hosts[0]));
+    }
+
+    // Woken up, polled quickly until it comes online
+    poll_schedule_done(&schedule, &hosts[0], false, now);
+    poll_schedule_host_waking(&schedule, &hosts[0], now);
+    TEST_ASSERT_TRUE(wait_for_poll(&hosts[0]) <= options.booting_interval_ms);
+    poll_schedule_done(&schedule, &hosts[0], false, now);
+    assert_within_jitter(options.booting_interval_ms, wait_for_poll(&hosts[0]));
+    poll_schedule_set_host(&schedule, &hosts[0], SERVER_STATE_AVAILABLE, false, now);
+    poll_schedule_done(&schedule, &hosts[0], true, now);
+    assert_within_jitter(options.idle_interval_ms, wait_for_poll(&hosts[0]));
+}
+
+void test_concurrency_cap(void) {
+    for (int i = 0; i < 4; i++) {
+        poll_schedule_set_host(&schedule, &hosts[i], SERVER_STATE_AVAILABLE, false, now);
+    }
+    now += options.stagger_ms;
+    uuidstr_t uuid[3];
+    TEST_ASSERT_TRUE(poll_schedule_next(&schedule, now, &uuid[0]));
+    TEST_ASSERT_TRUE(poll_schedule_next(&schedule, now, &uuid[1]));
+    TEST_ASSERT_FALSE(poll_schedule_next(&schedule, now, &uuid[2]));
+    TEST_ASSERT_EQUAL(-1, poll_schedule_next_delay(&schedule, now));
+    TEST_ASSERT_FALSE(uuidstr_t_equals_t(&uuid[0], &uuid[1]));
+
+    poll_schedule_done(&schedule, &uuid[0], true, now);
+    TEST_ASSERT_EQUAL(0, poll_schedule_next_delay(&schedule, now));
+    TEST_ASSERT_TRUE(poll_schedule_next(&schedule, now, &uuid[2]));
+    TEST_ASSERT_FALSE(uuidstr_t_equals_t(&uuid[2], &uuid[0]));
+    TEST_ASSERT_FALSE(uuidstr_t_equals_t(&uuid[2], &uuid[1]));
+}
+
+void test_stagger(void) {
+    for (int i = 0; i < 4; i++) {
+        poll_schedule_set_host(&schedule, &hosts[i], SERVER_STATE_NONE, false, now);
+    }
+    Uint64 first = now + options.stagger_ms, last = now;
+    for (size_t i = 0; i < schedule.count; i++) {
+        TEST_ASSERT_TRUE(schedule.hosts[i].due < now + options.stagger_ms);
+        first = SDL_min(first, schedule.hosts[i].due);
+        last = SDL_max(last, schedule.hosts[i].due);
+    }
+    TEST_ASSERT_TRUE(last > first);
+}
+
+void test_suspend(void) {
+    poll_schedule_set_host(&schedule, &hosts[0], SERVER_STATE_AVAILABLE, false, now);
+    poll_schedule_set_suspended(&schedule, true, now);
+    now += 60000;
+    uuidstr_t uuid;
+    TEST_ASSERT_FALSE(poll_schedule_next(&schedule, now, &uuid));
+    TEST_ASSERT_EQUAL(-1, poll_schedule_next_delay(&schedule, now));
+
+    poll_schedule_set_suspended(&schedule, false, now);
+    TEST_ASSERT_TRUE(wait_for_poll(&hosts[0]) < options.stagger_ms);
+}
+
+void test_deterministic(void) {
+    Uint64 due[2][4];
+    for (int round = 0; round < 2; round++) {
+        poll_schedule_deinit(&schedule);
+        poll_schedule_init(&schedule, &options, 42);
+        for (int i = 0; i < 4; i++) {
+            poll_schedule_set_host(&schedule, &hosts[i], SERVER_STATE_AVAILABLE, false, 0);
+            due[round][i] = schedule.hosts[i].due;
+        }
+    }
+    TEST_ASSERT_EQUAL_MEMORY(due[0], due[1], sizeof(due[0]));
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_interval_by_state);
+    RUN_TEST(test_offline_backoff);
+    RUN_TEST(test_concurrency_cap);
+    RUN_TEST(test_stagger);
+    RUN_TEST(test_suspend);
+    RUN_TEST(test_deterministic);
+    return UNITY_END();
+}
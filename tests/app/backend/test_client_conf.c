@@ -0,0 +1,135 @@
+#include "unity.h"
+#include "backend/client_conf.h"
+#include "executor.h"
+#include "errors.h"
+
+#include <SDL2/SDL_atomic.h>
+#include <SDL2/SDL_timer.h>
+
+#define KEYGEN_DELAY_MS 1000
+#define DISCOVERY_TASKS 8
+
+static executor_t *executor = NULL;
+static client_conf_t *conf = NULL;
+static SDL_atomic_t keygen_calls;
+
+typedef struct discovery_task_t {
+    client_conf_t *conf;
+    bool conf_ready_when_done;
+    SDL_atomic_t *finished;
+} discovery_task_t;
+
+typedef struct client_task_t {
+    client_conf_t *conf;
+    int result;
+    bool conf_ready_when_done;
+    SDL_atomic_t *finished;
+} client_task_t;
+
+static int slow_keygen(const char *keydir) {
+    (void) keydir;
+    SDL_AtomicIncRef(&keygen_calls);
+    SDL_Delay(KEYGEN_DELAY_MS);
+    return GS_OK;
+}
+
+static int failed_keygen(const char *keydir) {
+    (void) keydir;
+    return GS_BAD_CONF;
+}
+
+/* Simulates a host found by discovery, which only touches the host list until a client is needed */
+static int discovery_run(discovery_task_t *task) {
+    SDL_Delay(10);
+    task->conf_ready_when_done = client_conf_is_ready(task->conf);
+    return 0;
+}
+
+static void discovery_finalize(discovery_task_t *task, int result) {
+    (void) result;
+    SDL_AtomicIncRef(task->finished);
+}
+
+/* Simulates a status update, which needs a client */
+static int client_run(client_task_t *task) {
+    task->result = client_conf_wait(task->conf, NULL);
+    task->conf_ready_when_done = client_conf_is_ready(task->conf);
+    return 0;
+}
+
+static void client_finalize(client_task_t *task, int result) {
+    (void) result;
+    SDL_AtomicIncRef(task->finished);
+}
+
+void setUp(void) {
+    executor = executor_create("test-client-conf", 4);
+    conf = client_conf_new(executor);
+    SDL_AtomicSet(&keygen_calls, 0);
+}
+
+void tearDown(void) {
+    executor_destroy(executor);
+    client_conf_destroy(conf);
+}
+
+void test_discovery_proceeds_during_keygen(void) {
+    Uint32 start = SDL_GetTicks();
+    client_conf_start(conf, "/tmp", slow_keygen);
+
+    SDL_atomic_t finished;
+    SDL_AtomicSet(&finished, 0);
+    discovery_task_t discovery[DISCOVERY_TASKS];
+    for (int i = 0; i < DISCOVERY_TASKS; i++) {
+        discovery[i] = (discovery_task_t) {.conf = conf, .finished = &finished};
+        executor_submit(executor, (executor_action_cb) discovery_run, (executor_cleanup_cb) discovery_finalize,
+                        &discovery[i]);
+    }
+    SDL_atomic_t client_finished;
+    SDL_AtomicSet(&client_finished, 0);
+    client_task_t client = {.conf = conf, .finished = &client_finished};
+    executor_submit(executor, (executor_action_cb) client_run, (executor_cleanup_cb) client_finalize, &client);
+
+    // Main thread keeps running its loop while keys are generated
+    int ui_iterations = 0;
+    while (SDL_AtomicGet(&finished) < DISCOVERY_TASKS) {
+        ui_iterations++;
+        SDL_Delay(1);
+    }
+    Uint32 discovery_done = SDL_GetTicks() - start;
+    TEST_ASSERT_FALSE(client_conf_is_ready(conf));
+    TEST_ASSERT_TRUE(ui_iterations > 0);
+    TEST_ASSERT_TRUE(discovery_done < KEYGEN_DELAY_MS);
+    for (int i = 0; i < DISCOVERY_TASKS; i++) {
+        TEST_ASSERT_FALSE(discovery[i].conf_ready_when_done);
+    }
+
+    TEST_ASSERT_EQUAL(GS_OK, client_conf_wait(conf, NULL));
+    while (SDL_AtomicGet(&client_finished) == 0) {
+        SDL_Delay(1);
+    }
+    TEST_ASSERT_EQUAL(GS_OK, client.result);
+    TEST_ASSERT_TRUE(client.conf_ready_when_done);
+    TEST_ASSERT_TRUE(SDL_GetTicks() - start >= KEYGEN_DELAY_MS);
+    TEST_ASSERT_EQUAL(1, SDL_AtomicGet(&keygen_calls));
+
+    char message[128];
+    SDL_snprintf(message, sizeof(message), "Discovery finished after %u ms, keygen took %u ms", discovery_done,
+                 SDL_GetTicks() - start);
+    TEST_MESSAGE(message);
+}
+
+void test_keygen_failure(void) {
+    client_conf_start(conf, "/tmp", failed_keygen);
+    const char *message = NULL;
+    TEST_ASSERT_EQUAL(GS_BAD_CONF, client_conf_wait(conf, &message));
+    // Result stays the same for later waits
+    TEST_ASSERT_EQUAL(GS_BAD_CONF, client_conf_wait(conf, NULL));
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_discovery_proceeds_during_keygen);
+    RUN_TEST(test_keygen_failure);
+    return UNITY_END();
+}
@@ -0,0 +1,160 @@
+#include "unity.h"
+#include "input/input_gamepad_mapping_index.h"
+
+#include <SDL.h>
+#include <stdio.h>
+#include <unistd.h>
+
+#define DB_PATH "/tmp/moonlight-test-gamecontrollerdb.txt"
+#define INDEX_PATH "/tmp/moonlight-test-gamecontrollerdb.txt.idx"
+#define DB_PLATFORMS 4
+#define DB_MAPPINGS_PER_PLATFORM 1000
+
+static const char *db_paths[] = {DB_PATH};
+
+static const char *platforms[DB_PLATFORMS] = {"Windows", "Mac OS X", "Linux", "Android"};
+
+static void mapping_guid(char *guid, size_t len, int vendor, int product) {
+    SDL_snprintf(guid, len, "03000000%04x0000%04x000010010000", vendor, product);
+}
+
+static void write_db() {
+    FILE *fp = fopen(DB_PATH, "w");
+    TEST_ASSERT_NOT_NULL(fp);
+    fprintf(fp, "# Synthetic controller database\n");
+    for (int i = 0; i < DB_MAPPINGS_PER_PLATFORM; i++) {
+        for (int p = 0; p < DB_PLATFORMS; p++) {
+            char guid[33];
+            mapping_guid(guid, sizeof(guid), 0x1000 + p, i);
+            fprintf(fp, "%s,Pad %d,a:b0,b:b1,x:b2,y:b3,leftx:a0,lefty:a1,platform:%s,\n", guid, i, platforms[p]);
+        }
+    }
+    // Duplicated entry, later one wins
+    char guid[33];
+    mapping_guid(guid, sizeof(guid), 0xbeef, 1);
+    fprintf(fp, "%s,Old Pad,a:b0,b:b1,\n", guid);
+    fprintf(fp, "%s,New Pad,a:b1,b:b0,\n", guid);
+    fclose(fp);
+}
+
+static long resident_kb() {
+#ifdef __linux__
+    long pages = 0, resident = 0;
+    FILE *fp = fopen("/proc/self/statm", "r");
+    if (fp == NULL) {
+        return 0;
+    }
+    if (fscanf(fp, "%ld %ld", &pages, &resident) != 2) {
+        resident = 0;
+    }
+    fclose(fp);
+    return resident * (sysconf(_SC_PAGESIZE) / 1024);
+#else
+    return 0;
+#endif
+}
+
+static double elapsed_ms(Uint64 start) {
+    return (double) (SDL_GetPerformanceCounter() - start) * 1000.0 / (double) SDL_GetPerformanceFrequency();
+}
+
+void setUp(void) {
+    write_db();
+    remove(INDEX_PATH);
+}
+
+void tearDown(void) {
+    remove(DB_PATH);
+    remove(INDEX_PATH);
+}
+
+void test_build_and_find() {
+    TEST_ASSERT_TRUE(gamepad_mapping_index_is_stale(db_paths, 1, INDEX_PATH));
+    TEST_ASSERT_EQUAL(DB_MAPPINGS_PER_PLATFORM + 1, gamepad_mapping_index_build(db_paths, 1, INDEX_PATH, "Linux"));
+    TEST_ASSERT_FALSE(gamepad_mapping_index_is_stale(db_paths, 1, INDEX_PATH));
+
+    gamepad_mapping_index_t *index = gamepad_mapping_index_open(INDEX_PATH);
+    TEST_ASSERT_NOT_NULL(index);
+    TEST_ASSERT_EQUAL(DB_MAPPINGS_PER_PLATFORM + 1, gamepad_mapping_index_count(index));
+
+    char guid[33];
+    mapping_guid(guid, sizeof(guid), 0x1002, 42);
+    const char *mapping = gamepad_mapping_index_find(index, SDL_JoystickGetGUIDFromString(guid));
+    TEST_ASSERT_NOT_NULL(mapping);
+    TEST_ASSERT_EQUAL(0, SDL_strncmp(mapping, guid, 32));
+    TEST_ASSERT_NOT_NULL(SDL_strstr(mapping, "platform:Linux"));
+
+    // Mapping of other platforms are filtered out
+    mapping_guid(guid, sizeof(guid), 0x1000, 42);
+    TEST_ASSERT_NULL(gamepad_mapping_index_find(index, SDL_JoystickGetGUIDFromString(guid)));
+
+    mapping_guid(guid, sizeof(guid), 0xbeef, 1);
+    SDL_JoystickGUID dup_guid = SDL_JoystickGetGUIDFromString(guid);
+    mapping = gamepad_mapping_index_find(index, dup_guid);
+    TEST_ASSERT_NOT_NULL(mapping);
+    TEST_ASSERT_NOT_NULL(SDL_strstr(mapping, "New Pad"));
+
+    // GUID with name CRC still matches
+    dup_guid.data[2] = 0x12;
+    dup_guid.data[3] = 0x34;
+    TEST_ASSERT_NOT_NULL(gamepad_mapping_index_find(index, dup_guid));
+
+    gamepad_mapping_index_close(index);
+
+    FILE *fp = fopen(DB_PATH, "a");
+    fprintf(fp, "# Changed\n");
+    fclose(fp);
+    TEST_ASSERT_TRUE(gamepad_mapping_index_is_stale(db_paths, 1, INDEX_PATH));
+}
+
+void test_invalid_index() {
+    FILE *fp = fopen(INDEX_PATH, "w");
+    fprintf(fp, "garbage");
+    fclose(fp);
+    TEST_ASSERT_TRUE(gamepad_mapping_index_is_stale(db_paths, 1, INDEX_PATH));
+    TEST_ASSERT_NULL(gamepad_mapping_index_open(INDEX_PATH));
+}
+
+void test_benchmark() {
+    char guid[33];
+    mapping_guid(guid, sizeof(guid), 0x1002, 7);
+    SDL_JoystickGUID connected = SDL_JoystickGetGUIDFromString(guid);
+
+    long rss_before = resident_kb();
+    Uint64 start = SDL_GetPerformanceCounter();
+    gamepad_mapping_index_build(db_paths, 1, INDEX_PATH, "Linux");
+    double build_ms = elapsed_ms(start);
+
+    start = SDL_GetPerformanceCounter();
+    gamepad_mapping_index_t *index = gamepad_mapping_index_open(INDEX_PATH);
+    const char *mapping = gamepad_mapping_index_find(index, connected);
+    TEST_ASSERT_NOT_NULL(mapping);
+    TEST_ASSERT_TRUE(SDL_GameControllerAddMapping(mapping) >= 0);
+    double indexed_ms = elapsed_ms(start);
+    long rss_indexed = resident_kb();
+    gamepad_mapping_index_close(index);
+
+    // What used to happen on every startup
+    start = SDL_GetPerformanceCounter();
+    int added = SDL_GameControllerAddMappingsFromRW(SDL_RWFromFile(DB_PATH, "r"), SDL_TRUE);
+    double full_ms = elapsed_ms(start);
+    long rss_full = resident_kb();
+    TEST_ASSERT_TRUE(added > 0);
+
+    char message[256];
+    SDL_snprintf(message, sizeof(message),
+                 "Full db: %.2f ms, +%ld KiB RSS; index: %.2f ms (build once %.2f ms), +%ld KiB RSS",
+                 full_ms, rss_full - rss_indexed, indexed_ms, build_ms, rss_indexed - rss_before);
+    TEST_MESSAGE(message);
+}
+
+int main() {
+    SDL_Init(SDL_INIT_GAMECONTROLLER);
+    UNITY_BEGIN();
+    RUN_TEST(test_build_and_find);
+    RUN_TEST(test_invalid_index);
+    RUN_TEST(test_benchmark);
+    int ret = UNITY_END();
+    SDL_Quit();
+    return ret;
+}
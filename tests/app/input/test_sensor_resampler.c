@@ -0,0 +1,183 @@
+#include "unity.h"
+#include "input/sensor_resampler.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#define NS_PER_MS 1000000ULL
+#define NS_PER_SEC 1000000000ULL
+
+static sensor_resampler_t resampler;
+
+typedef struct replay_result_t {
+    uint32_t sent;
+    /* Sum of sent value * send interval, i.e. integrated angle for gyro */
+    double integrated;
+    double expected_integral;
+} replay_result_t;
+
+/**
+ * Feeds a synthetic stream of sensor samples.
+ *
+ * @param sensor_hz Rate of samples from the device
+ * @param jitter_ns Maximum deviation of each sample time
+ */
+static replay_result_t replay(uint16_t rate_hz, uint32_t sensor_hz, uint64_t jitter_ns, double seconds,
+                              double (*signal)(double t)) {
+    replay_result_t result = {0};
+    sensor_resampler_set_rate(&resampler, rate_hz);
+    uint64_t interval_ns = NS_PER_SEC / sensor_hz;
+    uint64_t end_ns = (uint64_t) (seconds * NS_PER_SEC);
+    uint64_t last_send_ns = 0;
+    float last_out = 0;
+    unsigned int seed = 1;
+    for (uint64_t t = 0; t <= end_ns; t += interval_ns) {
+        uint64_t jitter = 0;
+        if (jitter_ns > 0 && t > 0) {
+            seed = seed * 1103515245 + 12345;
+            jitter = (seed >> 8) % jitter_ns;
+        }
+        uint64_t timestamp = t + jitter;
+        float value = (float) signal((double) timestamp / NS_PER_SEC);
+        float data[3] = {value, -value, 0}, out[3];
+        if (sensor_resampler_feed(&resampler, timestamp, data, out)) {
+            sensor_resampler_mark_sent(&resampler, timestamp);
+            TEST_ASSERT_EQUAL_FLOAT(-out[0], out[1]);
+            if (result.sent > 0) {
+                result.integrated += (double) last_out * (double) (timestamp - last_send_ns) / NS_PER_SEC;
+            }
+            last_out = out[0];
+            last_send_ns = timestamp;
+            result.sent++;
+        }
+    }
+    return result;
+}
+
+static double constant_signal(double t) {
+    (void) t;
+    return 1.0;
+}
+
+static double vibration_signal(double t) {
+    // Vibration at the report rate, picking one sample per period would turn it into a constant turn
+    return cos(2 * M_PI * 120 * t);
+}
+
+void setUp(void) {
+}
+
+void tearDown(void) {
+}
+
+void test_exact_rate(void) {
+    // 1000 / 300 isn't a whole number of milliseconds
+    replay_result_t result = replay(300, 1000, 0, 10, constant_signal);
+    TEST_ASSERT_UINT32_WITHIN(2, 3000, result.sent);
+    TEST_ASSERT_FLOAT_WITHIN(1.0f, 300.0f, sensor_resampler_achieved_hz(&resampler));
+}
+
+void test_exact_rate_with_jitter(void) {
+    replay_result_t result = replay(200, 250, 2 * NS_PER_MS, 10, constant_signal);
+    TEST_ASSERT_UINT32_WITHIN(20, 2000, result.sent);
+    TEST_ASSERT_FLOAT_WITHIN(10.0f, 200.0f, sensor_resampler_achieved_hz(&resampler));
+}
+
+void test_average_keeps_value(void) {
+    sensor_resampler_set_rate(&resampler, 100);
+    float out[3];
+    for (uint64_t t = 0; t < NS_PER_SEC; t += NS_PER_MS) {
+        float data[3] = {1, 2, 3};
+        if (sensor_resampler_feed(&resampler, t, data, out)) {
+            TEST_ASSERT_EQUAL_FLOAT(1, out[0]);
+            TEST_ASSERT_EQUAL_FLOAT(2, out[1]);
+            TEST_ASSERT_EQUAL_FLOAT(3, out[2]);
+        }
+    }
+}
+
+void test_average_between_sends(void) {
+    sensor_resampler_set_rate(&resampler, 100);
+    float out[3];
+    float first[3] = {0, 0, 0};
+    TEST_ASSERT_TRUE(sensor_resampler_feed(&resampler, 0, first, out));
+    // Half of the period at 1, half at 3
+    float low[3] = {1, 1, 1}, high[3] = {3, 3, 3};
+    TEST_ASSERT_FALSE(sensor_resampler_feed(&resampler, 1 * NS_PER_MS, low, out));
+    TEST_ASSERT_FALSE(sensor_resampler_feed(&resampler, 6 * NS_PER_MS, high, out));
+    TEST_ASSERT_TRUE(sensor_resampler_feed(&resampler, 11 * NS_PER_MS, high, out));
+    // 1ms of 0, 5ms of 1, 5ms of 3
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 20.0f / 11.0f, out[0]);
+}
+
+void test_integral_preserved(void) {
+    replay_result_t result = replay(120, 1000, 0, 2, vibration_signal);
+    // Picking the latest sample at each send, like the old throttling did
+    double decimated = 0;
+    for (uint32_t i = 0; i < result.sent; i++) {
+        decimated += vibration_signal((double) i / 120.0) / 120.0;
+    }
+    TEST_ASSERT_TRUE(fabs(decimated) > 1);
+    TEST_ASSERT_FLOAT_WITHIN(0.05, 0, result.integrated);
+
+    char message[128];
+    snprintf(message, sizeof(message), "Sent %u samples, integrated drift %.5f (decimated %.5f)", result.sent,
+             result.integrated, decimated);
+    TEST_MESSAGE(message);
+}
+
+void test_disabled(void) {
+    replay_result_t result = replay(0, 1000, 0, 1, constant_signal);
+    TEST_ASSERT_EQUAL(0, result.sent);
+}
+
+void test_skipped_sends_not_counted(void) {
+    sensor_resampler_set_rate(&resampler, 100);
+    float data[3] = {1, 1, 1}, out[3], last[3] = {0, 0, 0};
+    uint32_t due = 0;
+    for (uint64_t t = 0; t <= 2 * NS_PER_SEC; t += NS_PER_MS) {
+        if (!sensor_resampler_feed(&resampler, t, data, out)) {
+            continue;
+        }
+        due++;
+        // Same value as the last one isn't sent, like the session does
+        if (memcmp(out, last, sizeof(last)) != 0) {
+            memcpy(last, out, sizeof(last));
+            sensor_resampler_mark_sent(&resampler, t);
+        }
+    }
+    TEST_ASSERT_UINT32_WITHIN(1, 200, due);
+    TEST_ASSERT_EQUAL(1, resampler.sent);
+    TEST_ASSERT_FLOAT_WITHIN(1.0f, 0.0f, sensor_resampler_achieved_hz(&resampler));
+}
+
+void test_no_burst_after_pause(void) {
+    sensor_resampler_set_rate(&resampler, 100);
+    float data[3] = {1, 1, 1}, out[3];
+    uint32_t sent = 0;
+    for (uint64_t t = 0; t < 100 * NS_PER_MS; t += NS_PER_MS) {
+        sent += sensor_resampler_feed(&resampler, t, data, out);
+    }
+    // Sensor paused for 1 second, then resumes
+    uint64_t resume = 1100 * NS_PER_MS;
+    uint32_t sent_after_pause = 0;
+    for (uint64_t t = resume; t < resume + 20 * NS_PER_MS; t += NS_PER_MS) {
+        sent_after_pause += sensor_resampler_feed(&resampler, t, data, out);
+    }
+    TEST_ASSERT_EQUAL(10, sent);
+    TEST_ASSERT_UINT32_WITHIN(1, 2, sent_after_pause);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_exact_rate);
+    RUN_TEST(test_exact_rate_with_jitter);
+    RUN_TEST(test_average_keeps_value);
+    RUN_TEST(test_average_between_sends);
+    RUN_TEST(test_integral_preserved);
+    RUN_TEST(test_disabled);
+    RUN_TEST(test_skipped_sends_not_counted);
+    RUN_TEST(test_no_burst_after_pause);
+    return UNITY_END();
+}
@@ -0,0 +1,103 @@
+#include "unity.h"
+#include "lvgl/lv_disp_drv_app.h"
+
+#include <SDL.h>
+
+#define FRAMES 120
+
+static SDL_Window *window = NULL;
+static lv_disp_drv_t *driver = NULL;
+static lv_disp_t *disp = NULL;
+
+void setUp(void) {
+    window = SDL_CreateWindow("test", 0, 0, 1920, 1080, 0);
+    TEST_ASSERT_NOT_NULL(window);
+    driver = lv_app_disp_drv_create(window, 320);
+    disp = lv_disp_drv_register(driver);
+    // Draw the first frame
+    lv_refr_now(disp);
+}
+
+void tearDown(void) {
+    lv_disp_remove(disp);
+    lv_app_disp_drv_deinit(driver);
+    SDL_DestroyWindow(window);
+}
+
+static double run_frames(const lv_area_t *area) {
+    Uint64 start = SDL_GetPerformanceCounter();
+    for (int i = 0; i < FRAMES; i++) {
+        if (area != NULL) {
+            lv_obj_invalidate_area(lv_scr_act(), area);
+        } else {
+            lv_obj_invalidate(lv_scr_act());
+        }
+        lv_refr_now(disp);
+    }
+    Uint64 elapsed = SDL_GetPerformanceCounter() - start;
+    return (double) elapsed * 1000.0 / (double) SDL_GetPerformanceFrequency() / FRAMES;
+}
+
+void test_skip_when_clean(void) {
+    lv_app_disp_stats_t before, after;
+    lv_app_disp_drv_get_stats(driver, &before);
+    lv_refr_now(disp);
+    lv_refr_now(disp);
+    lv_app_disp_drv_get_stats(driver, &after);
+    TEST_ASSERT_EQUAL(before.presented, after.presented);
+    TEST_ASSERT_EQUAL_UINT64(before.presented_pixels, after.presented_pixels);
+
+    // Last flush of a refresh with nothing visible in it must not present
+    lv_area_t offscreen = {-200, -200, -100, -100};
+    driver->draw_buf->flushing_last = 1;
+    driver->flush_cb(driver, &offscreen, NULL);
+    lv_app_disp_drv_get_stats(driver, &after);
+    TEST_ASSERT_EQUAL(before.presented, after.presented);
+    TEST_ASSERT_EQUAL_UINT64(before.presented_pixels, after.presented_pixels);
+    TEST_ASSERT_EQUAL(before.skipped + 1, after.skipped);
+
+    // Same flush with a visible area does present, so the assertions above aren't vacuous
+    lv_area_t visible = {0, 0, 99, 99};
+    driver->draw_buf->flushing_last = 1;
+    driver->flush_cb(driver, &visible, NULL);
+    lv_app_disp_drv_get_stats(driver, &after);
+    TEST_ASSERT_EQUAL(before.presented + 1, after.presented);
+    TEST_ASSERT_EQUAL(before.skipped + 1, after.skipped);
+}
+
+void test_frame_cost(void) {
+    lv_app_disp_stats_t initial_stats, full_stats, partial_stats;
+    lv_app_disp_drv_get_stats(driver, &initial_stats);
+    double full_ms = run_frames(NULL);
+    lv_app_disp_drv_get_stats(driver, &full_stats);
+
+    // Roughly the size of a focus ring on a 1080p screen
+    lv_area_t focus = {100, 100, 339, 419};
+    double partial_ms = run_frames(&focus);
+    lv_app_disp_drv_get_stats(driver, &partial_stats);
+
+    TEST_ASSERT_EQUAL(FRAMES, full_stats.presented - initial_stats.presented);
+    TEST_ASSERT_EQUAL(FRAMES, partial_stats.presented - full_stats.presented);
+    TEST_ASSERT_EQUAL(FRAMES, partial_stats.partial - full_stats.partial);
+    uint64_t full_pixels = full_stats.presented_pixels - initial_stats.presented_pixels;
+    uint64_t partial_pixels = partial_stats.presented_pixels - full_stats.presented_pixels;
+    TEST_ASSERT_TRUE(partial_pixels < full_pixels);
+
+    char message[128];
+    SDL_snprintf(message, sizeof(message), "Full screen: %.3f ms/frame, dirty area: %.3f ms/frame", full_ms,
+                 partial_ms);
+    TEST_MESSAGE(message);
+}
+
+int main() {
+    SDL_SetHint(SDL_HINT_VIDEODRIVER, "dummy");
+    SDL_SetHint(SDL_HINT_RENDER_DRIVER, "software");
+    SDL_Init(SDL_INIT_VIDEO);
+    lv_init();
+    UNITY_BEGIN();
+    RUN_TEST(test_skip_when_clean);
+    RUN_TEST(test_frame_cost);
+    int ret = UNITY_END();
+    SDL_Quit();
+    return ret;
+}
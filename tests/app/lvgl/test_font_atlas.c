@@ -0,0 +1,243 @@
+#include "unity.h"
+#include "lvgl/font/lv_font_atlas.h"
+#include "lvgl/lv_disp_drv_app.h"
+#include "util/font.h"
+#include "util/i18n.h"
+
+#include <SDL.h>
+#include <dirent.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#define ATLAS_PATH "/tmp/moonlight-test-glyphs.atlas"
+#define CACHE_DIR "/tmp/moonlight-test-font-cache"
+/* Same as FONT_CACHE_NAME and GLYPH_ATLAS_DIR in font.c */
+#define CACHE_FILE CACHE_DIR "/font_cache.ini"
+#define ATLAS_DIR CACHE_DIR "/glyphs"
+
+static const uint32_t letters[] = {0x65E5, 0x672C, 0x8A9E, 0x4E2D, 0x6587, 0x0041, 0x0020};
+
+static int base_dsc_calls = 0;
+
+static bool fake_get_glyph_dsc(const lv_font_t *font, lv_font_glyph_dsc_t *dsc, uint32_t letter,
+                               uint32_t letter_next);
+
+static const uint8_t *fake_get_glyph_bitmap(const lv_font_t *font, uint32_t letter);
+
+static void cache_dir_clear();
+
+static const lv_font_t fake_font = {
+        .get_glyph_dsc = fake_get_glyph_dsc,
+        .get_glyph_bitmap = fake_get_glyph_bitmap,
+        .line_height = 20,
+        .base_line = 4,
+};
+
+void setUp(void) {
+    unlink(ATLAS_PATH);
+    base_dsc_calls = 0;
+}
+
+void tearDown(void) {
+    unlink(ATLAS_PATH);
+}
+
+static void assert_glyph(const lv_font_t *font, uint32_t letter) {
+    lv_font_glyph_dsc_t dsc, expected;
+    TEST_ASSERT_TRUE(font->get_glyph_dsc(font, &dsc, letter, 0));
+    fake_get_glyph_dsc(&fake_font, &expected, letter, 0);
+    base_dsc_calls--;
+    TEST_ASSERT_EQUAL(expected.adv_w, dsc.adv_w);
+    TEST_ASSERT_EQUAL(expected.box_w, dsc.box_w);
+    TEST_ASSERT_EQUAL(expected.box_h, dsc.box_h);
+    TEST_ASSERT_EQUAL(expected.ofs_x, dsc.ofs_x);
+    TEST_ASSERT_EQUAL(expected.ofs_y, dsc.ofs_y);
+    const uint8_t *bitmap = font->get_glyph_bitmap(font, letter);
+    TEST_ASSERT_EQUAL_MEMORY(fake_get_glyph_bitmap(&fake_font, letter), bitmap, dsc.box_w * dsc.box_h);
+}
+
+void test_round_trip(void) {
+    lv_font_t *font = lv_font_atlas_create((lv_font_t *) &fake_font, ATLAS_PATH, "fake|20");
+    for (size_t i = 0; i < sizeof(letters) / sizeof(letters[0]); i++) {
+        assert_glyph(font, letters[i]);
+    }
+    TEST_ASSERT_TRUE(base_dsc_calls > 0);
+    TEST_ASSERT_TRUE(lv_font_atlas_save(font));
+    lv_font_atlas_destroy(font);
+
+    base_dsc_calls = 0;
+    font = lv_font_atlas_create((lv_font_t *) &fake_font, ATLAS_PATH, "fake|20");
+    for (size_t i = 0; i < sizeof(letters) / sizeof(letters[0]); i++) {
+        assert_glyph(font, letters[i]);
+    }
+    // Everything came from the atlas
+    TEST_ASSERT_EQUAL(0, base_dsc_calls);
+    lv_font_atlas_stats_t stats;
+    lv_font_atlas_get_stats(font, &stats);
+    TEST_ASSERT_EQUAL(sizeof(letters) / sizeof(letters[0]), stats.glyphs);
+    TEST_ASSERT_EQUAL(0, stats.misses);
+
+    // New glyph is added to existing ones
+    assert_glyph(font, 0x8A2D);
+    TEST_ASSERT_TRUE(lv_font_atlas_save(font));
+    lv_font_atlas_destroy(font);
+    font = lv_font_atlas_create((lv_font_t *) &fake_font, ATLAS_PATH, "fake|20");
+    lv_font_atlas_get_stats(font, &stats);
+    TEST_ASSERT_EQUAL(sizeof(letters) / sizeof(letters[0]) + 1, stats.glyphs);
+    lv_font_atlas_destroy(font);
+}
+
+void test_other_font_ignored(void) {
+    lv_font_t *font = lv_font_atlas_create((lv_font_t *) &fake_font, ATLAS_PATH, "fake|20");
+    assert_glyph(font, letters[0]);
+    TEST_ASSERT_TRUE(lv_font_atlas_save(font));
+    lv_font_atlas_destroy(font);
+
+    font = lv_font_atlas_create((lv_font_t *) &fake_font, ATLAS_PATH, "fake|24");
+    lv_font_atlas_stats_t stats;
+    lv_font_atlas_get_stats(font, &stats);
+    TEST_ASSERT_EQUAL(0, stats.glyphs);
+    base_dsc_calls = 0;
+    assert_glyph(font, letters[0]);
+    TEST_ASSERT_EQUAL(1, base_dsc_calls);
+    lv_font_atlas_destroy(font);
+}
+
+void test_snapshot(void) {
+    lv_font_t *font = lv_font_atlas_create((lv_font_t *) &fake_font, ATLAS_PATH, "fake|20");
+    TEST_ASSERT_NULL(lv_font_atlas_snapshot(font));
+    assert_glyph(font, letters[0]);
+    lv_font_atlas_snapshot_t *snapshot = lv_font_atlas_snapshot(font);
+    TEST_ASSERT_NOT_NULL(snapshot);
+    // Glyph is served from the atlas once copied, before the file is written
+    base_dsc_calls = 0;
+    assert_glyph(font, letters[0]);
+    TEST_ASSERT_EQUAL(0, base_dsc_calls);
+    TEST_ASSERT_NULL(lv_font_atlas_snapshot(font));
+    lv_font_atlas_destroy(font);
+
+    // Snapshot doesn't depend on the font
+    TEST_ASSERT_TRUE(lv_font_atlas_snapshot_write(snapshot));
+    lv_font_atlas_snapshot_free(snapshot);
+    font = lv_font_atlas_create((lv_font_t *) &fake_font, ATLAS_PATH, "fake|20");
+    lv_font_atlas_stats_t stats;
+    lv_font_atlas_get_stats(font, &stats);
+    TEST_ASSERT_EQUAL(1, stats.glyphs);
+    lv_font_atlas_destroy(font);
+}
+
+static double first_paint(lv_disp_t *disp, const char *text, lv_font_atlas_stats_t *stats) {
+    app_fonts_t fonts;
+    memset(stats, 0, sizeof(*stats));
+    if (app_font_init(&fonts, 160, CACHE_DIR, true) != 0) {
+        return -1;
+    }
+    lv_obj_t *label = lv_label_create(lv_scr_act());
+    lv_obj_set_style_text_font(label, fonts.fonts.normal, 0);
+    lv_label_set_text(label, text);
+    Uint64 start = SDL_GetPerformanceCounter();
+    lv_refr_now(disp);
+    double elapsed = (double) (SDL_GetPerformanceCounter() - start) * 1000.0 / (double) SDL_GetPerformanceFrequency();
+    const lv_font_t *fallback = fonts.fonts.normal->fallback;
+    if (fallback != NULL && lv_font_atlas_is_atlas(fallback)) {
+        lv_font_atlas_get_stats(fallback, stats);
+    }
+    lv_obj_del(label);
+    app_font_deinit(&fonts);
+    return elapsed;
+}
+
+void test_first_paint_cjk(void) {
+    static const struct {
+        const char *locale;
+        const char *text;
+    } samples[] = {
+            {"ja",    "ホストを追加 設定 ストリーミングを開始 接続しています"},
+            {"zh-CN", "添加主机 设置 开始串流 正在连接"},
+    };
+    SDL_Window *window = SDL_CreateWindow("test", 0, 0, 1280, 720, 0);
+    TEST_ASSERT_NOT_NULL(window);
+    lv_disp_drv_t *driver = lv_app_disp_drv_create(window, 160);
+    lv_disp_t *disp = lv_disp_drv_register(driver);
+    for (size_t i = 0; i < sizeof(samples) / sizeof(samples[0]); i++) {
+        cache_dir_clear();
+        i18n_setlocale(samples[i].locale);
+        lv_font_atlas_stats_t cold_stats, warm_stats;
+        double cold = first_paint(disp, samples[i].text, &cold_stats);
+        if (cold < 0) {
+            TEST_IGNORE_MESSAGE("No font available");
+        }
+        double warm = first_paint(disp, samples[i].text, &warm_stats);
+        TEST_ASSERT_EQUAL(0, warm_stats.misses);
+
+        char message[160];
+        SDL_snprintf(message, sizeof(message), "%s first paint: %.3f ms without atlas, %.3f ms with atlas "
+                                               "(%u glyphs)", samples[i].locale, cold, warm, warm_stats.glyphs);
+        TEST_MESSAGE(message);
+    }
+    cache_dir_clear();
+    lv_disp_remove(disp);
+    lv_app_disp_drv_deinit(driver);
+    SDL_DestroyWindow(window);
+}
+
+/* Atlas files are named after a hash of the font, so remove whatever is in the atlas directory */
+static void cache_dir_clear() {
+    DIR *dir = opendir(ATLAS_DIR);
+    if (dir != NULL) {
+        struct dirent *entry;
+        while ((entry = readdir(dir)) != NULL) {
+            if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0) {
+                continue;
+            }
+            char path[512];
+            SDL_snprintf(path, sizeof(path), "%s/%s", ATLAS_DIR, entry->d_name);
+            unlink(path);
+        }
+        closedir(dir);
+        rmdir(ATLAS_DIR);
+    }
+    unlink(CACHE_FILE);
+    rmdir(CACHE_DIR);
+}
+
+static bool fake_get_glyph_dsc(const lv_font_t *font, lv_font_glyph_dsc_t *dsc, uint32_t letter,
+                               uint32_t letter_next) {
+    LV_UNUSED(font);
+    LV_UNUSED(letter_next);
+    base_dsc_calls++;
+    memset(dsc, 0, sizeof(*dsc));
+    dsc->adv_w = 4 + letter % 13;
+    dsc->box_w = 1 + letter % 7;
+    dsc->box_h = 1 + letter % 5;
+    dsc->ofs_x = (int16_t) (letter % 3);
+    dsc->ofs_y = -(int16_t) (letter % 4);
+    dsc->bpp = 8;
+    return true;
+}
+
+static const uint8_t *fake_get_glyph_bitmap(const lv_font_t *font, uint32_t letter) {
+    LV_UNUSED(font);
+    // Like FreeType cache, only the last bitmap is valid
+    static uint8_t bitmap[64];
+    for (size_t i = 0; i < sizeof(bitmap); i++) {
+        bitmap[i] = (uint8_t) (letter * 31 + i);
+    }
+    return bitmap;
+}
+
+int main() {
+    SDL_SetHint(SDL_HINT_VIDEODRIVER, "dummy");
+    SDL_SetHint(SDL_HINT_RENDER_DRIVER, "software");
+    SDL_Init(SDL_INIT_VIDEO);
+    lv_init();
+    UNITY_BEGIN();
+    RUN_TEST(test_round_trip);
+    RUN_TEST(test_other_font_ignored);
+    RUN_TEST(test_snapshot);
+    RUN_TEST(test_first_paint_cjk);
+    int ret = UNITY_END();
+    SDL_Quit();
+    return ret;
+}
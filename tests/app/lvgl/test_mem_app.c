@@ -0,0 +1,158 @@
+#include "unity.h"
+#include "lvgl/lv_mem_app.h"
+#include "lvgl/lv_disp_drv_app.h"
+#include "lvgl/ext/lv_fragment_arena.h"
+
+#include <SDL.h>
+
+#define SOAK_ROUNDS 200
+#define SOAK_ROWS 100
+
+static SDL_Window *window = NULL;
+static lv_disp_drv_t *driver = NULL;
+static lv_disp_t *disp = NULL;
+
+static lv_obj_t *soak_view(lv_fragment_t *self, lv_obj_t *container);
+
+static const lv_fragment_class_t soak_fragment_class = {
+        .create_obj_cb = soak_view,
+        .instance_size = sizeof(lv_fragment_t),
+};
+
+void setUp(void) {
+    window = SDL_CreateWindow("test", 0, 0, 1280, 720, 0);
+    TEST_ASSERT_NOT_NULL(window);
+    driver = lv_app_disp_drv_create(window, 160);
+    disp = lv_disp_drv_register(driver);
+}
+
+void tearDown(void) {
+    lv_disp_remove(disp);
+    lv_app_disp_drv_deinit(driver);
+    SDL_DestroyWindow(window);
+}
+
+void test_reuse_block(void) {
+    // Keeps the slab from being freed
+    void *keep = lv_mem_app_alloc(40);
+    void *a = lv_mem_app_alloc(40);
+    lv_mem_app_free(a);
+    void *b = lv_mem_app_alloc(40);
+    TEST_ASSERT_EQUAL_PTR(a, b);
+    lv_mem_app_free(b);
+    lv_mem_app_free(keep);
+}
+
+void test_realloc(void) {
+    char *ptr = lv_mem_app_alloc(10);
+    SDL_strlcpy(ptr, "moonlight", 10);
+    // Same size class, no need to move
+    TEST_ASSERT_EQUAL_PTR(ptr, lv_mem_app_realloc(ptr, 12));
+    ptr = lv_mem_app_realloc(ptr, 300);
+    TEST_ASSERT_EQUAL_STRING("moonlight", ptr);
+    ptr = lv_mem_app_realloc(ptr, 64 * 1024);
+    TEST_ASSERT_EQUAL_STRING("moonlight", ptr);
+    ptr = lv_mem_app_realloc(ptr, 8);
+    TEST_ASSERT_EQUAL_MEMORY("moonligh", ptr, 8);
+    lv_mem_app_free(ptr);
+}
+
+void test_arena_drain(void) {
+    lv_mem_app_stats_t before, during, after;
+    lv_mem_app_get_stats(&before);
+    lv_mem_app_arena_t *arena = lv_mem_app_arena_create("test");
+    lv_mem_app_arena_push(arena);
+    void *blocks[256];
+    for (int i = 0; i < 256; i++) {
+        blocks[i] = lv_mem_app_alloc(24 + i % 100);
+    }
+    lv_mem_app_arena_pop(arena);
+    // Allocated outside of the arena, shouldn't keep it alive
+    void *outside = lv_mem_app_alloc(24);
+
+    lv_mem_app_arena_release(arena);
+    lv_mem_app_get_stats(&during);
+    TEST_ASSERT_EQUAL(before.arenas, during.arenas);
+    TEST_ASSERT_EQUAL(before.arenas_draining + 1, during.arenas_draining);
+    for (int i = 0; i < 256; i++) {
+        lv_mem_app_free(blocks[i]);
+    }
+    lv_mem_app_get_stats(&after);
+    TEST_ASSERT_EQUAL(before.arenas_draining, after.arenas_draining);
+    TEST_ASSERT_TRUE(after.slab_bytes < during.slab_bytes);
+    lv_mem_app_free(outside);
+}
+
+static void soak_round(void **retained, int round) {
+    lv_fragment_t *fragment = lv_fragment_create(&soak_fragment_class, NULL);
+    lv_obj_t *view = lv_fragment_create_obj_arena(fragment, lv_scr_act(), "soak");
+    TEST_ASSERT_NOT_NULL(view);
+    if (retained != NULL) {
+        retained[round] = lv_mem_alloc(32 + round % 64);
+    }
+    lv_refr_now(disp);
+    lv_fragment_del(fragment);
+}
+
+void test_soak_fragments(void) {
+    lv_mem_app_stats_t baseline, stats;
+    // Long living allocations made while views come and go, like cover images and app lists
+    void *retained[SOAK_ROUNDS];
+    // Let LVGL set up its draw buffers and caches first
+    soak_round(NULL, 0);
+    lv_mem_app_get_stats(&baseline);
+    Uint64 start = SDL_GetPerformanceCounter();
+    for (int round = 0; round < SOAK_ROUNDS; round++) {
+        soak_round(retained, round);
+    }
+    double elapsed_ms = (double) (SDL_GetPerformanceCounter() - start) * 1000.0 /
+                        (double) SDL_GetPerformanceFrequency();
+    lv_mem_app_get_stats(&stats);
+
+    // All views are gone, so are their arenas
+    TEST_ASSERT_EQUAL(baseline.arenas, stats.arenas);
+    TEST_ASSERT_EQUAL(baseline.arenas_draining, stats.arenas_draining);
+    // Retained blocks are packed into a few slabs, not scattered across everything the views ever used
+    TEST_ASSERT_TRUE(stats.slab_bytes <= baseline.slab_bytes + 8 * 16 * 1024);
+    TEST_ASSERT_TRUE(stats.peak_slab_bytes > stats.slab_bytes);
+
+    char message[192];
+    SDL_snprintf(message, sizeof(message), "%d rounds: %.3f ms/round, peak used %u KiB, peak slabs %u KiB, "
+                                           "now %u KiB in slabs, fragmentation %u%%", SOAK_ROUNDS,
+                 elapsed_ms / SOAK_ROUNDS, (unsigned) (stats.peak_used / 1024),
+                 (unsigned) (stats.peak_slab_bytes / 1024), (unsigned) (stats.slab_bytes / 1024),
+                 (unsigned) stats.frag_pct);
+    TEST_MESSAGE(message);
+    for (int round = 0; round < SOAK_ROUNDS; round++) {
+        lv_mem_free(retained[round]);
+    }
+}
+
+static lv_obj_t *soak_view(lv_fragment_t *self, lv_obj_t *container) {
+    LV_UNUSED(self);
+    lv_obj_t *view = lv_obj_create(container);
+    lv_obj_set_size(view, LV_PCT(100), LV_PCT(100));
+    lv_obj_set_flex_flow(view, LV_FLEX_FLOW_COLUMN);
+    for (int i = 0; i < SOAK_ROWS; i++) {
+        lv_obj_t *row = lv_btn_create(view);
+        lv_obj_set_style_pad_all(row, i % 8, 0);
+        lv_obj_t *label = lv_label_create(row);
+        lv_label_set_text_fmt(label, "Row %d of the soak test view", i);
+    }
+    return view;
+}
+
+int main() {
+    SDL_SetHint(SDL_HINT_VIDEODRIVER, "dummy");
+    SDL_SetHint(SDL_HINT_RENDER_DRIVER, "software");
+    SDL_Init(SDL_INIT_VIDEO);
+    lv_init();
+    UNITY_BEGIN();
+    RUN_TEST(test_reuse_block);
+    RUN_TEST(test_realloc);
+    RUN_TEST(test_arena_drain);
+    RUN_TEST(test_soak_fragments);
+    int ret = UNITY_END();
+    SDL_Quit();
+    return ret;
+}
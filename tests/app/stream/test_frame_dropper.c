@@ -0,0 +1,167 @@
+#include "unity.h"
+#include "stream/video/frame_dropper.h"
+
+#include <Limelight.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef FIXTURES_PATH_PREFIX
+#define FIXTURES_PATH_PREFIX "./"
+#endif
+
+#define MAX_FRAMES 64
+#define REPLAY_PASSES 4
+#define FAST_FEED_MS 1.0f
+#define SLOW_FEED_MS 30.0f
+
+typedef struct replay_t {
+    unsigned char *data;
+    size_t size;
+    size_t offsets[MAX_FRAMES + 1];
+    size_t count;
+} replay_t;
+
+static replay_t replay;
+
+static bool is_aud(int videoFormat, const unsigned char *nal) {
+    if (videoFormat & VIDEO_FORMAT_MASK_H264) {
+        return (nal[0] & 0x1f) == 9;
+    }
+    return ((nal[0] >> 1) & 0x3f) == 35;
+}
+
+/**
+ * Loads Annex B stream, and splits it into access units by access unit delimiters. Fixtures are synthetic: NAL headers
+ * follow a real IPB GOP (I, then alternating reference and non-reference frames), but payloads are 0xAA filler, so
+ * only headers can be checked with them.
+ */
+static void replay_load(const char *path, int videoFormat) {
+    FILE *fp = fopen(path, "rb");
+    TEST_ASSERT_NOT_NULL_MESSAGE(fp, path);
+    fseek(fp, 0, SEEK_END);
+    replay.size = ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+    replay.data = malloc(replay.size);
+    TEST_ASSERT_EQUAL(replay.size, fread(replay.data, 1, replay.size, fp));
+    fclose(fp);
+    replay.count = 0;
+    for (size_t i = 0; i + 4 < replay.size; i++) {
+        if (memcmp(&replay.data[i], "\0\0\0\1", 4) == 0 && is_aud(videoFormat, &replay.data[i + 4])) {
+            TEST_ASSERT_TRUE(replay.count < MAX_FRAMES);
+            replay.offsets[replay.count++] = i;
+        }
+    }
+    replay.offsets[replay.count] = replay.size;
+}
+
+static frame_class_t replay_classify(int videoFormat, size_t index) {
+    size_t offset = replay.offsets[index];
+    return frame_classify(videoFormat, &replay.data[offset], replay.offsets[index + 1] - offset);
+}
+
+void setUp(void) {
+    memset(&replay, 0, sizeof(replay));
+}
+
+void tearDown(void) {
+    free(replay.data);
+}
+
+static void assert_gop_pattern(int videoFormat) {
+    TEST_ASSERT_EQUAL(32, replay.count);
+    for (size_t i = 0; i < replay.count; i++) {
+        frame_class_t expected;
+        if (i % 8 == 0) {
+            expected = FRAME_CLASS_KEY;
+        } else if (i % 2 == 1) {
+            expected = FRAME_CLASS_REFERENCE;
+        } else {
+            expected = FRAME_CLASS_DISPOSABLE;
+        }
+        TEST_ASSERT_EQUAL(expected, replay_classify(videoFormat, i));
+    }
+}
+
+static void assert_drop_under_backpressure(int videoFormat) {
+    frame_dropper_t dropper;
+    frame_dropper_init(&dropper, 60);
+    uint32_t disposable = 0, dropped_in_last_pass = 0;
+    for (int pass = 0; pass < REPLAY_PASSES; pass++) {
+        // Decoder is slow in the middle passes
+        float feed_ms = pass == 1 || pass == 2 ? SLOW_FEED_MS : FAST_FEED_MS;
+        for (size_t i = 0; i < replay.count; i++) {
+            frame_class_t frame_class = replay_classify(videoFormat, i);
+            if (frame_class == FRAME_CLASS_DISPOSABLE) {
+                disposable++;
+            }
+            if (frame_dropper_should_drop(&dropper, frame_class)) {
+                TEST_ASSERT_EQUAL(FRAME_CLASS_DISPOSABLE, frame_class);
+                if (pass == REPLAY_PASSES - 1 && i >= replay.count / 2) {
+                    dropped_in_last_pass++;
+                }
+                continue;
+            }
+            frame_dropper_feed_done(&dropper, feed_ms);
+        }
+    }
+    TEST_ASSERT_TRUE(dropper.stats.dropped > 0);
+    TEST_ASSERT_TRUE(dropper.stats.dropped < disposable);
+    TEST_ASSERT_TRUE(dropper.stats.congested > 0);
+    // Recovered after decoder caught up
+    TEST_ASSERT_EQUAL(0, dropped_in_last_pass);
+    TEST_ASSERT_FALSE(dropper.congested);
+
+    char message[128];
+    snprintf(message, sizeof(message), "Dropped %u of %u disposable frames, %u submitted while congested",
+             dropper.stats.dropped, disposable, dropper.stats.congested);
+    TEST_MESSAGE(message);
+}
+
+void test_classify_h264(void) {
+    replay_load(FIXTURES_PATH_PREFIX "synthetic_h264_ipb.h264", VIDEO_FORMAT_H264);
+    assert_gop_pattern(VIDEO_FORMAT_H264);
+}
+
+void test_classify_hevc(void) {
+    replay_load(FIXTURES_PATH_PREFIX "synthetic_hevc_trail_n.h265", VIDEO_FORMAT_H265);
+    assert_gop_pattern(VIDEO_FORMAT_H265);
+}
+
+void test_classify_unsupported(void) {
+    static const unsigned char obu[] = {0x12, 0x00, 0x32, 0x10, 0xAA, 0xAA};
+    TEST_ASSERT_EQUAL(FRAME_CLASS_UNKNOWN, frame_classify(VIDEO_FORMAT_AV1_MAIN8, obu, sizeof(obu)));
+    static const unsigned char truncated[] = {0x00, 0x00, 0x00, 0x01};
+    TEST_ASSERT_EQUAL(FRAME_CLASS_UNKNOWN, frame_classify(VIDEO_FORMAT_H264, truncated, sizeof(truncated)));
+}
+
+void test_no_drop_without_backpressure(void) {
+    frame_dropper_t dropper;
+    frame_dropper_init(&dropper, 60);
+    for (int i = 0; i < 100; i++) {
+        TEST_ASSERT_FALSE(frame_dropper_should_drop(&dropper, FRAME_CLASS_DISPOSABLE));
+        frame_dropper_feed_done(&dropper, FAST_FEED_MS);
+    }
+    TEST_ASSERT_EQUAL(0, dropper.stats.dropped);
+}
+
+void test_replay_h264_backpressure(void) {
+    replay_load(FIXTURES_PATH_PREFIX "synthetic_h264_ipb.h264", VIDEO_FORMAT_H264);
+    assert_drop_under_backpressure(VIDEO_FORMAT_H264);
+}
+
+void test_replay_hevc_backpressure(void) {
+    replay_load(FIXTURES_PATH_PREFIX "synthetic_hevc_trail_n.h265", VIDEO_FORMAT_H265);
+    assert_drop_under_backpressure(VIDEO_FORMAT_H265);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_classify_h264);
+    RUN_TEST(test_classify_hevc);
+    RUN_TEST(test_classify_unsupported);
+    RUN_TEST(test_no_drop_without_backpressure);
+    RUN_TEST(test_replay_h264_backpressure);
+    RUN_TEST(test_replay_hevc_backpressure);
+    return UNITY_END();
+}
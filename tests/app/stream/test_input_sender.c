@@ -0,0 +1,101 @@
+#include "unity.h"
+#include "stream/input/input_sender.h"
+
+#include <SDL2/SDL.h>
+
+#define FRAMES 10
+#define EVENTS_PER_FRAME 8
+/* A slow UI frame, e.g. overlay animation */
+#define UI_FRAME_MS 40
+/* Time LiSend* and handler take for each event */
+#define SEND_COST_MS 1
+
+typedef struct dispatch_state_t {
+    Sint32 last_seq;
+    bool out_of_order;
+    SDL_threadID thread_id;
+} dispatch_state_t;
+
+static input_sender_t sender;
+static dispatch_state_t state;
+
+static void dispatch(const SDL_Event *event, void *userdata) {
+    dispatch_state_t *s = userdata;
+    if (event->user.code != s->last_seq + 1) {
+        s->out_of_order = true;
+    }
+    s->last_seq = event->user.code;
+    s->thread_id = SDL_ThreadID();
+    SDL_Delay(SEND_COST_MS);
+}
+
+static void post_event(Sint32 seq) {
+    SDL_Event event = {.user = {.type = SDL_USEREVENT, .timestamp = SDL_GetTicks(), .code = seq}};
+    input_sender_post(&sender, &event);
+}
+
+void setUp(void) {
+    SDL_memset(&state, 0, sizeof(state));
+    state.last_seq = -1;
+}
+
+void tearDown(void) {
+}
+
+void test_dispatch_in_order_off_main_thread(void) {
+    TEST_ASSERT_EQUAL(0, input_sender_init(&sender, 4, dispatch, &state));
+    // More than capacity, so posting has to wait for the sender
+    for (int i = 0; i < 32; i++) {
+        post_event(i);
+    }
+    input_sender_flush(&sender);
+    TEST_ASSERT_EQUAL(31, state.last_seq);
+    TEST_ASSERT_FALSE(state.out_of_order);
+    TEST_ASSERT_TRUE(state.thread_id != SDL_ThreadID());
+    const input_sender_stats_t *stats = input_sender_get_stats(&sender);
+    TEST_ASSERT_EQUAL(32, stats->dispatched);
+    TEST_ASSERT_TRUE(stats->full > 0);
+    input_sender_deinit(&sender);
+}
+
+void test_latency_with_loaded_ui(void) {
+    TEST_ASSERT_EQUAL(0, input_sender_init(&sender, 256, dispatch, &state));
+    Sint32 seq = 0;
+    for (int frame = 0; frame < FRAMES; frame++) {
+        for (int i = 0; i < EVENTS_PER_FRAME; i++) {
+            post_event(seq++);
+        }
+        // Render a slow frame, events are sent meanwhile
+        SDL_Delay(UI_FRAME_MS);
+    }
+    input_sender_deinit(&sender);
+    const input_sender_stats_t *stats = input_sender_get_stats(&sender);
+    TEST_ASSERT_EQUAL(FRAMES * EVENTS_PER_FRAME, stats->dispatched);
+    TEST_ASSERT_FALSE(state.out_of_order);
+    TEST_ASSERT_TRUE(stats->latency_max_ms < UI_FRAME_MS);
+
+    char message[128];
+    SDL_snprintf(message, sizeof(message), "Input to send latency: avg %.2f ms, max %u ms (UI frame %d ms)",
+                 (double) stats->latency_total_ms / stats->latency_samples, stats->latency_max_ms, UI_FRAME_MS);
+    TEST_MESSAGE(message);
+}
+
+void test_dispatch_inline_without_thread(void) {
+    SDL_memset(&sender, 0, sizeof(sender));
+    sender.dispatch = dispatch;
+    sender.userdata = &state;
+    post_event(0);
+    TEST_ASSERT_EQUAL(0, state.last_seq);
+    TEST_ASSERT_TRUE(state.thread_id == SDL_ThreadID());
+}
+
+int main() {
+    SDL_Init(SDL_INIT_TIMER);
+    UNITY_BEGIN();
+    RUN_TEST(test_dispatch_in_order_off_main_thread);
+    RUN_TEST(test_latency_with_loaded_ui);
+    RUN_TEST(test_dispatch_inline_without_thread);
+    int ret = UNITY_END();
+    SDL_Quit();
+    return ret;
+}
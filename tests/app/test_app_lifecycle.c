@@ -1,6 +1,6 @@
 #include "unity.h"
 #include "app.h"
-#include "uuidstr.h"
+#include "app_test_fixture.h"
 #include "app_launch.h"
 
 static int argc = 1;
@@ -17,17 +17,8 @@ Uint32 quitTimer(Uint32 interval, void *context) {
     return 0;
 }
 
-int initSettings(app_settings_t *settings) {
-    char *path = malloc(128);
-    uuidstr_t uuid;
-    uuidstr_random(&uuid);
-    snprintf(path, 128, "/tmp/moonlight-test-%s", (char *) &uuid);
-    settings_initialize(settings, path);
-    return 0;
-}
-
 void setUp(void) {
-    app_init(&app, initSettings, argc, argv);
+    app_init(&app, app_test_init_settings, argc, argv);
 }
 
 void tearDown(void) {
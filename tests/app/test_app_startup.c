@@ -0,0 +1,56 @@
+#include "unity.h"
+#include "app.h"
+#include "app_test_fixture.h"
+#include "util/startup_trace.h"
+
+#define FIRST_FRAME_TIMEOUT_MS 10000
+
+static int argc = 1;
+static char *argv[] = {"moonlight"};
+app_t app;
+
+void setUp(void) {
+}
+
+void tearDown(void) {
+}
+
+void test_startup_to_first_frame() {
+    Uint64 start = SDL_GetPerformanceCounter();
+    TEST_ASSERT_EQUAL(0, app_init(&app, app_test_init_settings, argc, argv));
+    Uint64 init_done = SDL_GetPerformanceCounter();
+    app_ui_open(&app.ui, NULL);
+    Uint32 deadline = SDL_GetTicks() + FIRST_FRAME_TIMEOUT_MS;
+    while (startup_trace_find("first_frame") == NULL && !SDL_TICKS_PASSED(SDL_GetTicks(), deadline)) {
+        app_run_loop(&app);
+    }
+    Uint64 first_frame = SDL_GetPerformanceCounter();
+    TEST_ASSERT_NOT_NULL(startup_trace_find("first_frame"));
+
+    const char *phases[] = {"settings", "client_conf", "os_info", "ss4s_modules", "ss4s", "locale", "known_hosts", "fontconfig",
+                            "gamepad_mapping", "video", "input", "ui", "post_init"};
+    Uint64 phases_total = 0;
+    for (size_t i = 0; i < sizeof(phases) / sizeof(phases[0]); i++) {
+        const startup_trace_entry_t *entry = startup_trace_find(phases[i]);
+        TEST_ASSERT_NOT_NULL_MESSAGE(entry, phases[i]);
+        TEST_ASSERT_TRUE(entry->end >= entry->begin);
+        phases_total += entry->end - entry->begin;
+    }
+
+    char message[256];
+    SDL_snprintf(message, sizeof(message), "app_init: %.2f ms (phases sum %.2f ms), first frame: %.2f ms",
+                 startup_trace_to_ms(init_done - start), startup_trace_to_ms(phases_total),
+                 startup_trace_to_ms(first_frame - start));
+    TEST_MESSAGE(message);
+
+    app.running = false;
+    app_deinit(&app);
+}
+
+int main() {
+    SDL_SetHint(SDL_HINT_VIDEODRIVER, "dummy");
+    SDL_SetHint(SDL_HINT_RENDER_DRIVER, "software");
+    UNITY_BEGIN();
+    RUN_TEST(test_startup_to_first_frame);
+    return UNITY_END();
+}
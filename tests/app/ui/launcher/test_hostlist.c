@@ -0,0 +1,84 @@
+#include "unity.h"
+#include "ui/launcher/hostlist.h"
+
+#define NUM_HOSTS 500
+
+static hostlist_t list;
+static uuidstr_t uuids[NUM_HOSTS];
+
+void setUp(void) {
+    hostlist_init(&list);
+    for (int i = 0; i < NUM_HOSTS; i++) {
+        uuidstr_random(&uuids[i]);
+    }
+}
+
+void tearDown(void) {
+    hostlist_deinit(&list);
+}
+
+static void assert_indices() {
+    for (int i = 0; i < list.count; i++) {
+        TEST_ASSERT_EQUAL(i, hostlist_index_of(&list, hostlist_get(&list, i)));
+    }
+}
+
+void test_append_lookup(void) {
+    for (int i = 0; i < NUM_HOSTS; i++) {
+        TEST_ASSERT_EQUAL(i, hostlist_append(&list, &uuids[i]));
+    }
+    // Appending again returns existing row
+    TEST_ASSERT_EQUAL(42, hostlist_append(&list, &uuids[42]));
+    TEST_ASSERT_EQUAL(NUM_HOSTS, list.count);
+    assert_indices();
+
+    uuidstr_t unknown;
+    uuidstr_random(&unknown);
+    TEST_ASSERT_EQUAL(-1, hostlist_index_of(&list, &unknown));
+    TEST_ASSERT_NULL(hostlist_get(&list, NUM_HOSTS));
+}
+
+void test_remove(void) {
+    for (int i = 0; i < NUM_HOSTS; i++) {
+        hostlist_append(&list, &uuids[i]);
+    }
+    TEST_ASSERT_EQUAL(0, hostlist_remove(&list, &uuids[0]));
+    TEST_ASSERT_EQUAL(99, hostlist_remove(&list, &uuids[100]));
+    TEST_ASSERT_EQUAL(-1, hostlist_remove(&list, &uuids[100]));
+    TEST_ASSERT_EQUAL(NUM_HOSTS - 2, list.count);
+    TEST_ASSERT_EQUAL(-1, hostlist_index_of(&list, &uuids[0]));
+    TEST_ASSERT_EQUAL(0, hostlist_index_of(&list, &uuids[1]));
+    TEST_ASSERT_EQUAL(99, hostlist_index_of(&list, &uuids[101]));
+    assert_indices();
+}
+
+void test_clear(void) {
+    for (int i = 0; i < 10; i++) {
+        hostlist_append(&list, &uuids[i]);
+    }
+    hostlist_clear(&list);
+    TEST_ASSERT_EQUAL(0, list.count);
+    TEST_ASSERT_EQUAL(-1, hostlist_index_of(&list, &uuids[0]));
+    TEST_ASSERT_EQUAL(0, hostlist_append(&list, &uuids[5]));
+    assert_indices();
+}
+
+void test_size_over_255(void) {
+    TEST_ASSERT_EQUAL(0, hostlist_size(NULL));
+    for (int i = 0; i < NUM_HOSTS; i++) {
+        hostlist_append(&list, &uuids[i]);
+    }
+    // Every host gets a row, not only the first 255
+    TEST_ASSERT_EQUAL(NUM_HOSTS, hostlist_size(&list));
+    TEST_ASSERT_EQUAL(NUM_HOSTS - 1, hostlist_index_of(&list, &uuids[NUM_HOSTS - 1]));
+    TEST_ASSERT_EQUAL_MEMORY(&uuids[300], hostlist_get(&list, 300), sizeof(uuidstr_t));
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_append_lookup);
+    RUN_TEST(test_remove);
+    RUN_TEST(test_clear);
+    RUN_TEST(test_size_over_255);
+    return UNITY_END();
+}
@@ -0,0 +1,150 @@
+#include "unity.h"
+#include "util/async_log.h"
+
+#include <SDL2/SDL.h>
+
+#define CAPACITY 16
+#define PRODUCERS 4
+#define MESSAGES_PER_PRODUCER 1000
+
+typedef struct sink_state_t {
+    size_t count;
+    size_t dropped_notices;
+    int last_seq[PRODUCERS];
+    bool out_of_order;
+    char last_message[ASYNC_LOG_MESSAGE_MAX];
+} sink_state_t;
+
+static sink_state_t state;
+static async_log_t *logger = NULL;
+
+static void test_sink(int level, const char *tag, const char *message, void *userdata) {
+    sink_state_t *s = userdata;
+    if (SDL_strcmp(tag, "Logging") == 0) {
+        s->dropped_notices++;
+        return;
+    }
+    s->count++;
+    SDL_strlcpy(s->last_message, message, sizeof(s->last_message));
+    int producer, seq;
+    if (SDL_sscanf(message, "%d:%d", &producer, &seq) == 2 && producer >= 0 && producer < PRODUCERS) {
+        if (seq <= s->last_seq[producer]) {
+            s->out_of_order = true;
+        }
+        s->last_seq[producer] = seq;
+    }
+}
+
+static int producer_worker(void *arg) {
+    int producer = (int) (intptr_t) arg;
+    for (int i = 0; i < MESSAGES_PER_PRODUCER; i++) {
+        async_log_printf(logger, COMMONS_LOG_LEVEL_INFO, "Test", "%d:%d", producer, i);
+    }
+    return 0;
+}
+
+void setUp(void) {
+    SDL_memset(&state, 0, sizeof(state));
+    for (int i = 0; i < PRODUCERS; i++) {
+        state.last_seq[i] = -1;
+    }
+    logger = async_log_create(CAPACITY, test_sink, &state);
+    TEST_ASSERT_NOT_NULL(logger);
+}
+
+void tearDown(void) {
+    if (logger != NULL) {
+        async_log_destroy(logger);
+        logger = NULL;
+    }
+}
+
+void test_drain_in_order(void) {
+    for (int i = 0; i < 10; i++) {
+        TEST_ASSERT_TRUE(async_log_printf(logger, COMMONS_LOG_LEVEL_INFO, "Test", "0:%d", i));
+    }
+    TEST_ASSERT_EQUAL(10, async_log_drain(logger));
+    TEST_ASSERT_EQUAL(10, state.count);
+    TEST_ASSERT_FALSE(state.out_of_order);
+    TEST_ASSERT_EQUAL_STRING("0:9", state.last_message);
+    TEST_ASSERT_EQUAL(0, async_log_drain(logger));
+}
+
+void test_drop_when_full(void) {
+    for (int i = 0; i < CAPACITY; i++) {
+        TEST_ASSERT_TRUE(async_log_printf(logger, COMMONS_LOG_LEVEL_INFO, "Test", "0:%d", i));
+    }
+    TEST_ASSERT_FALSE(async_log_printf(logger, COMMONS_LOG_LEVEL_INFO, "Test", "0:%d", CAPACITY));
+    async_log_stats_t stats;
+    async_log_get_stats(logger, &stats);
+    TEST_ASSERT_EQUAL(1, stats.dropped);
+
+    TEST_ASSERT_EQUAL(CAPACITY, async_log_drain(logger));
+    TEST_ASSERT_EQUAL(1, state.dropped_notices);
+    // Slots are usable again after draining
+    TEST_ASSERT_TRUE(async_log_printf(logger, COMMONS_LOG_LEVEL_INFO, "Test", "0:%d", CAPACITY + 1));
+    TEST_ASSERT_EQUAL(1, async_log_drain(logger));
+    TEST_ASSERT_EQUAL(1, state.dropped_notices);
+}
+
+void test_truncate_long_message(void) {
+    char long_message[ASYNC_LOG_MESSAGE_MAX * 2];
+    SDL_memset(long_message, 'a', sizeof(long_message) - 1);
+    long_message[sizeof(long_message) - 1] = '\0';
+    async_log_printf(logger, COMMONS_LOG_LEVEL_INFO, "Test", "%s", long_message);
+    async_log_drain(logger);
+    TEST_ASSERT_EQUAL(ASYNC_LOG_MESSAGE_MAX - 1, SDL_strlen(state.last_message));
+}
+
+void test_filter_level(void) {
+    async_log_set_level(logger, COMMONS_LOG_LEVEL_WARN);
+    TEST_ASSERT_FALSE(async_log_is_loggable(logger, COMMONS_LOG_LEVEL_VERBOSE));
+    TEST_ASSERT_TRUE(async_log_is_loggable(logger, COMMONS_LOG_LEVEL_ERROR));
+    // Filtered messages don't take slots, so they can't push out important ones
+    for (int i = 0; i < CAPACITY * 2; i++) {
+        TEST_ASSERT_TRUE(async_log_printf(logger, COMMONS_LOG_LEVEL_VERBOSE, "Test", "0:%d", i));
+    }
+    TEST_ASSERT_TRUE(async_log_printf(logger, COMMONS_LOG_LEVEL_WARN, "Test", "0:%d", CAPACITY * 2));
+    TEST_ASSERT_EQUAL(1, async_log_drain(logger));
+    async_log_stats_t stats;
+    async_log_get_stats(logger, &stats);
+    TEST_ASSERT_EQUAL(0, stats.dropped);
+    TEST_ASSERT_EQUAL(1, stats.written);
+}
+
+void test_concurrent_producers(void) {
+    TEST_ASSERT_TRUE(async_log_start(logger));
+    SDL_Thread *threads[PRODUCERS];
+    for (int i = 0; i < PRODUCERS; i++) {
+        threads[i] = SDL_CreateThread(producer_worker, "producer", (void *) (intptr_t) i);
+    }
+    for (int i = 0; i < PRODUCERS; i++) {
+        SDL_WaitThread(threads[i], NULL);
+    }
+    // Writer thread is still running, draining here makes sure nothing is left in the queue
+    async_log_drain(logger);
+    async_log_stats_t stats;
+    async_log_get_stats(logger, &stats);
+
+    // Every message is either written or counted as dropped, and each producer's messages stay in order
+    TEST_ASSERT_FALSE(state.out_of_order);
+    TEST_ASSERT_TRUE(state.count > 0);
+    TEST_ASSERT_EQUAL(state.count, stats.written);
+    TEST_ASSERT_EQUAL(PRODUCERS * MESSAGES_PER_PRODUCER, stats.written + stats.dropped);
+    if (stats.dropped > 0) {
+        TEST_ASSERT_TRUE(state.dropped_notices > 0);
+    }
+}
+
+int main() {
+    SDL_Init(0);
+    UNITY_BEGIN();
+    RUN_TEST(test_drain_in_order);
+    RUN_TEST(test_drop_when_full);
+    RUN_TEST(test_truncate_long_message);
+    RUN_TEST(test_filter_level);
+    RUN_TEST(test_concurrent_producers);
+    int ret = UNITY_END();
+    SDL_Quit();
+    return ret;
+}
@@ -0,0 +1,89 @@
+#include "unity.h"
+#include "util/font_cache.h"
+
+#include <SDL_stdinc.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <utime.h>
+
+#define CACHE_PATH "/tmp/moonlight-test-font_cache.ini"
+#define FONT_PATH "/tmp/moonlight-test-font.ttf"
+#define FALLBACK_PATH "/tmp/moonlight-test-font-cjk.ttf"
+
+static void touch(const char *path, time_t mtime) {
+    FILE *fp = fopen(path, "w");
+    TEST_ASSERT_NOT_NULL(fp);
+    fclose(fp);
+    struct utimbuf times = {.actime = mtime, .modtime = mtime};
+    utime(path, &times);
+}
+
+void setUp(void) {
+    unlink(CACHE_PATH);
+    touch(FONT_PATH, 1000000);
+    touch(FALLBACK_PATH, 1000000);
+}
+
+void tearDown(void) {
+    unlink(CACHE_PATH);
+    unlink(FONT_PATH);
+    unlink(FALLBACK_PATH);
+}
+
+void test_round_trip(void) {
+    font_cache_entry_t entry = {.primary = FONT_PATH, .fallback = FALLBACK_PATH};
+    TEST_ASSERT_TRUE(font_cache_store(CACHE_PATH, "ja@160", &entry));
+    font_cache_entry_t en_entry = {.primary = FONT_PATH, .fallback = NULL};
+    TEST_ASSERT_TRUE(font_cache_store(CACHE_PATH, "en@160", &en_entry));
+
+    font_cache_entry_t loaded;
+    TEST_ASSERT_TRUE(font_cache_lookup(CACHE_PATH, "ja@160", &loaded));
+    TEST_ASSERT_EQUAL_STRING(FONT_PATH, loaded.primary);
+    TEST_ASSERT_EQUAL_STRING(FALLBACK_PATH, loaded.fallback);
+    font_cache_entry_clear(&loaded);
+
+    TEST_ASSERT_TRUE(font_cache_lookup(CACHE_PATH, "en@160", &loaded));
+    TEST_ASSERT_NULL(loaded.fallback);
+    font_cache_entry_clear(&loaded);
+
+    // Resolved for another DPI
+    TEST_ASSERT_FALSE(font_cache_lookup(CACHE_PATH, "ja@320", &loaded));
+}
+
+void test_font_changed(void) {
+    font_cache_entry_t entry = {.primary = FONT_PATH, .fallback = FALLBACK_PATH};
+    TEST_ASSERT_TRUE(font_cache_store(CACHE_PATH, "zh-CN@160", &entry));
+    // Font package upgraded
+    touch(FALLBACK_PATH, 2000000);
+    font_cache_entry_t loaded;
+    TEST_ASSERT_FALSE(font_cache_lookup(CACHE_PATH, "zh-CN@160", &loaded));
+
+    TEST_ASSERT_TRUE(font_cache_store(CACHE_PATH, "zh-CN@160", &entry));
+    unlink(FONT_PATH);
+    TEST_ASSERT_FALSE(font_cache_lookup(CACHE_PATH, "zh-CN@160", &loaded));
+}
+
+void test_oldest_dropped(void) {
+    font_cache_entry_t entry = {.primary = FONT_PATH, .fallback = NULL};
+    char key[16];
+    for (int i = 0; i < FONT_CACHE_MAX_ENTRIES + 2; i++) {
+        SDL_snprintf(key, sizeof(key), "l%d@160", i);
+        TEST_ASSERT_TRUE(font_cache_store(CACHE_PATH, key, &entry));
+    }
+    font_cache_entry_t loaded;
+    TEST_ASSERT_FALSE(font_cache_lookup(CACHE_PATH, "l0@160", &loaded));
+    TEST_ASSERT_FALSE(font_cache_lookup(CACHE_PATH, "l1@160", &loaded));
+    for (int i = 2; i < FONT_CACHE_MAX_ENTRIES + 2; i++) {
+        SDL_snprintf(key, sizeof(key), "l%d@160", i);
+        TEST_ASSERT_TRUE(font_cache_lookup(CACHE_PATH, key, &loaded));
+        font_cache_entry_clear(&loaded);
+    }
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_round_trip);
+    RUN_TEST(test_font_changed);
+    RUN_TEST(test_oldest_dropped);
+    return UNITY_END();
+}
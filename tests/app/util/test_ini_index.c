@@ -0,0 +1,123 @@
+#include "unity.h"
+#include "util/ini_index.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#define INI_PATH "/tmp/moonlight-test-index.ini"
+
+typedef struct {
+    char lines[16][64];
+    int count;
+} parse_log_t;
+
+static void write_ini(const char *content);
+
+static int log_handler(parse_log_t *log, const char *section, const char *name, const char *value);
+
+void setUp(void) {
+}
+
+void tearDown(void) {
+    remove(INI_PATH);
+}
+
+void test_sections(void) {
+    write_ini("; comment\n"
+              "top = level\n"
+              "[first]\n"
+              "name = value with spaces  \n"
+              "address=192.168.1.100:47989\n"
+              "\n"
+              "  [second]  \n"
+              "# another comment\n"
+              "key: colon\n"
+              "inline = value ; comment\n"
+              "[first]\n"
+              "name = overridden\n");
+    ini_index_t *index = ini_index_open(INI_PATH);
+    TEST_ASSERT_NOT_NULL(index);
+    TEST_ASSERT_EQUAL(0, ini_index_error(index));
+    TEST_ASSERT_EQUAL(3, ini_index_sections_count(index));
+    TEST_ASSERT_EQUAL_STRING("", ini_index_section_name(index, 0));
+    TEST_ASSERT_EQUAL_STRING("first", ini_index_section_name(index, 1));
+    TEST_ASSERT_EQUAL_STRING("second", ini_index_section_name(index, 2));
+    TEST_ASSERT_EQUAL(2, ini_index_find_section(index, "second"));
+    TEST_ASSERT_EQUAL(-1, ini_index_find_section(index, "third"));
+
+    TEST_ASSERT_EQUAL_STRING("level", ini_index_get(index, "", "top"));
+    TEST_ASSERT_EQUAL_STRING("overridden", ini_index_get(index, "first", "name"));
+    TEST_ASSERT_EQUAL_STRING("192.168.1.100:47989", ini_index_get(index, "first", "address"));
+    TEST_ASSERT_EQUAL_STRING("colon", ini_index_get(index, "second", "key"));
+    TEST_ASSERT_EQUAL_STRING("value", ini_index_get(index, "second", "inline"));
+    TEST_ASSERT_NULL(ini_index_get(index, "second", "name"));
+
+    // Repeated section is merged, entries stay in file order
+    const ini_index_entry_t *entry = ini_index_section_first(index, 1);
+    TEST_ASSERT_EQUAL_STRING("value with spaces", entry->value);
+    entry = ini_index_entry_next(index, entry);
+    TEST_ASSERT_EQUAL_STRING("address", entry->name);
+    entry = ini_index_entry_next(index, entry);
+    TEST_ASSERT_EQUAL_STRING("overridden", entry->value);
+    TEST_ASSERT_NULL(ini_index_entry_next(index, entry));
+    ini_index_close(index);
+}
+
+void test_no_trailing_newline(void) {
+    write_ini("\xEF\xBB\xBF[host]\r\nmac = aa:bb\r\nhostname = pc");
+    ini_index_t *index = ini_index_open(INI_PATH);
+    TEST_ASSERT_NOT_NULL(index);
+    TEST_ASSERT_EQUAL_STRING("aa:bb", ini_index_get(index, "host", "mac"));
+    TEST_ASSERT_EQUAL_STRING("pc", ini_index_get(index, "host", "hostname"));
+    ini_index_close(index);
+}
+
+void test_many_sections(void) {
+    FILE *fp = fopen(INI_PATH, "wb");
+    for (int i = 0; i < 1000; i++) {
+        fprintf(fp, "[section-%d]\nvalue = %d\n", i, i);
+    }
+    fclose(fp);
+    ini_index_t *index = ini_index_open(INI_PATH);
+    TEST_ASSERT_EQUAL(1000, ini_index_sections_count(index));
+    for (int i = 0; i < 1000; i++) {
+        char section[32], value[16];
+        snprintf(section, sizeof(section), "section-%d", i);
+        snprintf(value, sizeof(value), "%d", i);
+        TEST_ASSERT_EQUAL(i, ini_index_find_section(index, section));
+        TEST_ASSERT_EQUAL_STRING(value, ini_index_get(index, section, "value"));
+    }
+    ini_index_close(index);
+}
+
+void test_parse(void) {
+    write_ini("[a]\nx = 1\n[b]\ny = 2\nbroken line\n[a]\nz = 3\n");
+    parse_log_t log = {.count = 0};
+    TEST_ASSERT_EQUAL(5, ini_index_parse(INI_PATH, (ini_index_handler) log_handler, &log));
+    TEST_ASSERT_EQUAL(3, log.count);
+    TEST_ASSERT_EQUAL_STRING("a.x=1", log.lines[0]);
+    TEST_ASSERT_EQUAL_STRING("b.y=2", log.lines[1]);
+    TEST_ASSERT_EQUAL_STRING("a.z=3", log.lines[2]);
+    TEST_ASSERT_EQUAL(-1, ini_index_parse("/tmp/moonlight-test-missing.ini", (ini_index_handler) log_handler, &log));
+}
+
+static void write_ini(const char *content) {
+    FILE *fp = fopen(INI_PATH, "wb");
+    TEST_ASSERT_NOT_NULL(fp);
+    fputs(content, fp);
+    fclose(fp);
+}
+
+static int log_handler(parse_log_t *log, const char *section, const char *name, const char *value) {
+    snprintf(log->lines[log->count++], sizeof(log->lines[0]), "%s.%s=%s", section, name, value);
+    return 1;
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_sections);
+    RUN_TEST(test_no_trailing_newline);
+    RUN_TEST(test_many_sections);
+    RUN_TEST(test_parse);
+    return UNITY_END();
+}
@@ -0,0 +1,230 @@
+#include "unity.h"
+#include "util/metrics.h"
+#include "util/metrics_executor.h"
+
+#include <SDL.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef __WIN32
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+#define DUMP_PATH "/tmp/moonlight-test-metrics.json"
+#define SOCKET_PATH "/tmp/moonlight-test-metrics.sock"
+
+#define THREADS 16
+#define ITERATIONS 100000
+
+METRICS_COUNTER(counter, "test.counter");
+METRICS_COUNTER(counter_alias, "test.counter");
+METRICS_GAUGE(gauge, "test.gauge");
+METRICS_HISTOGRAM(histogram, "test.histogram");
+METRICS_GAUGE(wrong_type, "test.counter");
+
+static int count_worker(void *unused);
+
+static int executor_task_run(void *arg);
+
+static void executor_task_finalize(void *arg, int result);
+
+static char *read_file(const char *path);
+
+void setUp(void) {
+    metrics_reset();
+}
+
+void tearDown(void) {
+    remove(DUMP_PATH);
+}
+
+void test_counter_threads(void) {
+    SDL_Thread *threads[THREADS];
+    for (int i = 0; i < THREADS; i++) {
+        threads[i] = SDL_CreateThread(count_worker, "counter", NULL);
+        TEST_ASSERT_NOT_NULL(threads[i]);
+    }
+    for (int i = 0; i < THREADS; i++) {
+        SDL_WaitThread(threads[i], NULL);
+    }
+    metrics_value_t value;
+    TEST_ASSERT_TRUE(metrics_get("test.counter", &value));
+    TEST_ASSERT_EQUAL(METRIC_COUNTER, value.type);
+    TEST_ASSERT_EQUAL_INT64((int64_t) THREADS * ITERATIONS, value.value);
+}
+
+void test_same_name(void) {
+    metrics_count(&counter, 2);
+    metrics_count(&counter_alias, 3);
+    metrics_value_t value;
+    TEST_ASSERT_TRUE(metrics_get("test.counter", &value));
+    TEST_ASSERT_EQUAL_INT64(5, value.value);
+
+    // Can't share a name with a different type
+    metrics_gauge_set(&wrong_type, 100);
+    TEST_ASSERT_TRUE(metrics_get("test.counter", &value));
+    TEST_ASSERT_EQUAL_INT64(5, value.value);
+    TEST_ASSERT_FALSE(metrics_get("test.missing", &value));
+}
+
+void test_gauge(void) {
+    metrics_gauge_set(&gauge, 10);
+    metrics_gauge_add(&gauge, -15);
+    metrics_value_t value;
+    TEST_ASSERT_TRUE(metrics_get("test.gauge", &value));
+    TEST_ASSERT_EQUAL(METRIC_GAUGE, value.type);
+    TEST_ASSERT_EQUAL_INT64(-5, value.value);
+}
+
+void test_reset_keeps_gauge(void) {
+    metrics_count(&counter, 3);
+    metrics_gauge_set(&gauge, 2);
+    metrics_reset();
+    metrics_gauge_add(&gauge, -1);
+    metrics_value_t value;
+    TEST_ASSERT_TRUE(metrics_get("test.counter", &value));
+    TEST_ASSERT_EQUAL_INT64(0, value.value);
+    TEST_ASSERT_TRUE(metrics_get("test.gauge", &value));
+    TEST_ASSERT_EQUAL_INT64(1, value.value);
+}
+
+void test_histogram(void) {
+    metrics_observe(&histogram, 0);
+    metrics_observe(&histogram, 1);
+    metrics_observe(&histogram, 2);
+    metrics_observe(&histogram, 3);
+    metrics_observe(&histogram, 1000);
+    metrics_observe(&histogram, UINT64_C(1) << 40);
+    metrics_value_t value;
+    TEST_ASSERT_TRUE(metrics_get("test.histogram", &value));
+    TEST_ASSERT_EQUAL(METRIC_HISTOGRAM, value.type);
+    TEST_ASSERT_EQUAL_UINT64(6, value.count);
+    TEST_ASSERT_EQUAL_UINT64(1006 + (UINT64_C(1) << 40), value.sum);
+    TEST_ASSERT_EQUAL_UINT64(1, value.buckets[0]);
+    TEST_ASSERT_EQUAL_UINT64(1, value.buckets[1]);
+    TEST_ASSERT_EQUAL_UINT64(2, value.buckets[2]);
+    // 512 <= 1000 < 1024
+    TEST_ASSERT_EQUAL_UINT64(1, value.buckets[10]);
+    TEST_ASSERT_EQUAL_UINT64(1, value.buckets[METRICS_HISTOGRAM_BUCKETS - 1]);
+}
+
+void test_dump(void) {
+    metrics_count(&counter, 42);
+    metrics_gauge_set(&gauge, 7);
+    metrics_observe(&histogram, 3);
+    TEST_ASSERT_TRUE(metrics_dump(DUMP_PATH));
+    char *json = read_file(DUMP_PATH);
+    TEST_ASSERT_NOT_NULL(strstr(json, "\"counters\": {\n    \"test.counter\": 42\n  }"));
+    TEST_ASSERT_NOT_NULL(strstr(json, "\"test.gauge\": 7"));
+    TEST_ASSERT_NOT_NULL(strstr(json, "\"test.histogram\": {\"count\": 1, \"sum\": 3, \"buckets\": [0, 0, 1]}"));
+    free(json);
+}
+
+void test_server(void) {
+#ifndef __WIN32
+    metrics_count(&counter, 9);
+    TEST_ASSERT_TRUE(metrics_server_start(SOCKET_PATH));
+    for (int i = 0; i < 2; i++) {
+        int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        struct sockaddr_un addr = {.sun_family = AF_UNIX};
+        strncpy(addr.sun_path, SOCKET_PATH, sizeof(addr.sun_path) - 1);
+        TEST_ASSERT_EQUAL(0, connect(fd, (struct sockaddr *) &addr, sizeof(addr)));
+        char buf[4096];
+        size_t len = 0;
+        ssize_t ret;
+        while ((ret = read(fd, buf + len, sizeof(buf) - 1 - len)) > 0) {
+            len += ret;
+        }
+        buf[len] = '\0';
+        close(fd);
+        TEST_ASSERT_NOT_NULL(strstr(buf, "\"test.counter\": 9"));
+    }
+    metrics_server_stop();
+    TEST_ASSERT_NOT_EQUAL(0, access(SOCKET_PATH, F_OK));
+#endif
+}
+
+void test_server_keeps_other_files(void) {
+#ifndef __WIN32
+    FILE *fp = fopen(SOCKET_PATH, "w");
+    TEST_ASSERT_NOT_NULL(fp);
+    fclose(fp);
+    TEST_ASSERT_FALSE(metrics_server_start(SOCKET_PATH));
+    TEST_ASSERT_EQUAL(0, access(SOCKET_PATH, F_OK));
+    remove(SOCKET_PATH);
+#endif
+}
+
+void test_executor(void) {
+    executor_t *executor = executor_create("test-metrics", 2);
+    // Result of the task, set to -1 by its cleanup
+    SDL_atomic_t results[3];
+    SDL_AtomicSet(&results[0], 0);
+    SDL_AtomicSet(&results[1], EIO);
+    SDL_AtomicSet(&results[2], 0);
+    for (int i = 0; i < 3; i++) {
+        metrics_executor_submit(executor, executor_task_run, executor_task_finalize, &results[i]);
+    }
+    for (int i = 0; i < 3; i++) {
+        while (SDL_AtomicGet(&results[i]) != -1) {
+            SDL_Delay(1);
+        }
+    }
+    executor_destroy(executor);
+    metrics_value_t value;
+    TEST_ASSERT_TRUE(metrics_get("executor.tasks", &value));
+    TEST_ASSERT_EQUAL_INT64(3, value.value);
+    TEST_ASSERT_TRUE(metrics_get("executor.failures", &value));
+    TEST_ASSERT_EQUAL_INT64(1, value.value);
+    TEST_ASSERT_TRUE(metrics_get("executor.pending", &value));
+    TEST_ASSERT_EQUAL_INT64(0, value.value);
+    TEST_ASSERT_TRUE(metrics_get("executor.task_ms", &value));
+    TEST_ASSERT_EQUAL_UINT64(3, value.count);
+}
+
+static int count_worker(void *unused) {
+    (void) unused;
+    for (int i = 0; i < ITERATIONS; i++) {
+        metrics_count(&counter, 1);
+    }
+    return 0;
+}
+
+static int executor_task_run(void *arg) {
+    return SDL_AtomicGet(arg);
+}
+
+static void executor_task_finalize(void *arg, int result) {
+    (void) result;
+    SDL_AtomicSet(arg, -1);
+}
+
+static char *read_file(const char *path) {
+    FILE *fp = fopen(path, "rb");
+    TEST_ASSERT_NOT_NULL(fp);
+    fseek(fp, 0, SEEK_END);
+    long size = ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+    char *data = malloc(size + 1);
+    TEST_ASSERT_EQUAL(size, fread(data, 1, size, fp));
+    data[size] = '\0';
+    fclose(fp);
+    return data;
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_counter_threads);
+    RUN_TEST(test_same_name);
+    RUN_TEST(test_gauge);
+    RUN_TEST(test_reset_keeps_gauge);
+    RUN_TEST(test_histogram);
+    RUN_TEST(test_dump);
+    RUN_TEST(test_server);
+    RUN_TEST(test_server_keeps_other_files);
+    RUN_TEST(test_executor);
+    return UNITY_END();
+}